@@ -0,0 +1,191 @@
+//
+//  AsyncFetchBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Measures getting random resources from several files whose data isn't in
+//  RAM yet, one FakeGetResource() after the other, against starting batches
+//  of FakeStartResFetch() and waiting for them with FakeCompleteResFetches(),
+//  with io_uring and with threads. The files are evicted from the OS's cache
+//  before each run, so this measures actual disk reads where the OS allows that.
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+#define NUM_FILES			4
+#define RESOURCES_PER_FILE	1000
+
+
+struct RCLRequest
+{
+	int			fileIndex;
+	int16_t		resID;
+};
+
+
+static int		sNumFetched = 0;
+static long		sBytesFetched = 0;
+
+
+static void	RCLFetchDone( Handle inResource, int16_t inError, void* inRefCon )
+{
+	if( inResource && inError == noErr )
+	{
+		sNumFetched++;
+		sBytesFetched += FakeGetHandleSize( inResource );
+	}
+}
+
+
+// Evicts and opens all files, without reading any resource data:
+static bool	RCLOpenFiles( char inPaths[NUM_FILES][256], int16_t outRefNums[NUM_FILES] )
+{
+	FakeSetResLoad( false );
+	FakeSetResPrefetch( false );
+	for( int x = 0; x < NUM_FILES; x++ )
+	{
+		RCLEvictFileFromCache( inPaths[x] );
+		outRefNums[x] = RCLOpenResFileAtPath( inPaths[x] );
+		if( outRefNums[x] < 0 )
+		{
+			fprintf( stderr, "Couldn't open %s (%d)\n", inPaths[x], FakeResError() );
+			return false;
+		}
+	}
+	FakeSetResLoad( true );
+	return true;
+}
+
+
+static void	RCLCloseFiles( int16_t inRefNums[NUM_FILES] )
+{
+	for( int x = 0; x < NUM_FILES; x++ )
+		FakeCloseResFile( inRefNums[x] );
+}
+
+
+static double	RCLGetOneByOne( char inPaths[NUM_FILES][256], const struct RCLRequest* inRequests, int inCount, long* outBytes )
+{
+	int16_t		refNums[NUM_FILES];
+	if( !RCLOpenFiles( inPaths, refNums ) )
+		return -1;
+
+	long		bytesRead = 0;
+	double		startTime = RCLCurrentTime();
+	for( int x = 0; x < inCount; x++ )
+	{
+		FakeUseResFile( refNums[inRequests[x].fileIndex] );
+		Handle	theResource = FakeGetResource( RCLGeneratedResType( 0 ), inRequests[x].resID );
+		if( theResource && FakeResError() == noErr )
+			bytesRead += FakeGetHandleSize( theResource );
+	}
+	double		duration = RCLCurrentTime() -startTime;
+
+	RCLCloseFiles( refNums );
+	*outBytes = bytesRead;
+	return duration;
+}
+
+
+static double	RCLFetchInBatches( char inPaths[NUM_FILES][256], const struct RCLRequest* inRequests, int inCount, int inBatchSize, long* outBytes )
+{
+	int16_t		refNums[NUM_FILES];
+	if( !RCLOpenFiles( inPaths, refNums ) )
+		return -1;
+
+	sNumFetched = 0;
+	sBytesFetched = 0;
+	double		startTime = RCLCurrentTime();
+	for( int x = 0; x < inCount; x += inBatchSize )
+	{
+		for( int y = x; y < inCount && y < (x +inBatchSize); y++ )
+		{
+			FakeUseResFile( refNums[inRequests[y].fileIndex] );
+			FakeStartResFetch( RCLGeneratedResType( 0 ), inRequests[y].resID, RCLFetchDone, NULL );
+		}
+		while( FakeCountResFetches() > 0 )
+			FakeCompleteResFetches( true );
+	}
+	double		duration = RCLCurrentTime() -startTime;
+
+	RCLCloseFiles( refNums );
+	if( sNumFetched != inCount )
+		fprintf( stderr, "Only fetched %d of %d resources.\n", sNumFetched, inCount );
+	*outBytes = sBytesFetched;
+	return duration;
+}
+
+
+int	main( int argc, const char** argv )
+{
+	const char*		pathPrefix = (argc > 1) ? argv[1] : "/tmp/AsyncFetchBench";
+	int				numRepeats = (argc > 2) ? atoi( argv[2] ) : 3;
+	const int		numRequests = 2000;
+	const int		batchSizes[] = { 1, 8, 64, 256 };
+	char			paths[NUM_FILES][256];
+
+	for( int x = 0; x < NUM_FILES; x++ )
+	{
+		struct RCLResFileSpec	spec = { .numTypes = 1, .resourcesPerType = RESOURCES_PER_FILE, .minDataSize = 4096, .maxDataSize = 12288,
+											.sizeDistribution = RCLSizeUniform, .seed = x +1 };
+		snprintf( paths[x], sizeof(paths[x]), "%s-%d.rsrc", pathPrefix, x );
+		if( !RCLWriteResFile( paths[x], &spec ) )
+		{
+			fprintf( stderr, "Couldn't write %s\n", paths[x] );
+			return 1;
+		}
+	}
+
+	// Random resources from random files, like requests coming in to a server:
+	struct RCLRequest*	requests = malloc( numRequests * sizeof(struct RCLRequest) );
+	uint32_t			randomState = 1;
+	for( int x = 0; x < numRequests; x++ )
+	{
+		requests[x].fileIndex = (int)(RCLNextRandom( &randomState ) % NUM_FILES);
+		requests[x].resID = (int16_t)(128 +RCLNextRandom( &randomState ) % RESOURCES_PER_FILE);
+	}
+
+	char		params[256];
+	long		bytesRead = 0;
+	double		bestTime = 0;
+	for( int r = 0; r < numRepeats; r++ )
+	{
+		double	duration = RCLGetOneByOne( paths, requests, numRequests, &bytesRead );
+		if( r == 0 || duration < bestTime )
+			bestTime = duration;
+	}
+	snprintf( params, sizeof(params), "\"files\":%d,\"mb_per_sec\":%.1f", NUM_FILES, (bytesRead / (1024.0 * 1024.0)) / bestTime );
+	RCLReportResult( "getresource_qd1", params, numRequests, bestTime );
+
+	for( int useIOUring = 1; useIOUring >= 0; useIOUring-- )
+	{
+		FakeSetResFetchIOUring( useIOUring );
+		for( size_t b = 0; b < sizeof(batchSizes) / sizeof(batchSizes[0]); b++ )
+		{
+			for( int r = 0; r < numRepeats; r++ )
+			{
+				double	duration = RCLFetchInBatches( paths, requests, numRequests, batchSizes[b], &bytesRead );
+				if( r == 0 || duration < bestTime )
+					bestTime = duration;
+			}
+			snprintf( params, sizeof(params), "\"files\":%d,\"backend\":\"%s\",\"batch\":%d,\"mb_per_sec\":%.1f", NUM_FILES,
+						useIOUring ? "io_uring" : "threads", batchSizes[b], (bytesRead / (1024.0 * 1024.0)) / bestTime );
+			RCLReportResult( "fetch_async", params, numRequests, bestTime );
+		}
+	}
+
+	free( requests );
+	for( int x = 0; x < NUM_FILES; x++ )
+		remove( paths[x] );
+
+	return 0;
+}
@@ -0,0 +1,82 @@
+//
+//  BenchSupport.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "BenchSupport.h"
+#include "FakeResources.h"
+
+
+double	RCLCurrentTime( void )
+{
+	struct timespec	now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return (double)now.tv_sec +(double)now.tv_nsec / 1e9;
+}
+
+
+uint32_t	RCLNextRandom( uint32_t* ioState )
+{
+	*ioState = *ioState * 1103515245 + 12345;
+	return *ioState >> 8;
+}
+
+
+void	RCLEvictFileFromCache( const char* inPath )
+{
+#if defined(POSIX_FADV_DONTNEED)
+	int		fd = open( inPath, O_RDONLY );
+	if( fd >= 0 )
+	{
+		fdatasync( fd );
+		posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+		close( fd );
+	}
+#endif
+}
+
+
+int16_t	RCLOpenResFileAtPath( const char* inPath )
+{
+	unsigned char	pascalPath[256] = {0};
+	pascalPath[0] = (unsigned char)strlen( inPath );
+	memmove( pascalPath +1, inPath, pascalPath[0] );
+	return FakeOpenResFile( pascalPath );
+}
+
+
+bool	RCLGetMemoryUsage( long* outRssKB, long* outPssKB )
+{
+	FILE*	theFile = fopen( "/proc/self/smaps_rollup", "r" );
+	if( !theFile )
+		return false;
+	char	line[256];
+	*outRssKB = *outPssKB = 0;
+	while( fgets( line, sizeof(line), theFile ) )
+	{
+		if( strncmp( line, "Rss:", 4 ) == 0 )
+			*outRssKB = atol( line +4 );
+		else if( strncmp( line, "Pss:", 4 ) == 0 )
+			*outPssKB = atol( line +4 );
+	}
+	fclose( theFile );
+	return true;
+}
+
+
+void	RCLReportResult( const char* inBenchmark, const char* inParams, int64_t inIterations, double inSeconds )
+{
+	printf( "{\"benchmark\":\"%s\",%s%s\"iterations\":%lld,\"seconds\":%.9f,\"ns_per_op\":%.1f}\n",
+			inBenchmark, inParams ? inParams : "", (inParams && inParams[0]) ? "," : "",
+			(long long)inIterations, inSeconds, (inIterations > 0) ? (inSeconds * 1e9 / inIterations) : 0.0 );
+	fflush( stdout );
+}
@@ -0,0 +1,47 @@
+//
+//  BenchSupport.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#ifndef ReClassicfication_BenchSupport_h
+#define ReClassicfication_BenchSupport_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+// Seconds since some arbitrary point in time, for measuring durations:
+double		RCLCurrentTime( void );
+
+// Pseudo-random numbers that are the same on every run, so results stay comparable.
+//	Advances *ioState, which is the seed to start with:
+uint32_t	RCLNextRandom( uint32_t* ioState );
+
+// Remove the file from the OS's file cache (if possible) so the next read has to hit the disk:
+void		RCLEvictFileFromCache( const char* inPath );
+
+// FakeOpenResFile() with a C string:
+int16_t		RCLOpenResFileAtPath( const char* inPath );
+
+// Resident set size and proportional set size (which only counts a share of
+//	memory several mappings or processes use) of this process, in KB. Needs
+//	Linux's /proc, returns false if we can't tell:
+bool		RCLGetMemoryUsage( long* outRssKB, long* outPssKB );
+
+// Prints one result as a line of JSON, e.g.
+//	{"benchmark":"open","types":4,"iterations":10,"seconds":0.5,"ns_per_op":50000000.0}
+//	inParams are extra JSON members (without surrounding braces), may be NULL.
+void		RCLReportResult( const char* inBenchmark, const char* inParams, int64_t inIterations, double inSeconds );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+//
+//  CacheCompressionBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Opens a generated file whose resources hold text-like data, gets all of
+//  them, then lets FakeSetResourceCacheCompression() compress them all and
+//  reports how long that took and how much smaller they got. Then gets them
+//  all again, which decompresses them, and reports the time per resource,
+//  against getting them all again after they were emptied to stay within the
+//  budget, which reads them from the file (which is in the OS's cache, so
+//  that's the best case for reading).
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+#define NUM_TYPES		4
+
+
+// Fills each resource with words picked at random, like strings or dialog items:
+static uint32_t	RCLMakeText( size_t inIndex, uint8_t* ioData, uint32_t inLength, uint32_t inMaxLength, uint8_t* outAttributes, void* inRefCon )
+{
+	(void)inMaxLength; (void)outAttributes; (void)inRefCon;
+	static const char*	words[] = { "the ", "resource ", "file ", "window ", "OK ", "Cancel ", "of ", "and ", "dialog ", "menu ",
+									"item ", "to ", "a ", "icon ", "Save ", "changes ", "before ", "closing ", "?\r", ".\r" };
+	uint32_t	seed = (uint32_t)inIndex +1;
+	uint32_t	length = 0;
+	while( length < inLength )
+	{
+		const char*	word = words[RCLNextRandom( &seed ) % (sizeof(words) / sizeof(words[0]))];
+		for( ; *word && length < inLength; word++ )
+			ioData[length++] = (uint8_t)*word;
+	}
+	return inLength;
+}
+
+
+// Gets all resources in the current file, returns the seconds that took:
+static double	RCLGetAllResources( int inResourcesPerType, uint32_t* ioChecksum )
+{
+	double		startTime = RCLCurrentTime();
+	for( int t = 0; t < NUM_TYPES; t++ )
+	{
+		for( int r = 0; r < inResourcesPerType; r++ )
+		{
+			Handle	theResource = FakeGet1Resource( RCLGeneratedResType( t ), (int16_t)(128 +r) );
+			if( theResource && *theResource )
+				*ioChecksum += (uint8_t)(*theResource)[FakeGetHandleSize( theResource ) / 2];
+		}
+	}
+	return RCLCurrentTime() -startTime;
+}
+
+
+int	main( int argc, const char** argv )
+{
+	int				numResources = (argc > 1) ? atoi( argv[1] ) : 4000;
+	const char*		filePath = (argc > 2) ? argv[2] : "/tmp/CacheCompressionBench.rsrc";
+	if( numResources < NUM_TYPES || numResources > 8000 )
+	{
+		fprintf( stderr, "Usage: %s [<resources, %d to 8000> [<file>]]\n", argv[0], NUM_TYPES );
+		return 1;
+	}
+	int				resourcesPerType = numResources / NUM_TYPES;
+
+	struct RCLResFileSpec	spec = { .numTypes = NUM_TYPES, .resourcesPerType = resourcesPerType, .minDataSize = 256, .maxDataSize = 4096,
+										.sizeDistribution = RCLSizeExponential, .seed = 1, .dataProc = RCLMakeText };
+	if( !RCLWriteResFile( filePath, &spec ) )
+	{
+		fprintf( stderr, "Couldn't write %s\n", filePath );
+		return 1;
+	}
+
+	int16_t		refNum = RCLOpenResFileAtPath( filePath );
+	if( refNum < 0 )
+	{
+		fprintf( stderr, "Couldn't open %s (%d)\n", filePath, refNum );
+		return 1;
+	}
+	uint32_t	checksum = 0;
+	RCLGetAllResources( resourcesPerType, &checksum );
+
+	// Compress everything: it's all cold after a moment, and the next request notices.
+	FakeSetResourceCacheCompression( 0.01 );
+	usleep( 20000 );
+	double		startTime = RCLCurrentTime();
+	FakeGet1Resource( RCLGeneratedResType( 0 ), 128 );
+	double		compressSeconds = RCLCurrentTime() -startTime;
+	FakeSetResourceCacheCompression( 0 );
+
+	struct FakeResourceCacheStats	stats;
+	FakeGetResourceCacheStats( &stats );
+	char		params[256];
+	snprintf( params, sizeof(params), "\"resources\":%llu,\"mb_before\":%.1f,\"mb_after\":%.1f,\"ratio\":%.2f,\"mb_saved\":%.1f",
+				(unsigned long long)stats.numCompressed, stats.bytesBeforeCompression / 1048576.0, stats.bytesAfterCompression / 1048576.0,
+				stats.bytesAfterCompression ? (double)stats.bytesBeforeCompression / stats.bytesAfterCompression : 0.0,
+				(stats.bytesBeforeCompression -stats.bytesAfterCompression) / 1048576.0 );
+	RCLReportResult( "compress", params, (int64_t)stats.numCompressed, compressSeconds );
+
+	// Get them all again, which decompresses them:
+	uint64_t	numDecompressions = stats.decompressions;
+	double		getSeconds = RCLGetAllResources( resourcesPerType, &checksum );
+	FakeGetResourceCacheStats( &stats );
+	numDecompressions = stats.decompressions -numDecompressions;
+	snprintf( params, sizeof(params), "\"decompressions\":%llu,\"decompress_ns_per_resource\":%.1f", (unsigned long long)numDecompressions,
+				stats.decompressions ? stats.decompressSeconds * 1e9 / stats.decompressions : 0.0 );
+	RCLReportResult( "get_compressed", params, numResources, getSeconds );
+
+	// Empty them all instead, and get them again, which reads them from the file:
+	FakeSetResourceCacheBudget( 1 );
+	FakeSetResourceCacheBudget( 0 );
+	getSeconds = RCLGetAllResources( resourcesPerType, &checksum );
+	snprintf( params, sizeof(params), "\"checksum\":%u", checksum );
+	RCLReportResult( "get_evicted", params, numResources, getSeconds );
+
+	FakeCloseResFile( refNum );
+	remove( filePath );
+
+	return 0;
+}
@@ -0,0 +1,119 @@
+//
+//  ChainMissBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Opens a chain of generated files and measures FakeGetResource() finding
+//  resources in the file opened first, which it has to search last, and
+//  not finding resources no file has, once with different IDs each time
+//  and once asking for the same few again and again. For comparison, also
+//  times what a miss costs when you look through every file yourself with
+//  FakeUseResFile() and FakeGet1Resource().
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+#define MAX_FILES			64
+#define RESOURCES_PER_FILE	500
+
+
+int	main( int argc, const char** argv )
+{
+	int64_t			numIterations = (argc > 1) ? atoll( argv[1] ) : 200000;
+	int				numFiles = (argc > 2) ? atoi( argv[2] ) : 16;
+	const char*		pathPrefix = (argc > 3) ? argv[3] : "/tmp/ChainMissBench";
+	if( numIterations < 1 || numFiles < 1 || numFiles > MAX_FILES )
+	{
+		fprintf( stderr, "Usage: %s [<iterations> [<files, 1 to %d> [<path prefix>]]]\n", argv[0], MAX_FILES );
+		return 1;
+	}
+
+	// Each file has its own range of IDs, so a resource is only in one of them:
+	char		paths[MAX_FILES][256];
+	int16_t		refNums[MAX_FILES];
+	for( int x = 0; x < numFiles; x++ )
+	{
+		struct RCLResFileSpec	spec = { .numTypes = 4, .resourcesPerType = RESOURCES_PER_FILE, .minDataSize = 16, .maxDataSize = 64,
+											.sizeDistribution = RCLSizeUniform, .seed = x +1 };
+		snprintf( paths[x], sizeof(paths[x]), "%s-%d.rsrc", pathPrefix, x );
+		if( !RCLWriteResFile( paths[x], &spec ) )
+		{
+			fprintf( stderr, "Couldn't write %s\n", paths[x] );
+			return 1;
+		}
+		refNums[x] = RCLOpenResFileAtPath( paths[x] );
+		if( refNums[x] < 0 )
+		{
+			fprintf( stderr, "Couldn't open %s (%d)\n", paths[x], FakeResError() );
+			return 1;
+		}
+	}
+
+	uint32_t	type = RCLGeneratedResType( 0 );
+	char		params[64];
+	snprintf( params, sizeof(params), "\"files\":%d", numFiles );
+
+	// Hits in the file opened first:
+	FakeUseResFile( refNums[numFiles -1] );
+	long		numFound = 0;
+	double		startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < numIterations; i++ )
+	{
+		if( FakeGetResource( type, (int16_t)(128 +(i * 7) % RESOURCES_PER_FILE) ) )
+			numFound++;
+	}
+	RCLReportResult( "chain_hit", params, numIterations, RCLCurrentTime() -startTime );
+	if( numFound != numIterations )
+		fprintf( stderr, "Only found %ld of %lld resources.\n", numFound, (long long)numIterations );
+
+	// Misses, with IDs none of the files have:
+	numFound = 0;
+	startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < numIterations; i++ )
+	{
+		if( FakeGetResource( type, (int16_t)(-1 -(i % 30000)) ) )
+			numFound++;
+	}
+	RCLReportResult( "chain_miss_distinct", params, numIterations, RCLCurrentTime() -startTime );
+
+	// The same few misses over and over, like an app checking for optional resources:
+	startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < numIterations; i++ )
+	{
+		if( FakeGetResource( type, (int16_t)(-1 -(i % 8)) ) )
+			numFound++;
+	}
+	RCLReportResult( "chain_miss_repeated", params, numIterations, RCLCurrentTime() -startTime );
+
+	// What a miss costs when each file has to be asked:
+	startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < numIterations; i++ )
+	{
+		for( int x = numFiles -1; x >= 0; x-- )
+		{
+			FakeUseResFile( refNums[x] );
+			if( FakeGet1Resource( type, (int16_t)(-1 -(i % 30000)) ) )
+				numFound++;
+		}
+	}
+	RCLReportResult( "get1_each_file_miss", params, numIterations, RCLCurrentTime() -startTime );
+	if( numFound != 0 )
+		fprintf( stderr, "Found %ld resources that shouldn't exist.\n", numFound );
+
+	for( int x = 0; x < numFiles; x++ )
+	{
+		FakeCloseResFile( refNums[x] );
+		remove( paths[x] );
+	}
+
+	return 0;
+}
@@ -0,0 +1,158 @@
+//
+//  CompactBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Records an access profile of an application asking for a few hundred
+//  resources from all over a generated file, then measures opening the file
+//  and getting those resources, with the file evicted from the OS's cache
+//  first, as the file was written, after FakeCompactResFile() ordered it by
+//  the profile, and after it also aligned each resource's data to 4 KB (in
+//  the extended format, as the padding doesn't fit in a classic file).
+//  Along with the time, reports how many bytes and reads getting the data
+//  of the cold resources takes, according to FakeCompactResFile().
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+#define NUM_TYPES			4
+#define RESOURCES_PER_TYPE	1000
+
+
+struct RCLRequest
+{
+	uint32_t	type;
+	int16_t		resID;
+};
+
+
+// Marks every 100th resource resPreload, like an application's few code resources:
+static uint32_t	RCLMarkPreloads( size_t inIndex, uint8_t* ioData, uint32_t inLength, uint32_t inMaxLength, uint8_t* outAttributes, void* inRefCon )
+{
+	if( (inIndex % 100) == 0 )
+		*outAttributes |= resPreload;
+	return inLength;
+}
+
+
+// Opens the file while it isn't in the OS's cache and gets the requested resources:
+static double	RCLTimeColdOpens( const char* inPath, const struct RCLRequest* inRequests, int inNumRequests, int inRepeats )
+{
+	double		totalSeconds = 0;
+	FakeSetResLoad( false );
+	for( int r = 0; r < inRepeats; r++ )
+	{
+		RCLEvictFileFromCache( inPath );
+		double		startTime = RCLCurrentTime();
+		int16_t		refNum = RCLOpenResFileAtPath( inPath );
+		for( int x = 0; x < inNumRequests && refNum >= 0; x++ )
+		{
+			if( !FakeGet1Resource( inRequests[x].type, inRequests[x].resID ) )
+				fprintf( stderr, "Couldn't get resource %d (%d)\n", inRequests[x].resID, FakeResError() );
+		}
+		totalSeconds += RCLCurrentTime() -startTime;
+		if( refNum >= 0 )
+			FakeCloseResFile( refNum );
+	}
+	FakeSetResLoad( true );
+	return totalSeconds;
+}
+
+
+// Compacts the file and returns what FakeCompactResFile() says, or false on failure:
+static bool	RCLCompact( const char* inPath, const struct FakeResCompactOptions* inOptions, enum FakeResFileFormat inFormat, struct FakeResCompactReport* outReport )
+{
+	FakeSetResLoad( false );
+	int16_t		refNum = RCLOpenResFileAtPath( inPath );
+	FakeSetResLoad( true );
+	if( refNum < 0 )
+		return false;
+	FakeSetResFileFormat( refNum, inFormat );
+	FakeCompactResFile( refNum, inOptions, outReport );
+	int16_t		err = FakeResError();
+	FakeCloseResFile( refNum );
+	if( err != noErr )
+		fprintf( stderr, "Couldn't compact %s (%d)\n", inPath, err );
+	return err == noErr;
+}
+
+
+static void	RCLReportColdOpens( const char* inName, int inNumRequests, int inRepeats, double inSeconds, uint64_t inBytesRead, uint32_t inNumReads, uint64_t inDataLength )
+{
+	char	params[192];
+	snprintf( params, sizeof(params), "\"resources\":%d,\"cold_bytes_read\":%llu,\"cold_reads\":%u,\"read_amplification\":%.2f", inNumRequests,
+				(unsigned long long)inBytesRead, inNumReads, inDataLength ? (double)inBytesRead / (double)inDataLength : 0.0 );
+	RCLReportResult( inName, params, inRepeats, inSeconds );
+}
+
+
+int	main( int argc, const char** argv )
+{
+	int				numRequests = (argc > 1) ? atoi( argv[1] ) : 300;
+	int				numRepeats = (argc > 2) ? atoi( argv[2] ) : 10;
+	const char*		filePath = (argc > 3) ? argv[3] : "/tmp/CompactBench.rsrc";
+	if( numRequests < 1 || numRequests > NUM_TYPES * RESOURCES_PER_TYPE || numRepeats < 1 )
+	{
+		fprintf( stderr, "Usage: %s [<resources, 1 to %d> [<repeats> [<file>]]]\n", argv[0], NUM_TYPES * RESOURCES_PER_TYPE );
+		return 1;
+	}
+	
+	struct RCLResFileSpec	spec = { .numTypes = NUM_TYPES, .resourcesPerType = RESOURCES_PER_TYPE, .minDataSize = 256, .maxDataSize = 2048,
+										.sizeDistribution = RCLSizeUniform, .seed = 1, .dataProc = RCLMarkPreloads };
+	char		profilePath[256 +6];
+	snprintf( profilePath, sizeof(profilePath), "%s.rprof", filePath );
+	remove( profilePath );
+	if( !RCLWriteResFile( filePath, &spec ) )
+	{
+		fprintf( stderr, "Couldn't write %s\n", filePath );
+		return 1;
+	}
+	
+	// What the "application" asks for, in random order from all over the file:
+	struct RCLRequest*	requests = malloc( numRequests * sizeof(struct RCLRequest) );
+	uint32_t			randomState = 1;
+	for( int x = 0; x < numRequests; x++ )
+	{
+		requests[x].type = RCLGeneratedResType( RCLNextRandom( &randomState ) % NUM_TYPES );
+		requests[x].resID = (int16_t)(128 +RCLNextRandom( &randomState ) % RESOURCES_PER_TYPE);
+	}
+	
+	// Record it once:
+	FakeSetResPrefetch( false );
+	FakeSetResProfileRecording( 3600 );
+	RCLTimeColdOpens( filePath, requests, numRequests, 1 );
+	FakeSetResProfileRecording( 0 );
+	
+	struct FakeResCompactReport	report = { 0 };
+	double		seconds = RCLTimeColdOpens( filePath, requests, numRequests, numRepeats );
+	bool		ok = RCLCompact( filePath, NULL, kFakeResFileClassic, &report );
+	if( ok )
+	{
+		RCLReportColdOpens( "cold_open_original", numRequests, numRepeats, seconds, report.coldBytesReadBefore, report.coldReadsBefore, report.coldDataLength );
+		seconds = RCLTimeColdOpens( filePath, requests, numRequests, numRepeats );
+		RCLReportColdOpens( "cold_open_compacted", numRequests, numRepeats, seconds, report.coldBytesReadAfter, report.coldReadsAfter, report.coldDataLength );
+	}
+	
+	struct FakeResCompactOptions	alignedOptions = { .useProfile = true, .alignment = 4096 };
+	ok = ok && RCLCompact( filePath, &alignedOptions, kFakeResFileExtended, &report );
+	if( ok )
+	{
+		seconds = RCLTimeColdOpens( filePath, requests, numRequests, numRepeats );
+		RCLReportColdOpens( "cold_open_aligned", numRequests, numRepeats, seconds, report.coldBytesReadAfter, report.coldReadsAfter, report.coldDataLength );
+	}
+	
+	free( requests );
+	remove( profilePath );
+	remove( filePath );
+	
+	return ok ? 0 : 1;
+}
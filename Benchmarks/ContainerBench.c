@@ -0,0 +1,115 @@
+//
+//  ContainerBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Compares opening the resource fork inside a MacBinary, AppleSingle or
+//  AppleDouble file in place with the old way of first copying it out into a
+//  file of its own. The container is evicted from the OS's cache before each
+//  run, so both include reading it from disk where the OS allows that.
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "FakeResources.h"
+#include "FakeContainers.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+// What we used to do: Copy the fork into a temporary file and open that:
+static int16_t	ExtractAndOpen( const char* inContainerPath, const char* inTempPath )
+{
+	int			containerFD = open( inContainerPath, O_RDONLY );
+	uint32_t	forkOffset = 0, forkLength = 0;
+	if( containerFD < 0 || FakeLocateResourceFork( containerFD, &forkOffset, &forkLength ) == kFakeContainerNone )
+		return -1;
+	
+	int		tempFD = open( inTempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	char	buffer[65536];
+	while( forkLength > 0 )
+	{
+		size_t	amount = (forkLength < sizeof(buffer)) ? forkLength : sizeof(buffer);
+		ssize_t	amountRead = pread( containerFD, buffer, amount, forkOffset );
+		if( amountRead <= 0 || write( tempFD, buffer, amountRead ) != amountRead )
+			break;
+		forkOffset += amountRead;
+		forkLength -= amountRead;
+	}
+	close( tempFD );
+	close( containerFD );
+	
+	return RCLOpenResFileAtPath( inTempPath );
+}
+
+
+int	main( int argc, const char** argv )
+{
+	const char*		filePath = (argc > 1) ? argv[1] : "/tmp/ContainerBench.rsrc";
+	int				numRepeats = (argc > 2) ? atoi( argv[2] ) : 10;
+	const char*		formatNames[] = { "macbinary", "applesingle", "appledouble" };
+	char			containerPath[1024], tempPath[1024];
+	snprintf( containerPath, sizeof(containerPath), "%s.container", filePath );
+	snprintf( tempPath, sizeof(tempPath), "%s.extracted", filePath );
+	
+	struct RCLResFileSpec	spec = { .numTypes = 8, .resourcesPerType = 256, .minDataSize = 16, .maxDataSize = 6144,
+										.sizeDistribution = RCLSizeExponential, .namedFraction = 0.5, .seed = 1 };
+	if( !RCLWriteResFile( filePath, &spec ) )
+	{
+		fprintf( stderr, "Couldn't write %s\n", filePath );
+		return 1;
+	}
+	
+	for( int f = RCLContainerMacBinary; f <= RCLContainerAppleDouble; f++ )
+	{
+		if( !RCLWrapResFile( filePath, containerPath, f, 100000 ) )
+		{
+			fprintf( stderr, "Couldn't write %s\n", containerPath );
+			return 1;
+		}
+		
+		char	params[128];
+		snprintf( params, sizeof(params), "\"format\":\"%s\",\"resources\":%d", formatNames[f], spec.numTypes * spec.resourcesPerType );
+		
+		double	extractTime = 0, inPlaceTime = 0;
+		for( int r = 0; r < numRepeats; r++ )
+		{
+			RCLEvictFileFromCache( containerPath );
+			double	startTime = RCLCurrentTime();
+			int16_t	refNum = ExtractAndOpen( containerPath, tempPath );
+			extractTime += RCLCurrentTime() -startTime;
+			if( refNum < 0 || FakeCount1Types() != spec.numTypes )
+			{
+				fprintf( stderr, "Couldn't open extracted %s fork (%d)\n", formatNames[f], refNum );
+				return 1;
+			}
+			FakeCloseResFile( refNum );
+			remove( tempPath );
+			
+			RCLEvictFileFromCache( containerPath );
+			startTime = RCLCurrentTime();
+			refNum = RCLOpenResFileAtPath( containerPath );
+			inPlaceTime += RCLCurrentTime() -startTime;
+			if( refNum < 0 || FakeCount1Types() != spec.numTypes )
+			{
+				fprintf( stderr, "Couldn't open %s in place (%d)\n", formatNames[f], refNum );
+				return 1;
+			}
+			FakeCloseResFile( refNum );
+		}
+		
+		RCLReportResult( "container_extract_then_open", params, numRepeats, extractTime );
+		RCLReportResult( "container_open_in_place", params, numRepeats, inPlaceTime );
+	}
+	
+	remove( containerPath );
+	remove( filePath );
+	
+	return 0;
+}
@@ -0,0 +1,337 @@
+//
+//  DecompressBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Measures how fast compressed resources are loaded and decompressed, per
+//  format, against the same data stored uncompressed. The data is made of
+//  2-byte words picked from a small vocabulary, a few of them much more often
+//  than the rest, roughly like 68000 code.
+//
+//  Formats that use a table built into the 'dcmp' ('dcmp' 0, 1, and 2 without
+//  a table of its own) code the most common words as words of that table, so
+//  they decompress to other words than the rest, but just as many.
+//  "dcmp_hook" measures the overhead of a decompressor installed with
+//  FakeSetResourceDecompressor() (one that just copies stored data).
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+enum RCLCompressionFormat
+{
+	RCLFormatUncompressed = 0,
+	RCLFormatDcmp0,
+	RCLFormatDcmp1,
+	RCLFormatDcmp2Untagged,
+	RCLFormatDcmp2Tagged,
+	RCLFormatDcmp2DefaultTable,
+	RCLFormatHook,
+	RCLFormatCount
+};
+
+
+#define RCL_VOCABULARY_SIZE		320		// More than fit in a 'dcmp' 2 table, so tagged data has literals.
+#define RCL_TABLE_SIZE			256
+#define RCL_HEADER_LENGTH		18
+#define RCL_TABLE_CODE_WORDS	32		// How many of the most common words 'dcmp' 0 and 1 code as words of their table.
+#define RCL_HOOK_DCMP_ID		128
+
+#define RCL_DCMP2_CUSTOM_TABLE	0x01
+#define RCL_DCMP2_TAGGED		0x02
+
+
+static const char*	sFormatNames[RCLFormatCount] = { "uncompressed", "dcmp0", "dcmp1", "dcmp2_untagged", "dcmp2_tagged", "dcmp2_default_table", "dcmp_hook" };
+
+
+static void	RCLPutUInt32BE( uint32_t inNum, uint8_t* outBytes )
+{
+	outBytes[0] = (uint8_t)(inNum >> 24);
+	outBytes[1] = (uint8_t)(inNum >> 16);
+	outBytes[2] = (uint8_t)(inNum >> 8);
+	outBytes[3] = (uint8_t)inNum;
+}
+
+
+// Word number inIndex of the vocabulary. Low numbers are the common ones:
+static void	RCLVocabularyWord( unsigned inIndex, uint8_t* outWord )
+{
+	outWord[0] = (uint8_t)(inIndex * 37 +0x4E);
+	outWord[1] = (uint8_t)(inIndex * 11 +(inIndex >> 8));
+}
+
+
+// Writes the extended header in front of compressed data:
+static void	RCLWriteExtendedHeader( uint8_t* outHeader, uint8_t inVersion, uint32_t inDecompressedLength, int16_t inDcmpID, uint8_t inFlags )
+{
+	memset( outHeader, 0, RCL_HEADER_LENGTH );
+	RCLPutUInt32BE( 0xA89F6572, outHeader );
+	outHeader[5] = RCL_HEADER_LENGTH;
+	outHeader[6] = inVersion;
+	outHeader[7] = 0x01;	// Compressed.
+	RCLPutUInt32BE( inDecompressedLength, outHeader +8 );
+	if( inVersion == 8 )
+	{
+		outHeader[14] = (uint8_t)(inDcmpID >> 8);
+		outHeader[15] = (uint8_t)inDcmpID;
+	}
+	else
+	{
+		outHeader[12] = (uint8_t)(inDcmpID >> 8);
+		outHeader[13] = (uint8_t)inDcmpID;
+		outHeader[16] = ((inFlags & RCL_DCMP2_CUSTOM_TABLE) != 0) ? (RCL_TABLE_SIZE -1) : 0;
+		outHeader[17] = inFlags;
+	}
+}
+
+
+// Number in the variable length format of 'dcmp' 0 and 1, for -0x4000 to 0x3EFF:
+static size_t	RCLPutDcmpNumber( int32_t inNum, uint8_t* outBytes )
+{
+	if( inNum >= -0x40 && inNum < 0x40 )
+	{
+		outBytes[0] = (uint8_t)(inNum +0x40);
+		return 1;
+	}
+	outBytes[0] = (uint8_t)((inNum +0xC000) >> 8);
+	outBytes[1] = (uint8_t)(inNum +0xC000);
+	return 2;
+}
+
+
+// Compresses with 'dcmp' 0 or 1. The most common words become words of the
+//	built-in table, the others are remembered as literals the first time and
+//	repeated after that:
+static size_t	RCLCompressDcmp0Or1( bool inDcmp1, const unsigned* inWordIndexes, const uint8_t* inWords, uint32_t inLength, uint8_t* outData )
+{
+	int			literalNumbers[RCL_VOCABULARY_SIZE];
+	int			numLiterals = 0;
+	size_t		pos = 0;
+	for( unsigned x = 0; x < RCL_VOCABULARY_SIZE; x++ )
+		literalNumbers[x] = -1;
+	for( uint32_t x = 0, item = 0; (x +1) < inLength; x += 2, item++ )
+	{
+		unsigned	wordIndex = inWordIndexes[item];
+		int			literalNumber = literalNumbers[wordIndex];
+		if( wordIndex < RCL_TABLE_CODE_WORDS )
+			outData[pos++] = (uint8_t)((inDcmp1 ? 0xD5 : 0x4B) +wordIndex);
+		else if( literalNumber < 0 )
+		{
+			outData[pos++] = 0x11;	// One word for 'dcmp' 0, two bytes for 'dcmp' 1, remembered.
+			memmove( outData +pos, inWords +x, 2 );
+			pos += 2;
+			literalNumbers[wordIndex] = numLiterals++;
+		}
+		else if( inDcmp1 && literalNumber < 0xB0 )
+			outData[pos++] = (uint8_t)(0x20 +literalNumber);
+		else if( inDcmp1 )
+		{
+			outData[pos++] = 0xD2;
+			outData[pos++] = (uint8_t)(literalNumber -0xB0);
+		}
+		else if( literalNumber < 0x28 )
+			outData[pos++] = (uint8_t)(0x23 +literalNumber);
+		else
+		{
+			outData[pos++] = (uint8_t)(0x20 +((literalNumber -0x28) >> 8));
+			outData[pos++] = (uint8_t)(literalNumber -0x28);
+		}
+	}
+	if( (inLength & 1) != 0 && inDcmp1 )
+	{
+		outData[pos++] = 0x00;	// Literal of one byte.
+		outData[pos++] = inWords[inLength -1];
+	}
+	else if( (inLength & 1) != 0 )
+	{
+		outData[pos++] = 0xFE;	// The byte, once.
+		outData[pos++] = 0x02;
+		pos += RCLPutDcmpNumber( inWords[inLength -1], outData +pos );
+		pos += RCLPutDcmpNumber( 0, outData +pos );
+	}
+	outData[pos++] = 0xFF;
+
+	return pos;
+}
+
+
+// Compresses with 'dcmp' 2. A custom table holds the most common words of our
+//	vocabulary, the built-in one stands in for them:
+static size_t	RCLCompressDcmp2( uint8_t inFlags, const unsigned* inWordIndexes, const uint8_t* inWords, uint32_t inLength, uint8_t* outData )
+{
+	bool		tagged = (inFlags & RCL_DCMP2_TAGGED) != 0;
+	size_t		pos = 0, tagPos = 0;
+	if( (inFlags & RCL_DCMP2_CUSTOM_TABLE) != 0 )
+	{
+		for( unsigned x = 0; x < RCL_TABLE_SIZE; x++, pos += 2 )
+			RCLVocabularyWord( x, outData +pos );
+	}
+	for( uint32_t x = 0, item = 0; (x +1) < inLength; x += 2, item++ )
+	{
+		if( tagged && (item % 8) == 0 )
+		{
+			tagPos = pos++;
+			outData[tagPos] = 0;
+		}
+		if( inWordIndexes[item] < RCL_TABLE_SIZE )
+		{
+			if( tagged )
+				outData[tagPos] |= (uint8_t)(0x80 >> (item % 8));
+			outData[pos++] = (uint8_t)inWordIndexes[item];
+		}
+		else
+		{
+			memmove( outData +pos, inWords +x, 2 );
+			pos += 2;
+		}
+	}
+	if( (inLength & 1) != 0 )
+		outData[pos++] = inWords[inLength -1];
+
+	return pos;
+}
+
+
+// Replaces the generated data with words from our vocabulary, compressed as
+//	the format in inRefCon says:
+static uint32_t	RCLMakeResourceData( size_t inIndex, uint8_t* ioData, uint32_t inLength, uint32_t inMaxLength, uint8_t* outAttributes, void* inRefCon )
+{
+	enum RCLCompressionFormat	format = *(enum RCLCompressionFormat*)inRefCon;
+	uint32_t	randomState = (uint32_t)inIndex * 2654435761u +1;
+	unsigned	vocabularySize = (format == RCLFormatDcmp2Untagged) ? RCL_TABLE_SIZE : RCL_VOCABULARY_SIZE;	// Untagged can't do literals.
+	uint8_t*	words = malloc( inLength +2 );
+	unsigned*	wordIndexes = malloc( (inLength / 2 +1) * sizeof(unsigned) );
+	for( uint32_t x = 0; x < inLength; x += 2 )
+	{
+		randomState = randomState * 1103515245 + 12345;
+		unsigned	a = (randomState >> 8) % vocabularySize, b = (randomState >> 20) % vocabularySize;
+		wordIndexes[x / 2] = (a < b) ? a : b;	// Smaller of two, so low numbers are more likely.
+		RCLVocabularyWord( wordIndexes[x / 2], words +x );
+	}
+
+	uint32_t	length = inLength;
+	if( format == RCLFormatUncompressed )
+		memmove( ioData, words, inLength );
+	else if( format == RCLFormatHook )
+	{
+		length = RCL_HEADER_LENGTH +inLength;
+		if( length > inMaxLength )
+			length = inMaxLength;
+		RCLWriteExtendedHeader( ioData, 8, length -RCL_HEADER_LENGTH, RCL_HOOK_DCMP_ID, 0 );
+		memmove( ioData +RCL_HEADER_LENGTH, words, length -RCL_HEADER_LENGTH );
+		*outAttributes = resCompressed;
+	}
+	else
+	{
+		uint8_t*	out = malloc( RCL_HEADER_LENGTH +2 * RCL_TABLE_SIZE +inLength * 2 +16 );
+		size_t		pos = RCL_HEADER_LENGTH;
+		if( format == RCLFormatDcmp0 || format == RCLFormatDcmp1 )
+		{
+			RCLWriteExtendedHeader( out, 8, inLength, (format == RCLFormatDcmp1) ? 1 : 0, 0 );
+			pos += RCLCompressDcmp0Or1( format == RCLFormatDcmp1, wordIndexes, words, inLength, out +pos );
+		}
+		else
+		{
+			uint8_t		flags = (format == RCLFormatDcmp2DefaultTable) ? 0 : RCL_DCMP2_CUSTOM_TABLE;
+			if( format != RCLFormatDcmp2Untagged )
+				flags |= RCL_DCMP2_TAGGED;
+			RCLWriteExtendedHeader( out, 9, inLength, 2, flags );
+			pos += RCLCompressDcmp2( flags, wordIndexes, words, inLength, out +pos );
+		}
+
+		length = (pos <= inMaxLength) ? (uint32_t)pos : inLength;
+		if( pos <= inMaxLength )
+		{
+			memmove( ioData, out, pos );
+			*outAttributes = resCompressed;
+		}
+		else
+			memmove( ioData, words, inLength );
+		free( out );
+	}
+
+	free( wordIndexes );
+	free( words );
+	return length;
+}
+
+
+// Stand-in for a decompressor of another format, the data is just stored:
+static int16_t	RCLCopyStoredData( int16_t inDcmpID, const uint8_t* inHeader, size_t inHeaderLength, const uint8_t* inData, size_t inDataLength,
+								uint8_t* outData, size_t outDataLength, void* inRefCon )
+{
+	if( inDataLength < outDataLength )
+		return CantDecompress;
+	memmove( outData, inData, outDataLength );
+	return noErr;
+}
+
+
+int	main( int argc, const char** argv )
+{
+	const char*		filePath = (argc > 1) ? argv[1] : "/tmp/DecompressBench.rsrc";
+	int				numRepeats = (argc > 2) ? atoi( argv[2] ) : 10;
+
+	FakeSetResourceDecompressor( RCL_HOOK_DCMP_ID, RCLCopyStoredData, NULL );
+
+	for( enum RCLCompressionFormat format = 0; format < RCLFormatCount; format++ )
+	{
+		struct RCLResFileSpec	spec = { .numTypes = 4, .resourcesPerType = 128, .minDataSize = 1024, .maxDataSize = 16384,
+											.sizeDistribution = RCLSizeUniform, .namedFraction = 0, .seed = 1,
+											.dataProc = RCLMakeResourceData, .dataRefCon = &format };
+		if( !RCLWriteResFile( filePath, &spec ) )
+		{
+			fprintf( stderr, "Couldn't write %s\n", filePath );
+			return 1;
+		}
+
+		double		loadTime = 0;
+		uint64_t	numBytes = 0;
+		for( int r = 0; r < numRepeats; r++ )
+		{
+			FakeSetResLoad( false );
+			int16_t		refNum = RCLOpenResFileAtPath( filePath );
+			FakeSetResLoad( true );
+			if( refNum < 0 )
+			{
+				fprintf( stderr, "Couldn't open %s (%d)\n", filePath, refNum );
+				return 1;
+			}
+
+			double	startTime = RCLCurrentTime();
+			for( int t = 0; t < spec.numTypes; t++ )
+			{
+				for( int i = 0; i < spec.resourcesPerType; i++ )
+				{
+					Handle	theResource = FakeGetResource( RCLGeneratedResType( t ), (int16_t)(128 +i) );
+					if( FakeResError() != noErr )
+					{
+						fprintf( stderr, "Couldn't load resource %d of format %s (%d)\n", 128 +i, sFormatNames[format], FakeResError() );
+						return 1;
+					}
+					if( r == 0 )
+						numBytes += FakeGetHandleSize( theResource );
+				}
+			}
+			loadTime += RCLCurrentTime() -startTime;
+			FakeCloseResFile( refNum );
+		}
+
+		char	params[256];
+		snprintf( params, sizeof(params), "\"format\":\"%s\",\"decompressed_bytes\":%llu,\"mb_per_s\":%.1f", sFormatNames[format],
+					(unsigned long long)numBytes, (numBytes * (double)numRepeats) / (loadTime * 1e6) );
+		RCLReportResult( "load_compressed", params, (int64_t)numRepeats * spec.numTypes * spec.resourcesPerType, loadTime );
+	}
+
+	remove( filePath );
+
+	return 0;
+}
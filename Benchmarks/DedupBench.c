@@ -0,0 +1,188 @@
+//
+//  DedupBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Writes a resource file where each resource's data is the same as that of
+//  several others, like icons repeated for each localization, then saves it
+//  with FakeCompactResFile(), once as it is and once after FakeSetResDedup(true),
+//  and reports how long that took and how large the file got. Then opens the
+//  deduplicated file in a new process, once with FakeSetResDedup(false), where
+//  each resource gets its own copy, and once with FakeSetResDedup(true), where
+//  those with the same data share it copy-on-write, looks at all the data, and
+//  reports how long opening took and how much RAM it needed.
+//
+//  RSS counts a page once for each Handle that points at it, PSS only once,
+//  so PSS is what the shared data really costs. Both need Linux's /proc,
+//  elsewhere they're reported as 0.
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+// What the process that did a measurement sends back:
+struct RCLMeasurement
+{
+	double		seconds;
+	long		rssKB;		// Growth since before it opened the file.
+	long		pssKB;
+	uint32_t	checksum;
+	int16_t		error;
+};
+
+
+// Gives every inCopies-th resource the same data, spread over all types:
+static uint32_t	RCLDuplicateData( size_t inIndex, uint8_t* ioData, uint32_t inLength, uint32_t inMaxLength, uint8_t* outAttributes, void* inRefCon )
+{
+	(void)inLength; (void)outAttributes;
+	size_t		numDistinct = *(const size_t*)inRefCon;
+	uint32_t	seed = (uint32_t)(inIndex % numDistinct) * 2654435761u +1;
+	uint32_t	length = 512 +seed % (inMaxLength -512 +1);
+	for( uint32_t x = 0; x < length; x++ )
+	{
+		seed = seed * 1103515245u +12345u;
+		ioData[x] = (uint8_t)(seed >> 16);
+	}
+	return length;
+}
+
+
+static long	RCLFileLength( const char* inPath )
+{
+	struct stat		info;
+	return (stat( inPath, &info ) == 0) ? (long)info.st_size : 0;
+}
+
+
+// Opens the file, rewrites it with FakeCompactResFile() and measures how long that takes:
+static void	RCLSaveFile( const char* inFilePath, bool inDedup, struct RCLMeasurement* outResult )
+{
+	FakeSetResDedup( inDedup );
+	int16_t		refNum = RCLOpenResFileAtPath( inFilePath );
+	outResult->error = FakeResError();
+	if( refNum < 0 )
+		return;
+	double		startTime = RCLCurrentTime();
+	FakeCompactResFile( refNum, NULL, NULL );
+	outResult->seconds = RCLCurrentTime() -startTime;
+	outResult->error = FakeResError();
+	FakeCloseResFile( refNum );
+}
+
+
+// Opens the file, looks at all its data and measures how long opening took,
+//	and how much RAM that needed:
+static void	RCLOpenFile( const char* inFilePath, bool inDedup, struct RCLMeasurement* outResult )
+{
+	long		rssBefore = 0, pssBefore = 0;
+	bool		haveMemory = RCLGetMemoryUsage( &rssBefore, &pssBefore );
+	
+	FakeSetResDedup( inDedup );
+	double		startTime = RCLCurrentTime();
+	int16_t		refNum = RCLOpenResFileAtPath( inFilePath );
+	outResult->seconds = RCLCurrentTime() -startTime;
+	outResult->error = FakeResError();
+	if( refNum < 0 )
+		return;
+	for( int16_t t = 1; t <= FakeCount1Types(); t++ )
+	{
+		uint32_t	type = 0;
+		FakeGet1IndType( &type, t );
+		for( int16_t r = 1; r <= FakeCount1Resources( type ); r++ )
+		{
+			Handle	theResource = FakeGet1IndResource( type, r );
+			long	size = theResource ? FakeGetHandleSize( theResource ) : 0;
+			for( long x = 0; x < size; x += 64 )
+				outResult->checksum += (uint8_t)(*theResource)[x];
+		}
+	}
+	
+	long		rssAfter = 0, pssAfter = 0;
+	if( haveMemory && RCLGetMemoryUsage( &rssAfter, &pssAfter ) )
+	{
+		outResult->rssKB = rssAfter -rssBefore;
+		outResult->pssKB = pssAfter -pssBefore;
+	}
+	FakeCloseResFile( refNum );
+}
+
+
+// Does each measurement in a new process, so RAM freed by earlier ones
+//	doesn't skew it, and reports the result:
+static bool	RCLMeasure( const char* inName, const char* inFilePath, bool inDedup, void (*inProc)( const char*, bool, struct RCLMeasurement* ) )
+{
+	long	lengthBefore = RCLFileLength( inFilePath );
+	int		resultPipe[2];
+	if( pipe( resultPipe ) != 0 )
+		return false;
+
+	fflush( stdout );
+	pid_t	child = fork();
+	if( child == 0 )
+	{
+		close( resultPipe[0] );
+		struct RCLMeasurement	result = { 0 };
+		inProc( inFilePath, inDedup, &result );
+		_exit( (write( resultPipe[1], &result, sizeof(result) ) == sizeof(result)) ? 0 : 1 );
+	}
+	close( resultPipe[1] );
+
+	struct RCLMeasurement	result;
+	bool					ok = (read( resultPipe[0], &result, sizeof(result) ) == sizeof(result));
+	close( resultPipe[0] );
+	waitpid( child, NULL, 0 );
+	if( !ok || result.error != noErr )
+	{
+		fprintf( stderr, "%s failed for %s (%d).\n", inName, inFilePath, ok ? result.error : 0 );
+		return false;
+	}
+
+	char	params[160];
+	snprintf( params, sizeof(params), "\"file_kb_before\":%ld,\"file_kb_after\":%ld,\"rss_mb\":%.1f,\"pss_mb\":%.1f", lengthBefore / 1024,
+				RCLFileLength( inFilePath ) / 1024, result.rssKB / 1024.0, result.pssKB / 1024.0 );
+	RCLReportResult( inName, params, 1, result.seconds );
+	return true;
+}
+
+
+int	main( int argc, const char** argv )
+{
+	int				numCopies = (argc > 1) ? atoi( argv[1] ) : 10;
+	int				numResources = (argc > 2) ? atoi( argv[2] ) : 2000;
+	const char*		filePath = (argc > 3) ? argv[3] : "/tmp/DedupBench.rsrc";
+	if( numCopies < 1 || numCopies > numResources || numResources < 1 || numResources > 2000 )
+	{
+		fprintf( stderr, "Usage: %s [<copies of each resource's data, 1 to resources> [<resources, 1 to 2000> [<file>]]]\n", argv[0] );
+		return 1;
+	}
+
+	size_t					numDistinct = (size_t)((numResources +numCopies -1) / numCopies);
+	struct RCLResFileSpec	spec = { .numTypes = 4, .resourcesPerType = (numResources +3) / 4, .minDataSize = 512, .maxDataSize = 8000,
+										.sizeDistribution = RCLSizeUniform, .seed = 1, .dataProc = RCLDuplicateData, .dataRefCon = &numDistinct };
+	if( !RCLWriteResFile( filePath, &spec ) )
+	{
+		fprintf( stderr, "Couldn't write %s\n", filePath );
+		return 1;
+	}
+
+	bool	ok = RCLMeasure( "save", filePath, false, RCLSaveFile );
+	ok = ok && RCLMeasure( "save_dedup", filePath, true, RCLSaveFile );
+
+	ok = ok && RCLMeasure( "open", filePath, false, RCLOpenFile );
+	ok = ok && RCLMeasure( "open_dedup", filePath, true, RCLOpenFile );
+
+	remove( filePath );
+
+	return ok ? 0 : 1;
+}
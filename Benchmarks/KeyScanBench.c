@@ -0,0 +1,178 @@
+//
+//  KeyScanBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Measures finding a resource ID in lists of different lengths, once in an
+//  array of structs the size of a reference list entry, and once each with the
+//  scalar, SSE2 and AVX2 versions of FakeFindInt16Key(). Then times
+//  FakeGet1Resource() and FakeCount1Resources() on generated files with few
+//  types of many resources and many types of few resources.
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResources.h"
+#include "FakeKeyScan.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+// Like a FakeReferenceListEntry, so a scan touches as much memory:
+struct RCLStructEntry
+{
+	int16_t		resourceID;
+	uint8_t		resourceAttributes;
+	void*		resourceHandle;
+	uint32_t	otherFields[5];
+	char		resourceName[257];
+};
+
+
+static const char*	sLevelNames[] = { "scalar", "sse2", "avx2" };
+
+
+static size_t	RCLFindInStructs( const struct RCLStructEntry* inEntries, size_t inCount, int16_t inID )
+{
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		if( inEntries[x].resourceID == inID && inEntries[x].resourceHandle )
+			return x;
+	}
+	return inCount;
+}
+
+
+// Looks up random IDs (all of which are there) in lists of inCount resources:
+static void	RCLBenchmarkKernels( size_t inCount, int64_t inIterations )
+{
+	size_t					numLists = (4 * 1024 * 1024) / (inCount * sizeof(struct RCLStructEntry)) +1;	// More than fits in the cache.
+	struct RCLStructEntry*	entries = calloc( numLists * inCount, sizeof(struct RCLStructEntry) );
+	int16_t*				ids = malloc( numLists * inCount * sizeof(int16_t) );
+	int16_t*				keys = malloc( inIterations * sizeof(int16_t) );
+	size_t*					keyLists = malloc( inIterations * sizeof(size_t) );
+	uint32_t				randomState = 1;
+	for( size_t x = 0; x < numLists * inCount; x++ )
+	{
+		ids[x] = entries[x].resourceID = (int16_t)(128 +x % inCount);
+		entries[x].resourceHandle = entries;
+	}
+	for( int64_t x = 0; x < inIterations; x++ )
+	{
+		keys[x] = (int16_t)(128 +RCLNextRandom( &randomState ) % inCount);
+		keyLists[x] = RCLNextRandom( &randomState ) % numLists;
+	}
+
+	char		params[64];
+	snprintf( params, sizeof(params), "\"resources\":%zu", inCount );
+	size_t		expected = 0;
+	double		startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < inIterations; x++ )
+		expected += RCLFindInStructs( entries +keyLists[x] * inCount, inCount, keys[x] );
+	RCLReportResult( "find_id_structs", params, inIterations, RCLCurrentTime() -startTime );
+
+	for( int level = kFakeKeyScanScalar; level <= kFakeKeyScanAVX2; level++ )
+	{
+		if( FakeSetKeyScanLevel( level ) != level )
+			break;	// CPU can't do it.
+
+		char		benchName[64];
+		size_t		found = 0;
+		snprintf( benchName, sizeof(benchName), "find_id_%s", sLevelNames[level] );
+		startTime = RCLCurrentTime();
+		for( int64_t x = 0; x < inIterations; x++ )
+			found += FakeFindInt16Key( ids +keyLists[x] * inCount, inCount, keys[x] );
+		RCLReportResult( benchName, params, inIterations, RCLCurrentTime() -startTime );
+		if( found != expected )
+			fprintf( stderr, "Scans disagree for %zu resources.\n", inCount );
+	}
+	FakeSetKeyScanLevel( kFakeKeyScanAVX2 );
+
+	free( keyLists );
+	free( keys );
+	free( ids );
+	free( entries );
+}
+
+
+// Looks up random resources in a generated file with the given layout:
+static void	RCLBenchmarkFile( const char* inFilePath, int inNumTypes, int inResourcesPerType, int64_t inIterations )
+{
+	struct RCLResFileSpec	spec = { .numTypes = inNumTypes, .resourcesPerType = inResourcesPerType, .minDataSize = 4, .maxDataSize = 4,
+										.sizeDistribution = RCLSizeUniform, .namedFraction = 0, .seed = 1 };
+	if( !RCLWriteResFile( inFilePath, &spec ) )
+	{
+		fprintf( stderr, "Couldn't write %s\n", inFilePath );
+		return;
+	}
+	int16_t		refNum = RCLOpenResFileAtPath( inFilePath );
+	if( refNum < 0 )
+	{
+		fprintf( stderr, "Couldn't open %s (%d)\n", inFilePath, refNum );
+		return;
+	}
+
+	uint32_t*	types = malloc( inIterations * sizeof(uint32_t) );
+	int16_t*	ids = malloc( inIterations * sizeof(int16_t) );
+	uint32_t	randomState = 1;
+	for( int64_t x = 0; x < inIterations; x++ )
+	{
+		types[x] = RCLGeneratedResType( RCLNextRandom( &randomState ) % inNumTypes );
+		ids[x] = (int16_t)(128 +RCLNextRandom( &randomState ) % inResourcesPerType);
+	}
+	for( int t = 0; t < inNumTypes; t++ )	// Load them all, so we only measure finding them.
+	{
+		for( int r = 0; r < inResourcesPerType; r++ )
+			FakeGet1Resource( RCLGeneratedResType( t ), (int16_t)(128 +r) );
+	}
+
+	char		params[64];
+	snprintf( params, sizeof(params), "\"types\":%d,\"resources_per_type\":%d", inNumTypes, inResourcesPerType );
+	int64_t		numMissing = 0;
+	double		startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < inIterations; x++ )
+		numMissing += (FakeGet1Resource( types[x], ids[x] ) == NULL);
+	RCLReportResult( "get1resource", params, inIterations, RCLCurrentTime() -startTime );
+
+	int64_t		numCounted = 0;
+	startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < inIterations; x++ )
+		numCounted += FakeCount1Resources( types[x] );
+	RCLReportResult( "count1resources", params, inIterations, RCLCurrentTime() -startTime );
+
+	if( numMissing != 0 || numCounted != inIterations * inResourcesPerType )
+		fprintf( stderr, "Lost resources in %s.\n", inFilePath );
+
+	free( ids );
+	free( types );
+	FakeCloseResFile( refNum );
+	remove( inFilePath );
+}
+
+
+int	main( int argc, const char** argv )
+{
+	int64_t			numIterations = (argc > 1) ? atoll( argv[1] ) : 1000000;
+	const char*		filePath = (argc > 2) ? argv[2] : "/tmp/KeyScanBench.rsrc";
+	if( numIterations < 1 )
+	{
+		fprintf( stderr, "Usage: %s [<lookups per measurement> [<file>]]\n", argv[0] );
+		return 1;
+	}
+
+	const size_t	listLengths[] = { 4, 8, 16, 32, 64, 256, 1024, 4096 };
+	for( size_t x = 0; x < sizeof(listLengths) / sizeof(listLengths[0]); x++ )
+		RCLBenchmarkKernels( listLengths[x], numIterations );
+
+	// Total resources have to fit the file format's 16 bit offsets:
+	const int		fileLayouts[][2] = { { 1, 8 }, { 1, 16 }, { 1, 32 }, { 1, 64 }, { 1, 4000 }, { 8, 256 },
+											{ 64, 16 }, { 256, 4 }, { 1024, 1 } };
+	for( size_t x = 0; x < sizeof(fileLayouts) / sizeof(fileLayouts[0]); x++ )
+		RCLBenchmarkFile( filePath, fileLayouts[x][0], fileLayouts[x][1], numIterations );
+
+	return 0;
+}
@@ -0,0 +1,167 @@
+//
+//  ManyFilesBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Opens thousands of small read-only resource files (MacBinary files, whose
+//  resource forks are opened read-only) with FakeSetResFileLimit() in effect,
+//  and measures opening them, switching between them with FakeUseResFile(),
+//  getting resources from random files, most of which have to be opened
+//  again, and from the few used most recently, which are still open, and
+//  closing them again. Reports how many descriptors the process had open.
+//
+//  Pass 0 as the limit to compare with keeping all files open, which needs
+//  a descriptor limit (ulimit -n) above the number of files.
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+#define NUM_TYPES			2
+#define RESOURCES_PER_TYPE	4
+
+
+// Descriptors this process has open, -1 if we can't tell (no /proc):
+static int	RCLCountOpenFiles( void )
+{
+	DIR*	theDir = opendir( "/proc/self/fd" );
+	if( !theDir )
+		return -1;
+	int		numFiles = -1;	// Don't count theDir itself.
+	for( struct dirent* currEntry = readdir( theDir ); currEntry != NULL; currEntry = readdir( theDir ) )
+	{
+		if( currEntry->d_name[0] != '.' )
+			numFiles++;
+	}
+	closedir( theDir );
+	return numFiles;
+}
+
+
+// Gets inCount random resources from the files in inRefNums, returns the seconds that took:
+static double	RCLGetRandomResources( const int16_t* inRefNums, int inNumFiles, int inCount, uint32_t* ioSeed, int16_t* outError )
+{
+	double		startTime = RCLCurrentTime();
+	for( int x = 0; x < inCount; x++ )
+	{
+		FakeUseResFile( inRefNums[RCLNextRandom( ioSeed ) % inNumFiles] );
+		Handle	theResource = FakeGet1Resource( RCLGeneratedResType( RCLNextRandom( ioSeed ) % NUM_TYPES ), (int16_t)(128 +RCLNextRandom( ioSeed ) % RESOURCES_PER_TYPE) );
+		if( theResource )
+			FakeLoadResource( theResource );
+		if( !theResource || *theResource == NULL )
+			*outError = FakeResError();
+	}
+	return RCLCurrentTime() -startTime;
+}
+
+
+int	main( int argc, const char** argv )
+{
+	int				numFiles = (argc > 1) ? atoi( argv[1] ) : 10000;
+	int				fileLimit = (argc > 2) ? atoi( argv[2] ) : 256;
+	const char*		pathPrefix = (argc > 3) ? argv[3] : "/tmp/ManyFilesBench";
+	if( numFiles < 1 || numFiles > 30000 || fileLimit < 0 || strlen( pathPrefix ) > 200 )
+	{
+		fprintf( stderr, "Usage: %s [<files, 1 to 30000> [<open file limit, 0 for none> [<path prefix>]]]\n", argv[0] );
+		return 1;
+	}
+
+	char			resFilePath[256];
+	snprintf( resFilePath, sizeof(resFilePath), "%s.rsrc", pathPrefix );
+	unsigned char	(*pascalPaths)[256] = calloc( numFiles, 256 );
+	int16_t*		refNums = calloc( numFiles, sizeof(int16_t) );
+	if( !pascalPaths || !refNums )
+		return 1;
+	for( int x = 0; x < numFiles; x++ )
+	{
+		struct RCLResFileSpec	spec = { .numTypes = NUM_TYPES, .resourcesPerType = RESOURCES_PER_TYPE, .minDataSize = 64, .maxDataSize = 1024,
+											.sizeDistribution = RCLSizeUniform, .seed = (unsigned)x +1 };
+		char					thePath[256];
+		snprintf( thePath, sizeof(thePath), "%s%d.bin", pathPrefix, x );
+		if( !RCLWriteResFile( resFilePath, &spec ) || !RCLWrapResFile( resFilePath, thePath, RCLContainerMacBinary, 0 ) )
+		{
+			fprintf( stderr, "Couldn't write %s\n", thePath );
+			return 1;
+		}
+		pascalPaths[x][0] = (unsigned char)strlen( thePath );
+		memmove( pascalPaths[x] +1, thePath, pascalPaths[x][0] );
+	}
+	remove( resFilePath );
+
+	FakeSetResFileLimit( (size_t)fileLimit );
+	FakeSetResLoad( false );
+	int16_t		err = noErr;
+	char		params[160];
+
+	double		startTime = RCLCurrentTime();
+	for( int x = 0; x < numFiles && err == noErr; x++ )
+	{
+		refNums[x] = FakeOpenResFile( pascalPaths[x] );
+		err = FakeResError();
+	}
+	double		openSeconds = RCLCurrentTime() -startTime;
+	if( err != noErr )
+	{
+		fprintf( stderr, "Couldn't open all files (%d).\n", err );
+		return 1;
+	}
+	snprintf( params, sizeof(params), "\"files\":%d,\"limit\":%d,\"open_fds\":%d", numFiles, fileLimit, RCLCountOpenFiles() );
+	RCLReportResult( "open", params, numFiles, openSeconds );
+
+	// Switching files only looks up the reference number:
+	uint32_t	seed = 1;
+	int			numSwitches = 1000000;
+	int16_t		checksum = 0;
+	startTime = RCLCurrentTime();
+	for( int x = 0; x < numSwitches; x++ )
+	{
+		FakeUseResFile( refNums[RCLNextRandom( &seed ) % numFiles] );
+		checksum ^= FakeCurResFile();
+	}
+	double		switchSeconds = RCLCurrentTime() -startTime;
+	snprintf( params, sizeof(params), "\"files\":%d,\"checksum\":%d", numFiles, checksum );
+	RCLReportResult( "use_res_file", params, numSwitches, switchSeconds );
+
+	// Random files, mostly closed, then the most recently used ones, which are still open:
+	int			numGets = 20000;
+	double		getSeconds = RCLGetRandomResources( refNums, numFiles, numGets, &seed, &err );
+	snprintf( params, sizeof(params), "\"files\":%d,\"limit\":%d,\"open_fds\":%d", numFiles, fileLimit, RCLCountOpenFiles() );
+	RCLReportResult( "get_any_file", params, numGets, getSeconds );
+
+	int			numHotFiles = (fileLimit > 0 && fileLimit / 2 < numFiles) ? (fileLimit / 2) : numFiles;
+	RCLGetRandomResources( refNums +numFiles -numHotFiles, numHotFiles, numGets, &seed, &err );	// Opens them all first.
+	FakeSetResourceCacheBudget( 1 );	// So the resources have to be read again.
+	FakeSetResourceCacheBudget( 0 );
+	getSeconds = RCLGetRandomResources( refNums +numFiles -numHotFiles, numHotFiles, numGets, &seed, &err );
+	snprintf( params, sizeof(params), "\"files\":%d,\"limit\":%d,\"open_fds\":%d", numHotFiles, fileLimit, RCLCountOpenFiles() );
+	RCLReportResult( "get_recent_file", params, numGets, getSeconds );
+	if( err != noErr )
+		fprintf( stderr, "Couldn't get all resources (%d).\n", err );
+
+	startTime = RCLCurrentTime();
+	for( int x = 0; x < numFiles; x++ )
+		FakeCloseResFile( refNums[x] );
+	double		closeSeconds = RCLCurrentTime() -startTime;
+	snprintf( params, sizeof(params), "\"files\":%d", numFiles );
+	RCLReportResult( "close", params, numFiles, closeSeconds );
+
+	for( int x = 0; x < numFiles; x++ )
+	{
+		char	thePath[256] = { 0 };
+		memmove( thePath, pascalPaths[x] +1, pascalPaths[x][0] );
+		remove( thePath );
+	}
+	free( refNums );
+	free( pascalPaths );
+
+	return (err == noErr) ? 0 : 1;
+}
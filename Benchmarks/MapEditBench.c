@@ -0,0 +1,233 @@
+//
+//  MapEditBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Measures building a resource map with many resources from (almost)
+//  nothing, then removing half of them in random order, once with one
+//  FakeAddResource()/FakeRemoveResource() call each, once with
+//  FakeAddResources()/FakeRemoveResources(), and looking up those left by
+//  Handle and ID. Also times FakeGet1ResourceIDsInRange(), and adding
+//  resources with IDs from FakeUnique1ID(). The resources are spread evenly
+//  over the given number of types. The second time, those left are saved in
+//  the extended file format (more than a few thousand resources don't fit the
+//  classic format's 16 bit offsets), and the file is opened again.
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+#define RCL_FIRST_TYPE		'ED00'
+
+
+// Resource number inIndex goes in this type, with this ID:
+static uint32_t	RCLEditedResType( int64_t inIndex, int inNumTypes )
+{
+	return RCL_FIRST_TYPE +(uint32_t)(inIndex % inNumTypes);
+}
+
+
+static int16_t	RCLEditedResID( int64_t inIndex, int inNumTypes )
+{
+	return (int16_t)(128 +inIndex / inNumTypes);
+}
+
+
+// The order to remove resources in, a shuffled list of all their numbers:
+static int64_t*	RCLCopyShuffledIndexes( int64_t inCount )
+{
+	int64_t*	indexes = malloc( (inCount +1) * sizeof(int64_t) );
+	uint32_t	randomState = 1;
+	for( int64_t x = 0; x < inCount; x++ )
+		indexes[x] = x;
+	for( int64_t x = inCount -1; x > 0; x-- )
+	{
+		randomState = randomState * 1103515245 + 12345;
+		int64_t	other = ((int64_t)(randomState >> 8) * 131 +(randomState >> 20)) % (x +1);
+		int64_t	temp = indexes[x];
+		indexes[x] = indexes[other];
+		indexes[other] = temp;
+	}
+	return indexes;
+}
+
+
+int	main( int argc, const char** argv )
+{
+	int64_t			numResources = (argc > 1) ? atoll( argv[1] ) : 100000;
+	int				numTypes = (argc > 2) ? atoi( argv[2] ) : 16;
+	const char*		filePath = (argc > 3) ? argv[3] : "/tmp/MapEditBench.rsrc";
+	if( numResources < 2 || numTypes < 1 || (numResources / numTypes) > (32767 -128) )
+	{
+		fprintf( stderr, "Usage: %s [<number of resources> [<number of types> [<file>]]]\n", argv[0] );
+		return 1;
+	}
+
+	struct RCLResFileSpec	spec = { .numTypes = 1, .resourcesPerType = 1, .minDataSize = 16, .maxDataSize = 16,
+										.sizeDistribution = RCLSizeUniform, .namedFraction = 0, .seed = 1 };
+	if( !RCLWriteResFile( filePath, &spec ) )
+	{
+		fprintf( stderr, "Couldn't write %s\n", filePath );
+		return 1;
+	}
+
+	char		params[128];
+	snprintf( params, sizeof(params), "\"resources\":%lld,\"types\":%d", (long long)numResources, numTypes );
+	Handle*		handles = malloc( numResources * sizeof(Handle) );
+	int64_t*	removeOrder = RCLCopyShuffledIndexes( numResources );
+	FakeStr255	emptyName = {0};
+	for( int64_t x = 0; x < numResources; x++ )
+		handles[x] = FakeNewHandle( 16 );
+
+	for( int bulk = 0; bulk < 2; bulk++ )
+	{
+		int16_t		refNum = RCLOpenResFileAtPath( filePath );
+		if( refNum < 0 )
+		{
+			fprintf( stderr, "Couldn't open %s (%d)\n", filePath, refNum );
+			return 1;
+		}
+
+		double		startTime = RCLCurrentTime();
+		if( bulk )
+		{
+			struct FakeResourceAddEntry*	entries = calloc( numResources, sizeof(struct FakeResourceAddEntry) );
+			for( int64_t x = 0; x < numResources; x++ )
+			{
+				entries[x].resHandle = handles[x];
+				entries[x].resType = RCLEditedResType( x, numTypes );
+				entries[x].resID = RCLEditedResID( x, numTypes );
+			}
+			FakeAddResources( entries, numResources );
+			free( entries );
+		}
+		else
+		{
+			for( int64_t x = 0; x < numResources; x++ )
+				FakeAddResource( handles[x], RCLEditedResType( x, numTypes ), RCLEditedResID( x, numTypes ), emptyName );
+		}
+		RCLReportResult( bulk ? "add_resources_bulk" : "add_resource_many", params, numResources, RCLCurrentTime() -startTime );
+		if( FakeResError() != noErr )
+		{
+			fprintf( stderr, "Couldn't add resources (%d)\n", FakeResError() );
+			return 1;
+		}
+
+		// Half of them, in random order:
+		int64_t		numRemoved = numResources / 2;
+		startTime = RCLCurrentTime();
+		if( bulk )
+		{
+			Handle*		removed = malloc( numRemoved * sizeof(Handle) );
+			for( int64_t x = 0; x < numRemoved; x++ )
+				removed[x] = handles[removeOrder[x]];
+			FakeRemoveResources( removed, NULL, numRemoved );
+			free( removed );
+		}
+		else
+		{
+			for( int64_t x = 0; x < numRemoved; x++ )
+				FakeRemoveResource( handles[removeOrder[x]] );
+		}
+		RCLReportResult( bulk ? "remove_resources_bulk" : "remove_resource_many", params, numRemoved, RCLCurrentTime() -startTime );
+		if( FakeResError() != noErr )
+		{
+			fprintf( stderr, "Couldn't remove resources (%d)\n", FakeResError() );
+			return 1;
+		}
+
+		// Look up what's left, by Handle and by type and ID:
+		startTime = RCLCurrentTime();
+		for( int64_t x = numRemoved; x < numResources; x++ )
+		{
+			int16_t		theID = 0;
+			uint32_t	theType = 0;
+			FakeStr255	theName;
+			FakeGetResInfo( handles[removeOrder[x]], &theID, &theType, theName );
+			if( FakeGet1Resource( theType, theID ) != handles[removeOrder[x]] )
+			{
+				fprintf( stderr, "Resource %lld went missing.\n", (long long)removeOrder[x] );
+				return 1;
+			}
+		}
+		RCLReportResult( bulk ? "lookup_after_bulk" : "lookup_after_many", params, numResources -numRemoved, RCLCurrentTime() -startTime );
+
+		if( !bulk )
+		{
+			// All IDs from 128 through 255 of each type:
+			int16_t		ids[128];
+			startTime = RCLCurrentTime();
+			for( int t = 0; t < numTypes; t++ )
+				FakeGet1ResourceIDsInRange( RCLEditedResType( t, numTypes ), 128, 255, ids, 128 );
+			RCLReportResult( "ids_in_range", params, numTypes, RCLCurrentTime() -startTime );
+
+			// Fill up one more type with IDs from FakeUnique1ID():
+			int64_t		numUnique = (numResources < 32767 -128) ? numResources : 32767 -128;
+			Handle*		uniqueHandles = malloc( numUnique * sizeof(Handle) );
+			for( int64_t x = 0; x < numUnique; x++ )
+				uniqueHandles[x] = FakeNewHandle( 16 );
+			startTime = RCLCurrentTime();
+			for( int64_t x = 0; x < numUnique; x++ )
+				FakeAddResource( uniqueHandles[x], RCL_FIRST_TYPE -1, FakeUnique1ID( RCL_FIRST_TYPE -1 ), emptyName );
+			RCLReportResult( "unique1id_add", params, numUnique, RCLCurrentTime() -startTime );
+			FakeRemoveResources( uniqueHandles, NULL, numUnique );
+			for( int64_t x = 0; x < numUnique; x++ )
+				FakeDisposeHandle( uniqueHandles[x] );
+			free( uniqueHandles );
+		}
+
+		if( bulk )
+		{
+			FakeSetResFileFormat( refNum, kFakeResFileExtended );
+			startTime = RCLCurrentTime();
+			FakeUpdateResFile( refNum );
+			RCLReportResult( "update_extended", params, numResources -numRemoved, RCLCurrentTime() -startTime );
+			if( FakeResError() != noErr )
+			{
+				fprintf( stderr, "Couldn't save resources (%d)\n", FakeResError() );
+				return 1;
+			}
+			FakeCloseResFile( refNum );	// Disposes of the Handles of those left.
+			for( int64_t x = numRemoved; x < numResources; x++ )
+				handles[removeOrder[x]] = NULL;
+			
+			startTime = RCLCurrentTime();
+			refNum = RCLOpenResFileAtPath( filePath );
+			RCLReportResult( "open_extended", params, numResources -numRemoved, RCLCurrentTime() -startTime );
+			int64_t		numReopened = 0;
+			for( int t = 0; refNum >= 0 && t < numTypes; t++ )
+				numReopened += FakeCount1Resources( RCLEditedResType( t, numTypes ) );
+			if( numReopened != (numResources -numRemoved) )
+			{
+				fprintf( stderr, "Reopened file has %lld resources instead of %lld (%d)\n", (long long)numReopened,
+							(long long)(numResources -numRemoved), FakeResError() );
+				return 1;
+			}
+		}
+		else
+		{
+			for( int64_t x = numRemoved; x < numResources; x++ )
+				FakeRemoveResource( handles[removeOrder[x]] );
+		}
+		FakeCloseResFile( refNum );
+	}
+
+	for( int64_t x = 0; x < numResources; x++ )
+	{
+		if( handles[x] )
+			FakeDisposeHandle( handles[x] );
+	}
+	free( handles );
+	free( removeOrder );
+	remove( filePath );
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+//
+//  ParallelLoadBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Measures how long FakeOpenResFile() takes to load all resource data of
+//  files of various sizes with different numbers of load threads (see
+//  FakeSetResLoadThreads()). The file is evicted from the OS's cache before
+//  each run, so this measures actual disk reads where the OS allows that.
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+int	main( int argc, const char** argv )
+{
+	const char*		filePath = (argc > 1) ? argv[1] : "/tmp/ParallelLoadBench.rsrc";
+	int				numRepeats = (argc > 2) ? atoi( argv[2] ) : 3;
+	const uint32_t	fileSizesMB[] = { 1, 4, 15 };	// The classic format can't address more than 16MB of data.
+	const int		threadCounts[] = { 1, 2, 4, 8, 16 };
+	
+	for( size_t s = 0; s < sizeof(fileSizesMB) / sizeof(fileSizesMB[0]); s++ )
+	{
+		struct RCLResFileSpec	spec = { .numTypes = 4, .minDataSize = 8192, .maxDataSize = 24576, .namedFraction = 0.25, .seed = 1 };
+		spec.resourcesPerType = (int)((fileSizesMB[s] * 1024 * 1024) / (spec.numTypes * (uint64_t)(spec.maxDataSize +4)));
+		if( !RCLWriteResFile( filePath, &spec ) )
+		{
+			fprintf( stderr, "Couldn't write %s\n", filePath );
+			return 1;
+		}
+		
+		FILE*	theFile = fopen( filePath, "r" );
+		fseek( theFile, 0, SEEK_END );
+		long	fileSize = ftell( theFile );
+		fclose( theFile );
+		
+		for( size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++ )
+		{
+			double	bestTime = 0;
+			FakeSetResLoadThreads( threadCounts[t] );
+			for( int r = 0; r < numRepeats; r++ )
+			{
+				RCLEvictFileFromCache( filePath );
+				double	startTime = RCLCurrentTime();
+				int16_t	refNum = RCLOpenResFileAtPath( filePath );
+				double	duration = RCLCurrentTime() -startTime;
+				if( FakeResError() != noErr )
+				{
+					fprintf( stderr, "Couldn't open %s (%d)\n", filePath, FakeResError() );
+					return 1;
+				}
+				FakeCloseResFile( refNum );
+				if( r == 0 || duration < bestTime )
+					bestTime = duration;
+			}
+			char	params[256];
+			snprintf( params, sizeof(params), "\"file_bytes\":%ld,\"threads\":%d,\"mb_per_sec\":%.1f",
+						fileSize, threadCounts[t], (fileSize / (1024.0 * 1024.0)) / bestTime );
+			RCLReportResult( "parallel_open", params, 1, bestTime );
+		}
+	}
+	
+	remove( filePath );
+	
+	return 0;
+}
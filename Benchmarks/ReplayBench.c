@@ -0,0 +1,915 @@
+//
+//  ReplayBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Executes a call trace written by FakeStartCallRecording() (see
+//  FakeCallRecorder.h) again, in the recorded order, on one thread, and
+//  reports per-call latency percentiles and overall throughput, next to the
+//  latencies that were recorded. Handles and file reference numbers in the
+//  trace are matched up with the ones this run gets. Calls on Handles this
+//  run doesn't know (e.g. ones created before recording started) are skipped.
+//
+//  Replaying saves changes the files at the recorded paths, so replay against
+//  copies. Relative paths are relative to --dir.
+//
+//  Prints one line of JSON per call kind and one for the whole trace.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "FakeResources.h"
+#include "FakeCallRecorder.h"
+#include "BenchSupport.h"
+
+
+struct RCLTraceCall
+{
+	uint8_t				call;
+	uint64_t			thread;
+	uint64_t			recordedDuration;	// ns.
+	size_t				numInts;
+	int64_t*			ints;
+	size_t				numStrings;
+	unsigned char**		strings;			// Pascal strings, 256 bytes each.
+};
+
+
+// Recorded value -> value in this run, for Handles and file reference numbers:
+struct RCLValueMap
+{
+	int64_t*	keys;
+	int64_t*	values;
+	bool*		used;
+	size_t		capacity;	// Power of 2.
+	size_t		count;
+};
+
+
+static const char*	sCallNames[kFakeCallNumCalls] =
+{
+	NULL, "NewHandle", "NewEmptyHandle", "DisposeHandle", "EmptyHandle", "GetHandleSize", "SetHandleSize",
+	"SetHandleSizeReentrant", "MoreMasters", "AdoptHandleMemory", "HLock", "HUnlock", "HPurge", "HNoPurge",
+	"HGetState", "HSetState", "OpenResFile", "OpenResFork", "OpenResFiles", "CloseResFile", "Get1Resource",
+	"GetResource", "GetResources", "CurResFile", "UseResFile", "UpdateResFile", "HomeResFile", "Count1Types",
+	"Count1Resources", "CountTypes", "CountResources", "Get1IndType", "Get1IndResource", "GetResInfo",
+	"SetResInfo", "AddResource", "ChangedResource", "RemoveResource", "WriteResource", "LoadResource",
+	"ReleaseResource", "SetResLoad", "SetResLoadThreads", "SetResProfileRecording", "SetResPrefetch",
+	"SetResourceCacheBudget", "GetResourceCacheStats", "ResetResourceCacheStats", "ResError",
+	"BeginResTransaction", "CommitResTransaction", "AbortResTransaction", "AddResources", "RemoveResources",
+	"UniqueID", "Unique1ID", "Get1ResourceIDsInRange", "Get1NamedResource", "GetNamedResource",
+	"SetResFileFormat", "GetResFileFormat", "CompactResFile", "SetResSharedCache", "RemoveResSharedCache",
+	"SetResDedup", "SetResourceCacheCompression", "SetResFileLimit"
+};
+
+
+// How many integers each call has at least (see enum FakeRecordedCall):
+static const uint8_t	sMinInts[kFakeCallNumCalls] =
+{
+	0, 2, 1, 1, 1, 2, 2,
+	3, 0, 2, 1, 1, 1, 1,
+	2, 2, 1, 3, 1, 1, 3,
+	3, 1, 1, 1, 1, 2, 1,
+	2, 1, 2, 2, 3, 3,
+	2, 3, 1, 1, 1, 1,
+	1, 1, 1, 1, 1,
+	1, 0, 0, 1,
+	1, 1, 1, 1,
+	1, 2, 2, 5,
+	2, 2,
+	2, 2, 5, 1, 0,
+	1, 1, 1
+};
+
+
+static size_t	RCLValueMapSlot( const struct RCLValueMap* inMap, int64_t inKey )
+{
+	uint64_t	hash = (uint64_t)inKey * 0x9E3779B97F4A7C15ULL;
+	size_t		slot = (size_t)(hash >> 17) & (inMap->capacity -1);
+	while( inMap->used[slot] && inMap->keys[slot] != inKey )
+		slot = (slot +1) & (inMap->capacity -1);
+	return slot;
+}
+
+
+static void	RCLValueMapSet( struct RCLValueMap* inMap, int64_t inKey, int64_t inValue )
+{
+	if( (inMap->count +1) * 2 > inMap->capacity )
+	{
+		struct RCLValueMap	bigger = { .capacity = inMap->capacity ? inMap->capacity * 2 : 1024 };
+		bigger.keys = calloc( bigger.capacity, sizeof(int64_t) );
+		bigger.values = calloc( bigger.capacity, sizeof(int64_t) );
+		bigger.used = calloc( bigger.capacity, sizeof(bool) );
+		for( size_t x = 0; x < inMap->capacity; x++ )
+		{
+			if( inMap->used[x] )
+				RCLValueMapSet( &bigger, inMap->keys[x], inMap->values[x] );
+		}
+		free( inMap->keys );
+		free( inMap->values );
+		free( inMap->used );
+		*inMap = bigger;
+	}
+	
+	size_t	slot = RCLValueMapSlot( inMap, inKey );
+	if( !inMap->used[slot] )
+		inMap->count++;
+	inMap->used[slot] = true;
+	inMap->keys[slot] = inKey;
+	inMap->values[slot] = inValue;
+}
+
+
+static bool	RCLValueMapGet( const struct RCLValueMap* inMap, int64_t inKey, int64_t* outValue )
+{
+	if( inMap->capacity == 0 )
+		return false;
+	size_t	slot = RCLValueMapSlot( inMap, inKey );
+	*outValue = inMap->values[slot];
+	return inMap->used[slot];
+}
+
+
+static bool	RCLGetVarint( const uint8_t** ioBytes, const uint8_t* inEnd, uint64_t* outNum )
+{
+	uint64_t	num = 0;
+	for( int shift = 0; shift < 64 && *ioBytes < inEnd; shift += 7 )
+	{
+		uint8_t	currByte = *(*ioBytes)++;
+		num |= (uint64_t)(currByte & 0x7F) << shift;
+		if( (currByte & 0x80) == 0 )
+		{
+			*outNum = num;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+static bool	RCLGetSignedVarint( const uint8_t** ioBytes, const uint8_t* inEnd, int64_t* outNum )
+{
+	uint64_t	zigzag = 0;
+	if( !RCLGetVarint( ioBytes, inEnd, &zigzag ) )
+		return false;
+	*outNum = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+	return true;
+}
+
+
+// Reads all calls in the trace at inPath, returns NULL if it isn't one:
+static struct RCLTraceCall*	RCLReadTrace( const char* inPath, size_t* outCount )
+{
+	FILE*	theFile = fopen( inPath, "r" );
+	if( !theFile )
+		return NULL;
+	fseek( theFile, 0, SEEK_END );
+	long	fileLength = ftell( theFile );
+	fseek( theFile, 0, SEEK_SET );
+	uint8_t*	fileData = malloc( fileLength +1 );
+	bool		readOK = fileData && fread( fileData, 1, fileLength, theFile ) == (size_t)fileLength;
+	fclose( theFile );
+	if( !readOK || fileLength < 6
+		|| ((uint32_t)fileData[0] << 24 | (uint32_t)fileData[1] << 16 | (uint32_t)fileData[2] << 8 | fileData[3]) != FAKE_CALL_TRACE_MAGIC
+		|| ((fileData[4] << 8) | fileData[5]) != FAKE_CALL_TRACE_VERSION )
+	{
+		free( fileData );
+		return NULL;
+	}
+	
+	const uint8_t*			currByte = fileData +6;
+	const uint8_t*			endByte = fileData +fileLength;
+	size_t					numCalls = 0, capacity = 1024;
+	struct RCLTraceCall*	calls = malloc( capacity * sizeof(struct RCLTraceCall) );
+	while( currByte < endByte )
+	{
+		if( numCalls >= capacity )
+		{
+			capacity *= 2;
+			calls = realloc( calls, capacity * sizeof(struct RCLTraceCall) );
+		}
+		struct RCLTraceCall*	theCall = calls +numCalls;
+		int64_t					startDelta = 0;
+		uint64_t				count = 0;
+		memset( theCall, 0, sizeof(struct RCLTraceCall) );
+		theCall->call = *currByte++;
+		if( !RCLGetVarint( &currByte, endByte, &theCall->thread ) || !RCLGetSignedVarint( &currByte, endByte, &startDelta )
+			|| !RCLGetVarint( &currByte, endByte, &theCall->recordedDuration ) || !RCLGetVarint( &currByte, endByte, &count )
+			|| count > (uint64_t)(endByte -currByte) )
+			break;	// Truncated, e.g. the application crashed. Replay what we have.
+		theCall->numInts = count;
+		theCall->ints = calloc( count +1, sizeof(int64_t) );
+		for( size_t x = 0; x < count; x++ )
+			RCLGetSignedVarint( &currByte, endByte, &theCall->ints[x] );
+		if( !RCLGetVarint( &currByte, endByte, &count ) || count > (uint64_t)(endByte -currByte) )
+			break;
+		theCall->numStrings = count;
+		theCall->strings = calloc( count +1, sizeof(unsigned char*) );
+		for( size_t x = 0; x < count; x++ )
+		{
+			uint64_t	stringLength = 0;
+			theCall->strings[x] = calloc( 1, 256 );
+			if( !RCLGetVarint( &currByte, endByte, &stringLength ) || stringLength > 255 || stringLength > (uint64_t)(endByte -currByte) )
+				break;
+			theCall->strings[x][0] = (unsigned char)stringLength;
+			memmove( theCall->strings[x] +1, currByte, stringLength );
+			currByte += stringLength;
+		}
+		numCalls++;
+	}
+	
+	free( fileData );
+	*outCount = numCalls;
+	return calls;
+}
+
+
+// Looks up the Handle this run has for a recorded one:
+static bool	RCLMapHandle( const struct RCLValueMap* inHandles, int64_t inRecorded, Handle* outHandle )
+{
+	int64_t		theValue = 0;
+	if( inRecorded == 0 || !RCLValueMapGet( inHandles, inRecorded, &theValue ) || theValue == 0 )
+		return false;
+	*outHandle = (Handle)(intptr_t)theValue;
+	return true;
+}
+
+
+static void	RCLNoteHandle( struct RCLValueMap* inHandles, int64_t inRecorded, Handle inHandle )
+{
+	if( inRecorded != 0 && inHandle != NULL )
+		RCLValueMapSet( inHandles, inRecorded, (int64_t)(intptr_t)inHandle );
+}
+
+
+static int16_t	RCLMapRefNum( const struct RCLValueMap* inRefNums, int64_t inRecorded )
+{
+	int64_t		theValue = inRecorded;	// Errors and 0 (the system file) stay what they are.
+	RCLValueMapGet( inRefNums, inRecorded, &theValue );
+	return (int16_t)theValue;
+}
+
+
+// Executes one call, returns its duration in seconds, or a negative number if it was skipped:
+static double	RCLReplayCall( const struct RCLTraceCall* inCall, struct RCLValueMap* ioHandles, struct RCLValueMap* ioRefNums )
+{
+	const int64_t*	ints = inCall->ints;
+	Handle			theHandle = NULL;
+	double			startTime = 0, endTime = 0;
+	int16_t			refNum = 0;
+	
+	// Calls on a Handle all have it first:
+	bool			takesHandle = (inCall->call == kFakeCallDisposeHandle || inCall->call == kFakeCallEmptyHandle
+									|| (inCall->call >= kFakeCallGetHandleSize && inCall->call <= kFakeCallHSetState && inCall->call != kFakeCallMoreMasters)
+									|| inCall->call == kFakeCallHomeResFile
+									|| (inCall->call >= kFakeCallGetResInfo && inCall->call <= kFakeCallReleaseResource));
+	if( inCall->call == 0 || inCall->call >= kFakeCallNumCalls || inCall->numInts < sMinInts[inCall->call] )
+		return -1;	// Written by a newer version, or damaged.
+	if( takesHandle && !RCLMapHandle( ioHandles, ints[0], &theHandle ) )
+		return -1;
+	
+	switch( inCall->call )
+	{
+		case kFakeCallNewHandle:
+			startTime = RCLCurrentTime();
+			theHandle = FakeNewHandle( (long)ints[0] );
+			endTime = RCLCurrentTime();
+			RCLNoteHandle( ioHandles, ints[1], theHandle );
+			break;
+		
+		case kFakeCallNewEmptyHandle:
+			startTime = RCLCurrentTime();
+			theHandle = FakeNewEmptyHandle();
+			endTime = RCLCurrentTime();
+			RCLNoteHandle( ioHandles, ints[0], theHandle );
+			break;
+		
+		case kFakeCallDisposeHandle:
+			startTime = RCLCurrentTime();
+			FakeDisposeHandle( theHandle );
+			endTime = RCLCurrentTime();
+			RCLValueMapSet( ioHandles, ints[0], 0 );	// Its address may be reused for a new Handle.
+			break;
+		
+		case kFakeCallEmptyHandle:
+			startTime = RCLCurrentTime();
+			FakeEmptyHandle( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallGetHandleSize:
+			startTime = RCLCurrentTime();
+			FakeGetHandleSize( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallSetHandleSize:
+			startTime = RCLCurrentTime();
+			FakeSetHandleSize( theHandle, (long)ints[1] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallSetHandleSizeReentrant:
+			startTime = RCLCurrentTime();
+			FakeSetHandleSizeReentrant( theHandle, (long)ints[1] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallMoreMasters:
+			startTime = RCLCurrentTime();
+			FakeMoreMasters();
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallAdoptHandleMemory:
+		{
+			char*	theData = malloc( (size_t)ints[1] +1 );
+			startTime = RCLCurrentTime();
+			FakeAdoptHandleMemory( theHandle, theData, (long)ints[1] );
+			endTime = RCLCurrentTime();
+			break;
+		}
+		
+		case kFakeCallHLock:
+			startTime = RCLCurrentTime();
+			FakeHLock( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallHUnlock:
+			startTime = RCLCurrentTime();
+			FakeHUnlock( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallHPurge:
+			startTime = RCLCurrentTime();
+			FakeHPurge( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallHNoPurge:
+			startTime = RCLCurrentTime();
+			FakeHNoPurge( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallHGetState:
+			startTime = RCLCurrentTime();
+			FakeHGetState( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallHSetState:
+			startTime = RCLCurrentTime();
+			FakeHSetState( theHandle, (char)ints[1] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallOpenResFile:
+			if( inCall->numStrings < 1 )
+				return -1;
+			startTime = RCLCurrentTime();
+			refNum = FakeOpenResFile( inCall->strings[0] );
+			endTime = RCLCurrentTime();
+			RCLValueMapSet( ioRefNums, ints[0], refNum );
+			break;
+		
+		case kFakeCallOpenResFork:
+			if( inCall->numStrings < 1 )
+				return -1;
+			startTime = RCLCurrentTime();
+			refNum = FakeOpenResFork( inCall->strings[0], (uint32_t)ints[0], (uint32_t)ints[1] );
+			endTime = RCLCurrentTime();
+			RCLValueMapSet( ioRefNums, ints[2], refNum );
+			break;
+		
+		case kFakeCallOpenResFiles:
+		{
+			int16_t		numFiles = (int16_t)ints[0];
+			if( numFiles < 1 || inCall->numStrings < (size_t)numFiles || inCall->numInts < (size_t)numFiles +1 )
+				return -1;
+			int16_t*	refNums = calloc( numFiles, sizeof(int16_t) );
+			startTime = RCLCurrentTime();
+			FakeOpenResFiles( (const unsigned char**)inCall->strings, numFiles, refNums, NULL );
+			endTime = RCLCurrentTime();
+			for( int16_t x = 0; x < numFiles; x++ )
+				RCLValueMapSet( ioRefNums, ints[x +1], refNums[x] );
+			free( refNums );
+			break;
+		}
+		
+		case kFakeCallCloseResFile:
+			refNum = RCLMapRefNum( ioRefNums, ints[0] );
+			startTime = RCLCurrentTime();
+			FakeCloseResFile( refNum );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallGet1Resource:
+			startTime = RCLCurrentTime();
+			theHandle = FakeGet1Resource( (uint32_t)ints[0], (int16_t)ints[1] );
+			endTime = RCLCurrentTime();
+			RCLNoteHandle( ioHandles, ints[2], theHandle );
+			break;
+		
+		case kFakeCallGetResource:
+			startTime = RCLCurrentTime();
+			theHandle = FakeGetResource( (uint32_t)ints[0], (int16_t)ints[1] );
+			endTime = RCLCurrentTime();
+			RCLNoteHandle( ioHandles, ints[2], theHandle );
+			break;
+		
+		case kFakeCallGetResources:
+		{
+			size_t		numEntries = (size_t)ints[0];
+			if( inCall->numInts < 1 +3 * numEntries )
+				return -1;
+			struct FakeResourceBatchEntry*	entries = calloc( numEntries +1, sizeof(struct FakeResourceBatchEntry) );
+			for( size_t x = 0; x < numEntries; x++ )
+			{
+				entries[x].resType = (uint32_t)ints[1 +3 * x];
+				entries[x].resID = (int16_t)ints[2 +3 * x];
+			}
+			startTime = RCLCurrentTime();
+			FakeGetResources( entries, numEntries );
+			endTime = RCLCurrentTime();
+			for( size_t x = 0; x < numEntries; x++ )
+				RCLNoteHandle( ioHandles, ints[3 +3 * x], entries[x].resHandle );
+			free( entries );
+			break;
+		}
+		
+		case kFakeCallCurResFile:
+			startTime = RCLCurrentTime();
+			FakeCurResFile();
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallUseResFile:
+			refNum = RCLMapRefNum( ioRefNums, ints[0] );
+			startTime = RCLCurrentTime();
+			FakeUseResFile( refNum );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallUpdateResFile:
+			refNum = RCLMapRefNum( ioRefNums, ints[0] );
+			startTime = RCLCurrentTime();
+			FakeUpdateResFile( refNum );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallHomeResFile:
+			startTime = RCLCurrentTime();
+			FakeHomeResFile( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallCount1Types:
+			startTime = RCLCurrentTime();
+			FakeCount1Types();
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallCount1Resources:
+			startTime = RCLCurrentTime();
+			FakeCount1Resources( (uint32_t)ints[0] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallCountTypes:
+			startTime = RCLCurrentTime();
+			FakeCountTypes();
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallCountResources:
+			startTime = RCLCurrentTime();
+			FakeCountResources( (uint32_t)ints[0] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallGet1IndType:
+		{
+			uint32_t	theType = 0;
+			startTime = RCLCurrentTime();
+			FakeGet1IndType( &theType, (int16_t)ints[0] );
+			endTime = RCLCurrentTime();
+			break;
+		}
+		
+		case kFakeCallGet1IndResource:
+			startTime = RCLCurrentTime();
+			theHandle = FakeGet1IndResource( (uint32_t)ints[0], (int16_t)ints[1] );
+			endTime = RCLCurrentTime();
+			RCLNoteHandle( ioHandles, ints[2], theHandle );
+			break;
+		
+		case kFakeCallGetResInfo:
+		{
+			int16_t		theID = 0;
+			uint32_t	theType = 0;
+			FakeStr255	theName = {0};
+			startTime = RCLCurrentTime();
+			FakeGetResInfo( theHandle, &theID, &theType, theName );
+			endTime = RCLCurrentTime();
+			break;
+		}
+		
+		case kFakeCallSetResInfo:
+			if( inCall->numStrings < 1 )
+				return -1;
+			startTime = RCLCurrentTime();
+			FakeSetResInfo( theHandle, (int16_t)ints[1], inCall->strings[0] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallAddResource:
+			if( inCall->numStrings < 1 )
+				return -1;
+			startTime = RCLCurrentTime();
+			FakeAddResource( theHandle, (uint32_t)ints[1], (int16_t)ints[2], inCall->strings[0] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallChangedResource:
+			startTime = RCLCurrentTime();
+			FakeChangedResource( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallRemoveResource:
+			startTime = RCLCurrentTime();
+			FakeRemoveResource( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallWriteResource:
+			startTime = RCLCurrentTime();
+			FakeWriteResource( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallLoadResource:
+			startTime = RCLCurrentTime();
+			FakeLoadResource( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallReleaseResource:
+			startTime = RCLCurrentTime();
+			FakeReleaseResource( theHandle );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallSetResLoad:
+			startTime = RCLCurrentTime();
+			FakeSetResLoad( ints[0] != 0 );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallSetResLoadThreads:
+			startTime = RCLCurrentTime();
+			FakeSetResLoadThreads( (int16_t)ints[0] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallSetResProfileRecording:
+			startTime = RCLCurrentTime();
+			FakeSetResProfileRecording( ints[0] / 1e6 );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallSetResPrefetch:
+			startTime = RCLCurrentTime();
+			FakeSetResPrefetch( ints[0] != 0 );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallSetResourceCacheBudget:
+			startTime = RCLCurrentTime();
+			FakeSetResourceCacheBudget( (uint64_t)ints[0] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallGetResourceCacheStats:
+		{
+			struct FakeResourceCacheStats	stats;
+			startTime = RCLCurrentTime();
+			FakeGetResourceCacheStats( &stats );
+			endTime = RCLCurrentTime();
+			break;
+		}
+		
+		case kFakeCallResetResourceCacheStats:
+			startTime = RCLCurrentTime();
+			FakeResetResourceCacheStats();
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallResError:
+			startTime = RCLCurrentTime();
+			FakeResError();
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallBeginResTransaction:
+			refNum = RCLMapRefNum( ioRefNums, ints[0] );
+			startTime = RCLCurrentTime();
+			FakeBeginResTransaction( refNum );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallCommitResTransaction:
+			refNum = RCLMapRefNum( ioRefNums, ints[0] );
+			startTime = RCLCurrentTime();
+			FakeCommitResTransaction( refNum );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallAbortResTransaction:
+			refNum = RCLMapRefNum( ioRefNums, ints[0] );
+			startTime = RCLCurrentTime();
+			FakeAbortResTransaction( refNum );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallAddResources:
+		{
+			size_t		numEntries = (size_t)ints[0];
+			if( inCall->numInts < 1 +3 * numEntries || inCall->numStrings < numEntries )
+				return -1;
+			struct FakeResourceAddEntry*	entries = calloc( numEntries +1, sizeof(struct FakeResourceAddEntry) );
+			for( size_t x = 0; x < numEntries; x++ )
+			{
+				RCLMapHandle( ioHandles, ints[1 +3 * x], &entries[x].resHandle );	// Unknown ones stay NULL and fail, as they did.
+				entries[x].resType = (uint32_t)ints[2 +3 * x];
+				entries[x].resID = (int16_t)ints[3 +3 * x];
+				entries[x].resName = inCall->strings[x];
+			}
+			startTime = RCLCurrentTime();
+			FakeAddResources( entries, numEntries );
+			endTime = RCLCurrentTime();
+			free( entries );
+			break;
+		}
+		
+		case kFakeCallRemoveResources:
+		{
+			size_t		numHandles = (size_t)ints[0];
+			if( inCall->numInts < 1 +numHandles )
+				return -1;
+			Handle*		handles = calloc( numHandles +1, sizeof(Handle) );
+			for( size_t x = 0; x < numHandles; x++ )
+				RCLMapHandle( ioHandles, ints[1 +x], &handles[x] );
+			startTime = RCLCurrentTime();
+			FakeRemoveResources( handles, NULL, numHandles );
+			endTime = RCLCurrentTime();
+			free( handles );
+			break;
+		}
+		
+		case kFakeCallUniqueID:
+			startTime = RCLCurrentTime();
+			FakeUniqueID( (uint32_t)ints[0] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallUnique1ID:
+			startTime = RCLCurrentTime();
+			FakeUnique1ID( (uint32_t)ints[0] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallGet1ResourceIDsInRange:
+		{
+			size_t		maxCount = (size_t)ints[3];
+			int16_t*	ids = malloc( (maxCount +1) * sizeof(int16_t) );
+			startTime = RCLCurrentTime();
+			FakeGet1ResourceIDsInRange( (uint32_t)ints[0], (int16_t)ints[1], (int16_t)ints[2], ids, maxCount );
+			endTime = RCLCurrentTime();
+			free( ids );
+			break;
+		}
+		
+		case kFakeCallGet1NamedResource:
+			if( inCall->numStrings < 1 )
+				return -1;
+			startTime = RCLCurrentTime();
+			theHandle = FakeGet1NamedResource( (uint32_t)ints[0], inCall->strings[0] );
+			endTime = RCLCurrentTime();
+			RCLNoteHandle( ioHandles, ints[1], theHandle );
+			break;
+		
+		case kFakeCallGetNamedResource:
+			if( inCall->numStrings < 1 )
+				return -1;
+			startTime = RCLCurrentTime();
+			theHandle = FakeGetNamedResource( (uint32_t)ints[0], inCall->strings[0] );
+			endTime = RCLCurrentTime();
+			RCLNoteHandle( ioHandles, ints[1], theHandle );
+			break;
+		
+		case kFakeCallSetResFileFormat:
+			refNum = RCLMapRefNum( ioRefNums, ints[0] );
+			startTime = RCLCurrentTime();
+			FakeSetResFileFormat( refNum, (enum FakeResFileFormat)ints[1] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallGetResFileFormat:
+			refNum = RCLMapRefNum( ioRefNums, ints[0] );
+			startTime = RCLCurrentTime();
+			FakeGetResFileFormat( refNum );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallCompactResFile:
+		{
+			size_t		numTypes = (size_t)ints[4];
+			if( inCall->numInts < 5 +numTypes )
+				return -1;
+			uint32_t*	typeOrder = malloc( (numTypes +1) * sizeof(uint32_t) );
+			for( size_t x = 0; x < numTypes; x++ )
+				typeOrder[x] = (uint32_t)ints[5 +x];
+			struct FakeResCompactOptions	options = { .useProfile = (ints[2] != 0), .typeOrder = numTypes ? typeOrder : NULL,
+														.numTypesInOrder = numTypes, .alignment = (uint32_t)ints[3] };
+			refNum = RCLMapRefNum( ioRefNums, ints[0] );
+			startTime = RCLCurrentTime();
+			FakeCompactResFile( refNum, (ints[1] != 0) ? &options : NULL, NULL );
+			endTime = RCLCurrentTime();
+			free( typeOrder );
+			break;
+		}
+		
+		case kFakeCallSetResSharedCache:
+			startTime = RCLCurrentTime();
+			FakeSetResSharedCache( ints[0] != 0 );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallRemoveResSharedCache:
+			if( inCall->numStrings < 1 )
+				return -1;
+			startTime = RCLCurrentTime();
+			FakeRemoveResSharedCache( inCall->strings[0] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallSetResDedup:
+			startTime = RCLCurrentTime();
+			FakeSetResDedup( ints[0] != 0 );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallSetResourceCacheCompression:
+			startTime = RCLCurrentTime();
+			FakeSetResourceCacheCompression( ints[0] / 1e6 );
+			endTime = RCLCurrentTime();
+			break;
+		
+		case kFakeCallSetResFileLimit:
+			startTime = RCLCurrentTime();
+			FakeSetResFileLimit( (size_t)ints[0] );
+			endTime = RCLCurrentTime();
+			break;
+		
+		default:
+			return -1;
+	}
+	
+	return endTime -startTime;
+}
+
+
+static int	RCLCompareUInt64( const void* inA, const void* inB )
+{
+	uint64_t	a = *(const uint64_t*)inA, b = *(const uint64_t*)inB;
+	return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+
+// Sorts inValues and returns the given percentile of them:
+static uint64_t	RCLPercentile( const uint64_t* inSortedValues, size_t inCount, double inPercentile )
+{
+	size_t	index = (size_t)(inPercentile / 100.0 * (inCount -1) +0.5);
+	return inSortedValues[(index < inCount) ? index : inCount -1];
+}
+
+
+int	main( int argc, const char** argv )
+{
+	const char*		tracePath = NULL;
+	const char*		directory = NULL;
+	bool			optionsOK = true;
+	for( int x = 1; x < argc && optionsOK; x++ )
+	{
+		if( strcmp( argv[x], "--dir" ) == 0 && (x +1) < argc )
+			directory = argv[++x];
+		else if( argv[x][0] != '-' && !tracePath )
+			tracePath = argv[x];
+		else
+			optionsOK = false;
+	}
+	if( !tracePath || !optionsOK )
+	{
+		fprintf( stderr, "Usage: %s [--dir <directory for relative paths>] <trace>\n", argv[0] );
+		return 1;
+	}
+	
+	size_t					numCalls = 0;
+	struct RCLTraceCall*	calls = RCLReadTrace( tracePath, &numCalls );
+	if( !calls )
+	{
+		fprintf( stderr, "Couldn't read call trace %s\n", tracePath );
+		return 1;
+	}
+	if( directory && chdir( directory ) != 0 )
+	{
+		fprintf( stderr, "Couldn't change to %s\n", directory );
+		return 1;
+	}
+	
+	// Collect this run's and the recorded durations per call kind:
+	uint64_t*		durations[kFakeCallNumCalls] = {0};
+	uint64_t*		recordedDurations[kFakeCallNumCalls] = {0};
+	size_t			numPerCall[kFakeCallNumCalls] = {0};
+	for( size_t x = 0; x < numCalls; x++ )
+	{
+		if( calls[x].call < kFakeCallNumCalls )
+			numPerCall[calls[x].call]++;
+	}
+	for( int c = 0; c < kFakeCallNumCalls; c++ )
+	{
+		durations[c] = malloc( (numPerCall[c] +1) * sizeof(uint64_t) );
+		recordedDurations[c] = malloc( (numPerCall[c] +1) * sizeof(uint64_t) );
+		numPerCall[c] = 0;
+	}
+	
+	struct RCLValueMap	handles = {0}, refNums = {0};
+	size_t				numSkipped = 0;
+	uint64_t			numThreads = 0, recordedTotal = 0;
+	double				totalTime = 0;
+	for( size_t x = 0; x < numCalls; x++ )
+	{
+		double	duration = RCLReplayCall( calls +x, &handles, &refNums );
+		if( duration < 0 )
+		{
+			numSkipped++;
+			continue;
+		}
+		uint8_t		c = calls[x].call;
+		durations[c][numPerCall[c]] = (uint64_t)(duration * 1e9);
+		recordedDurations[c][numPerCall[c]] = calls[x].recordedDuration;
+		numPerCall[c]++;
+		totalTime += duration;
+		recordedTotal += calls[x].recordedDuration;
+		if( calls[x].thread > numThreads )
+			numThreads = calls[x].thread;
+	}
+	
+	for( int c = 1; c < kFakeCallNumCalls; c++ )
+	{
+		if( numPerCall[c] == 0 )
+			continue;
+		qsort( durations[c], numPerCall[c], sizeof(uint64_t), RCLCompareUInt64 );
+		qsort( recordedDurations[c], numPerCall[c], sizeof(uint64_t), RCLCompareUInt64 );
+		printf( "{\"benchmark\":\"replay_call\",\"call\":\"%s\",\"count\":%zu,\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"max_ns\":%llu,"
+					"\"recorded_p50_ns\":%llu,\"recorded_p99_ns\":%llu}\n", sCallNames[c], numPerCall[c],
+				(unsigned long long)RCLPercentile( durations[c], numPerCall[c], 50 ), (unsigned long long)RCLPercentile( durations[c], numPerCall[c], 90 ),
+				(unsigned long long)RCLPercentile( durations[c], numPerCall[c], 99 ), (unsigned long long)durations[c][numPerCall[c] -1],
+				(unsigned long long)RCLPercentile( recordedDurations[c], numPerCall[c], 50 ),
+				(unsigned long long)RCLPercentile( recordedDurations[c], numPerCall[c], 99 ) );
+	}
+	
+	char	params[256];
+	snprintf( params, sizeof(params), "\"skipped\":%zu,\"recorded_threads\":%llu,\"recorded_seconds\":%.9f",
+				numSkipped, (unsigned long long)numThreads, recordedTotal / 1e9 );
+	RCLReportResult( "replay", params, (int64_t)(numCalls -numSkipped), totalTime );
+	
+	for( int c = 0; c < kFakeCallNumCalls; c++ )
+	{
+		free( durations[c] );
+		free( recordedDurations[c] );
+	}
+	for( size_t x = 0; x < numCalls; x++ )
+	{
+		for( size_t y = 0; y < calls[x].numStrings; y++ )
+			free( calls[x].strings[y] );
+		free( calls[x].strings );
+		free( calls[x].ints );
+	}
+	free( calls );
+	free( handles.keys );
+	free( handles.values );
+	free( handles.used );
+	free( refNums.keys );
+	free( refNums.values );
+	free( refNums.used );
+	
+	return 0;
+}
@@ -0,0 +1,262 @@
+//
+//  ResFileGenerator.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ResFileGenerator.h"
+#include "EndianStuff.h"
+
+
+struct RCLGeneratedRef
+{
+	int16_t		resID;
+	int32_t		nameOffset;		// -1 if no name.
+	uint8_t		attributes;
+	uint32_t	dataOffset;		// Resource data relative.
+};
+
+
+// Small, fast, deterministic random number generator (xorshift):
+static uint32_t	RCLRandom( uint32_t* ioState )
+{
+	uint32_t	x = *ioState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*ioState = x;
+	return x;
+}
+
+
+uint32_t	RCLGeneratedResType( int inTypeIndex )
+{
+	return ((uint32_t)'T' << 24) | ((uint32_t)('0' +(inTypeIndex / 100) % 10) << 16)
+			| ((uint32_t)('0' +(inTypeIndex / 10) % 10) << 8) | (uint32_t)('0' +inTypeIndex % 10);
+}
+
+
+static void	RCLWriteUInt32BE( uint32_t inNum, FILE* inFile )
+{
+	inNum = BIG_ENDIAN_32(inNum);
+	fwrite( &inNum, sizeof(inNum), 1, inFile );
+}
+
+
+static void	RCLWriteUInt16BE( uint16_t inNum, FILE* inFile )
+{
+	inNum = BIG_ENDIAN_16(inNum);
+	fwrite( &inNum, sizeof(inNum), 1, inFile );
+}
+
+
+bool	RCLWriteResFile( const char* inPath, const struct RCLResFileSpec* inSpec )
+{
+	// The classic format can only address 16MB of data and 64KB of map (without names):
+	uint64_t	maxTotalDataSize = (uint64_t)inSpec->numTypes * inSpec->resourcesPerType * (sizeof(uint32_t) +inSpec->maxDataSize);
+	uint64_t	maxMapSizeWithoutNames = 28 +2 +8 * (uint64_t)inSpec->numTypes +12 * (uint64_t)inSpec->numTypes * inSpec->resourcesPerType;
+	if( inSpec->numTypes < 1 || inSpec->resourcesPerType < 1 || inSpec->resourcesPerType > 32767
+		|| maxTotalDataSize > 0xFFFFFF || maxMapSizeWithoutNames > 0xFFFF )
+		return false;
+	
+	FILE*		theFile = fopen( inPath, "w" );
+	if( !theFile )
+		return false;
+	
+	uint32_t	randomState = inSpec->seed ? inSpec->seed : 1;
+	size_t		numRefs = (size_t)inSpec->numTypes * inSpec->resourcesPerType;
+	struct RCLGeneratedRef*	refs = calloc( numRefs +1, sizeof(struct RCLGeneratedRef) );
+	uint32_t	maxDataSize = (inSpec->maxDataSize < inSpec->minDataSize) ? inSpec->minDataSize : inSpec->maxDataSize;
+	char*		dataBuffer = malloc( maxDataSize +1 );
+	uint32_t	dataLength = 0;
+	uint32_t	nameListLength = 0;
+	
+	// Header, filled in at the end:
+	char		emptyHeader[256] = {0};
+	fwrite( emptyHeader, sizeof(emptyHeader), 1, theFile );
+	
+	// Resource data:
+	for( size_t x = 0; x < numRefs; x++ )
+	{
+		uint32_t	dataSize = inSpec->minDataSize;
+		uint32_t	sizeRange = maxDataSize -inSpec->minDataSize;
+		if( sizeRange > 0 && inSpec->sizeDistribution == RCLSizeExponential )
+		{
+			double	unitRandom = (RCLRandom( &randomState ) % 1000000) / 1000000.0;
+			double	scaled = -log( 1.0 -unitRandom ) / 6.0;	// Mean at 1/6 of the range.
+			dataSize += (scaled >= 1.0) ? sizeRange : (uint32_t)(scaled * sizeRange);
+		}
+		else if( sizeRange > 0 )
+			dataSize += RCLRandom( &randomState ) % (sizeRange +1);
+		for( uint32_t y = 0; y < dataSize; y++ )
+			dataBuffer[y] = (char)(x +y);
+		if( inSpec->dataProc )
+			dataSize = inSpec->dataProc( x, (uint8_t*)dataBuffer, dataSize, maxDataSize, &refs[x].attributes, inSpec->dataRefCon );
+		
+		refs[x].resID = (int16_t)(128 +(x % inSpec->resourcesPerType));
+		refs[x].dataOffset = dataLength;
+		refs[x].nameOffset = -1;
+		if( (RCLRandom( &randomState ) % 1000) < (uint32_t)(inSpec->namedFraction * 1000.0) )
+		{
+			refs[x].nameOffset = nameListLength;
+			nameListLength += 1 +snprintf( NULL, 0, "Resource %zu", x );
+		}
+		
+		RCLWriteUInt32BE( dataSize, theFile );
+		fwrite( dataBuffer, 1, dataSize, theFile );
+		dataLength += sizeof(uint32_t) +dataSize;
+	}
+	
+	// Resource map:
+	uint32_t	mapOffset = 256 +dataLength;
+	uint16_t	typeListOffset = 28;
+	uint32_t	typeListLength = 2 +8 * inSpec->numTypes;
+	uint32_t	refListLength = 12 * (uint32_t)numRefs;
+	uint16_t	nameListOffset = (uint16_t)(typeListOffset +typeListLength +refListLength);
+	uint32_t	mapLength = nameListOffset +nameListLength;
+	
+	fwrite( emptyHeader, 16 +4 +2, 1, theFile );	// Header copy, next map, file ref num.
+	RCLWriteUInt16BE( 0, theFile );					// File attributes.
+	RCLWriteUInt16BE( typeListOffset, theFile );
+	RCLWriteUInt16BE( nameListOffset, theFile );
+	RCLWriteUInt16BE( (uint16_t)(inSpec->numTypes -1), theFile );
+	for( int x = 0; x < inSpec->numTypes; x++ )
+	{
+		RCLWriteUInt32BE( RCLGeneratedResType( x ), theFile );
+		RCLWriteUInt16BE( (uint16_t)(inSpec->resourcesPerType -1), theFile );
+		RCLWriteUInt16BE( (uint16_t)(typeListLength +12 * x * inSpec->resourcesPerType), theFile );
+	}
+	for( size_t x = 0; x < numRefs; x++ )
+	{
+		RCLWriteUInt16BE( (uint16_t)refs[x].resID, theFile );
+		RCLWriteUInt16BE( (uint16_t)refs[x].nameOffset, theFile );
+		RCLWriteUInt32BE( ((uint32_t)refs[x].attributes << 24) | refs[x].dataOffset, theFile );
+		RCLWriteUInt32BE( 0, theFile );				// Handle placeholder.
+	}
+	for( size_t x = 0; x < numRefs; x++ )
+	{
+		if( refs[x].nameOffset < 0 )
+			continue;
+		char	name[257] = {0};
+		int		nameLength = snprintf( name +1, sizeof(name) -1, "Resource %zu", x );
+		name[0] = (char)nameLength;
+		fwrite( name, 1, nameLength +1, theFile );
+	}
+	
+	// Now that we know all offsets, write the header:
+	fseek( theFile, 0, SEEK_SET );
+	RCLWriteUInt32BE( 256, theFile );
+	RCLWriteUInt32BE( mapOffset, theFile );
+	RCLWriteUInt32BE( dataLength, theFile );
+	RCLWriteUInt32BE( mapLength, theFile );
+	
+	bool	success = (ferror( theFile ) == 0);
+	success = (fclose( theFile ) == 0) && success;
+	free( dataBuffer );
+	free( refs );
+	
+	return success;
+}
+
+
+// CRC MacBinary II uses to recognize its header:
+static uint16_t	RCLMacBinaryCRC( const uint8_t* inBytes, size_t inLength )
+{
+	uint16_t	crc = 0;
+	for( size_t x = 0; x < inLength; x++ )
+	{
+		crc ^= (uint16_t)inBytes[x] << 8;
+		for( int y = 0; y < 8; y++ )
+			crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+	}
+	return crc;
+}
+
+
+static void	RCLPutUInt32BE( uint32_t inNum, uint8_t* outBytes )
+{
+	inNum = BIG_ENDIAN_32(inNum);
+	memmove( outBytes, &inNum, sizeof(inNum) );
+}
+
+
+static void	RCLWritePadding( size_t inLength, FILE* inFile )
+{
+	for( size_t x = 0; x < inLength; x++ )
+		fputc( 0, inFile );
+}
+
+
+bool	RCLWrapResFile( const char* inResFilePath, const char* inContainerPath, enum RCLContainerFormat inFormat, uint32_t inDataForkLength )
+{
+	FILE*	resFile = fopen( inResFilePath, "r" );
+	if( !resFile )
+		return false;
+	fseek( resFile, 0, SEEK_END );
+	uint32_t	resForkLength = (uint32_t)ftell( resFile );
+	fseek( resFile, 0, SEEK_SET );
+	
+	FILE*	theFile = fopen( inContainerPath, "w" );
+	if( !theFile )
+	{
+		fclose( resFile );
+		return false;
+	}
+	
+	if( inFormat == RCLContainerAppleDouble )
+		inDataForkLength = 0;
+	
+	if( inFormat == RCLContainerMacBinary )
+	{
+		uint8_t		header[128] = {0};
+		const char*	fileName = "Generated";
+		header[1] = (uint8_t)strlen( fileName );
+		memmove( header +2, fileName, header[1] );
+		memmove( header +65, "rsrcRSED", 8 );
+		RCLPutUInt32BE( inDataForkLength, header +83 );
+		RCLPutUInt32BE( resForkLength, header +87 );
+		header[122] = 129;	// Version that wrote this, minimum version needed to read it.
+		header[123] = 129;
+		uint16_t	crc = BIG_ENDIAN_16(RCLMacBinaryCRC( header, 124 ));
+		memmove( header +124, &crc, sizeof(crc) );
+		fwrite( header, 1, sizeof(header), theFile );
+		
+		RCLWritePadding( inDataForkLength, theFile );
+		RCLWritePadding( ((inDataForkLength +127) & ~127) -inDataForkLength, theFile );
+	}
+	else
+	{
+		// AppleSingle has the data fork and resource fork, AppleDouble Finder info and resource fork:
+		const uint32_t	kHeaderLength = 26 + 2 * 12;
+		uint32_t		firstEntryLength = (inFormat == RCLContainerAppleSingle) ? inDataForkLength : 32;
+		RCLWriteUInt32BE( (inFormat == RCLContainerAppleSingle) ? 0x00051600 : 0x00051607, theFile );
+		RCLWriteUInt32BE( 0x00020000, theFile );
+		RCLWritePadding( 16, theFile );
+		RCLWriteUInt16BE( 2, theFile );
+		RCLWriteUInt32BE( (inFormat == RCLContainerAppleSingle) ? 1 : 9, theFile );	// Data fork, or Finder info.
+		RCLWriteUInt32BE( kHeaderLength, theFile );
+		RCLWriteUInt32BE( firstEntryLength, theFile );
+		RCLWriteUInt32BE( 2, theFile );		// Resource fork.
+		RCLWriteUInt32BE( kHeaderLength +firstEntryLength, theFile );
+		RCLWriteUInt32BE( resForkLength, theFile );
+		RCLWritePadding( firstEntryLength, theFile );
+	}
+	
+	char	buffer[65536];
+	size_t	amountRead = 0;
+	while( (amountRead = fread( buffer, 1, sizeof(buffer), resFile )) > 0 )
+		fwrite( buffer, 1, amountRead, theFile );
+	if( inFormat == RCLContainerMacBinary )
+		RCLWritePadding( ((resForkLength +127) & ~127) -resForkLength, theFile );
+	
+	bool	success = (ferror( theFile ) == 0) && (ferror( resFile ) == 0);
+	success = (fclose( theFile ) == 0) && success;
+	fclose( resFile );
+	
+	return success;
+}
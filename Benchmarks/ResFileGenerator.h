@@ -0,0 +1,73 @@
+//
+//  ResFileGenerator.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#ifndef ReClassicfication_ResFileGenerator_h
+#define ReClassicfication_ResFileGenerator_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+// How the sizes of resource data are spread between minDataSize and maxDataSize:
+enum RCLSizeDistribution
+{
+	RCLSizeUniform = 0,		// Every size equally likely.
+	RCLSizeExponential		// Mostly small resources, a few big ones, like real files.
+};
+
+
+// Called with the data made up for the inIndex-th resource. May replace it with
+//	up to inMaxLength bytes of its own and set the resource's attributes.
+//	Returns the length of the data to write:
+typedef uint32_t (*RCLResourceDataProc)( size_t inIndex, uint8_t* ioData, uint32_t inLength, uint32_t inMaxLength, uint8_t* outAttributes, void* inRefCon );
+
+
+// Describes a synthetic resource file for benchmarks:
+struct RCLResFileSpec
+{
+	int			numTypes;			// Types are 'T000', 'T001' etc.
+	int			resourcesPerType;	// IDs start at 128.
+	uint32_t	minDataSize;		// Size of each resource's data is picked at random from this range.
+	uint32_t	maxDataSize;
+	enum RCLSizeDistribution	sizeDistribution;
+	double		namedFraction;		// 0.0 ... 1.0, how many of the resources get a name.
+	unsigned	seed;				// Same seed, same file.
+	RCLResourceDataProc	dataProc;	// May be NULL.
+	void*		dataRefCon;
+};
+
+
+// Formats RCLWrapResFile() can write:
+enum RCLContainerFormat
+{
+	RCLContainerMacBinary = 0,	// MacBinary II
+	RCLContainerAppleSingle,
+	RCLContainerAppleDouble
+};
+
+
+// Type code of the n-th type in a generated file:
+uint32_t	RCLGeneratedResType( int inTypeIndex );
+
+// Writes a file in the classic resource file format. Returns false on failure.
+bool		RCLWriteResFile( const char* inPath, const struct RCLResFileSpec* inSpec );
+
+// Writes a container file holding the resource fork at inResFilePath and a
+//	data fork of inDataForkLength bytes (not for AppleDouble, which has none).
+//	Returns false on failure.
+bool		RCLWrapResFile( const char* inResFilePath, const char* inContainerPath, enum RCLContainerFormat inFormat, uint32_t inDataForkLength );
+
+#if __cplusplus
+};
+#endif
+
+#endif
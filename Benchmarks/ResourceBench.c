@@ -0,0 +1,291 @@
+//
+//  ResourceBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Times the common Resource Manager and Handle calls on a synthetic
+//  resource file. Run with --help for the options. Prints one line of JSON
+//  per measurement (see RCLReportResult()), so results can be collected and
+//  compared between versions.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+struct RCLBenchOptions
+{
+	struct RCLResFileSpec	spec;
+	int						iterations;
+	uint64_t				cacheBudget;
+	const char*				filePath;
+};
+
+
+static void	PrintUsage( const char* inToolName )
+{
+	fprintf( stderr, "Usage: %s [options]\n"
+			"  --types <n>            Number of resource types (default 16)\n"
+			"  --per-type <n>         Resources per type (default 256)\n"
+			"  --min-size <bytes>     Smallest resource data (default 16)\n"
+			"  --max-size <bytes>     Largest resource data (default 2048)\n"
+			"  --distribution <d>     'uniform' or 'exponential' (default exponential)\n"
+			"  --named <fraction>     Fraction of resources with a name (default 0.5)\n"
+			"  --seed <n>             Random seed for the generated file (default 1)\n"
+			"  --iterations <n>       Repeat count for the slower operations (default 20)\n"
+			"  --cache-budget <bytes> FakeSetResourceCacheBudget() for the lookups (default 0, no limit)\n"
+			"  --file <path>          Where to write the generated file (default ResourceBench.rsrc)\n",
+			inToolName );
+}
+
+
+static bool	ParseOptions( int argc, const char** argv, struct RCLBenchOptions* outOptions )
+{
+	for( int x = 1; x < argc; x++ )
+	{
+		const char*	value = (x +1 < argc) ? argv[x +1] : NULL;
+		if( strcmp( argv[x], "--help" ) == 0 || !value )
+			return false;
+		else if( strcmp( argv[x], "--types" ) == 0 )
+			outOptions->spec.numTypes = atoi( value );
+		else if( strcmp( argv[x], "--per-type" ) == 0 )
+			outOptions->spec.resourcesPerType = atoi( value );
+		else if( strcmp( argv[x], "--min-size" ) == 0 )
+			outOptions->spec.minDataSize = (uint32_t)strtoul( value, NULL, 10 );
+		else if( strcmp( argv[x], "--max-size" ) == 0 )
+			outOptions->spec.maxDataSize = (uint32_t)strtoul( value, NULL, 10 );
+		else if( strcmp( argv[x], "--distribution" ) == 0 )
+			outOptions->spec.sizeDistribution = (strcmp( value, "uniform" ) == 0) ? RCLSizeUniform : RCLSizeExponential;
+		else if( strcmp( argv[x], "--named" ) == 0 )
+			outOptions->spec.namedFraction = atof( value );
+		else if( strcmp( argv[x], "--seed" ) == 0 )
+			outOptions->spec.seed = (unsigned)strtoul( value, NULL, 10 );
+		else if( strcmp( argv[x], "--iterations" ) == 0 )
+			outOptions->iterations = atoi( value );
+		else if( strcmp( argv[x], "--cache-budget" ) == 0 )
+			outOptions->cacheBudget = strtoull( value, NULL, 10 );
+		else if( strcmp( argv[x], "--file" ) == 0 )
+			outOptions->filePath = value;
+		else
+			return false;
+		x++;
+	}
+	
+	return outOptions->iterations > 0;
+}
+
+
+int	main( int argc, const char** argv )
+{
+	struct RCLBenchOptions	options = { { .numTypes = 16, .resourcesPerType = 256, .minDataSize = 16, .maxDataSize = 2048,
+											.sizeDistribution = RCLSizeExponential, .namedFraction = 0.5, .seed = 1 },
+										20, 0, "ResourceBench.rsrc" };
+	if( !ParseOptions( argc, argv, &options ) )
+	{
+		PrintUsage( argv[0] );
+		return 1;
+	}
+	
+	const struct RCLResFileSpec*	spec = &options.spec;
+	int64_t		numResources = (int64_t)spec->numTypes * spec->resourcesPerType;
+	char		params[512];
+	snprintf( params, sizeof(params), "\"types\":%d,\"per_type\":%d,\"min_size\":%u,\"max_size\":%u,\"distribution\":\"%s\",\"named\":%.2f",
+				spec->numTypes, spec->resourcesPerType, spec->minDataSize, spec->maxDataSize,
+				(spec->sizeDistribution == RCLSizeUniform) ? "uniform" : "exponential", spec->namedFraction );
+	
+	if( !RCLWriteResFile( options.filePath, spec ) )
+	{
+		fprintf( stderr, "Couldn't write %s (too large for the classic format?)\n", options.filePath );
+		return 1;
+	}
+	
+	// Open & close, from disk and from the OS's cache:
+	double	openTime = 0, closeTime = 0, coldOpenTime = 0;
+	int16_t	refNum = 0;
+	for( int x = 0; x < options.iterations; x++ )
+	{
+		RCLEvictFileFromCache( options.filePath );
+		double	startTime = RCLCurrentTime();
+		refNum = RCLOpenResFileAtPath( options.filePath );
+		coldOpenTime += RCLCurrentTime() -startTime;
+		FakeCloseResFile( refNum );
+		
+		startTime = RCLCurrentTime();
+		refNum = RCLOpenResFileAtPath( options.filePath );
+		openTime += RCLCurrentTime() -startTime;
+		if( FakeResError() != noErr )
+		{
+			fprintf( stderr, "Couldn't open %s (%d)\n", options.filePath, FakeResError() );
+			return 1;
+		}
+		
+		startTime = RCLCurrentTime();
+		FakeCloseResFile( refNum );
+		closeTime += RCLCurrentTime() -startTime;
+	}
+	RCLReportResult( "open_cold", params, options.iterations, coldOpenTime );
+	RCLReportResult( "open", params, options.iterations, openTime );
+	RCLReportResult( "close", params, options.iterations, closeTime );
+	
+	refNum = RCLOpenResFileAtPath( options.filePath );
+	FakeSetResourceCacheBudget( options.cacheBudget );
+	FakeResetResourceCacheStats();
+	
+	// Lookups, in a fixed pseudo-random order so all runs do the same:
+	int64_t		numLookups = (numResources < 100000) ? 100000 : numResources;
+	uint32_t	randomState = 12345;
+	uint32_t*	lookupTypes = malloc( numLookups * sizeof(uint32_t) );
+	int16_t*	lookupIDs = malloc( numLookups * sizeof(int16_t) );
+	Handle*		lookupHandles = malloc( numLookups * sizeof(Handle) );
+	for( int64_t x = 0; x < numLookups; x++ )
+	{
+		randomState = randomState * 1103515245 + 12345;
+		lookupTypes[x] = RCLGeneratedResType( (randomState >> 8) % spec->numTypes );
+		randomState = randomState * 1103515245 + 12345;
+		lookupIDs[x] = (int16_t)(128 +(randomState >> 8) % spec->resourcesPerType);
+	}
+	
+	double	startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < numLookups; x++ )
+		lookupHandles[x] = FakeGetResource( lookupTypes[x], lookupIDs[x] );
+	RCLReportResult( "get_resource_hit", params, numLookups, RCLCurrentTime() -startTime );
+	
+	struct FakeResourceCacheStats	cacheStats = {0};
+	FakeGetResourceCacheStats( &cacheStats );
+	printf( "{\"benchmark\":\"resource_cache\",%s,\"budget\":%llu,\"hits\":%llu,\"misses\":%llu,\"evictions\":%llu,\"bytes_cached\":%llu}\n",
+			params, (unsigned long long)cacheStats.budget, (unsigned long long)cacheStats.hits, (unsigned long long)cacheStats.misses,
+			(unsigned long long)cacheStats.evictions, (unsigned long long)cacheStats.bytesCached );
+	FakeSetResourceCacheBudget( 0 );
+	
+	startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < numLookups; x++ )
+		FakeGetResource( lookupTypes[x], (int16_t)(-1 -lookupIDs[x]) );		// No negative IDs in our file.
+	RCLReportResult( "get_resource_miss", params, numLookups, RCLCurrentTime() -startTime );
+	
+	startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < numLookups; x++ )
+	{
+		int16_t		theID = 0;
+		uint32_t	theType = 0;
+		FakeStr255	theName;
+		FakeGetResInfo( lookupHandles[x], &theID, &theType, theName );
+	}
+	RCLReportResult( "get_res_info", params, numLookups, RCLCurrentTime() -startTime );
+	
+	// Add and remove resources of a new type:
+	const uint32_t	kAddedType = 'ADDR';
+	int64_t			numAdds = (numResources < 32767) ? numResources : 32767;
+	Handle*			addedHandles = malloc( numAdds * sizeof(Handle) );
+	FakeStr255		emptyName = {0};
+	for( int64_t x = 0; x < numAdds; x++ )
+		addedHandles[x] = FakeNewHandle( 16 );
+	startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < numAdds; x++ )
+		FakeAddResource( addedHandles[x], kAddedType, (int16_t)x, emptyName );
+	RCLReportResult( "add_resource", params, numAdds, RCLCurrentTime() -startTime );
+	
+	startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < numAdds; x++ )
+		FakeRemoveResource( addedHandles[x] );
+	RCLReportResult( "remove_resource", params, numAdds, RCLCurrentTime() -startTime );
+	
+	// The same as one transaction each, including saving the file. A classic
+	//	file may not have room for all of them, so save in the extended format:
+	FakeSetResFileFormat( refNum, kFakeResFileExtended );
+	startTime = RCLCurrentTime();
+	FakeBeginResTransaction( refNum );
+	for( int64_t x = 0; x < numAdds; x++ )
+		FakeAddResource( addedHandles[x], kAddedType, (int16_t)x, emptyName );
+	FakeCommitResTransaction( refNum );
+	if( FakeResError() != noErr )
+	{
+		fprintf( stderr, "Couldn't commit adding resources (%d)\n", FakeResError() );
+		return 1;
+	}
+	RCLReportResult( "add_resource_transaction", params, numAdds, RCLCurrentTime() -startTime );
+	
+	startTime = RCLCurrentTime();
+	FakeBeginResTransaction( refNum );
+	for( int64_t x = 0; x < numAdds; x++ )
+		FakeRemoveResource( addedHandles[x] );
+	FakeCommitResTransaction( refNum );
+	if( FakeResError() != noErr )
+	{
+		fprintf( stderr, "Couldn't commit removing resources (%d)\n", FakeResError() );
+		return 1;
+	}
+	RCLReportResult( "remove_resource_transaction", params, numAdds, RCLCurrentTime() -startTime );
+	FakeSetResFileFormat( refNum, kFakeResFileClassic );	// So the updates below write what we generated.
+	for( int64_t x = 0; x < numAdds; x++ )
+		FakeDisposeHandle( addedHandles[x] );
+	free( addedHandles );
+	
+	// Write the whole file back:
+	double	updateTime = 0;
+	for( int x = 0; x < options.iterations; x++ )
+	{
+		FakeChangedResource( lookupHandles[x % numLookups] );
+		startTime = RCLCurrentTime();
+		FakeUpdateResFile( refNum );
+		updateTime += RCLCurrentTime() -startTime;
+	}
+	RCLReportResult( "update_res_file", params, options.iterations, updateTime );
+	
+	FakeCloseResFile( refNum );
+	free( lookupHandles );
+	
+	// Startup with FakeSetResLoad(false): Record which resources the first
+	//	lookups need, then time them with and without the background prefetch:
+	int64_t		numStartupLookups = (numLookups < 1000) ? numLookups : 1000;
+	char		profilePath[1024];
+	snprintf( profilePath, sizeof(profilePath), "%s.rprof", options.filePath );
+	for( int pass = 0; pass < 3; pass++ )
+	{
+		FakeSetResProfileRecording( (pass == 0) ? 3600 : 0 );
+		FakeSetResPrefetch( pass == 2 );
+		RCLEvictFileFromCache( options.filePath );
+		FakeSetResLoad( false );
+		startTime = RCLCurrentTime();
+		refNum = RCLOpenResFileAtPath( options.filePath );
+		FakeSetResLoad( true );
+		for( int64_t x = 0; x < numStartupLookups; x++ )
+			FakeGetResource( lookupTypes[x], lookupIDs[x] );
+		double	startupTime = RCLCurrentTime() -startTime;
+		FakeCloseResFile( refNum );
+		if( pass > 0 )
+			RCLReportResult( (pass == 2) ? "startup_prefetch" : "startup_no_prefetch", params, numStartupLookups, startupTime );
+	}
+	FakeSetResProfileRecording( 0 );
+	FakeSetResPrefetch( true );
+	remove( profilePath );
+	
+	free( lookupIDs );
+	free( lookupTypes );
+	remove( options.filePath );
+	
+	// Handles:
+	const int64_t	kNumHandles = 100000;
+	Handle*			handles = malloc( kNumHandles * sizeof(Handle) );
+	startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < kNumHandles; x++ )
+		handles[x] = FakeNewHandle( 64 );
+	RCLReportResult( "new_handle", "\"size\":64", kNumHandles, RCLCurrentTime() -startTime );
+	
+	startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < kNumHandles; x++ )
+		FakeSetHandleSize( handles[x], 256 );
+	RCLReportResult( "set_handle_size", "\"size\":256", kNumHandles, RCLCurrentTime() -startTime );
+	
+	startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < kNumHandles; x++ )
+		FakeDisposeHandle( handles[x] );
+	RCLReportResult( "dispose_handle", NULL, kNumHandles, RCLCurrentTime() -startTime );
+	free( handles );
+	
+	return 0;
+}
@@ -0,0 +1,274 @@
+//
+//  ResourceViewBench.cpp
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Measures reading 'STR#' and 'DITL' resources through the views in
+//  FakeResourceViews.hpp against copying and swapping each field by hand,
+//  and converting 'snd ' samples and 'PICT' words to host byte order with
+//  FakeSwapBigEndian16()/32() against a loop of BIG_ENDIAN_16()/32(). Then
+//  times getting resources through FakeResources.hpp against the C calls.
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "FakeResourceViews.hpp"
+#include "FakeResources.hpp"
+#include "EndianStuff.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+// A 'STR#' with inCount strings "String 0", "String 1" etc.:
+static Handle	RCLMakeStringList( uint16_t inCount )
+{
+	Handle		theList = FakeNewHandle( 2 +inCount * 256 );
+	uint8_t*	bytes = reinterpret_cast<uint8_t*>( *theList );
+	size_t		offset = 2;
+	Fake::BigUInt16	count( inCount );
+	memcpy( bytes, &count, 2 );
+	for( uint16_t x = 0; x < inCount; x++ )
+	{
+		bytes[offset] = static_cast<uint8_t>( snprintf( reinterpret_cast<char*>( bytes +offset +1 ), 255, "String %u", x ) );
+		offset += 1 +bytes[offset];
+	}
+	FakeSetHandleSize( theList, offset );
+	return theList;
+}
+
+
+// A 'DITL' with inCount static text items, each a bit further down:
+static Handle	RCLMakeDialogItemList( int16_t inCount )
+{
+	Handle		theList = FakeNewHandle( 2 +inCount * (sizeof(Fake::DialogItemHeader) +16) );
+	uint8_t*	bytes = reinterpret_cast<uint8_t*>( *theList );
+	size_t		offset = 2;
+	Fake::BigInt16	countMinusOne( inCount -1 );
+	memcpy( bytes, &countMinusOne, 2 );
+	for( int16_t x = 0; x < inCount; x++ )
+	{
+		Fake::DialogItemHeader	item = {};
+		item.bounds.top = static_cast<int16_t>( 10 +x * 20 );
+		item.bounds.left = 10;
+		item.bounds.bottom = static_cast<int16_t>( 26 +x * 20 );
+		item.bounds.right = 200;
+		item.type = Fake::kFakeDITLStaticText;
+		item.dataLength = 11;
+		memcpy( bytes +offset, &item, sizeof(item) );
+		memcpy( bytes +offset +sizeof(item), "Static text", 11 );
+		offset += sizeof(item) +12;	// Padded to even.
+	}
+	FakeSetHandleSize( theList, offset );
+	return theList;
+}
+
+
+static void	RCLBenchmarkStringList( int64_t inIterations )
+{
+	const uint16_t	kNumStrings = 256;
+	Handle			theList = RCLMakeStringList( kNumStrings );
+	char			params[64];
+	snprintf( params, sizeof(params), "\"strings\":%u", kNumStrings );
+
+	// By hand, copying each into a C string like callers used to:
+	size_t		totalLengthCopied = 0;
+	double		startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < inIterations; i++ )
+	{
+		const uint8_t*	bytes = reinterpret_cast<const uint8_t*>( *theList );
+		long			size = FakeGetHandleSize( theList );
+		uint16_t		count = 0;
+		memcpy( &count, bytes, 2 );
+		count = BIG_ENDIAN_16(count);
+		long			offset = 2;
+		for( uint16_t x = 0; x < count && offset < size && (offset +1 +bytes[offset]) <= size; x++ )
+		{
+			char	cString[256];
+			memcpy( cString, bytes +offset +1, bytes[offset] );
+			cString[bytes[offset]] = 0;
+			totalLengthCopied += strlen( cString );
+			offset += 1 +bytes[offset];
+		}
+	}
+	RCLReportResult( "strlist_copy", params, inIterations * kNumStrings, RCLCurrentTime() -startTime );
+
+	size_t		totalLengthViewed = 0;
+	startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < inIterations; i++ )
+	{
+		for( std::string_view currString : Fake::StringListView( theList ) )
+			totalLengthViewed += currString.size();
+	}
+	RCLReportResult( "strlist_view", params, inIterations * kNumStrings, RCLCurrentTime() -startTime );
+
+	if( totalLengthCopied != totalLengthViewed || Fake::StringListView( theList )[17] != "String 17" )
+		fprintf( stderr, "'STR#' views disagree.\n" );
+	FakeDisposeHandle( theList );
+}
+
+
+static void	RCLBenchmarkDialogItemList( int64_t inIterations )
+{
+	const int16_t	kNumItems = 64;
+	Handle			theList = RCLMakeDialogItemList( kNumItems );
+	char			params[64];
+	snprintf( params, sizeof(params), "\"items\":%d", kNumItems );
+
+	// By hand, copying each item's rectangle out and swapping its fields:
+	int64_t		totalHeightCopied = 0;
+	double		startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < inIterations; i++ )
+	{
+		const uint8_t*	bytes = reinterpret_cast<const uint8_t*>( *theList );
+		long			size = FakeGetHandleSize( theList );
+		int16_t			countMinusOne = 0;
+		memcpy( &countMinusOne, bytes, 2 );
+		countMinusOne = static_cast<int16_t>( BIG_ENDIAN_16(countMinusOne) );
+		long			offset = 2;
+		for( int x = 0; x <= countMinusOne && (offset +14) <= size; x++ )
+		{
+			int16_t		rect[4];
+			memcpy( rect, bytes +offset +4, sizeof(rect) );
+			for( int r = 0; r < 4; r++ )
+				rect[r] = static_cast<int16_t>( BIG_ENDIAN_16(rect[r]) );
+			totalHeightCopied += rect[2] -rect[0];
+			uint8_t		dataLength = bytes[offset +13];
+			offset += 14 +dataLength +(dataLength & 1);
+		}
+	}
+	RCLReportResult( "ditl_copy", params, inIterations * kNumItems, RCLCurrentTime() -startTime );
+
+	int64_t		totalHeightViewed = 0;
+	startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < inIterations; i++ )
+	{
+		for( Fake::DialogItemView currItem : Fake::DialogItemListView( theList ) )
+			totalHeightViewed += currItem.bounds().height();
+	}
+	RCLReportResult( "ditl_view", params, inIterations * kNumItems, RCLCurrentTime() -startTime );
+
+	if( totalHeightCopied != totalHeightViewed )
+		fprintf( stderr, "'DITL' views disagree.\n" );
+	FakeDisposeHandle( theList );
+}
+
+
+// Makes the compiler assume the memory was looked at, so it can't drop
+//	swapping the same values twice:
+static inline void	RCLTouchMemory( void* inMemory )
+{
+#if defined(__GNUC__)
+	__asm__ volatile( "" : : "r"(inMemory) : "memory" );
+#endif
+}
+
+
+// Byte-swaps inCount values of the given size, first with a loop, then in bulk.
+//	Reports the time per inCount values:
+template<class T>
+static void	RCLBenchmarkSwap( const char* inLoopName, const char* inBulkName, size_t inCount, int64_t inIterations )
+{
+	T*		values = static_cast<T*>( malloc( inCount * sizeof(T) ) );
+	T*		swappedValues = static_cast<T*>( malloc( inCount * sizeof(T) ) );
+	for( size_t x = 0; x < inCount; x++ )
+		values[x] = swappedValues[x] = static_cast<T>( x * 2654435761U );
+	char	params[64];
+	snprintf( params, sizeof(params), "\"values\":%zu", inCount );
+
+	double	startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < inIterations; i++ )
+	{
+		for( size_t x = 0; x < inCount; x++ )
+			values[x] = static_cast<T>( (sizeof(T) == 2) ? BIG_ENDIAN_16(values[x]) : BIG_ENDIAN_32(values[x]) );
+		RCLTouchMemory( values );
+	}
+	RCLReportResult( inLoopName, params, inIterations, RCLCurrentTime() -startTime );
+
+	startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < inIterations; i++ )
+	{
+		Fake::SwapBigEndian( swappedValues, inCount );
+		RCLTouchMemory( swappedValues );
+	}
+	RCLReportResult( inBulkName, params, inIterations, RCLCurrentTime() -startTime );
+
+	if( memcmp( values, swappedValues, inCount * sizeof(T) ) != 0 )
+		fprintf( stderr, "Byte swaps disagree.\n" );
+	free( swappedValues );
+	free( values );
+}
+
+
+// Gets random resources of a generated file and adds up their sizes:
+static void	RCLBenchmarkGet1Resource( const char* inFilePath, int64_t inIterations )
+{
+	const int				kNumResources = 256;
+	struct RCLResFileSpec	spec = {};
+	spec.numTypes = 1;
+	spec.resourcesPerType = kNumResources;
+	spec.minDataSize = spec.maxDataSize = 16;
+	spec.sizeDistribution = RCLSizeUniform;
+	spec.seed = 1;
+	if( !RCLWriteResFile( inFilePath, &spec ) )
+	{
+		fprintf( stderr, "Couldn't write %s\n", inFilePath );
+		return;
+	}
+	Fake::Result<Fake::ResFile>	file = Fake::ResFile::open( inFilePath );
+	if( !file )
+	{
+		fprintf( stderr, "Couldn't open %s (%d)\n", inFilePath, file.error() );
+		return;
+	}
+
+	uint32_t	type = RCLGeneratedResType( 0 );
+	char		params[64];
+	snprintf( params, sizeof(params), "\"resources\":%d", kNumResources );
+	long		totalSizeC = 0;
+	double		startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < inIterations; i++ )
+	{
+		Handle	theResource = FakeGet1Resource( type, static_cast<int16_t>( 128 +(i * 7) % kNumResources ) );
+		if( theResource && FakeResError() == noErr )
+			totalSizeC += FakeGetHandleSize( theResource );
+	}
+	RCLReportResult( "get1resource_c", params, inIterations, RCLCurrentTime() -startTime );
+
+	long		totalSizeCpp = 0;
+	startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < inIterations; i++ )
+	{
+		if( Fake::Result<Fake::ResHandle> theResource = Fake::Get1Resource( type, static_cast<int16_t>( 128 +(i * 7) % kNumResources ) ) )
+			totalSizeCpp += static_cast<long>( theResource->size() );
+	}
+	RCLReportResult( "get1resource_cpp", params, inIterations, RCLCurrentTime() -startTime );
+
+	if( totalSizeC != totalSizeCpp )
+		fprintf( stderr, "C and C++ calls disagree.\n" );
+	file->close();
+	remove( inFilePath );
+}
+
+
+int	main( int argc, const char** argv )
+{
+	int64_t		numIterations = (argc > 1) ? atoll( argv[1] ) : 20000;
+	const char*	filePath = (argc > 2) ? argv[2] : "/tmp/ResourceViewBench.rsrc";
+	if( numIterations < 1 )
+	{
+		fprintf( stderr, "Usage: %s [<iterations> [<file>]]\n", argv[0] );
+		return 1;
+	}
+
+	RCLBenchmarkStringList( numIterations );
+	RCLBenchmarkDialogItemList( numIterations );
+	RCLBenchmarkSwap<int16_t>( "swap16_loop", "swap16_bulk", 22050, numIterations / 10 +1 );	// A second of 'snd ' samples.
+	RCLBenchmarkSwap<uint32_t>( "swap32_loop", "swap32_bulk", 16384, numIterations / 10 +1 );
+	RCLBenchmarkGet1Resource( filePath, numIterations * 50 );
+
+	return 0;
+}
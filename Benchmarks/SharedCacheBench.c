@@ -0,0 +1,184 @@
+//
+//  SharedCacheBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Starts a pool of worker processes that each open the same resource file
+//  and look at all of its resources, once with every process reading its own
+//  copy, and once with FakeSetResSharedCache(true), where the first process
+//  publishes the data and the others share it. Reports how long opening the
+//  file took each worker, and how much RAM each worker needed for it: its
+//  resident set size (RSS), and its proportional set size (PSS), which only
+//  counts a share of the memory several processes use. Memory is measured
+//  once all workers have the file open. PSS needs Linux's /proc, elsewhere
+//  both are reported as 0.
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+#define MAX_WORKERS		256
+
+
+// What a worker sends back:
+struct RCLWorkerResult
+{
+	double		openSeconds;
+	long		rssKB;		// Growth since before it opened the file.
+	long		pssKB;
+};
+
+
+// Waits until the parent closes its end of the pipe:
+static void	RCLWaitForParent( int inFD )
+{
+	char	dummy;
+	while( read( inFD, &dummy, 1 ) > 0 )
+		;
+}
+
+
+static void	RCLRunWorker( const char* inFilePath, bool inShare, int inResultFD, int inMeasureFD, int inQuitFD )
+{
+	struct RCLWorkerResult	result = { 0 };
+	long					rssBefore = 0, pssBefore = 0;
+	bool					haveMemory = RCLGetMemoryUsage( &rssBefore, &pssBefore );
+
+	FakeSetResSharedCache( inShare );
+	double		startTime = RCLCurrentTime();
+	int16_t		refNum = RCLOpenResFileAtPath( inFilePath );
+	result.openSeconds = RCLCurrentTime() -startTime;
+	if( refNum < 0 )
+		_exit( 1 );
+
+	// Look at all the data, like a worker serving requests for all of it would:
+	uint32_t	checksum = 0;
+	for( int16_t t = 1; t <= FakeCount1Types(); t++ )
+	{
+		uint32_t	type = 0;
+		FakeGet1IndType( &type, t );
+		for( int16_t r = 1; r <= FakeCount1Resources( type ); r++ )
+		{
+			Handle	theResource = FakeGet1IndResource( type, r );
+			long	size = theResource ? FakeGetHandleSize( theResource ) : 0;
+			for( long x = 0; x < size; x += 64 )
+				checksum += (uint8_t)(*theResource)[x];
+		}
+	}
+
+	RCLWaitForParent( inMeasureFD );
+	long		rssAfter = 0, pssAfter = 0;
+	if( haveMemory && RCLGetMemoryUsage( &rssAfter, &pssAfter ) )
+	{
+		result.rssKB = rssAfter -rssBefore;
+		result.pssKB = pssAfter -pssBefore;
+	}
+	if( write( inResultFD, &result, sizeof(result) ) != sizeof(result) || checksum == 1 )	// Use the checksum, so it isn't optimized away.
+		_exit( 1 );
+
+	RCLWaitForParent( inQuitFD );
+	FakeCloseResFile( refNum );
+	_exit( 0 );
+}
+
+
+// Starts inNumWorkers processes that each open the file, and reports their averages:
+static bool	RCLRunWorkers( const char* inName, const char* inFilePath, bool inShare, int inNumWorkers )
+{
+	int		resultPipe[2], measurePipe[2], quitPipe[2];
+	if( pipe( resultPipe ) != 0 || pipe( measurePipe ) != 0 || pipe( quitPipe ) != 0 )
+		return false;
+
+	pid_t	workers[MAX_WORKERS];
+	for( int x = 0; x < inNumWorkers; x++ )
+	{
+		fflush( stdout );
+		workers[x] = fork();
+		if( workers[x] == 0 )
+		{
+			close( resultPipe[0] );
+			close( measurePipe[1] );
+			close( quitPipe[1] );
+			RCLRunWorker( inFilePath, inShare, resultPipe[1], measurePipe[0], quitPipe[0] );
+		}
+	}
+	close( resultPipe[1] );
+	close( measurePipe[0] );
+	close( quitPipe[0] );
+
+	// Let them measure once they've all opened the file, then collect the results:
+	close( measurePipe[1] );
+	double		totalOpenSeconds = 0;
+	long		totalRssKB = 0, totalPssKB = 0;
+	int			numResults = 0;
+	struct RCLWorkerResult	result;
+	while( numResults < inNumWorkers && read( resultPipe[0], &result, sizeof(result) ) == sizeof(result) )
+	{
+		totalOpenSeconds += result.openSeconds;
+		totalRssKB += result.rssKB;
+		totalPssKB += result.pssKB;
+		numResults++;
+	}
+	close( quitPipe[1] );
+	close( resultPipe[0] );
+	for( int x = 0; x < inNumWorkers; x++ )
+		waitpid( workers[x], NULL, 0 );
+	if( numResults != inNumWorkers )
+	{
+		fprintf( stderr, "Only %d of %d workers reported back.\n", numResults, inNumWorkers );
+		return false;
+	}
+
+	char	params[128];
+	snprintf( params, sizeof(params), "\"workers\":%d,\"rss_mb_per_worker\":%.1f,\"pss_mb_per_worker\":%.1f", inNumWorkers,
+				totalRssKB / 1024.0 / inNumWorkers, totalPssKB / 1024.0 / inNumWorkers );
+	RCLReportResult( inName, params, inNumWorkers, totalOpenSeconds );
+	return true;
+}
+
+
+int	main( int argc, const char** argv )
+{
+	int				numWorkers = (argc > 1) ? atoi( argv[1] ) : 8;
+	int				numResources = (argc > 2) ? atoi( argv[2] ) : 2000;
+	const char*		filePath = (argc > 3) ? argv[3] : "/tmp/SharedCacheBench.rsrc";
+	if( numWorkers < 1 || numWorkers > MAX_WORKERS || numResources < 1 || numResources > 2000 )
+	{
+		fprintf( stderr, "Usage: %s [<workers, 1 to %d> [<resources, 1 to 2000> [<file>]]]\n", argv[0], MAX_WORKERS );
+		return 1;
+	}
+
+	struct RCLResFileSpec	spec = { .numTypes = 4, .resourcesPerType = numResources / 4 +1, .minDataSize = 512, .maxDataSize = 8000,
+										.sizeDistribution = RCLSizeUniform, .seed = 1 };
+	if( !RCLWriteResFile( filePath, &spec ) )
+	{
+		fprintf( stderr, "Couldn't write %s\n", filePath );
+		return 1;
+	}
+	unsigned char	pascalPath[256] = {0};
+	pascalPath[0] = (unsigned char)strlen( filePath );
+	memmove( pascalPath +1, filePath, pascalPath[0] );
+	FakeRemoveResSharedCache( pascalPath );
+
+	// Every worker reads its own copy:
+	bool	ok = RCLRunWorkers( "open_private", filePath, false, numWorkers );
+
+	// The first worker publishes, the rest share:
+	ok = ok && RCLRunWorkers( "open_publish", filePath, true, 1 );
+	ok = ok && RCLRunWorkers( "open_shared", filePath, true, numWorkers );
+
+	FakeRemoveResSharedCache( pascalPath );
+	remove( filePath );
+
+	return ok ? 0 : 1;
+}
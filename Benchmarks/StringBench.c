@@ -0,0 +1,183 @@
+//
+//  StringBench.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Measures comparing Pascal strings of different lengths without case with
+//  FakeEqualString() against folding one character at a time through a table,
+//  sorting resource names with FakeRelString(), and finding resources with
+//  FakeGet1NamedResource() in a generated file where every resource has a name.
+//
+//  Prints one line of JSON per measurement (see RCLReportResult()).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+#include "BenchSupport.h"
+
+
+static uint8_t	sUpperTable[256];
+
+
+// What the comparison would cost without SIMD:
+static bool	RCLEqualStringByChar( const unsigned char* inStr1, const unsigned char* inStr2 )
+{
+	if( inStr1[0] != inStr2[0] )
+		return false;
+	for( size_t x = 1; x <= inStr1[0]; x++ )
+	{
+		if( sUpperTable[inStr1[x]] != sUpperTable[inStr2[x]] )
+			return false;
+	}
+	return true;
+}
+
+
+// Compares inNumStrings pairs of equal strings of inLength characters that
+//	only differ in case:
+static void	RCLBenchmarkEqualString( uint8_t inLength, int64_t inIterations )
+{
+	const size_t	kNumStrings = 1024;
+	FakeStr255*		strings = calloc( kNumStrings, sizeof(FakeStr255) );
+	FakeStr255*		upperStrings = calloc( kNumStrings, sizeof(FakeStr255) );
+	uint32_t		randomState = 1;
+	for( size_t x = 0; x < kNumStrings; x++ )
+	{
+		strings[x][0] = inLength;
+		for( size_t y = 1; y <= inLength; y++ )
+			strings[x][y] = (uint8_t)('a' +RCLNextRandom( &randomState ) % 26);
+		memcpy( upperStrings[x], strings[x], sizeof(FakeStr255) );
+		FakeUpperString( upperStrings[x], true );
+	}
+
+	char		params[64];
+	snprintf( params, sizeof(params), "\"length\":%u", inLength );
+	int64_t		numEqualByChar = 0;
+	double		startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < inIterations; i++ )
+		numEqualByChar += RCLEqualStringByChar( strings[i % kNumStrings], upperStrings[i % kNumStrings] );
+	RCLReportResult( "equalstring_bychar", params, inIterations, RCLCurrentTime() -startTime );
+
+	int64_t		numEqual = 0;
+	startTime = RCLCurrentTime();
+	for( int64_t i = 0; i < inIterations; i++ )
+		numEqual += FakeEqualString( strings[i % kNumStrings], upperStrings[i % kNumStrings], false, true );
+	RCLReportResult( "equalstring", params, inIterations, RCLCurrentTime() -startTime );
+
+	if( numEqual != inIterations || numEqualByChar != inIterations )
+		fprintf( stderr, "Strings of length %u compare differently.\n", inLength );
+	free( upperStrings );
+	free( strings );
+}
+
+
+static int	RCLCompareNames( const void* inA, const void* inB )
+{
+	return FakeRelString( *(const unsigned char* const*)inA, *(const unsigned char* const*)inB, false, false );
+}
+
+
+static void	RCLBenchmarkRelString( size_t inNumNames )
+{
+	FakeStr255*			names = calloc( inNumNames, sizeof(FakeStr255) );
+	unsigned char**		sortedNames = malloc( inNumNames * sizeof(unsigned char*) );
+	for( size_t x = 0; x < inNumNames; x++ )
+	{
+		snprintf( (char*)names[x], sizeof(FakeStr255), "%s Resource %zu", (x & 1) ? "Named" : "named", inNumNames -x );
+		FakeC2PStr( (char*)names[x] );
+		sortedNames[x] = names[x];
+	}
+
+	char		params[64];
+	snprintf( params, sizeof(params), "\"names\":%zu", inNumNames );
+	double		startTime = RCLCurrentTime();
+	qsort( sortedNames, inNumNames, sizeof(unsigned char*), RCLCompareNames );
+	RCLReportResult( "relstring_sort", params, (int64_t)inNumNames, RCLCurrentTime() -startTime );
+
+	for( size_t x = 1; x < inNumNames; x++ )
+	{
+		if( FakeRelString( sortedNames[x -1], sortedNames[x], false, false ) > 0 )
+		{
+			fprintf( stderr, "Names not sorted.\n" );
+			break;
+		}
+	}
+	free( sortedNames );
+	free( names );
+}
+
+
+static void	RCLBenchmarkNamedResources( const char* inFilePath, int inResourcesPerType, int64_t inIterations )
+{
+	struct RCLResFileSpec	spec = { .numTypes = 1, .resourcesPerType = inResourcesPerType, .minDataSize = 4, .maxDataSize = 4,
+										.sizeDistribution = RCLSizeUniform, .namedFraction = 1.0, .seed = 1 };
+	if( !RCLWriteResFile( inFilePath, &spec ) )
+	{
+		fprintf( stderr, "Couldn't write %s\n", inFilePath );
+		return;
+	}
+	int16_t		refNum = RCLOpenResFileAtPath( inFilePath );
+	if( refNum < 0 )
+	{
+		fprintf( stderr, "Couldn't open %s (%d)\n", inFilePath, refNum );
+		return;
+	}
+
+	// The generator names resources "Resource 0", "Resource 1"... Look them up in uppercase:
+	FakeStr255*		names = calloc( inIterations, sizeof(FakeStr255) );
+	uint32_t		randomState = 1;
+	for( int64_t x = 0; x < inIterations; x++ )
+	{
+		snprintf( (char*)names[x], sizeof(FakeStr255), "RESOURCE %u", RCLNextRandom( &randomState ) % inResourcesPerType );
+		FakeC2PStr( (char*)names[x] );
+	}
+
+	char		params[64];
+	snprintf( params, sizeof(params), "\"resources\":%d", inResourcesPerType );
+	int64_t		numMissing = 0;
+	double		startTime = RCLCurrentTime();
+	for( int64_t x = 0; x < inIterations; x++ )
+		numMissing += (FakeGet1NamedResource( RCLGeneratedResType( 0 ), names[x] ) == NULL);
+	RCLReportResult( "get1namedresource", params, inIterations, RCLCurrentTime() -startTime );
+
+	if( numMissing != 0 )
+		fprintf( stderr, "Couldn't find %lld resources by name in %s.\n", (long long)numMissing, inFilePath );
+	free( names );
+	FakeCloseResFile( refNum );
+	remove( inFilePath );
+}
+
+
+int	main( int argc, const char** argv )
+{
+	int64_t			numIterations = (argc > 1) ? atoll( argv[1] ) : 1000000;
+	const char*		filePath = (argc > 2) ? argv[2] : "/tmp/StringBench.rsrc";
+	if( numIterations < 1 )
+	{
+		fprintf( stderr, "Usage: %s [<comparisons per measurement> [<file>]]\n", argv[0] );
+		return 1;
+	}
+
+	for( int x = 0; x < 256; x++ )
+	{
+		FakeStr255	oneChar = { 1, (unsigned char)x };
+		FakeUpperString( oneChar, true );
+		sUpperTable[x] = oneChar[1];
+	}
+
+	const uint8_t	lengths[] = { 8, 16, 32, 64, 255 };
+	for( size_t x = 0; x < sizeof(lengths) / sizeof(lengths[0]); x++ )
+		RCLBenchmarkEqualString( lengths[x], numIterations );
+
+	RCLBenchmarkRelString( 100000 );
+
+	const int		numResources[] = { 16, 256, 2000 };
+	for( size_t x = 0; x < sizeof(numResources) / sizeof(numResources[0]); x++ )
+		RCLBenchmarkNamedResources( filePath, numResources[x], numIterations / 10 +1 );
+
+	return 0;
+}
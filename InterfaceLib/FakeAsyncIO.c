@@ -0,0 +1,565 @@
+//
+//  FakeAsyncIO.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "FakeAsyncIO.h"
+#include "FakeTrace.h"
+
+// We talk to io_uring with raw system calls, so we don't need liburing:
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define FAKE_HAVE_IO_URING	1
+#endif
+#endif
+#endif
+#ifndef FAKE_HAVE_IO_URING
+#define FAKE_HAVE_IO_URING	0
+#endif
+
+
+// Number of reads we hand the kernel at once. More wait in our queue:
+#define FAKE_ASYNC_IO_RING_ENTRIES	128
+
+// Number of threads doing reads when we can't use io_uring:
+#define FAKE_ASYNC_IO_THREADS		8
+
+
+struct FakeAsyncRead
+{
+	int			fd;
+	void*		buffer;
+	uint32_t	length;
+	uint64_t	offset;
+	uint64_t	userData;
+};
+
+
+#if FAKE_HAVE_IO_URING
+struct FakeIOURing
+{
+	int						ringFD;
+	void*					sqRing;
+	size_t					sqRingSize;
+	void*					cqRing;			// Same as sqRing if the kernel maps both at once.
+	size_t					cqRingSize;
+	struct io_uring_sqe*	sqes;
+	size_t					sqesSize;
+	unsigned*				sqHead;
+	unsigned*				sqTail;
+	unsigned*				sqMask;
+	unsigned*				sqArray;
+	unsigned				sqEntries;
+	unsigned*				cqHead;
+	unsigned*				cqTail;
+	unsigned*				cqMask;
+	struct io_uring_cqe*	cqes;
+	unsigned				cqEntries;
+};
+#endif
+
+
+struct FakeAsyncIO
+{
+	bool							usesIOUring;
+	struct FakeAsyncRead*			queued;			// Reads not submitted yet.
+	size_t							numQueued;
+	size_t							maxQueued;
+	size_t							numInFlight;	// Submitted, but not reaped yet.
+	int								pollFD;
+	int								wakeFD;			// Write end of the pipe, or the eventfd again.
+#if FAKE_HAVE_IO_URING
+	struct FakeIOURing				ring;
+#endif
+
+	// Only used with threads:
+	pthread_t						threads[FAKE_ASYNC_IO_THREADS];
+	int								numThreads;
+	pthread_mutex_t					lock;
+	pthread_cond_t					workAvailable;
+	pthread_cond_t					readDone;
+	bool							stop;
+	struct FakeAsyncRead*			work;			// Submitted reads no thread has taken yet, from workHead on.
+	size_t							workHead;
+	size_t							numWork;
+	size_t							maxWork;
+	struct FakeAsyncCompletion*		done;			// Reads the threads finished.
+	size_t							numDone;
+	size_t							maxDone;
+};
+
+
+#if FAKE_HAVE_IO_URING
+
+static int	FakeIOURingEnter( int inRingFD, unsigned inToSubmit, unsigned inMinComplete, unsigned inFlags )
+{
+	int		result = 0;
+	do
+		result = (int)syscall( __NR_io_uring_enter, inRingFD, inToSubmit, inMinComplete, inFlags, NULL, 0 );
+	while( result < 0 && errno == EINTR );
+	return result;
+}
+
+
+static void	FakeIOURingDispose( struct FakeIOURing* inRing )
+{
+	if( inRing->sqes && inRing->sqes != MAP_FAILED )
+		munmap( inRing->sqes, inRing->sqesSize );
+	if( inRing->cqRing && inRing->cqRing != MAP_FAILED && inRing->cqRing != inRing->sqRing )
+		munmap( inRing->cqRing, inRing->cqRingSize );
+	if( inRing->sqRing && inRing->sqRing != MAP_FAILED )
+		munmap( inRing->sqRing, inRing->sqRingSize );
+	if( inRing->ringFD >= 0 )
+		close( inRing->ringFD );
+	memset( inRing, 0, sizeof(struct FakeIOURing) );
+	inRing->ringFD = -1;
+}
+
+
+// Sets up a ring and an eventfd it signals. Returns false if the kernel is too
+//	old for IORING_OP_READ or doesn't let us use io_uring (e.g. in a sandbox):
+static bool	FakeIOURingInit( struct FakeAsyncIO* inIO, unsigned inEntries )
+{
+	struct FakeIOURing*		theRing = &inIO->ring;
+	struct io_uring_params	params;
+	memset( &params, 0, sizeof(params) );
+	memset( theRing, 0, sizeof(struct FakeIOURing) );
+	theRing->ringFD = (int)syscall( __NR_io_uring_setup, inEntries, &params );
+	if( theRing->ringFD < 0 )
+	{
+		FAKE_TRACE( kFakeTraceLevelInfo, "io_uring not available (%d), using threads.", errno );
+		return false;
+	}
+	if( (params.features & IORING_FEAT_RW_CUR_POS) == 0 )	// Came with IORING_OP_READ in Linux 5.6.
+	{
+		FakeIOURingDispose( theRing );
+		return false;
+	}
+
+	theRing->sqRingSize = params.sq_off.array +params.sq_entries * sizeof(unsigned);
+	theRing->cqRingSize = params.cq_off.cqes +params.cq_entries * sizeof(struct io_uring_cqe);
+	if( params.features & IORING_FEAT_SINGLE_MMAP )
+	{
+		if( theRing->cqRingSize > theRing->sqRingSize )
+			theRing->sqRingSize = theRing->cqRingSize;
+		theRing->cqRingSize = theRing->sqRingSize;
+	}
+	theRing->sqRing = mmap( NULL, theRing->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, theRing->ringFD, IORING_OFF_SQ_RING );
+	if( theRing->sqRing == MAP_FAILED )
+	{
+		FakeIOURingDispose( theRing );
+		return false;
+	}
+	if( params.features & IORING_FEAT_SINGLE_MMAP )
+		theRing->cqRing = theRing->sqRing;
+	else
+		theRing->cqRing = mmap( NULL, theRing->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, theRing->ringFD, IORING_OFF_CQ_RING );
+	theRing->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+	theRing->sqes = mmap( NULL, theRing->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, theRing->ringFD, IORING_OFF_SQES );
+	if( theRing->cqRing == MAP_FAILED || theRing->sqes == MAP_FAILED )
+	{
+		FakeIOURingDispose( theRing );
+		return false;
+	}
+
+	char*	sqRing = theRing->sqRing;
+	char*	cqRing = theRing->cqRing;
+	theRing->sqHead = (unsigned*)(sqRing +params.sq_off.head);
+	theRing->sqTail = (unsigned*)(sqRing +params.sq_off.tail);
+	theRing->sqMask = (unsigned*)(sqRing +params.sq_off.ring_mask);
+	theRing->sqArray = (unsigned*)(sqRing +params.sq_off.array);
+	theRing->sqEntries = params.sq_entries;
+	theRing->cqHead = (unsigned*)(cqRing +params.cq_off.head);
+	theRing->cqTail = (unsigned*)(cqRing +params.cq_off.tail);
+	theRing->cqMask = (unsigned*)(cqRing +params.cq_off.ring_mask);
+	theRing->cqes = (struct io_uring_cqe*)(cqRing +params.cq_off.cqes);
+	theRing->cqEntries = params.cq_entries;
+
+	inIO->pollFD = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+	if( inIO->pollFD < 0 || syscall( __NR_io_uring_register, theRing->ringFD, IORING_REGISTER_EVENTFD, &inIO->pollFD, 1 ) < 0 )
+	{
+		if( inIO->pollFD >= 0 )
+			close( inIO->pollFD );
+		inIO->pollFD = -1;
+		FakeIOURingDispose( theRing );
+		return false;
+	}
+	inIO->wakeFD = inIO->pollFD;
+
+	return true;
+}
+
+
+static void	FakeIOURingSubmit( struct FakeAsyncIO* inIO )
+{
+	struct FakeIOURing*	theRing = &inIO->ring;
+	unsigned			tail = *theRing->sqTail;	// Only we write this.
+	unsigned			head = __atomic_load_n( theRing->sqHead, __ATOMIC_ACQUIRE );
+	size_t				numTaken = 0;
+	while( numTaken < inIO->numQueued && (tail -head) < theRing->sqEntries && inIO->numInFlight < theRing->cqEntries )
+	{
+		struct FakeAsyncRead*	currRead = inIO->queued +numTaken;
+		unsigned				index = tail & *theRing->sqMask;
+		struct io_uring_sqe*	theSQE = theRing->sqes +index;
+		memset( theSQE, 0, sizeof(struct io_uring_sqe) );
+		theSQE->opcode = IORING_OP_READ;
+		theSQE->fd = currRead->fd;
+		theSQE->addr = (uintptr_t)currRead->buffer;
+		theSQE->len = currRead->length;
+		theSQE->off = currRead->offset;
+		theSQE->user_data = currRead->userData;
+		theRing->sqArray[index] = index;
+		tail++;
+		numTaken++;
+		inIO->numInFlight++;
+	}
+	__atomic_store_n( theRing->sqTail, tail, __ATOMIC_RELEASE );
+	inIO->numQueued -= numTaken;
+	memmove( inIO->queued, inIO->queued +numTaken, inIO->numQueued * sizeof(struct FakeAsyncRead) );
+
+	// Also hands over anything a failed io_uring_enter() left behind:
+	unsigned	toSubmit = tail -__atomic_load_n( theRing->sqHead, __ATOMIC_ACQUIRE );
+	if( toSubmit > 0 && FakeIOURingEnter( theRing->ringFD, toSubmit, 0, 0 ) < 0 )
+		FAKE_TRACE( kFakeTraceLevelError, "io_uring_enter() failed (%d).", errno );
+}
+
+
+static size_t	FakeIOURingReap( struct FakeAsyncIO* inIO, struct FakeAsyncCompletion* outCompletions, size_t inMaxCount, bool inWait )
+{
+	struct FakeIOURing*	theRing = &inIO->ring;
+	size_t				numReaped = 0;
+	uint64_t			eventCount = 0;
+	if( read( inIO->pollFD, &eventCount, sizeof(eventCount) ) < 0 )	// Reset before looking, so we don't miss any.
+		eventCount = 0;
+
+	while( true )
+	{
+		unsigned	head = *theRing->cqHead;	// Only we write this.
+		unsigned	tail = __atomic_load_n( theRing->cqTail, __ATOMIC_ACQUIRE );
+		while( head != tail && numReaped < inMaxCount )
+		{
+			struct io_uring_cqe*	theCQE = theRing->cqes +(head & *theRing->cqMask);
+			outCompletions[numReaped].userData = theCQE->user_data;
+			outCompletions[numReaped].result = theCQE->res;
+			numReaped++;
+			head++;
+		}
+		__atomic_store_n( theRing->cqHead, head, __ATOMIC_RELEASE );
+		if( head != tail )
+			FakeAsyncIOWakeUp( inIO );	// Left some for next time.
+
+		if( numReaped > 0 || !inWait || inIO->numInFlight == 0 )
+			break;
+		unsigned	toSubmit = *theRing->sqTail -__atomic_load_n( theRing->sqHead, __ATOMIC_ACQUIRE );
+		if( FakeIOURingEnter( theRing->ringFD, toSubmit, 1, IORING_ENTER_GETEVENTS ) < 0 )
+		{
+			FAKE_TRACE( kFakeTraceLevelError, "io_uring_enter() failed waiting (%d).", errno );
+			break;
+		}
+	}
+
+	inIO->numInFlight -= numReaped;
+	return numReaped;
+}
+
+#endif // FAKE_HAVE_IO_URING
+
+
+static void*	FakeAsyncIOThread( void* inIO )
+{
+	struct FakeAsyncIO*		theIO = inIO;
+
+	pthread_mutex_lock( &theIO->lock );
+	while( true )
+	{
+		while( theIO->workHead == theIO->numWork && !theIO->stop )
+			pthread_cond_wait( &theIO->workAvailable, &theIO->lock );
+		if( theIO->workHead == theIO->numWork )
+			break;
+		struct FakeAsyncRead	currRead = theIO->work[theIO->workHead++];
+		if( theIO->workHead == theIO->numWork )
+			theIO->workHead = theIO->numWork = 0;
+		pthread_mutex_unlock( &theIO->lock );
+
+		int64_t		result = 0;
+		while( result < currRead.length )
+		{
+			ssize_t	amountRead = pread( currRead.fd, (char*)currRead.buffer +result, currRead.length -result, currRead.offset +result );
+			if( amountRead < 0 && errno == EINTR )
+				continue;
+			if( amountRead < 0 )
+				result = -errno;
+			if( amountRead <= 0 )
+				break;
+			result += amountRead;
+		}
+
+		pthread_mutex_lock( &theIO->lock );
+		theIO->done[theIO->numDone].userData = currRead.userData;	// FakeAsyncIOSubmit() made room.
+		theIO->done[theIO->numDone].result = result;
+		if( theIO->numDone++ == 0 )
+			FakeAsyncIOWakeUp( theIO );
+		pthread_cond_signal( &theIO->readDone );
+	}
+	pthread_mutex_unlock( &theIO->lock );
+
+	return NULL;
+}
+
+
+static void	FakeAsyncIOStopThreads( struct FakeAsyncIO* inIO )
+{
+	pthread_mutex_lock( &inIO->lock );
+	inIO->stop = true;
+	pthread_cond_broadcast( &inIO->workAvailable );
+	pthread_mutex_unlock( &inIO->lock );
+	for( int x = 0; x < inIO->numThreads; x++ )
+		pthread_join( inIO->threads[x], NULL );
+
+	pthread_cond_destroy( &inIO->readDone );
+	pthread_cond_destroy( &inIO->workAvailable );
+	pthread_mutex_destroy( &inIO->lock );
+	close( inIO->pollFD );
+	close( inIO->wakeFD );
+}
+
+
+static bool	FakeAsyncIOStartThreads( struct FakeAsyncIO* inIO )
+{
+	int		pipeFDs[2] = { -1, -1 };
+	if( pipe( pipeFDs ) != 0 )
+		return false;
+	for( int x = 0; x < 2; x++ )
+	{
+		fcntl( pipeFDs[x], F_SETFL, fcntl( pipeFDs[x], F_GETFL ) | O_NONBLOCK );
+		fcntl( pipeFDs[x], F_SETFD, FD_CLOEXEC );
+	}
+	inIO->pollFD = pipeFDs[0];
+	inIO->wakeFD = pipeFDs[1];
+
+	pthread_mutex_init( &inIO->lock, NULL );
+	pthread_cond_init( &inIO->workAvailable, NULL );
+	pthread_cond_init( &inIO->readDone, NULL );
+	for( int x = 0; x < FAKE_ASYNC_IO_THREADS; x++ )
+	{
+		if( pthread_create( &inIO->threads[inIO->numThreads], NULL, FakeAsyncIOThread, inIO ) == 0 )
+			inIO->numThreads++;
+	}
+	if( inIO->numThreads == 0 )
+	{
+		FakeAsyncIOStopThreads( inIO );
+		return false;
+	}
+
+	return true;
+}
+
+
+static void	FakeAsyncIOThreadsSubmit( struct FakeAsyncIO* inIO )
+{
+	pthread_mutex_lock( &inIO->lock );
+
+	// Make sure threads never need to grow anything:
+	size_t		neededWork = inIO->numWork +inIO->numQueued;
+	size_t		neededDone = inIO->numInFlight +inIO->numQueued;
+	if( neededWork > inIO->maxWork )
+	{
+		size_t					newMax = (neededWork > inIO->maxWork * 2) ? neededWork : (inIO->maxWork * 2);
+		struct FakeAsyncRead*	newWork = realloc( inIO->work, newMax * sizeof(struct FakeAsyncRead) );
+		if( !newWork )
+		{
+			pthread_mutex_unlock( &inIO->lock );
+			return;	// Try again next time.
+		}
+		inIO->work = newWork;
+		inIO->maxWork = newMax;
+	}
+	if( neededDone > inIO->maxDone )
+	{
+		size_t						newMax = (neededDone > inIO->maxDone * 2) ? neededDone : (inIO->maxDone * 2);
+		struct FakeAsyncCompletion*	newDone = realloc( inIO->done, newMax * sizeof(struct FakeAsyncCompletion) );
+		if( !newDone )
+		{
+			pthread_mutex_unlock( &inIO->lock );
+			return;
+		}
+		inIO->done = newDone;
+		inIO->maxDone = newMax;
+	}
+
+	memcpy( inIO->work +inIO->numWork, inIO->queued, inIO->numQueued * sizeof(struct FakeAsyncRead) );
+	inIO->numWork += inIO->numQueued;
+	inIO->numInFlight += inIO->numQueued;
+	inIO->numQueued = 0;
+	pthread_cond_broadcast( &inIO->workAvailable );
+	pthread_mutex_unlock( &inIO->lock );
+}
+
+
+static size_t	FakeAsyncIOThreadsReap( struct FakeAsyncIO* inIO, struct FakeAsyncCompletion* outCompletions, size_t inMaxCount, bool inWait )
+{
+	pthread_mutex_lock( &inIO->lock );
+	while( inWait && inIO->numDone == 0 && inIO->numInFlight > 0 )
+		pthread_cond_wait( &inIO->readDone, &inIO->lock );
+
+	size_t	numReaped = (inIO->numDone < inMaxCount) ? inIO->numDone : inMaxCount;
+	memcpy( outCompletions, inIO->done, numReaped * sizeof(struct FakeAsyncCompletion) );
+	inIO->numDone -= numReaped;
+	memmove( inIO->done, inIO->done +numReaped, inIO->numDone * sizeof(struct FakeAsyncCompletion) );
+	if( inIO->numDone == 0 )	// Under the lock, so a thread finishing now writes again after we've emptied it.
+	{
+		char	buffer[64];
+		while( read( inIO->pollFD, buffer, sizeof(buffer) ) > 0 )
+			;
+	}
+	pthread_mutex_unlock( &inIO->lock );
+
+	inIO->numInFlight -= numReaped;
+	return numReaped;
+}
+
+
+struct FakeAsyncIO*	FakeAsyncIOCreate( bool inUseIOUring )
+{
+	struct FakeAsyncIO*	theIO = calloc( 1, sizeof(struct FakeAsyncIO) );
+	if( !theIO )
+		return NULL;
+	theIO->pollFD = theIO->wakeFD = -1;
+
+#if FAKE_HAVE_IO_URING
+	theIO->ring.ringFD = -1;
+	if( inUseIOUring && FakeIOURingInit( theIO, FAKE_ASYNC_IO_RING_ENTRIES ) )
+	{
+		theIO->usesIOUring = true;
+		return theIO;
+	}
+#endif
+
+	if( !FakeAsyncIOStartThreads( theIO ) )
+	{
+		free( theIO );
+		return NULL;
+	}
+
+	return theIO;
+}
+
+
+void	FakeAsyncIODispose( struct FakeAsyncIO* inIO )
+{
+	if( !inIO )
+		return;
+
+	// Nobody may write into the callers' buffers once we've returned:
+	struct FakeAsyncCompletion	completions[32];
+	inIO->numQueued = 0;
+	while( inIO->numInFlight > 0 )
+		FakeAsyncIOReap( inIO, completions, sizeof(completions) / sizeof(completions[0]), true );
+
+#if FAKE_HAVE_IO_URING
+	if( inIO->usesIOUring )
+	{
+		close( inIO->pollFD );
+		FakeIOURingDispose( &inIO->ring );
+	}
+	else
+#endif
+		FakeAsyncIOStopThreads( inIO );
+
+	free( inIO->done );
+	free( inIO->work );
+	free( inIO->queued );
+	free( inIO );
+}
+
+
+bool	FakeAsyncIOUsesIOUring( struct FakeAsyncIO* inIO )
+{
+	return inIO->usesIOUring;
+}
+
+
+bool	FakeAsyncIOQueueRead( struct FakeAsyncIO* inIO, int inFD, void* inBuffer, uint32_t inLength, uint64_t inOffset, uint64_t inUserData )
+{
+	if( inIO->numQueued >= inIO->maxQueued )
+	{
+		size_t					newMax = inIO->maxQueued ? (inIO->maxQueued * 2) : 16;
+		struct FakeAsyncRead*	newQueued = realloc( inIO->queued, newMax * sizeof(struct FakeAsyncRead) );
+		if( !newQueued )
+			return false;
+		inIO->queued = newQueued;
+		inIO->maxQueued = newMax;
+	}
+	struct FakeAsyncRead*	theRead = inIO->queued +inIO->numQueued++;
+	theRead->fd = inFD;
+	theRead->buffer = inBuffer;
+	theRead->length = inLength;
+	theRead->offset = inOffset;
+	theRead->userData = inUserData;
+
+	return true;
+}
+
+
+void	FakeAsyncIOSubmit( struct FakeAsyncIO* inIO )
+{
+	if( inIO->numQueued == 0 )
+		return;
+#if FAKE_HAVE_IO_URING
+	if( inIO->usesIOUring )
+	{
+		FakeIOURingSubmit( inIO );
+		return;
+	}
+#endif
+	FakeAsyncIOThreadsSubmit( inIO );
+}
+
+
+size_t	FakeAsyncIOReap( struct FakeAsyncIO* inIO, struct FakeAsyncCompletion* outCompletions, size_t inMaxCount, bool inWait )
+{
+	size_t	numReaped = 0;
+#if FAKE_HAVE_IO_URING
+	if( inIO->usesIOUring )
+	{
+		numReaped = FakeIOURingReap( inIO, outCompletions, inMaxCount, inWait );
+		FakeAsyncIOSubmit( inIO );	// There may be room for more now.
+		return numReaped;
+	}
+#endif
+	numReaped = FakeAsyncIOThreadsReap( inIO, outCompletions, inMaxCount, inWait );
+	return numReaped;
+}
+
+
+size_t	FakeAsyncIOCountPending( struct FakeAsyncIO* inIO )
+{
+	return inIO->numQueued +inIO->numInFlight;
+}
+
+
+int	FakeAsyncIOPollFD( struct FakeAsyncIO* inIO )
+{
+	return inIO->pollFD;
+}
+
+
+void	FakeAsyncIOWakeUp( struct FakeAsyncIO* inIO )
+{
+	uint64_t	one = 1;	// An eventfd wants 8 bytes, a pipe takes anything.
+	if( write( inIO->wakeFD, &one, sizeof(one) ) < 0 )
+		FAKE_TRACE( kFakeTraceLevelInfo, "Poll descriptor already full (%d).", errno );
+}
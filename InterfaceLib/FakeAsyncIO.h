@@ -0,0 +1,79 @@
+//
+//  FakeAsyncIO.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Reads parts of files without making the caller wait. On Linux the reads
+//  go through io_uring, elsewhere (or if the kernel doesn't let us) a few
+//  threads do them with pread(). Either way, you queue reads, submit them,
+//  and later reap what finished. A file descriptor becomes readable when
+//  there's something to reap, so you can poll() for it in an event loop.
+//
+//  Not thread-safe. Only call these from one thread at a time.
+//
+
+#ifndef ReClassicfication_FakeAsyncIO_h
+#define ReClassicfication_FakeAsyncIO_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+struct FakeAsyncIO;
+
+
+// A read that finished:
+struct FakeAsyncCompletion
+{
+	uint64_t	userData;	// What you passed to FakeAsyncIOQueueRead().
+	int64_t		result;		// Number of bytes read (fewer at the end of the file), or -errno.
+};
+
+
+// Private calls for internal use:
+
+// Makes a new queue. Uses io_uring if inUseIOUring and the kernel supports
+//	it, threads otherwise. Returns NULL if neither could be set up.
+struct FakeAsyncIO*	FakeAsyncIOCreate( bool inUseIOUring );
+
+// Waits for all reads still in flight, then frees the queue:
+void	FakeAsyncIODispose( struct FakeAsyncIO* inIO );
+
+// Whether this queue ended up using io_uring:
+bool	FakeAsyncIOUsesIOUring( struct FakeAsyncIO* inIO );
+
+// Notes down a read of inLength bytes at inOffset of inFD into inBuffer. It
+//	only starts once you call FakeAsyncIOSubmit(). inBuffer must stay valid
+//	until the read has been reaped. Returns false if we ran out of memory.
+bool	FakeAsyncIOQueueRead( struct FakeAsyncIO* inIO, int inFD, void* inBuffer, uint32_t inLength, uint64_t inOffset, uint64_t inUserData );
+
+// Starts all queued reads, or as many as fit, the rest start as others finish:
+void	FakeAsyncIOSubmit( struct FakeAsyncIO* inIO );
+
+// Gives you up to inMaxCount reads that finished. If inWait, and none have
+//	finished yet but some are in flight, waits for at least one.
+size_t	FakeAsyncIOReap( struct FakeAsyncIO* inIO, struct FakeAsyncCompletion* outCompletions, size_t inMaxCount, bool inWait );
+
+// Number of reads queued or in flight that haven't been reaped yet:
+size_t	FakeAsyncIOCountPending( struct FakeAsyncIO* inIO );
+
+// A file descriptor that becomes readable when there's something to reap.
+//	FakeAsyncIOReap() makes it unreadable again. Don't read from or close it.
+int		FakeAsyncIOPollFD( struct FakeAsyncIO* inIO );
+
+// Makes the poll file descriptor readable, e.g. because you have something
+//	to report that didn't need a read:
+void	FakeAsyncIOWakeUp( struct FakeAsyncIO* inIO );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
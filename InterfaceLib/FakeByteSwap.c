@@ -0,0 +1,144 @@
+//
+//  FakeByteSwap.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <string.h>
+#include "FakeResources.h"
+#include "EndianStuff.h"
+
+#if !RECLASSIFICATION_BUILD_BIG_ENDIAN && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define FAKE_BYTE_SWAP_X86		1
+#include <immintrin.h>
+#else
+#define FAKE_BYTE_SWAP_X86		0
+#endif
+
+
+#if FAKE_BYTE_SWAP_X86
+
+static int		gFakeByteSwapHasAVX2 = -1;		// Not determined yet.
+
+
+static bool	FakeByteSwapHasAVX2( void )
+{
+	int		hasAVX2 = __atomic_load_n( &gFakeByteSwapHasAVX2, __ATOMIC_RELAXED );
+	if( hasAVX2 < 0 )
+	{
+		__builtin_cpu_init();
+		hasAVX2 = __builtin_cpu_supports( "avx2" ) ? 1 : 0;
+		__atomic_store_n( &gFakeByteSwapHasAVX2, hasAVX2, __ATOMIC_RELAXED );
+	}
+	return hasAVX2 != 0;
+}
+
+
+// Swaps the two bytes of each 16 bit value:
+static inline __m128i	FakeSwapBytes16SSE2( __m128i inValues )
+{
+	return _mm_or_si128( _mm_slli_epi16( inValues, 8 ), _mm_srli_epi16( inValues, 8 ) );
+}
+
+
+// Returns how many values it swapped, always a multiple of 8:
+static size_t	FakeSwapBigEndian16SSE2( uint8_t* ioBytes, size_t inCount )
+{
+	size_t	x = 0;
+	for( ; (x +8) <= inCount; x += 8 )
+	{
+		__m128i		values = _mm_loadu_si128( (const __m128i*)(ioBytes +x * 2) );
+		_mm_storeu_si128( (__m128i*)(ioBytes +x * 2), FakeSwapBytes16SSE2( values ) );
+	}
+	return x;
+}
+
+
+// Returns how many values it swapped, always a multiple of 4:
+static size_t	FakeSwapBigEndian32SSE2( uint8_t* ioBytes, size_t inCount )
+{
+	size_t	x = 0;
+	for( ; (x +4) <= inCount; x += 4 )
+	{
+		__m128i		values = _mm_loadu_si128( (const __m128i*)(ioBytes +x * 4) );
+		values = _mm_shufflehi_epi16( _mm_shufflelo_epi16( values, 0xB1 ), 0xB1 );	// Swap the 16 bit halves ...
+		_mm_storeu_si128( (__m128i*)(ioBytes +x * 4), FakeSwapBytes16SSE2( values ) );	// ... then the bytes in each.
+	}
+	return x;
+}
+
+
+__attribute__((target("avx2")))
+static size_t	FakeSwapBigEndianAVX2( uint8_t* ioBytes, size_t inNumBytes, __m256i inShuffle )
+{
+	size_t	x = 0;
+	for( ; (x +32) <= inNumBytes; x += 32 )
+	{
+		__m256i		values = _mm256_loadu_si256( (const __m256i*)(ioBytes +x) );
+		_mm256_storeu_si256( (__m256i*)(ioBytes +x), _mm256_shuffle_epi8( values, inShuffle ) );
+	}
+	return x;
+}
+
+
+__attribute__((target("avx2")))
+static size_t	FakeSwapBigEndian16AVX2( uint8_t* ioBytes, size_t inCount )
+{
+	__m256i		shuffle = _mm256_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+											1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 );
+	return FakeSwapBigEndianAVX2( ioBytes, inCount * 2, shuffle ) / 2;
+}
+
+
+__attribute__((target("avx2")))
+static size_t	FakeSwapBigEndian32AVX2( uint8_t* ioBytes, size_t inCount )
+{
+	__m256i		shuffle = _mm256_setr_epi8( 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+											3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+	return FakeSwapBigEndianAVX2( ioBytes, inCount * 4, shuffle ) / 4;
+}
+
+#endif // FAKE_BYTE_SWAP_X86
+
+
+void	FakeSwapBigEndian16( void* ioValues, size_t inCount )
+{
+#if !RECLASSIFICATION_BUILD_BIG_ENDIAN
+	uint8_t*	bytes = ioValues;
+	size_t		x = 0;
+#if FAKE_BYTE_SWAP_X86
+	if( inCount >= 16 && FakeByteSwapHasAVX2() )
+		x = FakeSwapBigEndian16AVX2( bytes, inCount );
+	x += FakeSwapBigEndian16SSE2( bytes +x * 2, inCount -x );
+#endif
+	for( ; x < inCount; x++ )
+	{
+		uint16_t	value = 0;
+		memcpy( &value, bytes +x * 2, sizeof(value) );	// May not be aligned.
+		value = BIG_ENDIAN_16(value);
+		memcpy( bytes +x * 2, &value, sizeof(value) );
+	}
+#endif
+}
+
+
+void	FakeSwapBigEndian32( void* ioValues, size_t inCount )
+{
+#if !RECLASSIFICATION_BUILD_BIG_ENDIAN
+	uint8_t*	bytes = ioValues;
+	size_t		x = 0;
+#if FAKE_BYTE_SWAP_X86
+	if( inCount >= 8 && FakeByteSwapHasAVX2() )
+		x = FakeSwapBigEndian32AVX2( bytes, inCount );
+	x += FakeSwapBigEndian32SSE2( bytes +x * 4, inCount -x );
+#endif
+	for( ; x < inCount; x++ )
+	{
+		uint32_t	value = 0;
+		memcpy( &value, bytes +x * 4, sizeof(value) );
+		value = BIG_ENDIAN_32(value);
+		memcpy( bytes +x * 4, &value, sizeof(value) );
+	}
+#endif
+}
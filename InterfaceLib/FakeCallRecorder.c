@@ -0,0 +1,773 @@
+//
+//  FakeCallRecorder.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include "FakeCallRecorder.h"
+#include "FakeResources.h"
+#include "FakeTrace.h"
+#include <pthread.h>
+#include <string.h>
+
+
+/*
+	Call trace:
+	
+	'RCLT'													  4 bytes
+	version (1)												  2 bytes
+	calls, until the end of the file:
+		call (enum FakeRecordedCall)						  1 byte
+		thread (1 = first thread that made a call)			  varint
+		start, ns after the previous call's start			  signed varint
+		duration in ns										  varint
+		number of integers									  varint
+			integer (arguments and results, see the enum)	  signed varint
+		number of strings									  varint
+			length											  varint
+			characters										  length bytes
+	
+	Varints are little-endian groups of 7 bits, the high bit set on all but the
+	last one. Signed varints are zigzag-encoded first, so small negative numbers
+	stay small. Handles are recorded as their address, so they can be matched up
+	with later calls, Str255s and paths without their length byte.
+*/
+
+
+static pthread_mutex_t	gFakeCallRecorderLock = PTHREAD_MUTEX_INITIALIZER;
+static FILE*			gFakeCallTraceFile = NULL;
+static bool				gFakeCallRecording = false;		// Checked without the lock, so use atomics.
+static double			gFakeCallPrevStartTime = 0;
+static uint64_t			gFakeCallNumThreads = 0;
+static __thread uint64_t	gFakeCallThreadID = 0;			// 0 until the thread's first recorded call.
+
+
+#define FAKE_RECORD_HANDLE( h )		((int64_t)(intptr_t)(h))
+
+#define FAKE_RECORD_BEGIN()			double recordStart_ = __atomic_load_n( &gFakeCallRecording, __ATOMIC_RELAXED ) ? FakeTraceCurrentTime() : 0
+// Takes the call and the integers to record:
+#define FAKE_RECORD_END( theCall, ... )	FAKE_RECORD_END_WITH_STRINGS( theCall, NULL, 0, ##__VA_ARGS__ )
+#define FAKE_RECORD_END_WITH_STRINGS( theCall, theStrings, numStrings, ... )	do { if( recordStart_ != 0 ) { int64_t args_[] = { 0, ##__VA_ARGS__ }; \
+																				FakeRecordCall( (theCall), recordStart_, args_ +1, sizeof(args_) / sizeof(int64_t) -1, (theStrings), (numStrings) ); } } while( 0 )
+
+
+static size_t	FakePutVarint( uint64_t inNum, uint8_t* outBytes )
+{
+	size_t	length = 0;
+	while( inNum >= 0x80 )
+	{
+		outBytes[length++] = (uint8_t)(inNum | 0x80);
+		inNum >>= 7;
+	}
+	outBytes[length++] = (uint8_t)inNum;
+	return length;
+}
+
+
+static size_t	FakePutSignedVarint( int64_t inNum, uint8_t* outBytes )
+{
+	return FakePutVarint( ((uint64_t)inNum << 1) ^ (uint64_t)(inNum >> 63), outBytes );
+}
+
+
+// Appends one call to the trace. inStrings are Pascal strings, may contain NULLs:
+static void	FakeRecordCall( enum FakeRecordedCall inCall, double inStartTime, const int64_t* inArgs, size_t inNumArgs,
+							const unsigned char* const* inStrings, size_t inNumStrings )
+{
+	double		endTime = FakeTraceCurrentTime();
+	uint8_t		localBuffer[512];
+	size_t		maxLength = 1 + 4 * 10 + 10 * (inNumArgs +1) + (10 +255) * inNumStrings;
+	uint8_t*	buffer = (maxLength <= sizeof(localBuffer)) ? localBuffer : malloc( maxLength );
+	if( !buffer )
+		return;
+	
+	pthread_mutex_lock( &gFakeCallRecorderLock );
+	if( gFakeCallTraceFile )
+	{
+		if( gFakeCallThreadID == 0 )
+			gFakeCallThreadID = ++gFakeCallNumThreads;
+		
+		size_t	length = 0;
+		buffer[length++] = (uint8_t)inCall;
+		length += FakePutVarint( gFakeCallThreadID, buffer +length );
+		length += FakePutSignedVarint( (int64_t)((inStartTime -gFakeCallPrevStartTime) * 1e9), buffer +length );
+		length += FakePutVarint( (uint64_t)((endTime -inStartTime) * 1e9), buffer +length );
+		length += FakePutVarint( inNumArgs, buffer +length );
+		for( size_t x = 0; x < inNumArgs; x++ )
+			length += FakePutSignedVarint( inArgs[x], buffer +length );
+		length += FakePutVarint( inNumStrings, buffer +length );
+		for( size_t x = 0; x < inNumStrings; x++ )
+		{
+			uint8_t		stringLength = inStrings[x] ? inStrings[x][0] : 0;
+			length += FakePutVarint( stringLength, buffer +length );
+			if( stringLength > 0 )
+				memmove( buffer +length, inStrings[x] +1, stringLength );
+			length += stringLength;
+		}
+		
+		// Start times are relative, so even if this call started before the
+		//	previous one we recorded (on another thread), we get it right:
+		gFakeCallPrevStartTime = inStartTime;
+		fwrite( buffer, 1, length, gFakeCallTraceFile );
+	}
+	pthread_mutex_unlock( &gFakeCallRecorderLock );
+	
+	if( buffer != localBuffer )
+		free( buffer );
+}
+
+
+bool	FakeStartCallRecording( const char* inTracePath )
+{
+	FakeStopCallRecording();
+	
+	FILE*	theFile = fopen( inTracePath, "w" );
+	if( !theFile )
+		return false;
+	uint8_t		header[4 + 2] = { (uint8_t)(FAKE_CALL_TRACE_MAGIC >> 24), (uint8_t)(FAKE_CALL_TRACE_MAGIC >> 16), (uint8_t)(FAKE_CALL_TRACE_MAGIC >> 8),
+									(uint8_t)FAKE_CALL_TRACE_MAGIC, (uint8_t)(FAKE_CALL_TRACE_VERSION >> 8), (uint8_t)FAKE_CALL_TRACE_VERSION };
+	fwrite( header, 1, sizeof(header), theFile );
+	
+	pthread_mutex_lock( &gFakeCallRecorderLock );
+	gFakeCallTraceFile = theFile;
+	gFakeCallPrevStartTime = FakeTraceCurrentTime();
+	__atomic_store_n( &gFakeCallRecording, true, __ATOMIC_RELAXED );
+	pthread_mutex_unlock( &gFakeCallRecorderLock );
+	
+	return true;
+}
+
+
+void	FakeStopCallRecording( void )
+{
+	pthread_mutex_lock( &gFakeCallRecorderLock );
+	FILE*	theFile = gFakeCallTraceFile;
+	gFakeCallTraceFile = NULL;
+	__atomic_store_n( &gFakeCallRecording, false, __ATOMIC_RELAXED );
+	pthread_mutex_unlock( &gFakeCallRecorderLock );
+	
+	if( theFile && fclose( theFile ) != 0 )
+		FAKE_TRACE( kFakeTraceLevelWarning, "Couldn't finish writing the call trace." );
+}
+
+
+// The wrappers FAKE_RECORD_CALLS routes calls through. Their prototypes come
+//	from FakeHandles.h and FakeResources.h with FAKE_RECORD_CALLS defined:
+
+Handle	FakeRecordedNewHandle( long theSize )
+{
+	FAKE_RECORD_BEGIN();
+	Handle	theHandle = FakeNewHandle( theSize );
+	FAKE_RECORD_END( kFakeCallNewHandle, theSize, FAKE_RECORD_HANDLE(theHandle) );
+	return theHandle;
+}
+
+
+Handle	FakeRecordedNewEmptyHandle()
+{
+	FAKE_RECORD_BEGIN();
+	Handle	theHandle = FakeNewEmptyHandle();
+	FAKE_RECORD_END( kFakeCallNewEmptyHandle, FAKE_RECORD_HANDLE(theHandle) );
+	return theHandle;
+}
+
+
+void	FakeRecordedDisposeHandle( Handle theHand )
+{
+	FAKE_RECORD_BEGIN();
+	FakeDisposeHandle( theHand );
+	FAKE_RECORD_END( kFakeCallDisposeHandle, FAKE_RECORD_HANDLE(theHand) );
+}
+
+
+void	FakeRecordedEmptyHandle( Handle theHand )
+{
+	FAKE_RECORD_BEGIN();
+	FakeEmptyHandle( theHand );
+	FAKE_RECORD_END( kFakeCallEmptyHandle, FAKE_RECORD_HANDLE(theHand) );
+}
+
+
+long	FakeRecordedGetHandleSize( Handle theHand )
+{
+	FAKE_RECORD_BEGIN();
+	long	theSize = FakeGetHandleSize( theHand );
+	FAKE_RECORD_END( kFakeCallGetHandleSize, FAKE_RECORD_HANDLE(theHand), theSize );
+	return theSize;
+}
+
+
+void	FakeRecordedSetHandleSize( Handle theHand, long theSize )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetHandleSize( theHand, theSize );
+	FAKE_RECORD_END( kFakeCallSetHandleSize, FAKE_RECORD_HANDLE(theHand), theSize );
+}
+
+
+long	FakeRecordedSetHandleSizeReentrant( Handle theHand, long theSize )
+{
+	FAKE_RECORD_BEGIN();
+	long	err = FakeSetHandleSizeReentrant( theHand, theSize );
+	FAKE_RECORD_END( kFakeCallSetHandleSizeReentrant, FAKE_RECORD_HANDLE(theHand), theSize, err );
+	return err;
+}
+
+
+void	FakeRecordedMoreMasters( void )
+{
+	FAKE_RECORD_BEGIN();
+	FakeMoreMasters();
+	FAKE_RECORD_END( kFakeCallMoreMasters );
+}
+
+
+void	FakeRecordedAdoptHandleMemory( Handle theHand, char* thePtr, long theSize )
+{
+	FAKE_RECORD_BEGIN();
+	FakeAdoptHandleMemory( theHand, thePtr, theSize );
+	FAKE_RECORD_END( kFakeCallAdoptHandleMemory, FAKE_RECORD_HANDLE(theHand), theSize );
+}
+
+
+void	FakeRecordedHLock( Handle theHand )
+{
+	FAKE_RECORD_BEGIN();
+	FakeHLock( theHand );
+	FAKE_RECORD_END( kFakeCallHLock, FAKE_RECORD_HANDLE(theHand) );
+}
+
+
+void	FakeRecordedHUnlock( Handle theHand )
+{
+	FAKE_RECORD_BEGIN();
+	FakeHUnlock( theHand );
+	FAKE_RECORD_END( kFakeCallHUnlock, FAKE_RECORD_HANDLE(theHand) );
+}
+
+
+void	FakeRecordedHPurge( Handle theHand )
+{
+	FAKE_RECORD_BEGIN();
+	FakeHPurge( theHand );
+	FAKE_RECORD_END( kFakeCallHPurge, FAKE_RECORD_HANDLE(theHand) );
+}
+
+
+void	FakeRecordedHNoPurge( Handle theHand )
+{
+	FAKE_RECORD_BEGIN();
+	FakeHNoPurge( theHand );
+	FAKE_RECORD_END( kFakeCallHNoPurge, FAKE_RECORD_HANDLE(theHand) );
+}
+
+
+char	FakeRecordedHGetState( Handle theHand )
+{
+	FAKE_RECORD_BEGIN();
+	char	theState = FakeHGetState( theHand );
+	FAKE_RECORD_END( kFakeCallHGetState, FAKE_RECORD_HANDLE(theHand), theState );
+	return theState;
+}
+
+
+void	FakeRecordedHSetState( Handle theHand, char theState )
+{
+	FAKE_RECORD_BEGIN();
+	FakeHSetState( theHand, theState );
+	FAKE_RECORD_END( kFakeCallHSetState, FAKE_RECORD_HANDLE(theHand), theState );
+}
+
+
+int16_t	FakeRecordedOpenResFile( const unsigned char* inPath )
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		refNum = FakeOpenResFile( inPath );
+	FAKE_RECORD_END_WITH_STRINGS( kFakeCallOpenResFile, &inPath, 1, refNum );
+	return refNum;
+}
+
+
+int16_t	FakeRecordedOpenResFork( const unsigned char* inPath, uint32_t inForkOffset, uint32_t inForkLength )
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		refNum = FakeOpenResFork( inPath, inForkOffset, inForkLength );
+	FAKE_RECORD_END_WITH_STRINGS( kFakeCallOpenResFork, &inPath, 1, inForkOffset, inForkLength, refNum );
+	return refNum;
+}
+
+
+void	FakeRecordedOpenResFiles( const unsigned char** inPaths, int16_t inCount, int16_t* outRefNums, int16_t* outErrors )
+{
+	FAKE_RECORD_BEGIN();
+	int16_t*	refNums = (outRefNums || recordStart_ == 0 || inCount <= 0) ? outRefNums : calloc( inCount, sizeof(int16_t) );
+	FakeOpenResFiles( inPaths, inCount, refNums, outErrors );
+	
+	int64_t*	args = (recordStart_ != 0 && refNums && inCount > 0) ? malloc( (inCount +1) * sizeof(int64_t) ) : NULL;
+	if( args )
+	{
+		args[0] = inCount;
+		for( int16_t x = 0; x < inCount; x++ )
+			args[x +1] = refNums[x];
+		FakeRecordCall( kFakeCallOpenResFiles, recordStart_, args, inCount +1, inPaths, inCount );
+		free( args );
+	}
+	if( refNums != outRefNums )
+		free( refNums );
+}
+
+
+void	FakeRecordedCloseResFile( int16_t resRefNum )
+{
+	FAKE_RECORD_BEGIN();
+	FakeCloseResFile( resRefNum );
+	FAKE_RECORD_END( kFakeCallCloseResFile, resRefNum );
+}
+
+
+Handle	FakeRecordedGet1Resource( uint32_t resType, int16_t resID )
+{
+	FAKE_RECORD_BEGIN();
+	Handle	theResource = FakeGet1Resource( resType, resID );
+	FAKE_RECORD_END( kFakeCallGet1Resource, resType, resID, FAKE_RECORD_HANDLE(theResource) );
+	return theResource;
+}
+
+
+Handle	FakeRecordedGetResource( uint32_t resType, int16_t resID )
+{
+	FAKE_RECORD_BEGIN();
+	Handle	theResource = FakeGetResource( resType, resID );
+	FAKE_RECORD_END( kFakeCallGetResource, resType, resID, FAKE_RECORD_HANDLE(theResource) );
+	return theResource;
+}
+
+
+Handle	FakeRecordedGet1NamedResource( uint32_t resType, const unsigned char* name )
+{
+	FAKE_RECORD_BEGIN();
+	Handle	theResource = FakeGet1NamedResource( resType, name );
+	FAKE_RECORD_END_WITH_STRINGS( kFakeCallGet1NamedResource, &name, 1, resType, FAKE_RECORD_HANDLE(theResource) );
+	return theResource;
+}
+
+
+Handle	FakeRecordedGetNamedResource( uint32_t resType, const unsigned char* name )
+{
+	FAKE_RECORD_BEGIN();
+	Handle	theResource = FakeGetNamedResource( resType, name );
+	FAKE_RECORD_END_WITH_STRINGS( kFakeCallGetNamedResource, &name, 1, resType, FAKE_RECORD_HANDLE(theResource) );
+	return theResource;
+}
+
+
+void	FakeRecordedGetResources( struct FakeResourceBatchEntry* ioEntries, size_t inCount )
+{
+	FAKE_RECORD_BEGIN();
+	FakeGetResources( ioEntries, inCount );
+	
+	int64_t*	args = (recordStart_ != 0) ? malloc( (1 +3 * inCount) * sizeof(int64_t) ) : NULL;
+	if( args )
+	{
+		args[0] = (int64_t)inCount;
+		for( size_t x = 0; x < inCount; x++ )
+		{
+			args[1 +3 * x] = ioEntries[x].resType;
+			args[2 +3 * x] = ioEntries[x].resID;
+			args[3 +3 * x] = FAKE_RECORD_HANDLE(ioEntries[x].resHandle);
+		}
+		FakeRecordCall( kFakeCallGetResources, recordStart_, args, 1 +3 * inCount, NULL, 0 );
+		free( args );
+	}
+}
+
+
+int16_t	FakeRecordedCurResFile()
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		refNum = FakeCurResFile();
+	FAKE_RECORD_END( kFakeCallCurResFile, refNum );
+	return refNum;
+}
+
+
+void	FakeRecordedUseResFile( int16_t resRefNum )
+{
+	FAKE_RECORD_BEGIN();
+	FakeUseResFile( resRefNum );
+	FAKE_RECORD_END( kFakeCallUseResFile, resRefNum );
+}
+
+
+void	FakeRecordedUpdateResFile( int16_t inFileRefNum )
+{
+	FAKE_RECORD_BEGIN();
+	FakeUpdateResFile( inFileRefNum );
+	FAKE_RECORD_END( kFakeCallUpdateResFile, inFileRefNum );
+}
+
+
+int16_t	FakeRecordedHomeResFile( Handle theResource )
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		refNum = FakeHomeResFile( theResource );
+	FAKE_RECORD_END( kFakeCallHomeResFile, FAKE_RECORD_HANDLE(theResource), refNum );
+	return refNum;
+}
+
+
+int16_t	FakeRecordedCount1Types()
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		theCount = FakeCount1Types();
+	FAKE_RECORD_END( kFakeCallCount1Types, theCount );
+	return theCount;
+}
+
+
+int16_t	FakeRecordedCount1Resources( uint32_t resType )
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		theCount = FakeCount1Resources( resType );
+	FAKE_RECORD_END( kFakeCallCount1Resources, resType, theCount );
+	return theCount;
+}
+
+
+int16_t	FakeRecordedCountTypes()
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		theCount = FakeCountTypes();
+	FAKE_RECORD_END( kFakeCallCountTypes, theCount );
+	return theCount;
+}
+
+
+int16_t	FakeRecordedCountResources( uint32_t resType )
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		theCount = FakeCountResources( resType );
+	FAKE_RECORD_END( kFakeCallCountResources, resType, theCount );
+	return theCount;
+}
+
+
+void	FakeRecordedGet1IndType( uint32_t* resType, int16_t index )
+{
+	FAKE_RECORD_BEGIN();
+	FakeGet1IndType( resType, index );
+	FAKE_RECORD_END( kFakeCallGet1IndType, index, *resType );
+}
+
+
+Handle	FakeRecordedGet1IndResource( uint32_t resType, int16_t index )
+{
+	FAKE_RECORD_BEGIN();
+	Handle	theResource = FakeGet1IndResource( resType, index );
+	FAKE_RECORD_END( kFakeCallGet1IndResource, resType, index, FAKE_RECORD_HANDLE(theResource) );
+	return theResource;
+}
+
+
+int16_t	FakeRecordedUniqueID( uint32_t resType )
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		theID = FakeUniqueID( resType );
+	FAKE_RECORD_END( kFakeCallUniqueID, resType, theID );
+	return theID;
+}
+
+
+int16_t	FakeRecordedUnique1ID( uint32_t resType )
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		theID = FakeUnique1ID( resType );
+	FAKE_RECORD_END( kFakeCallUnique1ID, resType, theID );
+	return theID;
+}
+
+
+size_t	FakeRecordedGet1ResourceIDsInRange( uint32_t resType, int16_t inFirstID, int16_t inLastID, int16_t* outIDs, size_t inMaxCount )
+{
+	FAKE_RECORD_BEGIN();
+	size_t		theCount = FakeGet1ResourceIDsInRange( resType, inFirstID, inLastID, outIDs, inMaxCount );
+	FAKE_RECORD_END( kFakeCallGet1ResourceIDsInRange, resType, inFirstID, inLastID, (int64_t)inMaxCount, (int64_t)theCount );
+	return theCount;
+}
+
+
+void	FakeRecordedGetResInfo( Handle theResource, int16_t* theID, uint32_t* theType, FakeStr255 name )
+{
+	FAKE_RECORD_BEGIN();
+	FakeGetResInfo( theResource, theID, theType, name );
+	const unsigned char*	theName = name;
+	FAKE_RECORD_END_WITH_STRINGS( kFakeCallGetResInfo, &theName, 1, FAKE_RECORD_HANDLE(theResource), theID ? *theID : 0, theType ? *theType : 0 );
+}
+
+
+void	FakeRecordedSetResInfo( Handle theResource, int16_t theID, FakeStr255 name )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResInfo( theResource, theID, name );
+	const unsigned char*	theName = name;
+	FAKE_RECORD_END_WITH_STRINGS( kFakeCallSetResInfo, &theName, 1, FAKE_RECORD_HANDLE(theResource), theID );
+}
+
+
+void	FakeRecordedAddResource( Handle theData, uint32_t theType, int16_t theID, FakeStr255 name )
+{
+	FAKE_RECORD_BEGIN();
+	FakeAddResource( theData, theType, theID, name );
+	const unsigned char*	theName = name;
+	FAKE_RECORD_END_WITH_STRINGS( kFakeCallAddResource, &theName, 1, FAKE_RECORD_HANDLE(theData), theType, theID );
+}
+
+
+void	FakeRecordedAddResources( struct FakeResourceAddEntry* ioEntries, size_t inCount )
+{
+	FAKE_RECORD_BEGIN();
+	FakeAddResources( ioEntries, inCount );
+	
+	int64_t*				args = (recordStart_ != 0) ? malloc( (1 +3 * inCount) * sizeof(int64_t) ) : NULL;
+	const unsigned char**	names = (recordStart_ != 0) ? malloc( (inCount +1) * sizeof(const unsigned char*) ) : NULL;
+	if( args && names )
+	{
+		args[0] = (int64_t)inCount;
+		for( size_t x = 0; x < inCount; x++ )
+		{
+			args[1 +3 * x] = FAKE_RECORD_HANDLE(ioEntries[x].resHandle);
+			args[2 +3 * x] = ioEntries[x].resType;
+			args[3 +3 * x] = ioEntries[x].resID;
+			names[x] = ioEntries[x].resName;
+		}
+		FakeRecordCall( kFakeCallAddResources, recordStart_, args, 1 +3 * inCount, names, inCount );
+	}
+	free( args );
+	free( names );
+}
+
+
+void	FakeRecordedChangedResource( Handle theResource )
+{
+	FAKE_RECORD_BEGIN();
+	FakeChangedResource( theResource );
+	FAKE_RECORD_END( kFakeCallChangedResource, FAKE_RECORD_HANDLE(theResource) );
+}
+
+
+void	FakeRecordedRemoveResource( Handle theResource )
+{
+	FAKE_RECORD_BEGIN();
+	FakeRemoveResource( theResource );
+	FAKE_RECORD_END( kFakeCallRemoveResource, FAKE_RECORD_HANDLE(theResource) );
+}
+
+
+void	FakeRecordedRemoveResources( const Handle* inResources, int16_t* outErrors, size_t inCount )
+{
+	FAKE_RECORD_BEGIN();
+	FakeRemoveResources( inResources, outErrors, inCount );
+	
+	int64_t*	args = (recordStart_ != 0) ? malloc( (1 +inCount) * sizeof(int64_t) ) : NULL;
+	if( args )
+	{
+		args[0] = (int64_t)inCount;
+		for( size_t x = 0; x < inCount; x++ )
+			args[1 +x] = FAKE_RECORD_HANDLE(inResources[x]);
+		FakeRecordCall( kFakeCallRemoveResources, recordStart_, args, 1 +inCount, NULL, 0 );
+		free( args );
+	}
+}
+
+
+void	FakeRecordedWriteResource( Handle theResource )
+{
+	FAKE_RECORD_BEGIN();
+	FakeWriteResource( theResource );
+	FAKE_RECORD_END( kFakeCallWriteResource, FAKE_RECORD_HANDLE(theResource) );
+}
+
+
+void	FakeRecordedLoadResource( Handle theResource )
+{
+	FAKE_RECORD_BEGIN();
+	FakeLoadResource( theResource );
+	FAKE_RECORD_END( kFakeCallLoadResource, FAKE_RECORD_HANDLE(theResource) );
+}
+
+
+void	FakeRecordedReleaseResource( Handle theResource )
+{
+	FAKE_RECORD_BEGIN();
+	FakeReleaseResource( theResource );
+	FAKE_RECORD_END( kFakeCallReleaseResource, FAKE_RECORD_HANDLE(theResource) );
+}
+
+
+void	FakeRecordedSetResLoad( bool load )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResLoad( load );
+	FAKE_RECORD_END( kFakeCallSetResLoad, load );
+}
+
+
+void	FakeRecordedSetResLoadThreads( int16_t numThreads )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResLoadThreads( numThreads );
+	FAKE_RECORD_END( kFakeCallSetResLoadThreads, numThreads );
+}
+
+
+void	FakeRecordedSetResProfileRecording( double inSeconds )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResProfileRecording( inSeconds );
+	FAKE_RECORD_END( kFakeCallSetResProfileRecording, (int64_t)(inSeconds * 1e6) );
+}
+
+
+void	FakeRecordedSetResPrefetch( bool inPrefetch )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResPrefetch( inPrefetch );
+	FAKE_RECORD_END( kFakeCallSetResPrefetch, inPrefetch );
+}
+
+
+void	FakeRecordedSetResourceCacheBudget( uint64_t inMaxBytes )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResourceCacheBudget( inMaxBytes );
+	FAKE_RECORD_END( kFakeCallSetResourceCacheBudget, (int64_t)inMaxBytes );
+}
+
+
+void	FakeRecordedGetResourceCacheStats( struct FakeResourceCacheStats* outStats )
+{
+	FAKE_RECORD_BEGIN();
+	FakeGetResourceCacheStats( outStats );
+	FAKE_RECORD_END( kFakeCallGetResourceCacheStats );
+}
+
+
+void	FakeRecordedResetResourceCacheStats( void )
+{
+	FAKE_RECORD_BEGIN();
+	FakeResetResourceCacheStats();
+	FAKE_RECORD_END( kFakeCallResetResourceCacheStats );
+}
+
+
+int16_t	FakeRecordedResError()
+{
+	FAKE_RECORD_BEGIN();
+	int16_t		err = FakeResError();
+	FAKE_RECORD_END( kFakeCallResError, err );
+	return err;
+}
+
+
+void	FakeRecordedBeginResTransaction( int16_t inFileRefNum )
+{
+	FAKE_RECORD_BEGIN();
+	FakeBeginResTransaction( inFileRefNum );
+	FAKE_RECORD_END( kFakeCallBeginResTransaction, inFileRefNum );
+}
+
+
+void	FakeRecordedCommitResTransaction( int16_t inFileRefNum )
+{
+	FAKE_RECORD_BEGIN();
+	FakeCommitResTransaction( inFileRefNum );
+	FAKE_RECORD_END( kFakeCallCommitResTransaction, inFileRefNum );
+}
+
+
+void	FakeRecordedAbortResTransaction( int16_t inFileRefNum )
+{
+	FAKE_RECORD_BEGIN();
+	FakeAbortResTransaction( inFileRefNum );
+	FAKE_RECORD_END( kFakeCallAbortResTransaction, inFileRefNum );
+}
+
+
+void	FakeRecordedSetResFileFormat( int16_t inFileRefNum, enum FakeResFileFormat inFormat )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResFileFormat( inFileRefNum, inFormat );
+	FAKE_RECORD_END( kFakeCallSetResFileFormat, inFileRefNum, inFormat );
+}
+
+
+enum FakeResFileFormat	FakeRecordedGetResFileFormat( int16_t inFileRefNum )
+{
+	FAKE_RECORD_BEGIN();
+	enum FakeResFileFormat	theFormat = FakeGetResFileFormat( inFileRefNum );
+	FAKE_RECORD_END( kFakeCallGetResFileFormat, inFileRefNum, theFormat );
+	return theFormat;
+}
+
+
+void	FakeRecordedCompactResFile( int16_t inFileRefNum, const struct FakeResCompactOptions* inOptions, struct FakeResCompactReport* outReport )
+{
+	FAKE_RECORD_BEGIN();
+	FakeCompactResFile( inFileRefNum, inOptions, outReport );
+	
+	size_t		numTypes = (inOptions && inOptions->typeOrder) ? inOptions->numTypesInOrder : 0;
+	int64_t*	args = (recordStart_ != 0) ? malloc( (5 +numTypes) * sizeof(int64_t) ) : NULL;
+	if( args )
+	{
+		args[0] = inFileRefNum;
+		args[1] = (inOptions != NULL);
+		args[2] = inOptions ? inOptions->useProfile : 0;
+		args[3] = inOptions ? inOptions->alignment : 0;
+		args[4] = (int64_t)numTypes;
+		for( size_t x = 0; x < numTypes; x++ )
+			args[5 +x] = inOptions->typeOrder[x];
+		FakeRecordCall( kFakeCallCompactResFile, recordStart_, args, 5 +numTypes, NULL, 0 );
+		free( args );
+	}
+}
+
+
+void	FakeRecordedSetResSharedCache( bool inShare )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResSharedCache( inShare );
+	FAKE_RECORD_END( kFakeCallSetResSharedCache, inShare );
+}
+
+
+void	FakeRecordedRemoveResSharedCache( const unsigned char* inPath )
+{
+	FAKE_RECORD_BEGIN();
+	FakeRemoveResSharedCache( inPath );
+	FAKE_RECORD_END_WITH_STRINGS( kFakeCallRemoveResSharedCache, &inPath, 1 );
+}
+
+
+void	FakeRecordedSetResDedup( bool inDedup )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResDedup( inDedup );
+	FAKE_RECORD_END( kFakeCallSetResDedup, inDedup );
+}
+
+
+void	FakeRecordedSetResourceCacheCompression( double inColdSeconds )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResourceCacheCompression( inColdSeconds );
+	FAKE_RECORD_END( kFakeCallSetResourceCacheCompression, (int64_t)(inColdSeconds * 1e6) );
+}
+
+
+void	FakeRecordedSetResFileLimit( size_t inMaxOpenFiles )
+{
+	FAKE_RECORD_BEGIN();
+	FakeSetResFileLimit( inMaxOpenFiles );
+	FAKE_RECORD_END( kFakeCallSetResFileLimit, (int64_t)inMaxOpenFiles );
+}
@@ -0,0 +1,197 @@
+//
+//  FakeCallRecorder.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Records the Resource Manager and Handle calls an application makes, with
+//  their arguments, results, timing and thread, into a compact binary trace
+//  that Benchmarks/ReplayBench can execute again against another version.
+//
+//  To opt in, define FAKE_RECORD_CALLS=1 when compiling your own sources (not
+//  InterfaceLib's). The calls in FakeResources.h and FakeHandles.h are then
+//  routed through wrappers that record them while FakeStartCallRecording() is
+//  in effect, and just pass them on otherwise. Without FAKE_RECORD_CALLS,
+//  nothing changes and nothing is recorded.
+//
+//  Only the sizes of Handles are recorded, not the data in them. Replaying
+//  calls that save files changes the files at the recorded paths, so replay
+//  against copies.
+//
+
+#ifndef ReClassicfication_FakeCallRecorder_h
+#define ReClassicfication_FakeCallRecorder_h
+
+#include <stdbool.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+// Starts writing every call made through the wrappers to a new trace file at
+//	inTracePath (replacing any previous recording). Returns false if the file
+//	couldn't be created.
+bool	FakeStartCallRecording( const char* inTracePath );
+
+// Finishes the trace file.
+void	FakeStopCallRecording( void );
+
+
+// Private, for reading traces:
+
+#define FAKE_CALL_TRACE_MAGIC		'RCLT'
+#define FAKE_CALL_TRACE_VERSION		1
+
+// The calls in a trace. Never renumber these, or old traces can't be replayed:
+enum FakeRecordedCall
+{
+	kFakeCallNewHandle = 1,			// size -> handle
+	kFakeCallNewEmptyHandle,		// -> handle
+	kFakeCallDisposeHandle,			// handle
+	kFakeCallEmptyHandle,			// handle
+	kFakeCallGetHandleSize,			// handle -> size
+	kFakeCallSetHandleSize,			// handle, size
+	kFakeCallSetHandleSizeReentrant,// handle, size -> error
+	kFakeCallMoreMasters,
+	kFakeCallAdoptHandleMemory,		// handle, size
+	kFakeCallHLock,					// handle
+	kFakeCallHUnlock,				// handle
+	kFakeCallHPurge,				// handle
+	kFakeCallHNoPurge,				// handle
+	kFakeCallHGetState,				// handle -> state
+	kFakeCallHSetState,				// handle, state
+	kFakeCallOpenResFile,			// -> refNum, path
+	kFakeCallOpenResFork,			// offset, length -> refNum, path
+	kFakeCallOpenResFiles,			// count -> refNum..., path...
+	kFakeCallCloseResFile,			// refNum
+	kFakeCallGet1Resource,			// type, ID -> handle
+	kFakeCallGetResource,			// type, ID -> handle
+	kFakeCallGetResources,			// count, (type, ID -> handle)...
+	kFakeCallCurResFile,			// -> refNum
+	kFakeCallUseResFile,			// refNum
+	kFakeCallUpdateResFile,			// refNum
+	kFakeCallHomeResFile,			// handle -> refNum
+	kFakeCallCount1Types,			// -> count
+	kFakeCallCount1Resources,		// type -> count
+	kFakeCallCountTypes,			// -> count
+	kFakeCallCountResources,		// type -> count
+	kFakeCallGet1IndType,			// index -> type
+	kFakeCallGet1IndResource,		// type, index -> handle
+	kFakeCallGetResInfo,			// handle -> ID, type, name
+	kFakeCallSetResInfo,			// handle, ID, name
+	kFakeCallAddResource,			// handle, type, ID, name
+	kFakeCallChangedResource,		// handle
+	kFakeCallRemoveResource,		// handle
+	kFakeCallWriteResource,			// handle
+	kFakeCallLoadResource,			// handle
+	kFakeCallReleaseResource,		// handle
+	kFakeCallSetResLoad,			// load
+	kFakeCallSetResLoadThreads,		// numThreads
+	kFakeCallSetResProfileRecording,// microseconds
+	kFakeCallSetResPrefetch,		// prefetch
+	kFakeCallSetResourceCacheBudget,// maxBytes
+	kFakeCallGetResourceCacheStats,
+	kFakeCallResetResourceCacheStats,
+	kFakeCallResError,				// -> error
+	kFakeCallBeginResTransaction,	// refNum
+	kFakeCallCommitResTransaction,	// refNum
+	kFakeCallAbortResTransaction,	// refNum
+	kFakeCallAddResources,			// count, (handle, type, ID)..., name...
+	kFakeCallRemoveResources,		// count, handle...
+	kFakeCallUniqueID,				// type -> ID
+	kFakeCallUnique1ID,				// type -> ID
+	kFakeCallGet1ResourceIDsInRange,// type, firstID, lastID, maxCount -> count
+	kFakeCallGet1NamedResource,		// type -> handle, name
+	kFakeCallGetNamedResource,		// type -> handle, name
+	kFakeCallSetResFileFormat,		// refNum, format
+	kFakeCallGetResFileFormat,		// refNum -> format
+	kFakeCallCompactResFile,		// refNum, hasOptions, useProfile, alignment, count, type...
+	kFakeCallSetResSharedCache,		// share
+	kFakeCallRemoveResSharedCache,	// path
+	kFakeCallSetResDedup,			// dedup
+	kFakeCallSetResourceCacheCompression,	// microseconds
+	kFakeCallSetResFileLimit,		// maxOpenFiles
+	kFakeCallNumCalls
+};
+
+
+#if FAKE_RECORD_CALLS
+
+// Route the calls through the recording wrappers. As this comes before the
+//	prototypes in FakeHandles.h and FakeResources.h, it also declares them:
+#define FakeNewHandle					FakeRecordedNewHandle
+#define FakeNewEmptyHandle				FakeRecordedNewEmptyHandle
+#define FakeDisposeHandle				FakeRecordedDisposeHandle
+#define FakeEmptyHandle					FakeRecordedEmptyHandle
+#define FakeGetHandleSize				FakeRecordedGetHandleSize
+#define FakeSetHandleSize				FakeRecordedSetHandleSize
+#define FakeSetHandleSizeReentrant		FakeRecordedSetHandleSizeReentrant
+#define FakeMoreMasters					FakeRecordedMoreMasters
+#define FakeAdoptHandleMemory			FakeRecordedAdoptHandleMemory
+#define FakeHLock						FakeRecordedHLock
+#define FakeHUnlock						FakeRecordedHUnlock
+#define FakeHPurge						FakeRecordedHPurge
+#define FakeHNoPurge					FakeRecordedHNoPurge
+#define FakeHGetState					FakeRecordedHGetState
+#define FakeHSetState					FakeRecordedHSetState
+#define FakeOpenResFile					FakeRecordedOpenResFile
+#define FakeOpenResFork					FakeRecordedOpenResFork
+#define FakeOpenResFiles				FakeRecordedOpenResFiles
+#define FakeCloseResFile				FakeRecordedCloseResFile
+#define FakeGet1Resource				FakeRecordedGet1Resource
+#define FakeGetResource					FakeRecordedGetResource
+#define FakeGetResources				FakeRecordedGetResources
+#define FakeCurResFile					FakeRecordedCurResFile
+#define FakeUseResFile					FakeRecordedUseResFile
+#define FakeUpdateResFile				FakeRecordedUpdateResFile
+#define FakeHomeResFile					FakeRecordedHomeResFile
+#define FakeCount1Types					FakeRecordedCount1Types
+#define FakeCount1Resources				FakeRecordedCount1Resources
+#define FakeCountTypes					FakeRecordedCountTypes
+#define FakeCountResources				FakeRecordedCountResources
+#define FakeGet1IndType					FakeRecordedGet1IndType
+#define FakeGet1IndResource				FakeRecordedGet1IndResource
+#define FakeGetResInfo					FakeRecordedGetResInfo
+#define FakeSetResInfo					FakeRecordedSetResInfo
+#define FakeAddResource					FakeRecordedAddResource
+#define FakeChangedResource				FakeRecordedChangedResource
+#define FakeRemoveResource				FakeRecordedRemoveResource
+#define FakeWriteResource				FakeRecordedWriteResource
+#define FakeLoadResource				FakeRecordedLoadResource
+#define FakeReleaseResource				FakeRecordedReleaseResource
+#define FakeSetResLoad					FakeRecordedSetResLoad
+#define FakeSetResLoadThreads			FakeRecordedSetResLoadThreads
+#define FakeSetResProfileRecording		FakeRecordedSetResProfileRecording
+#define FakeSetResPrefetch				FakeRecordedSetResPrefetch
+#define FakeSetResourceCacheBudget		FakeRecordedSetResourceCacheBudget
+#define FakeGetResourceCacheStats		FakeRecordedGetResourceCacheStats
+#define FakeResetResourceCacheStats		FakeRecordedResetResourceCacheStats
+#define FakeResError					FakeRecordedResError
+#define FakeBeginResTransaction			FakeRecordedBeginResTransaction
+#define FakeCommitResTransaction		FakeRecordedCommitResTransaction
+#define FakeAbortResTransaction			FakeRecordedAbortResTransaction
+#define FakeAddResources				FakeRecordedAddResources
+#define FakeRemoveResources				FakeRecordedRemoveResources
+#define FakeUniqueID					FakeRecordedUniqueID
+#define FakeUnique1ID					FakeRecordedUnique1ID
+#define FakeGet1ResourceIDsInRange		FakeRecordedGet1ResourceIDsInRange
+#define FakeGet1NamedResource			FakeRecordedGet1NamedResource
+#define FakeGetNamedResource			FakeRecordedGetNamedResource
+#define FakeSetResFileFormat			FakeRecordedSetResFileFormat
+#define FakeGetResFileFormat			FakeRecordedGetResFileFormat
+#define FakeCompactResFile				FakeRecordedCompactResFile
+#define FakeSetResSharedCache			FakeRecordedSetResSharedCache
+#define FakeRemoveResSharedCache		FakeRecordedRemoveResSharedCache
+#define FakeSetResDedup					FakeRecordedSetResDedup
+#define FakeSetResourceCacheCompression	FakeRecordedSetResourceCacheCompression
+#define FakeSetResFileLimit				FakeRecordedSetResFileLimit
+
+#endif // FAKE_RECORD_CALLS
+
+
+#if __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,185 @@
+//
+//  FakeContainers.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "FakeContainers.h"
+#include "EndianStuff.h"
+
+
+/*
+	MacBinary header:
+	
+	old version number (0)									  1 byte	@0
+	file name length (1...63)								  1 byte	@1
+	file name												 63 bytes	@2
+	file type, creator, Finder flags etc.					 ...
+	zero fill												  1 byte	@74
+	zero fill												  1 byte	@82
+	data fork length										  4 bytes	@83
+	resource fork length									  4 bytes	@87
+	'mBIN' (MacBinary III only)								  4 bytes	@102
+	length of secondary header								  2 bytes	@120
+	CRC of bytes 0...123 (MacBinary II and later)			  2 bytes	@124
+	
+	Then the secondary header, data fork and resource fork follow, each
+	padded to a multiple of 128 bytes.
+*/
+
+#define MACBINARY_HEADER_LENGTH			128
+
+/*
+	AppleSingle/AppleDouble header:
+	
+	magic number											  4 bytes	@0
+	version number (0x00010000 or 0x00020000)				  4 bytes	@4
+	filler													 16 bytes	@8
+	number of entries										  2 bytes	@24
+		entry ID (2 = resource fork)						  4 bytes
+		offset of entry in file								  4 bytes
+		length of entry										  4 bytes
+*/
+
+#define APPLESINGLE_MAGIC				0x00051600
+#define APPLEDOUBLE_MAGIC				0x00051607
+#define APPLESINGLE_HEADER_LENGTH		26
+#define APPLESINGLE_ENTRY_LENGTH		12
+#define APPLESINGLE_RESOURCE_FORK_ID	2
+
+
+static uint16_t	FakeContainerUInt16( const uint8_t* inBytes )
+{
+	uint16_t	theNum = 0;
+	memmove( &theNum, inBytes, sizeof(theNum) );
+	return BIG_ENDIAN_16(theNum);
+}
+
+
+static uint32_t	FakeContainerUInt32( const uint8_t* inBytes )
+{
+	uint32_t	theNum = 0;
+	memmove( &theNum, inBytes, sizeof(theNum) );
+	return BIG_ENDIAN_32(theNum);
+}
+
+
+// CRC-16/CCITT as used by MacBinary II (the XMODEM variant, starting at 0):
+static uint16_t	FakeMacBinaryCRC( const uint8_t* inBytes, size_t inLength )
+{
+	uint16_t	crc = 0;
+	for( size_t x = 0; x < inLength; x++ )
+	{
+		crc ^= (uint16_t)inBytes[x] << 8;
+		for( int y = 0; y < 8; y++ )
+			crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+	}
+	return crc;
+}
+
+
+static uint64_t	FakeRoundUpTo128( uint64_t inNumber )
+{
+	return (inNumber +127) & ~(uint64_t)127;
+}
+
+
+static bool	FakeLocateMacBinaryResourceFork( const uint8_t* inHeader, uint64_t inFileSize, uint32_t* outForkOffset, uint32_t* outForkLength )
+{
+	if( inHeader[0] != 0 || inHeader[1] < 1 || inHeader[1] > 63 || inHeader[74] != 0 || inHeader[82] != 0 )
+		return false;
+	
+	// MacBinary I has no signature at all, so unless the CRC or the 'mBIN'
+	//	tag say this is MacBinary II or III, insist on the zeroed-out fields:
+	bool	hasCRC = FakeMacBinaryCRC( inHeader, 124 ) == FakeContainerUInt16( inHeader +124 );
+	bool	isMacBinaryIII = memcmp( inHeader +102, "mBIN", 4 ) == 0;
+	if( !hasCRC && !isMacBinaryIII )
+	{
+		for( int x = 99; x < 128; x++ )
+		{
+			if( inHeader[x] != 0 )
+				return false;
+		}
+	}
+	
+	uint32_t	dataForkLength = FakeContainerUInt32( inHeader +83 );
+	uint32_t	resourceForkLength = FakeContainerUInt32( inHeader +87 );
+	uint16_t	secondaryHeaderLength = (hasCRC || isMacBinaryIII) ? FakeContainerUInt16( inHeader +120 ) : 0;
+	uint64_t	resourceForkOffset = MACBINARY_HEADER_LENGTH +FakeRoundUpTo128( secondaryHeaderLength ) +FakeRoundUpTo128( dataForkLength );
+	if( (resourceForkOffset +resourceForkLength) > inFileSize || resourceForkOffset > UINT32_MAX )
+		return false;
+	if( !hasCRC && !isMacBinaryIII && resourceForkLength == 0 )	// Most likely a bare resource fork with a large data offset.
+		return false;
+	
+	*outForkOffset = (uint32_t)resourceForkOffset;
+	*outForkLength = resourceForkLength;
+	return true;
+}
+
+
+static bool	FakeLocateAppleSingleResourceFork( int inFD, const uint8_t* inHeader, uint64_t inFileSize, uint32_t* outForkOffset, uint32_t* outForkLength )
+{
+	uint32_t	version = FakeContainerUInt32( inHeader +4 );
+	if( version != 0x00010000 && version != 0x00020000 )
+		return false;
+	
+	uint16_t	numEntries = FakeContainerUInt16( inHeader +24 );
+	size_t		entriesLength = (size_t)numEntries * APPLESINGLE_ENTRY_LENGTH;
+	if( (APPLESINGLE_HEADER_LENGTH +entriesLength) > inFileSize )
+		return false;
+	
+	uint8_t		entries[APPLESINGLE_ENTRY_LENGTH * 64];
+	*outForkOffset = 0;
+	*outForkLength = 0;
+	for( size_t x = 0; x < numEntries; x += 64 )	// Read entries in batches, there usually is only one.
+	{
+		size_t	numInBatch = (numEntries -x < 64) ? (numEntries -x) : 64;
+		size_t	batchLength = numInBatch * APPLESINGLE_ENTRY_LENGTH;
+		if( pread( inFD, entries, batchLength, APPLESINGLE_HEADER_LENGTH +x * APPLESINGLE_ENTRY_LENGTH ) != (ssize_t)batchLength )
+			return false;
+		for( size_t y = 0; y < numInBatch; y++ )
+		{
+			const uint8_t*	currEntry = entries +y * APPLESINGLE_ENTRY_LENGTH;
+			if( FakeContainerUInt32( currEntry ) != APPLESINGLE_RESOURCE_FORK_ID )
+				continue;
+			uint32_t	forkOffset = FakeContainerUInt32( currEntry +4 );
+			uint32_t	forkLength = FakeContainerUInt32( currEntry +8 );
+			if( ((uint64_t)forkOffset +forkLength) > inFileSize )
+				return false;
+			*outForkOffset = forkOffset;
+			*outForkLength = forkLength;
+			return true;
+		}
+	}
+	
+	return true;	// Valid, but no resource fork.
+}
+
+
+enum FakeContainerKind	FakeLocateResourceFork( int inFD, uint32_t* outForkOffset, uint32_t* outForkLength )
+{
+	uint8_t		header[MACBINARY_HEADER_LENGTH] = {0};
+	struct stat	fileInfo = {0};
+	if( fstat( inFD, &fileInfo ) != 0 )
+		return kFakeContainerNone;
+	ssize_t		headerLength = pread( inFD, header, sizeof(header), 0 );
+	
+	if( headerLength >= APPLESINGLE_HEADER_LENGTH )
+	{
+		uint32_t	magic = FakeContainerUInt32( header );
+		if( (magic == APPLESINGLE_MAGIC || magic == APPLEDOUBLE_MAGIC)
+			&& FakeLocateAppleSingleResourceFork( inFD, header, fileInfo.st_size, outForkOffset, outForkLength ) )
+			return (magic == APPLESINGLE_MAGIC) ? kFakeContainerAppleSingle : kFakeContainerAppleDouble;
+	}
+	
+	if( headerLength == MACBINARY_HEADER_LENGTH
+		&& FakeLocateMacBinaryResourceFork( header, fileInfo.st_size, outForkOffset, outForkLength ) )
+		return kFakeContainerMacBinary;
+	
+	return kFakeContainerNone;
+}
@@ -0,0 +1,42 @@
+//
+//  FakeContainers.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Finds the resource fork inside the file formats used to carry Mac files
+//  through other file systems, so we can read it in place.
+//
+
+#ifndef ReClassicfication_FakeContainers_h
+#define ReClassicfication_FakeContainers_h
+
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+enum FakeContainerKind
+{
+	kFakeContainerNone = 0,		// Not a container, the file itself is the resource fork.
+	kFakeContainerMacBinary,	// MacBinary I, II or III (.bin)
+	kFakeContainerAppleSingle,
+	kFakeContainerAppleDouble	// The "._foo" header file, not the data fork.
+};
+
+
+// Private calls for internal use:
+
+// Looks at the start of the given open file. If it is one of the containers
+//	above, returns its kind and the position and length of the resource fork
+//	in it. If the container has no resource fork, *outForkLength is 0.
+enum FakeContainerKind	FakeLocateResourceFork( int inFD, uint32_t* outForkOffset, uint32_t* outForkLength );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,630 @@
+//
+//  FakeDecompression.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <string.h>
+#include "FakeDecompression.h"
+#include "FakeTrace.h"
+
+
+/*
+	Extended resource header (in front of the compressed data):
+
+	signature (0xA89F6572)									  4 bytes	@0
+	header length (18)										  2 bytes	@4
+	header version (8 or 9)									  1 byte	@6
+	attributes (1 = compressed)								  1 byte	@7
+	decompressed length										  4 bytes	@8
+
+	version 8:
+	working buffer fractional size							  1 byte	@12
+	expansion buffer size									  1 byte	@13
+	'dcmp' resource ID										  2 bytes	@14
+	reserved												  2 bytes	@16
+
+	version 9:
+	'dcmp' resource ID										  2 bytes	@12
+	decompressor parameters									  4 bytes	@14
+
+	The compressed data follows the header.
+*/
+
+#define FAKE_EXTENDED_HEADER_SIGNATURE		0xA89F6572
+#define FAKE_EXTENDED_HEADER_MIN_LENGTH		18
+#define FAKE_MAX_DECOMPRESSORS				16
+
+/*
+	'dcmp' 2 parameters:
+
+	unknown													  2 bytes	@14
+	number of table entries (-1)							  1 byte	@16
+	flags (see below)										  1 byte	@17
+
+	With the custom table flag, the table (2 bytes per entry) comes before the
+	compressed data, otherwise sDcmp2DefaultTable is used. Untagged data is one
+	table index per output word. Tagged data is groups of a tag byte and 8
+	items, one per bit of the tag, high bit first: a table index if the bit is
+	set, a literal word if not. If the decompressed length is odd, the last
+	byte of the data is the last byte of the output.
+*/
+
+#define FAKE_DCMP2_CUSTOM_TABLE		(1 << 0)
+#define FAKE_DCMP2_TAGGED			(1 << 1)
+
+/*
+	'dcmp' 0 and 1 data (version 8 header) is a series of codes, each a tag
+	byte and its operands, and ends with an 0xFF tag. Literals can be
+	remembered, and later codes repeat them by their number in the order they
+	were remembered. Some tags stand for one word of a table in the 'dcmp'.
+
+	'dcmp' 0, lengths count words:
+	0x01-0x0F, 0x00 len			literal of the low nibble or len words
+	0x11-0x1F, 0x10 len			the same, remembered
+	0x20-0x21 n					remembered literal 0x28 +((tag & 1) << 8 | n)
+	0x22 n n					remembered literal 0x28 +n (2 byte n)
+	0x23-0x4A					remembered literal 0 to 0x27
+	0x4B-0xFD					word of sDcmp0Table
+	0xFE 0x00 s c a d...		rest of a segment loader jump table entry for
+								segment s, then c entries, the first at
+								offset a, each after that d -6 after the last
+	0xFE 0x02 v c				byte v, c +1 times
+	0xFE 0x03 v c				word v, c +1 times
+	0xFE 0x04 v c d...			word v, then c words, each d (a signed byte)
+								more than the last
+	0xFE 0x06 v c d...			long v, then c longs, each d more than the last
+
+	'dcmp' 1, lengths count bytes:
+	0x00-0x0F					literal of the low nibble +1 bytes
+	0x10-0x1F					the same, remembered
+	0x20-0xCF					remembered literal 0 to 0xAF
+	0xD0 len, 0xD1 len			literal of len bytes, remembered for 0xD1
+	0xD2 n						remembered literal 0xB0 +n
+	0xD5-0xFD					word of sDcmp1Table
+	0xFE 0x02 v c				byte v, c +1 times
+
+	Numbers (s, c, a, v and d unless noted) take 1 byte 0x00-0x7F for -0x40
+	to 0x3F, 2 bytes 0x8000-0xFEFF for -0x4000 to 0x3EFF, or 0xFF and 4 bytes.
+*/
+
+#define FAKE_DCMP_EXTENDED_TAG		0xFE
+#define FAKE_DCMP_END_TAG			0xFF
+
+
+// The words 'dcmp' 0 tags 0x4B to 0xFD stand for:
+static const uint8_t	sDcmp0Table[] =
+{
+	0x00,0x00, 0x4E,0xBA, 0x00,0x08, 0x4E,0x75, 0x00,0x0C, 0x4E,0xAD, 0x20,0x53, 0x2F,0x0B,
+	0x61,0x00, 0x00,0x10, 0x70,0x00, 0x2F,0x00, 0x48,0x6E, 0x20,0x50, 0x20,0x6E, 0x2F,0x2E,
+	0xFF,0xFC, 0x48,0xE7, 0x3F,0x3C, 0x00,0x04, 0xFF,0xF8, 0x2F,0x0C, 0x20,0x06, 0x4E,0xED,
+	0x4E,0x56, 0x20,0x68, 0x4E,0x5E, 0x00,0x01, 0x58,0x8F, 0x4F,0xEF, 0x00,0x02, 0x00,0x18,
+	0x60,0x00, 0xFF,0xFF, 0x50,0x8F, 0x4E,0x90, 0x00,0x06, 0x26,0x6E, 0x00,0x14, 0xFF,0xF4,
+	0x4C,0xEE, 0x00,0x0A, 0x00,0x0E, 0x41,0xEE, 0x4C,0xDF, 0x48,0xC0, 0xFF,0xF0, 0x2D,0x40,
+	0x00,0x12, 0x30,0x2E, 0x70,0x01, 0x2F,0x28, 0x20,0x54, 0x67,0x00, 0x00,0x20, 0x00,0x1C,
+	0x20,0x5F, 0x18,0x00, 0x26,0x6F, 0x48,0x78, 0x00,0x16, 0x41,0xFA, 0x30,0x3C, 0x28,0x40,
+	0x72,0x00, 0x28,0x6E, 0x20,0x0C, 0x66,0x00, 0x20,0x6B, 0x2F,0x07, 0x55,0x8F, 0x00,0x28,
+	0xFF,0xFE, 0xFF,0xEC, 0x22,0xD8, 0x20,0x0B, 0x00,0x0F, 0x59,0x8F, 0x2F,0x3C, 0xFF,0x00,
+	0x01,0x18, 0x81,0xE1, 0x4A,0x00, 0x4E,0xB0, 0xFF,0xE8, 0x48,0xC7, 0x00,0x03, 0x00,0x22,
+	0x00,0x07, 0x00,0x1A, 0x67,0x06, 0x67,0x08, 0x4E,0xF9, 0x00,0x24, 0x20,0x78, 0x08,0x00,
+	0x66,0x04, 0x00,0x2A, 0x4E,0xD0, 0x30,0x28, 0x26,0x5F, 0x67,0x04, 0x00,0x30, 0x43,0xEE,
+	0x3F,0x00, 0x20,0x1F, 0x00,0x1E, 0xFF,0xF6, 0x20,0x2E, 0x42,0xA7, 0x20,0x07, 0xFF,0xFA,
+	0x60,0x02, 0x3D,0x40, 0x0C,0x40, 0x66,0x06, 0x00,0x26, 0x2D,0x48, 0x2F,0x01, 0x70,0xFF,
+	0x60,0x04, 0x18,0x80, 0x4A,0x40, 0x00,0x40, 0x00,0x2C, 0x2F,0x08, 0x00,0x11, 0xFF,0xE4,
+	0x21,0x40, 0x26,0x40, 0xFF,0xF2, 0x42,0x6E, 0x4E,0xB9, 0x3D,0x7C, 0x00,0x38, 0x00,0x0D,
+	0x60,0x06, 0x42,0x2E, 0x20,0x3C, 0x67,0x0C, 0x2D,0x68, 0x66,0x08, 0x4A,0x2E, 0x4A,0xAE,
+	0x00,0x2E, 0x48,0x40, 0x22,0x5F, 0x22,0x00, 0x67,0x0A, 0x30,0x07, 0x42,0x67, 0x00,0x32,
+	0x20,0x28, 0x00,0x09, 0x48,0x7A, 0x02,0x00, 0x2F,0x2B, 0x00,0x05, 0x22,0x6E, 0x66,0x02,
+	0xE5,0x80, 0x67,0x0E, 0x66,0x0A, 0x00,0x50, 0x3E,0x00, 0x66,0x0C, 0x2E,0x00, 0xFF,0xEE,
+	0x20,0x6D, 0x20,0x40, 0xFF,0xE0, 0x53,0x40, 0x60,0x08, 0x04,0x80, 0x00,0x68, 0x0B,0x7C,
+	0x44,0x00, 0x41,0xE8, 0x48,0x41
+};
+
+
+// The words 'dcmp' 1 tags 0xD5 to 0xFD stand for:
+static const uint8_t	sDcmp1Table[] =
+{
+	0x00,0x00, 0x00,0x01, 0x00,0x02, 0x00,0x03, 0x2E,0x01, 0x3E,0x01, 0x01,0x01, 0x1E,0x01,
+	0xFF,0xFF, 0x0E,0x01, 0x31,0x00, 0x11,0x12, 0x01,0x07, 0x33,0x32, 0x12,0x39, 0xED,0x10,
+	0x01,0x27, 0x23,0x22, 0x01,0x37, 0x07,0x06, 0x01,0x17, 0x01,0x23, 0x00,0xFF, 0x00,0x2F,
+	0x07,0x0E, 0xFD,0x3C, 0x01,0x35, 0x01,0x15, 0x01,0x02, 0x00,0x07, 0x00,0x3E, 0x05,0xD5,
+	0x02,0x01, 0x06,0x07, 0x07,0x08, 0x30,0x01, 0x01,0x33, 0x00,0x10, 0x17,0x16, 0x37,0x3E,
+	0x36,0x37
+};
+
+
+// The words of 'dcmp' 2 resources without their own table:
+static const uint8_t	sDcmp2DefaultTable[] =
+{
+	0x00,0x00, 0x00,0x08, 0x4E,0xBA, 0x20,0x6E, 0x4E,0x75, 0x00,0x0C, 0x00,0x04, 0x70,0x00,
+	0x00,0x10, 0x00,0x02, 0x48,0x6E, 0xFF,0xFC, 0x60,0x00, 0x00,0x01, 0x48,0xE7, 0x2F,0x2E,
+	0x4E,0x56, 0x00,0x06, 0x4E,0x5E, 0x2F,0x00, 0x61,0x00, 0xFF,0xF8, 0x2F,0x0B, 0xFF,0xFF,
+	0x00,0x14, 0x00,0x0A, 0x00,0x18, 0x20,0x5F, 0x00,0x0E, 0x20,0x50, 0x3F,0x3C, 0xFF,0xF4,
+	0x4C,0xEE, 0x30,0x2E, 0x67,0x00, 0x4C,0xDF, 0x26,0x6E, 0x00,0x12, 0x00,0x1C, 0x42,0x67,
+	0xFF,0xF0, 0x30,0x3C, 0x2F,0x0C, 0x00,0x03, 0x4E,0xD0, 0x00,0x20, 0x70,0x01, 0x00,0x16,
+	0x2D,0x40, 0x48,0xC0, 0x20,0x78, 0x72,0x00, 0x58,0x8F, 0x66,0x00, 0x4F,0xEF, 0x42,0xA7,
+	0x67,0x06, 0xFF,0xFA, 0x55,0x8F, 0x28,0x6E, 0x3F,0x00, 0xFF,0xFE, 0x2F,0x3C, 0x67,0x04,
+	0x59,0x8F, 0x20,0x6B, 0x00,0x24, 0x20,0x1F, 0x41,0xFA, 0x81,0xE1, 0x66,0x04, 0x67,0x08,
+	0x00,0x1A, 0x4E,0xB9, 0x50,0x8F, 0x20,0x2E, 0x00,0x07, 0x4E,0xB0, 0xFF,0xF2, 0x3D,0x40,
+	0x00,0x1E, 0x20,0x68, 0x66,0x06, 0xFF,0xF6, 0x4E,0xF9, 0x08,0x00, 0x0C,0x40, 0x3D,0x7C,
+	0xFF,0xEC, 0x00,0x05, 0x20,0x3C, 0xFF,0xE8, 0xDE,0xFC, 0x4A,0x2E, 0x00,0x30, 0x00,0x28,
+	0x2F,0x08, 0x20,0x0B, 0x60,0x02, 0x42,0x6E, 0x2D,0x48, 0x20,0x53, 0x20,0x40, 0x18,0x00,
+	0x60,0x04, 0x41,0xEE, 0x2F,0x28, 0x2F,0x01, 0x67,0x0A, 0x48,0x40, 0x20,0x07, 0x66,0x08,
+	0x01,0x18, 0x2F,0x07, 0x30,0x28, 0x3F,0x2E, 0x30,0x2B, 0x22,0x6E, 0x2F,0x2B, 0x00,0x2C,
+	0x67,0x0C, 0x22,0x5F, 0x60,0x06, 0x00,0xFF, 0x30,0x07, 0xFF,0xEE, 0x53,0x40, 0x00,0x40,
+	0xFF,0xE4, 0x4A,0x40, 0x66,0x0A, 0x00,0x0F, 0x4E,0xAD, 0x70,0xFF, 0x22,0xD8, 0x48,0x6B,
+	0x00,0x22, 0x20,0x4B, 0x67,0x0E, 0x4A,0xAE, 0x4E,0x90, 0xFF,0xE0, 0xFF,0xC0, 0x00,0x2A,
+	0x27,0x40, 0x67,0x02, 0x51,0xC8, 0x02,0xB6, 0x48,0x7A, 0x22,0x78, 0xB0,0x6E, 0xFF,0xE6,
+	0x00,0x09, 0x32,0x2E, 0x3E,0x00, 0x48,0x41, 0xFF,0xEA, 0x43,0xEE, 0x4E,0x71, 0x74,0x00,
+	0x2F,0x2C, 0x20,0x6C, 0x00,0x3C, 0x00,0x26, 0x00,0x50, 0x18,0x80, 0x30,0x1F, 0x22,0x00,
+	0x66,0x0C, 0xFF,0xDA, 0x00,0x38, 0x66,0x02, 0x30,0x2C, 0x20,0x0C, 0x2D,0x6E, 0x42,0x40,
+	0xFF,0xE2, 0xA9,0xF0, 0xFF,0x00, 0x37,0x7C, 0xE5,0x80, 0xFF,0xDC, 0x48,0x68, 0x59,0x4F,
+	0x00,0x34, 0x3E,0x1F, 0x60,0x08, 0x2F,0x06, 0xFF,0xDE, 0x60,0x0A, 0x70,0x02, 0x00,0x32,
+	0xFF,0xCC, 0x00,0x80, 0x22,0x51, 0x10,0x1F, 0x31,0x7C, 0xA0,0x29, 0xFF,0xD8, 0x52,0x40,
+	0x01,0x00, 0x67,0x10, 0xA0,0x23, 0xFF,0xCE, 0xFF,0xD4, 0x20,0x06, 0x48,0x78, 0x00,0x2E,
+	0x50,0x4F, 0x43,0xFA, 0x67,0x12, 0x76,0x00, 0x41,0xE8, 0x4A,0x6E, 0x20,0xD9, 0x00,0x5A,
+	0x7F,0xFF, 0x51,0xCA, 0x00,0x5C, 0x2E,0x00, 0x02,0x40, 0x48,0xC7, 0x67,0x14, 0x0C,0x80,
+	0x2E,0x9F, 0xFF,0xD6, 0x80,0x00, 0x10,0x00, 0x48,0x42, 0x4A,0x6B, 0xFF,0xD2, 0x00,0x48,
+	0x4A,0x47, 0x4E,0xD1, 0x20,0x6F, 0x00,0x41, 0x60,0x0C, 0x2A,0x78, 0x42,0x2E, 0x32,0x00,
+	0x65,0x74, 0x67,0x16, 0x00,0x44, 0x48,0x6D, 0x20,0x08, 0x48,0x6C, 0x0B,0x7C, 0x26,0x40,
+	0x04,0x00, 0x00,0x68, 0x20,0x6D, 0x00,0x0D, 0x2A,0x40, 0x00,0x0B, 0x00,0x3E, 0x02,0x20
+};
+
+
+struct FakeDcmpStream
+{
+	const uint8_t*	in;
+	size_t			inLength;
+	size_t			inPos;
+	uint8_t*		out;
+	size_t			outLength;
+	size_t			outPos;
+	uint32_t*		literals;		// Output offset and length of each remembered literal.
+	size_t			numLiterals;
+	size_t			maxLiterals;
+};
+
+
+struct FakeDecompressor
+{
+	int16_t							dcmpID;
+	FakeResourceDecompressorProc	proc;	// NULL if this slot is unused.
+	void*							refCon;
+};
+
+
+struct FakeDecompressor		gFakeDecompressors[FAKE_MAX_DECOMPRESSORS] = {};
+
+
+static uint32_t	FakeGetUInt32BEAt( const uint8_t* inBytes )
+{
+	return ((uint32_t)inBytes[0] << 24) | ((uint32_t)inBytes[1] << 16) | ((uint32_t)inBytes[2] << 8) | inBytes[3];
+}
+
+
+static inline bool	FakeDcmpReadByte( struct FakeDcmpStream* ioStream, uint8_t* outByte )
+{
+	if( ioStream->inPos >= ioStream->inLength )
+		return false;
+	*outByte = ioStream->in[ioStream->inPos++];
+	return true;
+}
+
+
+// Reads a number in the variable length format of 'dcmp' 0 and 1:
+static bool	FakeDcmpReadNumber( struct FakeDcmpStream* ioStream, int32_t* outNumber )
+{
+	uint8_t		head = 0, tail = 0;
+	if( !FakeDcmpReadByte( ioStream, &head ) )
+		return false;
+	if( head < 0x80 )
+	{
+		*outNumber = (int32_t)head -0x40;
+		return true;
+	}
+	if( head < 0xFF )
+	{
+		if( !FakeDcmpReadByte( ioStream, &tail ) )
+			return false;
+		*outNumber = (int32_t)(((uint32_t)head << 8) | tail) -0xC000;
+		return true;
+	}
+	if( (ioStream->inPos +4) > ioStream->inLength )
+		return false;
+	*outNumber = (int32_t)FakeGetUInt32BEAt( ioStream->in +ioStream->inPos );
+	ioStream->inPos += 4;
+	return true;
+}
+
+
+// Writes the low inLength bytes of inValue, big endian:
+static bool	FakeDcmpWriteValue( struct FakeDcmpStream* ioStream, uint32_t inValue, size_t inLength )
+{
+	if( (ioStream->outPos +inLength) > ioStream->outLength )
+		return false;
+	for( size_t x = inLength; x > 0; x-- )
+		ioStream->out[ioStream->outPos++] = (uint8_t)(inValue >> (8 * (x -1)));
+	return true;
+}
+
+
+static inline bool	FakeDcmpWriteTableWord( struct FakeDcmpStream* ioStream, const uint8_t* inTable, size_t inIndex )
+{
+	if( (ioStream->outPos +2) > ioStream->outLength )
+		return false;
+	memmove( ioStream->out +ioStream->outPos, inTable +2 * inIndex, 2 );
+	ioStream->outPos += 2;
+	return true;
+}
+
+
+static bool	FakeDcmpGrowLiterals( struct FakeDcmpStream* ioStream )
+{
+	size_t		newMaxLiterals = (ioStream->maxLiterals == 0) ? 64 : ioStream->maxLiterals * 2;
+	uint32_t*	newLiterals = realloc( ioStream->literals, newMaxLiterals * 2 * sizeof(uint32_t) );
+	if( !newLiterals )
+		return false;
+	ioStream->literals = newLiterals;
+	ioStream->maxLiterals = newMaxLiterals;
+	return true;
+}
+
+
+// Copies inLength bytes of input to the output, and remembers them if asked to:
+static inline bool	FakeDcmpCopyLiteral( struct FakeDcmpStream* ioStream, size_t inLength, bool inRemember )
+{
+	if( (ioStream->inPos +inLength) > ioStream->inLength || (ioStream->outPos +inLength) > ioStream->outLength )
+		return false;
+	if( inRemember )
+	{
+		if( ioStream->numLiterals == ioStream->maxLiterals && !FakeDcmpGrowLiterals( ioStream ) )
+			return false;
+		ioStream->literals[2 * ioStream->numLiterals] = (uint32_t)ioStream->outPos;
+		ioStream->literals[2 * ioStream->numLiterals +1] = (uint32_t)inLength;
+		ioStream->numLiterals++;
+	}
+	memmove( ioStream->out +ioStream->outPos, ioStream->in +ioStream->inPos, inLength );
+	ioStream->inPos += inLength;
+	ioStream->outPos += inLength;
+	return true;
+}
+
+
+static inline bool	FakeDcmpRepeatLiteral( struct FakeDcmpStream* ioStream, size_t inIndex )
+{
+	if( inIndex >= ioStream->numLiterals )
+		return false;
+	uint32_t	literalStart = ioStream->literals[2 * inIndex], literalLength = ioStream->literals[2 * inIndex +1];
+	if( (ioStream->outPos +literalLength) > ioStream->outLength )
+		return false;
+	uint8_t*		dest = ioStream->out +ioStream->outPos;
+	const uint8_t*	literal = ioStream->out +literalStart;
+	for( uint32_t x = 0; x < literalLength; x++ )	// Mostly a word or two, not worth calling memmove().
+		dest[x] = literal[x];
+	ioStream->outPos += literalLength;
+	return true;
+}
+
+
+// A byte or word (inLength) repeated:
+static bool	FakeDcmpRepeatValue( struct FakeDcmpStream* ioStream, size_t inLength )
+{
+	int32_t		value = 0, count = 0;
+	if( !FakeDcmpReadNumber( ioStream, &value ) || !FakeDcmpReadNumber( ioStream, &count )
+		|| value < 0 || (uint32_t)value >= (1U << (8 * inLength)) || count < 0
+		|| ((size_t)count +1) * inLength > (ioStream->outLength -ioStream->outPos) )
+		return false;
+	for( int32_t x = 0; x <= count; x++ )
+		FakeDcmpWriteValue( ioStream, (uint32_t)value, inLength );
+	return true;
+}
+
+
+// Entries of a 'CODE' 0 jump table for a segment that isn't loaded: offset,
+//	MOVE.W #segment,-(SP), _LoadSeg. Starts after the first entry's offset:
+static bool	FakeDcmpJumpTable( struct FakeDcmpStream* ioStream )
+{
+	int32_t		segment = 0, count = 0, offset = 0, delta = 0;
+	if( !FakeDcmpReadNumber( ioStream, &segment ) || !FakeDcmpReadNumber( ioStream, &count ) || !FakeDcmpReadNumber( ioStream, &offset )
+		|| segment < 0 || segment > UINT16_MAX || count <= 0 )
+		return false;
+	for( int32_t x = 0; x <= count; x++ )
+	{
+		if( x > 1 )
+		{
+			if( !FakeDcmpReadNumber( ioStream, &delta ) )
+				return false;
+			offset = (int32_t)((uint32_t)offset +(uint32_t)delta -6);	// The deltas are 6 more than the distance.
+		}
+		if( (x > 0 && !FakeDcmpWriteValue( ioStream, (uint32_t)offset, 2 ))
+			|| !FakeDcmpWriteValue( ioStream, 0x3F3C, 2 ) || !FakeDcmpWriteValue( ioStream, (uint32_t)segment, 2 ) || !FakeDcmpWriteValue( ioStream, 0xA9F0, 2 ) )
+			return false;
+	}
+	return true;
+}
+
+
+// Words (inLength 2) or longs (4), each a bit more than the last:
+static bool	FakeDcmpDeltas( struct FakeDcmpStream* ioStream, size_t inLength )
+{
+	int32_t		value = 0, count = 0, delta = 0;
+	if( !FakeDcmpReadNumber( ioStream, &value ) || !FakeDcmpReadNumber( ioStream, &count ) || count < 0
+		|| (inLength == 2 && (value < INT16_MIN || value > INT16_MAX)) || !FakeDcmpWriteValue( ioStream, (uint32_t)value, inLength ) )
+		return false;
+	uint32_t	currValue = (uint32_t)value;
+	for( int32_t x = 0; x < count; x++ )
+	{
+		uint8_t		deltaByte = 0;
+		if( inLength == 2 )	// Just a signed byte, not a number.
+		{
+			if( !FakeDcmpReadByte( ioStream, &deltaByte ) )
+				return false;
+			delta = (int8_t)deltaByte;
+		}
+		else if( !FakeDcmpReadNumber( ioStream, &delta ) )
+			return false;
+		currValue += (uint32_t)delta;
+		if( !FakeDcmpWriteValue( ioStream, currValue, inLength ) )
+			return false;
+	}
+	return true;
+}
+
+
+// The codes after an 0xFE tag:
+static bool	FakeDcmp0ExtendedCode( struct FakeDcmpStream* ioStream )
+{
+	uint8_t		kind = 0;
+	if( !FakeDcmpReadByte( ioStream, &kind ) )
+		return false;
+	switch( kind )
+	{
+		case 0x00:
+			return FakeDcmpJumpTable( ioStream );
+		case 0x02:
+			return FakeDcmpRepeatValue( ioStream, 1 );
+		case 0x03:
+			return FakeDcmpRepeatValue( ioStream, 2 );
+		case 0x04:
+			return FakeDcmpDeltas( ioStream, 2 );
+		case 0x06:
+			return FakeDcmpDeltas( ioStream, 4 );
+	}
+	return false;
+}
+
+
+static inline bool	FakeDcmp0Code( struct FakeDcmpStream* ioStream, uint8_t inTag )
+{
+	uint8_t		operand = 0, operand2 = 0;
+	if( inTag < 0x20 )
+	{
+		size_t	numWords = inTag & 0x0F;
+		if( numWords == 0 )
+		{
+			if( !FakeDcmpReadByte( ioStream, &operand ) )
+				return false;
+			numWords = operand;
+		}
+		return FakeDcmpCopyLiteral( ioStream, 2 * numWords, inTag >= 0x10 );
+	}
+	if( inTag < 0x22 )
+		return FakeDcmpReadByte( ioStream, &operand ) && FakeDcmpRepeatLiteral( ioStream, 0x28 +((((size_t)inTag & 1) << 8) | operand) );
+	if( inTag == 0x22 )
+		return FakeDcmpReadByte( ioStream, &operand ) && FakeDcmpReadByte( ioStream, &operand2 )
+				&& FakeDcmpRepeatLiteral( ioStream, 0x28 +(((size_t)operand << 8) | operand2) );
+	if( inTag < 0x4B )
+		return FakeDcmpRepeatLiteral( ioStream, inTag -0x23 );
+	if( inTag < FAKE_DCMP_EXTENDED_TAG )
+		return FakeDcmpWriteTableWord( ioStream, sDcmp0Table, inTag -0x4B );
+	
+	return FakeDcmp0ExtendedCode( ioStream );
+}
+
+
+static inline bool	FakeDcmp1Code( struct FakeDcmpStream* ioStream, uint8_t inTag )
+{
+	uint8_t		operand = 0;
+	if( inTag < 0x20 )
+		return FakeDcmpCopyLiteral( ioStream, (inTag & 0x0F) +1, inTag >= 0x10 );
+	if( inTag < 0xD0 )
+		return FakeDcmpRepeatLiteral( ioStream, inTag -0x20 );
+	if( inTag == 0xD0 || inTag == 0xD1 )
+		return FakeDcmpReadByte( ioStream, &operand ) && FakeDcmpCopyLiteral( ioStream, operand, inTag == 0xD1 );
+	if( inTag == 0xD2 )
+		return FakeDcmpReadByte( ioStream, &operand ) && FakeDcmpRepeatLiteral( ioStream, 0xB0 +(size_t)operand );
+	if( inTag >= 0xD5 && inTag < FAKE_DCMP_EXTENDED_TAG )
+		return FakeDcmpWriteTableWord( ioStream, sDcmp1Table, inTag -0xD5 );
+	if( inTag == FAKE_DCMP_EXTENDED_TAG )
+		return FakeDcmpReadByte( ioStream, &operand ) && operand == 0x02 && FakeDcmpRepeatValue( ioStream, 1 );
+	
+	return false;	// 0xD3 and 0xD4 aren't used.
+}
+
+
+static inline int16_t	FakeDecompressDcmpCodes( int16_t inDcmpID, const uint8_t* inHeader, const uint8_t* inData, size_t inDataLength, uint8_t* outData, size_t outDataLength )
+{
+	if( inHeader[6] != 8 )
+		return CantDecompress;
+	
+	struct FakeDcmpStream	stream = { .in = inData, .inLength = inDataLength, .out = outData, .outLength = outDataLength };
+	uint8_t					tag = 0;
+	bool					ok = FakeDcmpReadByte( &stream, &tag );
+	while( ok && tag != FAKE_DCMP_END_TAG )
+		ok = ((inDcmpID == 0) ? FakeDcmp0Code( &stream, tag ) : FakeDcmp1Code( &stream, tag )) && FakeDcmpReadByte( &stream, &tag );
+	free( stream.literals );
+	
+	return (ok && stream.outPos == outDataLength) ? noErr : CantDecompress;
+}
+
+
+static int16_t	FakeDecompressDcmp0( int16_t inDcmpID, const uint8_t* inHeader, size_t inHeaderLength, const uint8_t* inData, size_t inDataLength,
+									uint8_t* outData, size_t outDataLength, void* inRefCon )
+{
+	return FakeDecompressDcmpCodes( 0, inHeader, inData, inDataLength, outData, outDataLength );
+}
+
+
+static int16_t	FakeDecompressDcmp1( int16_t inDcmpID, const uint8_t* inHeader, size_t inHeaderLength, const uint8_t* inData, size_t inDataLength,
+									uint8_t* outData, size_t outDataLength, void* inRefCon )
+{
+	return FakeDecompressDcmpCodes( 1, inHeader, inData, inDataLength, outData, outDataLength );
+}
+
+
+static int16_t	FakeDecompressDcmp2( int16_t inDcmpID, const uint8_t* inHeader, size_t inHeaderLength, const uint8_t* inData, size_t inDataLength,
+									uint8_t* outData, size_t outDataLength, void* inRefCon )
+{
+	if( inHeaderLength < FAKE_EXTENDED_HEADER_MIN_LENGTH || inHeader[6] != 9 )
+		return CantDecompress;
+	uint8_t			flags = inHeader[17];
+	size_t			tableCount = sizeof(sDcmp2DefaultTable) / 2;
+	const uint8_t*	table = sDcmp2DefaultTable;
+	if( (flags & FAKE_DCMP2_CUSTOM_TABLE) != 0 )
+	{
+		tableCount = inHeader[16] +1;
+		if( inDataLength < (tableCount * 2) )
+			return CantDecompress;
+		table = inData;
+		inData += tableCount * 2;
+		inDataLength -= tableCount * 2;
+	}
+
+	if( (outDataLength & 1) != 0 )
+	{
+		if( inDataLength < 1 )
+			return CantDecompress;
+		outData[outDataLength -1] = inData[--inDataLength];
+	}
+
+	size_t		wordsLength = outDataLength & ~(size_t)1;
+	size_t		outPos = 0, inPos = 0;
+	if( (flags & FAKE_DCMP2_TAGGED) == 0 )
+	{
+		if( inDataLength < wordsLength / 2 )
+			return CantDecompress;
+		for( ; outPos < wordsLength; outPos += 2 )
+		{
+			uint8_t		index = inData[inPos++];
+			if( index >= tableCount )
+				return CantDecompress;
+			memmove( outData +outPos, table +2 * index, 2 );
+		}
+		return noErr;
+	}
+
+	while( outPos < wordsLength )
+	{
+		if( inPos >= inDataLength )
+			return CantDecompress;
+		uint8_t		tag = inData[inPos++];
+		for( uint8_t bit = 0x80; bit != 0 && outPos < wordsLength; bit >>= 1, outPos += 2 )
+		{
+			if( (tag & bit) != 0 )
+			{
+				if( inPos >= inDataLength || inData[inPos] >= tableCount )
+					return CantDecompress;
+				memmove( outData +outPos, table +2 * inData[inPos++], 2 );
+			}
+			else
+			{
+				if( (inPos +2) > inDataLength )
+					return CantDecompress;
+				memmove( outData +outPos, inData +inPos, 2 );
+				inPos += 2;
+			}
+		}
+	}
+
+	return noErr;
+}
+
+
+static FakeResourceDecompressorProc	FakeFindDecompressor( int16_t inDcmpID, void** outRefCon )
+{
+	for( int x = 0; x < FAKE_MAX_DECOMPRESSORS; x++ )
+	{
+		if( gFakeDecompressors[x].proc && gFakeDecompressors[x].dcmpID == inDcmpID )
+		{
+			*outRefCon = gFakeDecompressors[x].refCon;
+			return gFakeDecompressors[x].proc;
+		}
+	}
+
+	*outRefCon = NULL;
+	switch( inDcmpID )
+	{
+		case 0:
+			return FakeDecompressDcmp0;
+		case 1:
+			return FakeDecompressDcmp1;
+		case 2:
+			return FakeDecompressDcmp2;
+	}
+	return NULL;
+}
+
+
+void	FakeSetResourceDecompressor( int16_t inDcmpID, FakeResourceDecompressorProc inProc, void* inRefCon )
+{
+	struct FakeDecompressor*	freeSlot = NULL;
+	for( int x = 0; x < FAKE_MAX_DECOMPRESSORS; x++ )
+	{
+		if( gFakeDecompressors[x].proc && gFakeDecompressors[x].dcmpID == inDcmpID )
+		{
+			gFakeDecompressors[x].proc = inProc;
+			gFakeDecompressors[x].refCon = inRefCon;
+			return;
+		}
+		if( !gFakeDecompressors[x].proc && !freeSlot )
+			freeSlot = gFakeDecompressors +x;
+	}
+
+	if( inProc && freeSlot )
+	{
+		freeSlot->dcmpID = inDcmpID;
+		freeSlot->proc = inProc;
+		freeSlot->refCon = inRefCon;
+	}
+	else if( inProc )
+		FAKE_TRACE( kFakeTraceLevelError, "Too many decompressors, ignoring the one for 'dcmp' %d.", inDcmpID );
+}
+
+
+int16_t	FakeDecompressResourceData( Handle ioResource )
+{
+	// Not FakeGetHandleSize(), which sets MemError() and isn't safe on several threads:
+	size_t			dataLength = ((MasterPointer*)ioResource)->size;
+	const uint8_t*	data = (const uint8_t*)*ioResource;
+	if( dataLength < FAKE_EXTENDED_HEADER_MIN_LENGTH || FakeGetUInt32BEAt( data ) != FAKE_EXTENDED_HEADER_SIGNATURE
+		|| (data[7] & 1) == 0 )
+		return CantDecompress;
+
+	size_t		headerLength = ((size_t)data[4] << 8) | data[5];
+	uint8_t		headerVersion = data[6];
+	uint32_t	decompressedLength = FakeGetUInt32BEAt( data +8 );
+	int16_t		dcmpID = (int16_t)((headerVersion == 8) ? ((data[14] << 8) | data[15]) : ((data[12] << 8) | data[13]));
+	void*		refCon = NULL;
+	FakeResourceDecompressorProc	decompressor = FakeFindDecompressor( dcmpID, &refCon );
+	if( headerLength < FAKE_EXTENDED_HEADER_MIN_LENGTH || headerLength > dataLength || (headerVersion != 8 && headerVersion != 9) || !decompressor )
+	{
+		FAKE_TRACE( kFakeTraceLevelDebug, "Can't decompress resource data for 'dcmp' %d (header version %d)", dcmpID, headerVersion );
+		return CantDecompress;
+	}
+
+	uint8_t*	decompressedData = malloc( (size_t)decompressedLength +1 );
+	if( !decompressedData )
+		return CantDecompress;
+	int16_t		err = decompressor( dcmpID, data, headerLength, data +headerLength, dataLength -headerLength,
+									decompressedData, decompressedLength, refCon );
+	if( err != noErr )
+	{
+		free( decompressedData );
+		return CantDecompress;
+	}
+
+	FakeAdoptHandleMemory( ioResource, (char*)decompressedData, decompressedLength );
+
+	return noErr;
+}
@@ -0,0 +1,35 @@
+//
+//  FakeDecompression.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Decompresses resources that System 7's Resource Manager would have run
+//  through a 'dcmp' resource, i.e. that have the resCompressed attribute and
+//  an extended header in front of their data.
+//
+
+#ifndef ReClassicfication_FakeDecompression_h
+#define ReClassicfication_FakeDecompression_h
+
+#include "FakeResources.h"
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+// Private calls for internal use:
+
+// Replaces the compressed data in the given resource Handle with the
+//	decompressed data. Returns CantDecompress and leaves the Handle alone if
+//	the data is damaged or there's no decompressor for it. Only makes calls
+//	that are safe to make on several threads for different Handles.
+int16_t		FakeDecompressResourceData( Handle ioResource );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,148 @@
+//
+//  FakeHandleIndex.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <stdlib.h>
+#include "FakeHandleIndex.h"
+
+
+// One slot of the open-addressed table. handle is NULL if the slot is empty:
+struct FakeHandleIndexSlot
+{
+	Handle		handle;
+	uint32_t	typeIndex;
+	uint32_t	entryIndex;
+};
+
+
+struct FakeHandleIndex
+{
+	struct FakeHandleIndexSlot*	slots;
+	size_t						numSlots;	// Power of 2.
+	size_t						count;
+};
+
+
+static size_t	FakeHandleIndexHash( Handle inHandle )
+{
+	uintptr_t	theKey = (uintptr_t)inHandle;
+	theKey ^= theKey >> 17;
+	theKey *= (uintptr_t)0x9E3779B97F4A7C15ULL;
+	return (size_t)(theKey ^ (theKey >> 29));
+}
+
+
+// Returns the slot for inHandle, or the empty slot where it would go:
+static size_t	FakeHandleIndexFindSlot( const struct FakeHandleIndex* inIndex, Handle inHandle )
+{
+	size_t	mask = inIndex->numSlots -1;
+	size_t	slot = FakeHandleIndexHash( inHandle ) & mask;
+	while( inIndex->slots[slot].handle != NULL && inIndex->slots[slot].handle != inHandle )
+		slot = (slot +1) & mask;
+	return slot;
+}
+
+
+static bool	FakeHandleIndexResize( struct FakeHandleIndex* ioIndex, size_t inNumSlots )
+{
+	struct FakeHandleIndexSlot*	newSlots = calloc( inNumSlots, sizeof(struct FakeHandleIndexSlot) );
+	if( !newSlots )
+		return false;
+
+	struct FakeHandleIndexSlot*	oldSlots = ioIndex->slots;
+	size_t						oldNumSlots = ioIndex->numSlots;
+	ioIndex->slots = newSlots;
+	ioIndex->numSlots = inNumSlots;
+	for( size_t x = 0; x < oldNumSlots; x++ )
+	{
+		if( oldSlots[x].handle != NULL )
+			ioIndex->slots[FakeHandleIndexFindSlot( ioIndex, oldSlots[x].handle )] = oldSlots[x];
+	}
+	free( oldSlots );
+
+	return true;
+}
+
+
+struct FakeHandleIndex*	FakeNewHandleIndex( size_t inExpectedCount )
+{
+	struct FakeHandleIndex*	newIndex = calloc( 1, sizeof(struct FakeHandleIndex) );
+	size_t					numSlots = 64;
+	while( numSlots < inExpectedCount * 2 )	// Keep it at most half full.
+		numSlots *= 2;
+	if( !newIndex || !FakeHandleIndexResize( newIndex, numSlots ) )
+	{
+		free( newIndex );
+		return NULL;
+	}
+
+	return newIndex;
+}
+
+
+void	FakeDisposeHandleIndex( struct FakeHandleIndex* inIndex )
+{
+	if( !inIndex )
+		return;
+	free( inIndex->slots );
+	free( inIndex );
+}
+
+
+bool	FakeHandleIndexSet( struct FakeHandleIndex* inIndex, Handle inHandle, uint32_t inTypeIndex, uint32_t inEntryIndex )
+{
+	if( (inIndex->count +1) * 2 > inIndex->numSlots && !FakeHandleIndexResize( inIndex, inIndex->numSlots * 2 ) )
+		return false;
+
+	struct FakeHandleIndexSlot*	theSlot = inIndex->slots +FakeHandleIndexFindSlot( inIndex, inHandle );
+	if( theSlot->handle == NULL )
+		inIndex->count++;
+	theSlot->handle = inHandle;
+	theSlot->typeIndex = inTypeIndex;
+	theSlot->entryIndex = inEntryIndex;
+
+	return true;
+}
+
+
+bool	FakeHandleIndexFind( const struct FakeHandleIndex* inIndex, Handle inHandle, uint32_t* outTypeIndex, uint32_t* outEntryIndex )
+{
+	const struct FakeHandleIndexSlot*	theSlot = inIndex->slots +FakeHandleIndexFindSlot( inIndex, inHandle );
+	if( theSlot->handle == NULL )
+		return false;
+
+	*outTypeIndex = theSlot->typeIndex;
+	*outEntryIndex = theSlot->entryIndex;
+	return true;
+}
+
+
+// Empties the slot of inHandle, moving later entries of the same probe
+//	sequence back so lookups don't need tombstones:
+void	FakeHandleIndexRemove( struct FakeHandleIndex* inIndex, Handle inHandle )
+{
+	size_t	mask = inIndex->numSlots -1;
+	size_t	hole = FakeHandleIndexFindSlot( inIndex, inHandle );
+	size_t	slot = hole;
+	if( inIndex->slots[hole].handle == NULL )
+		return;
+
+	inIndex->slots[hole].handle = NULL;
+	inIndex->count--;
+	while( true )
+	{
+		slot = (slot +1) & mask;
+		if( inIndex->slots[slot].handle == NULL )
+			break;
+		size_t	home = FakeHandleIndexHash( inIndex->slots[slot].handle ) & mask;
+		if( ((slot -home) & mask) >= ((slot -hole) & mask) )	// Would still be found if moved into the hole?
+		{
+			inIndex->slots[hole] = inIndex->slots[slot];
+			inIndex->slots[slot].handle = NULL;
+			hole = slot;
+		}
+	}
+}
@@ -0,0 +1,48 @@
+//
+//  FakeHandleIndex.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Finds where in a resource map the entry for a given resource Handle is,
+//  without looking at every entry in the map.
+//
+
+#ifndef ReClassicfication_FakeHandleIndex_h
+#define ReClassicfication_FakeHandleIndex_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "FakeHandles.h"
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+struct FakeHandleIndex;
+
+
+// Private calls for internal use:
+
+// Returns NULL if there isn't enough memory. inExpectedCount is how many
+//	Handles you're about to add, so the table doesn't have to grow for them.
+struct FakeHandleIndex*	FakeNewHandleIndex( size_t inExpectedCount );
+
+void	FakeDisposeHandleIndex( struct FakeHandleIndex* inIndex );
+
+// Remembers (or updates) where inHandle's entry is. Returns false if there
+//	isn't enough memory, in which case the index must be thrown away.
+bool	FakeHandleIndexSet( struct FakeHandleIndex* inIndex, Handle inHandle, uint32_t inTypeIndex, uint32_t inEntryIndex );
+
+// Returns false if inHandle isn't in the index:
+bool	FakeHandleIndexFind( const struct FakeHandleIndex* inIndex, Handle inHandle, uint32_t* outTypeIndex, uint32_t* outEntryIndex );
+
+void	FakeHandleIndexRemove( struct FakeHandleIndex* inIndex, Handle inHandle );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
@@ -31,6 +31,10 @@
 	of master pointers easily. */
 MasterPointerBlock		gMasterPointers = {};
 long					gFakeHandleError = noErr;
+MasterPointerBlock*		gFreeMasterPointerHintBlock = NULL;	// Where FakeNewEmptyHandle() starts looking for an unused master pointer.
+long					gFreeMasterPointerHintIndex = 0;
+long					gNumMasterPointers = MASTERPOINTER_CHUNK_SIZE;		// Number of master pointers in all blocks.
+long					gNumUsedMasterPointers = 0;
 
 
 /* -----------------------------------------------------------------------------
@@ -62,6 +66,7 @@ void	FakeMoreMasters()
 	
 	// Make this last master pointer point to our new block:
 	vCurrBlock->next = vMPtrBlock;
+	gNumMasterPointers += MASTERPOINTER_CHUNK_SIZE;
 	
 	gFakeHandleError = noErr;
 }
@@ -70,37 +75,51 @@ void	FakeMoreMasters()
 Handle	FakeNewEmptyHandle()
 {
 	Handle				theHandle = NULL;
-	long				x;
-	MasterPointerBlock*	vCurrBlock = &gMasterPointers; // TODO: Could optimize performance by remembering last freed MasterPointerBlock or even pointer in it.
-	bool				notFound = true;
+	MasterPointerBlock*	vCurrBlock = NULL;
+	long				x = 0;
 	
 	gFakeHandleError = noErr;
 	
-	while( notFound )
+	// Search from the last allocated or freed master pointer to the end of the
+	//	list first, then from the start of the list:
+	for( int pass = 0; pass < 2 && theHandle == NULL && gNumUsedMasterPointers < gNumMasterPointers; pass++ )
 	{
-		for( x = 0; x < (MASTERPOINTER_CHUNK_SIZE-1); x++ )
+		vCurrBlock = (pass == 0 && gFreeMasterPointerHintBlock) ? gFreeMasterPointerHintBlock : &gMasterPointers;
+		x = (pass == 0) ? gFreeMasterPointerHintIndex : 0;
+		for( ; vCurrBlock != NULL && theHandle == NULL; vCurrBlock = vCurrBlock->next, x = 0 )
 		{
-			if( !(vCurrBlock->pointers[x].used) )
+			for( ; x < MASTERPOINTER_CHUNK_SIZE; x++ )
 			{
-				vCurrBlock->pointers[x].used = true;
-				vCurrBlock->pointers[x].memoryFlags = 0;
-				vCurrBlock->pointers[x].size = 0;
-				
-				theHandle = (Handle) &(vCurrBlock->pointers[x]);
-				notFound = false;
-				break;
+				if( !(vCurrBlock->pointers[x].used) )
+				{
+					theHandle = (Handle) &(vCurrBlock->pointers[x]);
+					break;
+				}
 			}
+			if( theHandle != NULL )
+				break;
 		}
-		
-		if( !vCurrBlock->pointers[MASTERPOINTER_CHUNK_SIZE-1].used )	// Last is unused? We need a new master pointer block!
-		{
-			FakeMoreMasters();
-			if( vCurrBlock->next == NULL )	// No new block added?!
-				notFound = false;	// Terminate, it's very likely an error occurred.
-		}
-		vCurrBlock = vCurrBlock->next;	// Go next master pointer block.
 	}
 	
+	if( theHandle == NULL )	// All master pointers in use? We need a new master pointer block!
+	{
+		FakeMoreMasters();
+		if( gFakeHandleError != noErr )
+			return NULL;
+		vCurrBlock = &gMasterPointers;
+		while( vCurrBlock->next != NULL )
+			vCurrBlock = vCurrBlock->next;
+		x = 0;
+		theHandle = (Handle) &(vCurrBlock->pointers[x]);
+	}
+	
+	vCurrBlock->pointers[x].used = true;
+	vCurrBlock->pointers[x].memoryFlags = 0;
+	vCurrBlock->pointers[x].size = 0;
+	gNumUsedMasterPointers++;
+	gFreeMasterPointerHintBlock = vCurrBlock;
+	gFreeMasterPointerHintIndex = x +1;
+	
 	return theHandle;
 }
 
@@ -157,12 +176,26 @@ void	FakeDisposeHandle( Handle theHand )
 {
 	MasterPointer*		theEntry = (MasterPointer*) theHand;
 	
-	if( theEntry->actualPointer )
+	if( theEntry->actualPointer && !(theEntry->memoryFlags & MASTERPOINTER_BORROWED_FLAG) )
 		free( theEntry->actualPointer );
 	theEntry->used = false;
+	gNumUsedMasterPointers--;
 	theEntry->actualPointer = NULL;
 	theEntry->memoryFlags = 0;
 	theEntry->size = 0;
+	
+	// Remember the block this came from so the next FakeNewEmptyHandle() finds it quickly:
+	MasterPointerBlock*	vCurrBlock = &gMasterPointers;
+	while( vCurrBlock != NULL )
+	{
+		if( theEntry >= vCurrBlock->pointers && theEntry < (vCurrBlock->pointers +MASTERPOINTER_CHUNK_SIZE) )
+		{
+			gFreeMasterPointerHintBlock = vCurrBlock;
+			gFreeMasterPointerHintIndex = theEntry -vCurrBlock->pointers;
+			break;
+		}
+		vCurrBlock = vCurrBlock->next;
+	}
 }
 
 
@@ -170,9 +203,78 @@ void	FakeEmptyHandle( Handle theHand )
 {
 	MasterPointer*		theEntry = (MasterPointer*) theHand;
 	
-	if( theEntry->actualPointer )
+	if( theEntry->actualPointer && !(theEntry->memoryFlags & MASTERPOINTER_BORROWED_FLAG) )
 		free( theEntry->actualPointer );
 	theEntry->actualPointer = NULL;
+	theEntry->memoryFlags &= ~MASTERPOINTER_BORROWED_FLAG;
+	theEntry->size = 0;
+}
+
+
+/* -----------------------------------------------------------------------------
+	AdoptHandleMemory:
+		Replace the Handle's data with the given block, which must have been
+		allocated using malloc(). The Handle now owns the block and frees it
+		when appropriate. Saves a copy when the data was read elsewhere.
+   ----------------------------------------------------------------------------- */
+
+void	FakeAdoptHandleMemory( Handle theHand, char* thePtr, long theSize )
+{
+	MasterPointer*		theEntry = (MasterPointer*) theHand;
+	
+	if( theEntry->actualPointer && theEntry->actualPointer != thePtr && !(theEntry->memoryFlags & MASTERPOINTER_BORROWED_FLAG) )
+		free( theEntry->actualPointer );
+	theEntry->actualPointer = thePtr;
+	theEntry->memoryFlags &= ~MASTERPOINTER_BORROWED_FLAG;
+	theEntry->size = theSize;
+}
+
+
+/* -----------------------------------------------------------------------------
+	BorrowHandleMemory:
+		Like AdoptHandleMemory(), but the block stays its owner's, e.g. because
+		it's in memory shared with other processes. The Handle never frees it,
+		and copies it into a block of its own when its size changes. The block
+		must stay valid until the Handle is disposed, emptied, or OwnHandleMemory()
+		is called.
+   ----------------------------------------------------------------------------- */
+
+void	FakeBorrowHandleMemory( Handle theHand, char* thePtr, long theSize )
+{
+	MasterPointer*		theEntry = (MasterPointer*) theHand;
+	
+	FakeAdoptHandleMemory( theHand, thePtr, theSize );
+	theEntry->memoryFlags |= MASTERPOINTER_BORROWED_FLAG;
+}
+
+
+/* -----------------------------------------------------------------------------
+	OwnHandleMemory:
+		Copy the data of a Handle that borrowed its block into a block of its
+		own, e.g. before the block goes away. Does nothing for other Handles.
+		Returns memFulErr and leaves the Handle alone if there's no room.
+   ----------------------------------------------------------------------------- */
+
+long	FakeOwnHandleMemory( Handle theHand )
+{
+	MasterPointer*		theEntry = (MasterPointer*) theHand;
+	
+	if( !(theEntry->memoryFlags & MASTERPOINTER_BORROWED_FLAG) )
+		return noErr;
+	char*	thePtr = malloc( (theEntry->size > 0) ? theEntry->size : 1 );
+	if( !thePtr )
+		return memFulErr;
+	if( theEntry->size > 0 )
+		memmove( thePtr, theEntry->actualPointer, theEntry->size );
+	theEntry->actualPointer = thePtr;
+	theEntry->memoryFlags &= ~MASTERPOINTER_BORROWED_FLAG;
+	return noErr;
+}
+
+
+bool	FakeIsHandleMemoryBorrowed( Handle theHand )
+{
+	return (((MasterPointer*) theHand)->memoryFlags & MASTERPOINTER_BORROWED_FLAG) != 0;
 }
 
 
@@ -205,28 +307,94 @@ long	FakeGetHandleSize( Handle theHand )
    ----------------------------------------------------------------------------- */
 
 void	FakeSetHandleSize( Handle theHand, long theSize )
+{
+	gFakeHandleError = FakeSetHandleSizeReentrant( theHand, theSize );
+}
+
+
+/* -----------------------------------------------------------------------------
+	SetHandleSizeReentrant:
+		Like SetHandleSize(), but returns the error instead of remembering it for
+		MemError(). That way, several threads can resize *different* Handles at
+		the same time, e.g. to load resources in parallel.
+   ----------------------------------------------------------------------------- */
+
+long	FakeSetHandleSizeReentrant( Handle theHand, long theSize )
 {
 	MasterPointer*	theEntry = (MasterPointer*) theHand;
-	char*			thePtr = realloc( theEntry->actualPointer, theSize );
+	char*			thePtr = NULL;
+	
+	if( theEntry->memoryFlags & MASTERPOINTER_BORROWED_FLAG )	// Not ours to realloc(), make a copy.
+	{
+		thePtr = malloc( (theSize > 0) ? theSize : 1 );
+		if( thePtr )
+		{
+			memmove( thePtr, theEntry->actualPointer, (theSize < theEntry->size) ? theSize : theEntry->size );
+			theEntry->memoryFlags &= ~MASTERPOINTER_BORROWED_FLAG;
+		}
+	}
+	else
+		thePtr = realloc( theEntry->actualPointer, theSize );
 	
 	if( thePtr )
 	{
 		theEntry->actualPointer = thePtr;
 		theEntry->size = theSize;
-		gFakeHandleError = noErr;
+		return noErr;
 	}
 	else
-		gFakeHandleError = memFulErr;
+		return memFulErr;
 }
 
 
+/* -----------------------------------------------------------------------------
+	HLock/HUnlock/HPurge/HNoPurge:
+		Set or clear the Handle's locked or purgeable flag. Our Handles never
+		move on their own, but the Resource Manager empties unlocked resource
+		Handles to stay within its memory budget, purgeable ones first.
+   ----------------------------------------------------------------------------- */
 
+void	FakeHLock( Handle theHand )
+{
+	((MasterPointer*) theHand)->memoryFlags |= kFakeHandleLockedBit;
+}
 
 
+void	FakeHUnlock( Handle theHand )
+{
+	((MasterPointer*) theHand)->memoryFlags &= ~kFakeHandleLockedBit;
+}
 
 
+void	FakeHPurge( Handle theHand )
+{
+	((MasterPointer*) theHand)->memoryFlags |= kFakeHandlePurgeableBit;
+}
 
 
+void	FakeHNoPurge( Handle theHand )
+{
+	((MasterPointer*) theHand)->memoryFlags &= ~kFakeHandlePurgeableBit;
+}
 
 
+/* -----------------------------------------------------------------------------
+	HGetState/HSetState:
+		Get all of the flags above at once, e.g. to lock a Handle temporarily
+		and then restore whatever state it was in before.
+   ----------------------------------------------------------------------------- */
 
+char	FakeHGetState( Handle theHand )
+{
+	gFakeHandleError = noErr;
+	
+	return (char)((MasterPointer*) theHand)->memoryFlags;
+}
+
+
+void	FakeHSetState( Handle theHand, char theState )
+{
+	MasterPointer*	theEntry = (MasterPointer*) theHand;
+	theEntry->memoryFlags = (theEntry->memoryFlags & (MASTERPOINTER_BORROWED_FLAG | MASTERPOINTER_COMPRESSED_FLAG)) | (unsigned char)theState;
+	gFakeHandleError = noErr;
+}
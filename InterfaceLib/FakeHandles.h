@@ -43,6 +43,9 @@ extern "C" {
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#if FAKE_RECORD_CALLS
+#include "FakeCallRecorder.h"	// Must come before the prototypes.
+#endif
 
 
 // -----------------------------------------------------------------------------
@@ -54,6 +57,8 @@ extern "C" {
 #endif
 
 #define MASTERPOINTER_CHUNK_SIZE        1024    // Size of blocks of master pointers we allocate in one go.
+#define MASTERPOINTER_BORROWED_FLAG     0x100   // In memoryFlags, beyond what FakeHGetState() returns: actualPointer isn't ours to free.
+#define MASTERPOINTER_COMPRESSED_FLAG   0x200   // In memoryFlags, beyond what FakeHGetState() returns: empty, but the resource cache keeps the data compressed.
 
 
 // Error codes MemError() may return after Handle calls:
@@ -65,6 +70,14 @@ enum {
 };
 
 
+// Bits in the state FakeHGetState() returns, same as on the Mac:
+enum {
+    kFakeHandleResourceBit = 0x20,    // Belongs to a resource.
+    kFakeHandlePurgeableBit = 0x40,   // May be emptied when memory is tight.
+    kFakeHandleLockedBit = 0x80       // Mustn't be moved or emptied.
+};
+
+
 // -----------------------------------------------------------------------------
 //	Data Types:
 // -----------------------------------------------------------------------------
@@ -110,12 +123,34 @@ extern long FakeGetHandleSize(Handle theHand);
 
 extern void FakeSetHandleSize(Handle theHand, long theSize);
 
+extern long FakeSetHandleSizeReentrant(Handle theHand, long theSize);
+
 extern void FakeMoreMasters(void);
 
 extern Handle FakeNewEmptyHandle();
 
 extern void FakeEmptyHandle(Handle theHand);
 
+extern void FakeAdoptHandleMemory(Handle theHand, char *thePtr, long theSize);
+
+extern void FakeBorrowHandleMemory(Handle theHand, char *thePtr, long theSize);
+
+extern long FakeOwnHandleMemory(Handle theHand);
+
+extern bool FakeIsHandleMemoryBorrowed(Handle theHand);
+
+extern void FakeHLock(Handle theHand);
+
+extern void FakeHUnlock(Handle theHand);
+
+extern void FakeHPurge(Handle theHand);
+
+extern void FakeHNoPurge(Handle theHand);
+
+extern char FakeHGetState(Handle theHand);
+
+extern void FakeHSetState(Handle theHand, char theState);
+
 
 #if __cplusplus
 };
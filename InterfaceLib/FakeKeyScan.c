@@ -0,0 +1,162 @@
+//
+//  FakeKeyScan.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <stdbool.h>
+#include "FakeKeyScan.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define FAKE_KEY_SCAN_X86		1
+#include <immintrin.h>
+#else
+#define FAKE_KEY_SCAN_X86		0
+#endif
+
+
+static int		gFakeKeyScanLevel = -1;		// Not determined yet.
+
+
+static enum FakeKeyScanLevel	FakeBestKeyScanLevel( void )
+{
+#if FAKE_KEY_SCAN_X86
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "avx2" ) ? kFakeKeyScanAVX2 : kFakeKeyScanSSE2;
+#else
+	return kFakeKeyScanScalar;
+#endif
+}
+
+
+static enum FakeKeyScanLevel	FakeGetKeyScanLevel( void )
+{
+	int		level = __atomic_load_n( &gFakeKeyScanLevel, __ATOMIC_RELAXED );
+	if( level < 0 )
+	{
+		level = FakeBestKeyScanLevel();	// Every thread gets the same answer, so it doesn't matter who stores it.
+		__atomic_store_n( &gFakeKeyScanLevel, level, __ATOMIC_RELAXED );
+	}
+	return (enum FakeKeyScanLevel)level;
+}
+
+
+enum FakeKeyScanLevel	FakeSetKeyScanLevel( enum FakeKeyScanLevel inLevel )
+{
+	enum FakeKeyScanLevel	bestLevel = FakeBestKeyScanLevel();
+	if( inLevel > bestLevel )
+		inLevel = bestLevel;
+	__atomic_store_n( &gFakeKeyScanLevel, (int)inLevel, __ATOMIC_RELAXED );
+	return inLevel;
+}
+
+
+#if FAKE_KEY_SCAN_X86
+
+static size_t	FakeFindInt16KeySSE2( const int16_t* inKeys, size_t inCount, int16_t inKey )
+{
+	__m128i		key = _mm_set1_epi16( inKey );
+	size_t		x = 0;
+	for( ; (x +8) <= inCount; x += 8 )
+	{
+		int		matches = _mm_movemask_epi8( _mm_cmpeq_epi16( _mm_loadu_si128( (const __m128i*)(inKeys +x) ), key ) );
+		if( matches != 0 )
+			return x +__builtin_ctz( matches ) / 2;	// 2 mask bits per key.
+	}
+	for( ; x < inCount; x++ )
+	{
+		if( inKeys[x] == inKey )
+			return x;
+	}
+	return inCount;
+}
+
+
+__attribute__((target("avx2")))
+static size_t	FakeFindInt16KeyAVX2( const int16_t* inKeys, size_t inCount, int16_t inKey )
+{
+	__m256i		key = _mm256_set1_epi16( inKey );
+	size_t		x = 0;
+	for( ; (x +16) <= inCount; x += 16 )
+	{
+		unsigned	matches = (unsigned)_mm256_movemask_epi8( _mm256_cmpeq_epi16( _mm256_loadu_si256( (const __m256i*)(inKeys +x) ), key ) );
+		if( matches != 0 )
+			return x +__builtin_ctz( matches ) / 2;
+	}
+	return x +FakeFindInt16KeySSE2( inKeys +x, inCount -x, inKey );
+}
+
+
+static size_t	FakeFindUInt32KeySSE2( const uint32_t* inKeys, size_t inCount, uint32_t inKey )
+{
+	__m128i		key = _mm_set1_epi32( (int)inKey );
+	size_t		x = 0;
+	for( ; (x +4) <= inCount; x += 4 )
+	{
+		int		matches = _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_loadu_si128( (const __m128i*)(inKeys +x) ), key ) ) );
+		if( matches != 0 )
+			return x +__builtin_ctz( matches );
+	}
+	for( ; x < inCount; x++ )
+	{
+		if( inKeys[x] == inKey )
+			return x;
+	}
+	return inCount;
+}
+
+
+__attribute__((target("avx2")))
+static size_t	FakeFindUInt32KeyAVX2( const uint32_t* inKeys, size_t inCount, uint32_t inKey )
+{
+	__m256i		key = _mm256_set1_epi32( (int)inKey );
+	size_t		x = 0;
+	for( ; (x +8) <= inCount; x += 8 )
+	{
+		int		matches = _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( _mm256_loadu_si256( (const __m256i*)(inKeys +x) ), key ) ) );
+		if( matches != 0 )
+			return x +__builtin_ctz( matches );
+	}
+	return x +FakeFindUInt32KeySSE2( inKeys +x, inCount -x, inKey );
+}
+
+#endif // FAKE_KEY_SCAN_X86
+
+
+size_t	FakeFindInt16Key( const int16_t* inKeys, size_t inCount, int16_t inKey )
+{
+#if FAKE_KEY_SCAN_X86
+	enum FakeKeyScanLevel	level = (inCount >= 8) ? FakeGetKeyScanLevel() : kFakeKeyScanScalar;	// Fewer don't fill a vector.
+	if( level == kFakeKeyScanAVX2 )
+		return FakeFindInt16KeyAVX2( inKeys, inCount, inKey );
+	else if( level == kFakeKeyScanSSE2 )
+		return FakeFindInt16KeySSE2( inKeys, inCount, inKey );
+#endif
+
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		if( inKeys[x] == inKey )
+			return x;
+	}
+	return inCount;
+}
+
+
+size_t	FakeFindUInt32Key( const uint32_t* inKeys, size_t inCount, uint32_t inKey )
+{
+#if FAKE_KEY_SCAN_X86
+	enum FakeKeyScanLevel	level = (inCount >= 4) ? FakeGetKeyScanLevel() : kFakeKeyScanScalar;
+	if( level == kFakeKeyScanAVX2 )
+		return FakeFindUInt32KeyAVX2( inKeys, inCount, inKey );
+	else if( level == kFakeKeyScanSSE2 )
+		return FakeFindUInt32KeySSE2( inKeys, inCount, inKey );
+#endif
+
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		if( inKeys[x] == inKey )
+			return x;
+	}
+	return inCount;
+}
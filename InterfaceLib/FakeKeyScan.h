@@ -0,0 +1,47 @@
+//
+//  FakeKeyScan.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Finds a key in an array of resource IDs or type codes, comparing 8 to 16
+//  of them at once where the CPU can (SSE2 or AVX2).
+//
+
+#ifndef ReClassicfication_FakeKeyScan_h
+#define ReClassicfication_FakeKeyScan_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+enum FakeKeyScanLevel
+{
+	kFakeKeyScanScalar = 0,	// One key at a time.
+	kFakeKeyScanSSE2,		// 16 bytes at a time.
+	kFakeKeyScanAVX2		// 32 bytes at a time.
+};
+
+
+// Private calls for internal use:
+
+// Index of the first key in inKeys that equals inKey, inCount if there is none:
+size_t	FakeFindInt16Key( const int16_t* inKeys, size_t inCount, int16_t inKey );
+
+size_t	FakeFindUInt32Key( const uint32_t* inKeys, size_t inCount, uint32_t inKey );
+
+// Use at most the given kind of instructions (e.g. to compare them in a
+//	benchmark). Returns the level actually used, which is lower if the CPU
+//	doesn't support the one requested. The default is the best one it supports.
+enum FakeKeyScanLevel	FakeSetKeyScanLevel( enum FakeKeyScanLevel inLevel );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
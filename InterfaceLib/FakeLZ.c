@@ -0,0 +1,174 @@
+//
+//  FakeLZ.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <string.h>
+#include "FakeLZ.h"
+
+
+/*
+	Compressed data is a list of sequences:
+	
+	token: literal count (high 4 bits), match length -4 (low 4 bits)	  1 byte
+	more literal count, if the high bits are 15							255s, then <255
+	literals															...
+	match offset (little endian, 1 = the byte before)					  2 bytes
+	more match length, if the low bits are 15							255s, then <255
+	
+	The last sequence ends after its literals.
+*/
+
+#define FAKE_LZ_MIN_MATCH			4
+#define FAKE_LZ_MAX_OFFSET			65535
+#define FAKE_LZ_HASH_BITS			12
+#define FAKE_LZ_LAST_LITERALS		5		// So we can always read 4 bytes where a match may start.
+
+
+static uint32_t	FakeLZRead32( const uint8_t* inData )
+{
+	uint32_t	value;
+	memmove( &value, inData, sizeof(value) );
+	return value;
+}
+
+
+static size_t	FakeLZHash( uint32_t inSequence )
+{
+	return (size_t)((inSequence * 2654435761u) >> (32 -FAKE_LZ_HASH_BITS));
+}
+
+
+// Writes a count that didn't fit in its 4 bits of the token:
+static bool	FakeLZWriteLength( size_t inLength, uint8_t* outData, size_t* ioOffset, size_t inCapacity )
+{
+	for( ; inLength >= 255; inLength -= 255 )
+	{
+		if( *ioOffset >= inCapacity )
+			return false;
+		outData[(*ioOffset)++] = 255;
+	}
+	if( *ioOffset >= inCapacity )
+		return false;
+	outData[(*ioOffset)++] = (uint8_t)inLength;
+	return true;
+}
+
+
+// Writes inNumLiterals literals and then a match, or only the literals if inMatchLength is 0:
+static bool	FakeLZWriteSequence( const uint8_t* inLiterals, size_t inNumLiterals, size_t inMatchOffset, size_t inMatchLength,
+									uint8_t* outData, size_t* ioOffset, size_t inCapacity )
+{
+	size_t	matchCode = (inMatchLength > 0) ? (inMatchLength -FAKE_LZ_MIN_MATCH) : 0;
+	if( *ioOffset >= inCapacity )
+		return false;
+	outData[(*ioOffset)++] = (uint8_t)(((inNumLiterals < 15) ? inNumLiterals : 15) << 4 | ((matchCode < 15) ? matchCode : 15));
+	if( inNumLiterals >= 15 && !FakeLZWriteLength( inNumLiterals -15, outData, ioOffset, inCapacity ) )
+		return false;
+	if( inNumLiterals > inCapacity -*ioOffset )
+		return false;
+	memmove( outData +*ioOffset, inLiterals, inNumLiterals );
+	*ioOffset += inNumLiterals;
+	if( inMatchLength == 0 )
+		return true;
+	
+	if( 2 > inCapacity -*ioOffset )
+		return false;
+	outData[(*ioOffset)++] = (uint8_t)inMatchOffset;
+	outData[(*ioOffset)++] = (uint8_t)(inMatchOffset >> 8);
+	return (matchCode < 15) || FakeLZWriteLength( matchCode -15, outData, ioOffset, inCapacity );
+}
+
+
+size_t	FakeLZCompress( const uint8_t* inData, size_t inLength, uint8_t* outData, size_t inCapacity )
+{
+	uint32_t	table[1 << FAKE_LZ_HASH_BITS] = { 0 };	// Where we last saw each hash of 4 bytes.
+	size_t		outLength = 0;
+	size_t		anchor = 0;		// Start of the literals not written yet.
+	size_t		currOffset = 0;
+	size_t		matchLimit = (inLength > FAKE_LZ_LAST_LITERALS) ? (inLength -FAKE_LZ_LAST_LITERALS) : 0;
+	
+	while( currOffset < matchLimit )
+	{
+		uint32_t	sequence = FakeLZRead32( inData +currOffset );
+		size_t		hash = FakeLZHash( sequence );
+		size_t		candidate = table[hash];
+		table[hash] = (uint32_t)currOffset;
+		if( candidate >= currOffset || (currOffset -candidate) > FAKE_LZ_MAX_OFFSET || FakeLZRead32( inData +candidate ) != sequence )
+		{
+			currOffset += 1 +((currOffset -anchor) >> 6);	// Skip ahead faster the longer we find nothing.
+			continue;
+		}
+		
+		size_t		matchLength = FAKE_LZ_MIN_MATCH;
+		while( (currOffset +matchLength) < inLength && inData[candidate +matchLength] == inData[currOffset +matchLength] )
+			matchLength++;
+		if( !FakeLZWriteSequence( inData +anchor, currOffset -anchor, currOffset -candidate, matchLength, outData, &outLength, inCapacity ) )
+			return 0;
+		currOffset += matchLength;
+		anchor = currOffset;
+	}
+	
+	if( !FakeLZWriteSequence( inData +anchor, inLength -anchor, 0, 0, outData, &outLength, inCapacity ) )
+		return 0;
+	return outLength;
+}
+
+
+// Reads a count that didn't fit in its 4 bits of the token:
+static bool	FakeLZReadLength( const uint8_t* inData, size_t inLength, size_t* ioOffset, size_t* ioCount )
+{
+	uint8_t		currByte = 255;
+	while( currByte == 255 )
+	{
+		if( *ioOffset >= inLength )
+			return false;
+		currByte = inData[(*ioOffset)++];
+		*ioCount += currByte;
+	}
+	return true;
+}
+
+
+bool	FakeLZDecompress( const uint8_t* inData, size_t inCompressedLength, uint8_t* outData, size_t inLength )
+{
+	size_t		inOffset = 0, outOffset = 0;
+	while( inOffset < inCompressedLength )
+	{
+		uint8_t		token = inData[inOffset++];
+		size_t		numLiterals = token >> 4;
+		if( numLiterals == 15 && !FakeLZReadLength( inData, inCompressedLength, &inOffset, &numLiterals ) )
+			return false;
+		if( numLiterals > (inCompressedLength -inOffset) || numLiterals > (inLength -outOffset) )
+			return false;
+		memmove( outData +outOffset, inData +inOffset, numLiterals );
+		inOffset += numLiterals;
+		outOffset += numLiterals;
+		if( inOffset == inCompressedLength )
+			break;	// Last sequence.
+		
+		if( (inCompressedLength -inOffset) < 2 )
+			return false;
+		size_t		matchOffset = inData[inOffset] | ((size_t)inData[inOffset +1] << 8);
+		size_t		matchLength = (token & 15);
+		inOffset += 2;
+		if( matchLength == 15 && !FakeLZReadLength( inData, inCompressedLength, &inOffset, &matchLength ) )
+			return false;
+		matchLength += FAKE_LZ_MIN_MATCH;
+		if( matchOffset == 0 || matchOffset > outOffset || matchLength > (inLength -outOffset) )
+			return false;
+		
+		const uint8_t*	matchStart = outData +outOffset -matchOffset;
+		if( matchOffset >= matchLength )
+			memcpy( outData +outOffset, matchStart, matchLength );
+		else
+		{
+			for( size_t x = 0; x < matchLength; x++ )	// Overlaps what it writes, e.g. runs of the same byte.
+				outData[outOffset +x] = matchStart[x];
+		}
+		outOffset += matchLength;
+	}
+	return outOffset == inLength;
+}
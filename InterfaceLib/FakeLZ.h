@@ -0,0 +1,39 @@
+//
+//  FakeLZ.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  A small, fast LZ77 codec for keeping data compressed in RAM, see
+//  FakeSetResourceCacheCompression(). Favors speed over size, and isn't any
+//  format the Mac or its files use.
+//
+
+#ifndef ReClassicfication_FakeLZ_h
+#define ReClassicfication_FakeLZ_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+// Private calls for internal use:
+
+// Compresses inLength bytes into outData. Returns the compressed length, or 0
+//	if it would take more than inCapacity bytes. Touches no globals.
+size_t		FakeLZCompress( const uint8_t* inData, size_t inLength, uint8_t* outData, size_t inCapacity );
+
+// Decompresses what FakeLZCompress() made back into exactly inLength bytes.
+//	Returns false if the data is damaged. Touches no globals.
+bool		FakeLZDecompress( const uint8_t* inData, size_t inCompressedLength, uint8_t* outData, size_t inLength );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
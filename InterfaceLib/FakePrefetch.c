@@ -0,0 +1,215 @@
+//
+//  FakePrefetch.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "FakePrefetch.h"
+#include "FakeResources.h"
+#include "FakeTrace.h"
+#include "EndianStuff.h"
+
+
+enum FakePrefetchItemState
+{
+	kFakePrefetchItemQueued = 0,
+	kFakePrefetchItemReading,
+	kFakePrefetchItemDone,
+	kFakePrefetchItemClaimed	// Caller took the data or will read it itself.
+};
+
+
+struct FakePrefetchItem
+{
+	uint64_t						offset;
+	uint32_t						extent;
+	enum FakePrefetchItemState		state;
+	int16_t							error;
+	char*							data;
+	uint32_t						length;
+};
+
+
+struct FakePrefetchJob
+{
+	pthread_t						thread;
+	pthread_mutex_t					lock;
+	pthread_cond_t					itemDone;
+	bool							stop;
+	int								fd;
+	uint64_t						readLimit;
+	size_t							count;
+	struct FakePrefetchItem*		items;
+};
+
+
+// Largest resource we try to read along with its length field in one go:
+#define FAKE_PREFETCH_MAX_SINGLE_READ	(1024 * 1024)
+
+
+// Read one resource's data into a new buffer. Only uses pread(), so doesn't need the lock:
+static int16_t	FakePrefetchReadItem( struct FakePrefetchJob* inJob, struct FakePrefetchItem* inItem, char** outData, uint32_t* outLength )
+{
+	uint32_t	dataLength = 0;
+	uint64_t	extentEnd = (uint64_t)inItem->offset +inItem->extent;
+	if( extentEnd > inJob->readLimit )
+		extentEnd = inJob->readLimit;
+	
+	// Usually the extent is exactly length field plus data, so read both at once:
+	if( extentEnd >= ((uint64_t)inItem->offset +sizeof(dataLength)) && (extentEnd -inItem->offset) <= FAKE_PREFETCH_MAX_SINGLE_READ )
+	{
+		size_t	readSize = (size_t)(extentEnd -inItem->offset);
+		char*	theData = malloc( readSize );
+		if( !theData )
+			return memFulErr;
+		ssize_t	amountRead = pread( inJob->fd, theData, readSize, inItem->offset );
+		FAKE_TRACE_EVENT( kFakeTraceBytesRead, .offset = inItem->offset, .byteCount = amountRead );
+		if( amountRead >= (ssize_t)sizeof(dataLength) )
+		{
+			memmove( &dataLength, theData, sizeof(dataLength) );
+			dataLength = BIG_ENDIAN_32(dataLength);
+			if( ((uint64_t)dataLength +sizeof(dataLength)) <= (uint64_t)amountRead )
+			{
+				memmove( theData, theData +sizeof(dataLength), dataLength );
+				char*	shrunkData = realloc( theData, dataLength ? dataLength : 1 );
+				*outData = shrunkData ? shrunkData : theData;
+				*outLength = dataLength;
+				return noErr;
+			}
+		}
+		free( theData );
+	}
+	
+	// Otherwise read the length first, then the data:
+	if( ((uint64_t)inItem->offset +sizeof(dataLength)) > inJob->readLimit
+		|| pread( inJob->fd, &dataLength, sizeof(dataLength), inItem->offset ) != sizeof(dataLength) )
+		return eofErr;
+	dataLength = BIG_ENDIAN_32(dataLength);
+	if( ((uint64_t)inItem->offset +sizeof(dataLength) +dataLength) > inJob->readLimit )
+		return eofErr;
+	
+	char*	theData = malloc( dataLength ? dataLength : 1 );
+	if( !theData )
+		return memFulErr;
+	ssize_t	amountRead = (dataLength > 0) ? pread( inJob->fd, theData, dataLength, inItem->offset +sizeof(dataLength) ) : 0;
+	FAKE_TRACE_EVENT( kFakeTraceBytesRead, .offset = inItem->offset, .byteCount = amountRead +sizeof(dataLength) );
+	if( amountRead != (ssize_t)dataLength )
+	{
+		free( theData );
+		return eofErr;
+	}
+	
+	*outData = theData;
+	*outLength = dataLength;
+	return noErr;
+}
+
+
+static void*	FakePrefetchThread( void* inJob )
+{
+	struct FakePrefetchJob*	theJob = inJob;
+	
+	pthread_mutex_lock( &theJob->lock );
+	for( size_t x = 0; x < theJob->count && !theJob->stop; x++ )
+	{
+		struct FakePrefetchItem*	currItem = theJob->items +x;
+		if( currItem->state != kFakePrefetchItemQueued )
+			continue;
+		currItem->state = kFakePrefetchItemReading;
+		pthread_mutex_unlock( &theJob->lock );
+		
+		char*		theData = NULL;
+		uint32_t	theLength = 0;
+		int16_t		err = FakePrefetchReadItem( theJob, currItem, &theData, &theLength );
+		
+		pthread_mutex_lock( &theJob->lock );
+		currItem->data = theData;
+		currItem->length = theLength;
+		currItem->error = err;
+		currItem->state = kFakePrefetchItemDone;
+		pthread_cond_broadcast( &theJob->itemDone );
+	}
+	pthread_mutex_unlock( &theJob->lock );
+	
+	return NULL;
+}
+
+
+struct FakePrefetchJob*	FakeStartPrefetch( int inFD, uint64_t inReadLimit, const uint64_t* inOffsets, const uint32_t* inExtents, size_t inCount )
+{
+	struct FakePrefetchJob*	theJob = calloc( 1, sizeof(struct FakePrefetchJob) );
+	if( !theJob )
+		return NULL;
+	theJob->items = calloc( inCount +1, sizeof(struct FakePrefetchItem) );
+	if( !theJob->items )
+	{
+		free( theJob );
+		return NULL;
+	}
+	theJob->fd = inFD;
+	theJob->readLimit = inReadLimit;
+	theJob->count = inCount;
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		theJob->items[x].offset = inOffsets[x];
+		theJob->items[x].extent = inExtents[x];
+	}
+	pthread_mutex_init( &theJob->lock, NULL );
+	pthread_cond_init( &theJob->itemDone, NULL );
+	
+	if( pthread_create( &theJob->thread, NULL, FakePrefetchThread, theJob ) != 0 )
+	{
+		pthread_cond_destroy( &theJob->itemDone );
+		pthread_mutex_destroy( &theJob->lock );
+		free( theJob->items );
+		free( theJob );
+		return NULL;
+	}
+	
+	return theJob;
+}
+
+
+enum FakePrefetchClaim	FakeClaimPrefetchedData( struct FakePrefetchJob* inJob, size_t inIndex, char** outData, uint32_t* outLength, int16_t* outError )
+{
+	enum FakePrefetchClaim		result = kFakePrefetchNotRead;
+	struct FakePrefetchItem*	theItem = inJob->items +inIndex;
+	
+	pthread_mutex_lock( &inJob->lock );
+	while( theItem->state == kFakePrefetchItemReading )	// Don't read it a second time, wait for the thread.
+		pthread_cond_wait( &inJob->itemDone, &inJob->lock );
+	if( theItem->state == kFakePrefetchItemDone )
+	{
+		result = (theItem->error == noErr) ? kFakePrefetchRead : kFakePrefetchFailed;
+		*outData = theItem->data;
+		*outLength = theItem->length;
+		*outError = theItem->error;
+		theItem->data = NULL;
+	}
+	theItem->state = kFakePrefetchItemClaimed;
+	pthread_mutex_unlock( &inJob->lock );
+	
+	return result;
+}
+
+
+void	FakeStopPrefetch( struct FakePrefetchJob* inJob )
+{
+	pthread_mutex_lock( &inJob->lock );
+	inJob->stop = true;
+	pthread_mutex_unlock( &inJob->lock );
+	pthread_join( inJob->thread, NULL );
+	
+	for( size_t x = 0; x < inJob->count; x++ )
+		free( inJob->items[x].data );
+	pthread_cond_destroy( &inJob->itemDone );
+	pthread_mutex_destroy( &inJob->lock );
+	free( inJob->items );
+	free( inJob );
+}
@@ -0,0 +1,57 @@
+//
+//  FakePrefetch.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Reads a list of resources' data from a file on a background thread, so it
+//  is already in RAM when the application asks for it. The thread only fills
+//  buffers of its own, the thread making Resource Manager calls claims them
+//  and puts the data into the resources' Handles.
+//
+
+#ifndef ReClassicfication_FakePrefetch_h
+#define ReClassicfication_FakePrefetch_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+struct FakePrefetchJob;
+
+
+// What FakeClaimPrefetchedData() found:
+enum FakePrefetchClaim
+{
+	kFakePrefetchNotRead = 0,	// The thread hadn't got to it, read it yourself. It won't read it anymore.
+	kFakePrefetchRead,			// Here's the data.
+	kFakePrefetchFailed			// The thread couldn't read it, see the error.
+};
+
+
+// Private calls for internal use:
+
+// Starts reading the resource data whose length fields are at the given
+//	offsets, in the given order. inExtents are the bytes each may occupy, as
+//	in FakeReferenceListEntry. Nothing at or after inReadLimit is read.
+//	Returns NULL if the thread couldn't be started.
+struct FakePrefetchJob*	FakeStartPrefetch( int inFD, uint64_t inReadLimit, const uint64_t* inOffsets, const uint32_t* inExtents, size_t inCount );
+
+// Takes the data for item inIndex off the job. If the thread is reading it
+//	right now, waits for it to finish. On kFakePrefetchRead, you get a malloc()ed
+//	block of *outLength bytes that you need to free.
+enum FakePrefetchClaim	FakeClaimPrefetchedData( struct FakePrefetchJob* inJob, size_t inIndex, char** outData, uint32_t* outLength, int16_t* outError );
+
+// Tells the thread to stop, waits for it, and frees everything that wasn't claimed:
+void	FakeStopPrefetch( struct FakePrefetchJob* inJob );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
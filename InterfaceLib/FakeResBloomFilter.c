@@ -0,0 +1,99 @@
+//
+//  FakeResBloomFilter.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <stdlib.h>
+#include "FakeResBloomFilter.h"
+
+
+// All bits of one pair go in the same 64 bit word, so a lookup only reads
+//	one word. With 16 bits per pair, about 1 in 100 missing pairs says "may be":
+#define FAKE_BLOOM_BITS_PER_KEY		16
+#define FAKE_BLOOM_BITS_SET			4
+
+
+struct FakeResBloomFilter
+{
+	uint64_t*	words;
+	size_t		wordMask;			// Number of words -1, which is a power of 2.
+	size_t		maxKeys;
+	size_t		numKeys;			// Added so far, including removed ones.
+	size_t		numRemovedKeys;
+};
+
+
+static uint64_t	FakeResBloomFilterHash( uint32_t inType, int16_t inID )
+{
+	uint64_t	hash = ((uint64_t)inType << 16) | (uint16_t)inID;
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+	hash *= 0xC4CEB9FE1A85EC53ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+
+// The bits of one pair in its word, picked from the hash bits not used for the word's index:
+static uint64_t	FakeResBloomFilterBits( uint64_t inHash )
+{
+	uint64_t	bits = 0;
+	for( int x = 0; x < FAKE_BLOOM_BITS_SET; x++ )
+		bits |= (uint64_t)1 << ((inHash >> (40 +x * 6)) & 63);
+	return bits;
+}
+
+
+struct FakeResBloomFilter*	FakeNewResBloomFilter( size_t inMaxKeys )
+{
+	size_t		numWords = 1;
+	while( (numWords * 64) < (inMaxKeys * FAKE_BLOOM_BITS_PER_KEY) && numWords < ((size_t)1 << 40) )
+		numWords *= 2;
+	
+	struct FakeResBloomFilter*	theFilter = calloc( 1, sizeof(struct FakeResBloomFilter) );
+	if( !theFilter )
+		return NULL;
+	theFilter->words = calloc( numWords, sizeof(uint64_t) );
+	if( !theFilter->words )
+	{
+		free( theFilter );
+		return NULL;
+	}
+	theFilter->wordMask = numWords -1;
+	theFilter->maxKeys = inMaxKeys;
+	return theFilter;
+}
+
+
+void	FakeDisposeResBloomFilter( struct FakeResBloomFilter* inFilter )
+{
+	if( !inFilter )
+		return;
+	free( inFilter->words );
+	free( inFilter );
+}
+
+
+bool	FakeResBloomFilterAdd( struct FakeResBloomFilter* inFilter, uint32_t inType, int16_t inID )
+{
+	uint64_t	hash = FakeResBloomFilterHash( inType, inID );
+	inFilter->words[hash & inFilter->wordMask] |= FakeResBloomFilterBits( hash );
+	return( ++inFilter->numKeys <= inFilter->maxKeys );
+}
+
+
+bool	FakeResBloomFilterNoteRemoved( struct FakeResBloomFilter* inFilter )
+{
+	return( ++inFilter->numRemovedKeys <= (inFilter->numKeys / 2) );
+}
+
+
+bool	FakeResBloomFilterMayContain( const struct FakeResBloomFilter* inFilter, uint32_t inType, int16_t inID )
+{
+	uint64_t	hash = FakeResBloomFilterHash( inType, inID );
+	uint64_t	bits = FakeResBloomFilterBits( hash );
+	return( (inFilter->words[hash & inFilter->wordMask] & bits) == bits );
+}
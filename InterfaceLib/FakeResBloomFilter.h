@@ -0,0 +1,52 @@
+//
+//  FakeResBloomFilter.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Which (type, ID) pairs a resource map has, roughly: if the filter says a
+//  pair isn't there, it isn't, if it says it may be, it usually is. Lets a
+//  lookup that goes through all open files skip most of those that don't
+//  have the resource with one memory access, instead of searching them.
+//
+
+#ifndef ReClassicfication_FakeResBloomFilter_h
+#define ReClassicfication_FakeResBloomFilter_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+struct FakeResBloomFilter;
+
+
+// Private calls for internal use:
+
+// Returns NULL if there isn't enough memory. inMaxKeys is how many pairs
+//	you'll add at most, including ones you add later.
+struct FakeResBloomFilter*	FakeNewResBloomFilter( size_t inMaxKeys );
+
+void	FakeDisposeResBloomFilter( struct FakeResBloomFilter* inFilter );
+
+// Returns false if more pairs were added than the filter was made for, so
+//	it says "may be" too often now and should be made again, larger.
+bool	FakeResBloomFilterAdd( struct FakeResBloomFilter* inFilter, uint32_t inType, int16_t inID );
+
+// Pairs can't be taken out of a Bloom filter, they keep saying "may be".
+//	Call this when one goes away anyway. Returns false once so many have
+//	gone that the filter should be made again.
+bool	FakeResBloomFilterNoteRemoved( struct FakeResBloomFilter* inFilter );
+
+bool	FakeResBloomFilterMayContain( const struct FakeResBloomFilter* inFilter, uint32_t inType, int16_t inID );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,276 @@
+//
+//  FakeResIDIndex.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResIDIndex.h"
+
+
+#define FAKE_REMOVED_ENTRY		UINT16_MAX	// Resource lists never have that many entries.
+#define FAKE_NUM_ID_WORDS		(65536 / 64)
+
+
+// One resource. Sorted by ID, then by entryIndex:
+struct FakeResIDIndexPair
+{
+	int16_t		id;
+	uint16_t	entryIndex;		// FAKE_REMOVED_ENTRY once removed, skipped until we squeeze them out.
+};
+
+
+struct FakeResIDIndex
+{
+	struct FakeResIDIndexPair*	pairs;
+	size_t						numPairs;
+	size_t						maxPairs;
+	size_t						numRemoved;
+	bool						hasSearchStart;
+	int16_t						searchStart;
+	uint64_t					used[FAKE_NUM_ID_WORDS];	// One bit per ID, indexed by (uint16_t)ID.
+};
+
+
+static void	FakeResIDIndexSetUsed( struct FakeResIDIndex* inIndex, int16_t inID, bool inUsed )
+{
+	uint16_t	bit = (uint16_t)inID;
+	if( inUsed )
+		inIndex->used[bit >> 6] |= (uint64_t)1 << (bit & 63);
+	else
+		inIndex->used[bit >> 6] &= ~((uint64_t)1 << (bit & 63));
+}
+
+
+// Index of the first pair with an ID of at least inID:
+static size_t	FakeResIDIndexLowerBound( const struct FakeResIDIndex* inIndex, int16_t inID )
+{
+	size_t	low = 0, high = inIndex->numPairs;
+	while( low < high )
+	{
+		size_t	middle = low +(high -low) / 2;
+		if( inIndex->pairs[middle].id < inID )
+			low = middle +1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+
+static bool	FakeResIDIndexReserve( struct FakeResIDIndex* inIndex, size_t inCount )
+{
+	if( (inIndex->numPairs +inCount) <= inIndex->maxPairs )
+		return true;
+
+	size_t	newMaxPairs = inIndex->maxPairs +inIndex->maxPairs / 2;
+	if( newMaxPairs < (inIndex->numPairs +inCount) )
+		newMaxPairs = inIndex->numPairs +inCount +8;
+	struct FakeResIDIndexPair*	newPairs = realloc( inIndex->pairs, newMaxPairs * sizeof(struct FakeResIDIndexPair) );
+	if( !newPairs )
+		return false;
+	inIndex->pairs = newPairs;
+	inIndex->maxPairs = newMaxPairs;
+	return true;
+}
+
+
+// Moves the pairs together over those of removed resources:
+static void	FakeResIDIndexSqueeze( struct FakeResIDIndex* inIndex )
+{
+	size_t	numPairs = 0;
+	for( size_t x = 0; x < inIndex->numPairs; x++ )
+	{
+		if( inIndex->pairs[x].entryIndex != FAKE_REMOVED_ENTRY )
+			inIndex->pairs[numPairs++] = inIndex->pairs[x];
+	}
+	inIndex->numPairs = numPairs;
+	inIndex->numRemoved = 0;
+}
+
+
+struct FakeResIDIndex*	FakeNewResIDIndex( size_t inExpectedCount )
+{
+	struct FakeResIDIndex*	newIndex = calloc( 1, sizeof(struct FakeResIDIndex) );
+	if( !newIndex || !FakeResIDIndexReserve( newIndex, inExpectedCount ) )
+	{
+		free( newIndex );
+		return NULL;
+	}
+
+	return newIndex;
+}
+
+
+void	FakeDisposeResIDIndex( struct FakeResIDIndex* inIndex )
+{
+	if( !inIndex )
+		return;
+	free( inIndex->pairs );
+	free( inIndex );
+}
+
+
+bool	FakeResIDIndexAppend( struct FakeResIDIndex* inIndex, int16_t inID, uint16_t inEntryIndex )
+{
+	if( !FakeResIDIndexReserve( inIndex, 1 ) )
+		return false;
+	inIndex->pairs[inIndex->numPairs].id = inID;
+	inIndex->pairs[inIndex->numPairs].entryIndex = inEntryIndex;
+	inIndex->numPairs++;
+	FakeResIDIndexSetUsed( inIndex, inID, true );
+	return true;
+}
+
+
+static int	FakeCompareResIDIndexPairs( const void* inA, const void* inB )
+{
+	const struct FakeResIDIndexPair*	a = inA;
+	const struct FakeResIDIndexPair*	b = inB;
+	if( a->id != b->id )
+		return (a->id < b->id) ? -1 : 1;
+	return (a->entryIndex < b->entryIndex) ? -1 : ((a->entryIndex > b->entryIndex) ? 1 : 0);
+}
+
+
+void	FakeResIDIndexSort( struct FakeResIDIndex* inIndex )
+{
+	qsort( inIndex->pairs, inIndex->numPairs, sizeof(struct FakeResIDIndexPair), FakeCompareResIDIndexPairs );
+}
+
+
+bool	FakeResIDIndexInsert( struct FakeResIDIndex* inIndex, int16_t inID, uint16_t inEntryIndex )
+{
+	if( !FakeResIDIndexReserve( inIndex, 1 ) )
+		return false;
+
+	// After all others with that ID, as its entry comes after theirs:
+	size_t	insertPos = inIndex->numPairs;
+	if( insertPos > 0 && inIndex->pairs[insertPos -1].id > inID )
+	{
+		insertPos = (inID < INT16_MAX) ? FakeResIDIndexLowerBound( inIndex, inID +1 ) : inIndex->numPairs;
+		memmove( inIndex->pairs +insertPos +1, inIndex->pairs +insertPos, (inIndex->numPairs -insertPos) * sizeof(struct FakeResIDIndexPair) );
+	}
+	inIndex->pairs[insertPos].id = inID;
+	inIndex->pairs[insertPos].entryIndex = inEntryIndex;
+	inIndex->numPairs++;
+	FakeResIDIndexSetUsed( inIndex, inID, true );
+	return true;
+}
+
+
+void	FakeResIDIndexRemove( struct FakeResIDIndex* inIndex, int16_t inID, uint16_t inEntryIndex )
+{
+	bool	otherWithID = false;
+	for( size_t x = FakeResIDIndexLowerBound( inIndex, inID ); x < inIndex->numPairs && inIndex->pairs[x].id == inID; x++ )
+	{
+		if( inIndex->pairs[x].entryIndex == inEntryIndex )
+		{
+			inIndex->pairs[x].entryIndex = FAKE_REMOVED_ENTRY;
+			inIndex->numRemoved++;
+		}
+		else if( inIndex->pairs[x].entryIndex != FAKE_REMOVED_ENTRY )
+			otherWithID = true;
+	}
+	if( !otherWithID )
+		FakeResIDIndexSetUsed( inIndex, inID, false );
+
+	if( inIndex->numRemoved > (inIndex->numPairs -inIndex->numRemoved) )
+		FakeResIDIndexSqueeze( inIndex );
+}
+
+
+void	FakeResIDIndexRenumber( struct FakeResIDIndex* inIndex, const uint16_t* inNewEntryIndexes )
+{
+	FakeResIDIndexSqueeze( inIndex );
+	for( size_t x = 0; x < inIndex->numPairs; x++ )
+		inIndex->pairs[x].entryIndex = inNewEntryIndexes[inIndex->pairs[x].entryIndex];
+}
+
+
+void	FakeResIDIndexMarkUsed( struct FakeResIDIndex* inIndex, int16_t inID )
+{
+	FakeResIDIndexSetUsed( inIndex, inID, true );
+}
+
+
+bool	FakeResIDIndexFind( const struct FakeResIDIndex* inIndex, int16_t inID, uint16_t* outEntryIndex )
+{
+	for( size_t x = FakeResIDIndexLowerBound( inIndex, inID ); x < inIndex->numPairs && inIndex->pairs[x].id == inID; x++ )
+	{
+		if( inIndex->pairs[x].entryIndex != FAKE_REMOVED_ENTRY )
+		{
+			*outEntryIndex = inIndex->pairs[x].entryIndex;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+size_t	FakeResIDIndexCopyRange( const struct FakeResIDIndex* inIndex, int16_t inFirstID, int16_t inLastID, uint16_t* outEntryIndexes, size_t inMaxCount )
+{
+	size_t	numFound = 0;
+	for( size_t x = FakeResIDIndexLowerBound( inIndex, inFirstID ); x < inIndex->numPairs && inIndex->pairs[x].id <= inLastID; x++ )
+	{
+		if( inIndex->pairs[x].entryIndex == FAKE_REMOVED_ENTRY )
+			continue;
+		if( numFound < inMaxCount )
+			outEntryIndexes[numFound] = inIndex->pairs[x].entryIndex;
+		numFound++;
+	}
+
+	return numFound;
+}
+
+
+// Looks from inFirstID through inLastID, 64 IDs at a time:
+static bool	FakeFindUnusedResIDInRange( struct FakeResIDIndex* const* inIndexes, size_t inCount, int32_t inFirstID, int32_t inLastID, int16_t* outID )
+{
+	for( int32_t currID = inFirstID; currID <= inLastID; )
+	{
+		uint16_t	bit = (uint16_t)currID;	// Words never span 0, as 65536 is a multiple of 64.
+		int32_t		wordStartID = currID -(bit & 63);
+		uint64_t	used = ((uint64_t)1 << (bit & 63)) -1;	// Ignore the IDs before currID.
+		for( size_t x = 0; x < inCount; x++ )
+		{
+			if( inIndexes[x] )
+				used |= inIndexes[x]->used[bit >> 6];
+		}
+		if( (wordStartID +63) > inLastID )
+			used |= ~(uint64_t)0 << (inLastID -wordStartID +1);	// Ignore the IDs after inLastID.
+		if( used != ~(uint64_t)0 )
+		{
+			*outID = (int16_t)(wordStartID +__builtin_ctzll( ~used ));
+			return true;
+		}
+		currID = wordStartID +64;
+	}
+
+	return false;
+}
+
+
+bool	FakeFindUnusedResID( struct FakeResIDIndex* const* inIndexes, size_t inCount, int16_t inFirstID, int16_t inLastID, int16_t inStartID, int16_t* outID )
+{
+	if( inStartID < inFirstID || inStartID > inLastID )
+		inStartID = inFirstID;
+	return FakeFindUnusedResIDInRange( inIndexes, inCount, inStartID, inLastID, outID )
+			|| FakeFindUnusedResIDInRange( inIndexes, inCount, inFirstID, (int32_t)inStartID -1, outID );
+}
+
+
+int16_t	FakeResIDIndexGetSearchStart( const struct FakeResIDIndex* inIndex, int16_t inDefault )
+{
+	return inIndex->hasSearchStart ? inIndex->searchStart : inDefault;
+}
+
+
+void	FakeResIDIndexSetSearchStart( struct FakeResIDIndex* inIndex, int16_t inID )
+{
+	inIndex->hasSearchStart = true;
+	inIndex->searchStart = inID;
+}
@@ -0,0 +1,79 @@
+//
+//  FakeResIDIndex.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  The resources of one type in a resource map, sorted by ID, plus which of
+//  the 65536 possible IDs are in use, so we can look up IDs, list the ones
+//  in a range and find unused ones without looking at every resource.
+//
+
+#ifndef ReClassicfication_FakeResIDIndex_h
+#define ReClassicfication_FakeResIDIndex_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+struct FakeResIDIndex;
+
+
+// Private calls for internal use:
+
+// Returns NULL if there isn't enough memory. inExpectedCount is how many
+//	resources you're about to add, so it doesn't have to grow for them.
+struct FakeResIDIndex*	FakeNewResIDIndex( size_t inExpectedCount );
+
+void	FakeDisposeResIDIndex( struct FakeResIDIndex* inIndex );
+
+// To fill a new index: FakeResIDIndexAppend() each resource in any order,
+//	then FakeResIDIndexSort() once. Append returns false if there isn't enough
+//	memory, in which case the index must be thrown away.
+bool	FakeResIDIndexAppend( struct FakeResIDIndex* inIndex, int16_t inID, uint16_t inEntryIndex );
+
+void	FakeResIDIndexSort( struct FakeResIDIndex* inIndex );
+
+// Add one resource to a sorted index. inEntryIndex must be higher than that
+//	of all resources already in it. Returns false if there isn't enough memory,
+//	in which case the index must be thrown away.
+bool	FakeResIDIndexInsert( struct FakeResIDIndex* inIndex, int16_t inID, uint16_t inEntryIndex );
+
+void	FakeResIDIndexRemove( struct FakeResIDIndex* inIndex, int16_t inID, uint16_t inEntryIndex );
+
+// The entries of the resources have been moved, the one that was at index x
+//	is at inNewEntryIndexes[x] now. Resources that were removed are ignored.
+void	FakeResIDIndexRenumber( struct FakeResIDIndex* inIndex, const uint16_t* inNewEntryIndexes );
+
+// Note the ID as taken even though no resource has it (yet):
+void	FakeResIDIndexMarkUsed( struct FakeResIDIndex* inIndex, int16_t inID );
+
+// The entry of the first resource with that ID. Returns false if there is none:
+bool	FakeResIDIndexFind( const struct FakeResIDIndex* inIndex, int16_t inID, uint16_t* outEntryIndex );
+
+// Copies the entry indexes of the resources with IDs from inFirstID through
+//	inLastID, by ascending ID, until outEntryIndexes has inMaxCount. Returns how
+//	many there are in total, even if that's more than inMaxCount.
+size_t	FakeResIDIndexCopyRange( const struct FakeResIDIndex* inIndex, int16_t inFirstID, int16_t inLastID, uint16_t* outEntryIndexes, size_t inMaxCount );
+
+// Finds an ID from inFirstID through inLastID that none of the given indexes
+//	(which may include NULLs) use. Starts looking at inStartID, going up and
+//	wrapping around to inFirstID. Returns false if all are used.
+bool	FakeFindUnusedResID( struct FakeResIDIndex* const* inIndexes, size_t inCount, int16_t inFirstID, int16_t inLastID, int16_t inStartID, int16_t* outID );
+
+// Where FakeFindUnusedResID() should start for this index next time. Starts out as inDefault.
+int16_t	FakeResIDIndexGetSearchStart( const struct FakeResIDIndex* inIndex, int16_t inDefault );
+
+void	FakeResIDIndexSetSearchStart( struct FakeResIDIndex* inIndex, int16_t inID );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,434 @@
+//
+//  FakeResourceCache.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "FakeResourceCache.h"
+#include "FakeLZ.h"
+#include "FakeTrace.h"
+
+
+#define FAKE_CACHE_NO_NODE		-1
+
+// Smaller data isn't worth compressing, and compressed data must be at least
+//	this fraction smaller than it was to be worth decompressing later:
+#define FAKE_CACHE_MIN_COMPRESS_SIZE		256
+#define FAKE_CACHE_MIN_COMPRESS_SAVINGS		8		// 1/8th.
+
+
+// One resource Handle in the cache. Nodes are linked from most to least recently used:
+struct FakeCacheNode
+{
+	Handle		handle;
+	uint64_t	size;			// What we counted in gFakeCacheStats.bytesCached for this one.
+	bool		purgeable;		// resPurgeable resources go first.
+	bool		incompressible;	// Compressing it didn't save enough, don't try again until it changes.
+	int32_t		newer;
+	int32_t		older;
+	double		lastUsed;		// When it was added or requested, if gFakeCacheColdSeconds isn't 0.
+	uint8_t*	compressed;		// The Handle's data while it's empty, see FakeSetResourceCacheCompression(). NULL if not compressed.
+	uint64_t	originalSize;	// Of the data before it was compressed.
+};
+
+
+struct FakeCacheNode*			gFakeCacheNodes = NULL;
+int32_t							gFakeCacheNumNodes = 0;		// Used and free nodes.
+int32_t							gFakeCacheFreeNode = FAKE_CACHE_NO_NODE;	// Free nodes are linked through 'older'.
+int32_t							gFakeCacheNewest = FAKE_CACHE_NO_NODE;
+int32_t							gFakeCacheOldest = FAKE_CACHE_NO_NODE;
+int32_t*						gFakeCacheTable = NULL;		// Open-addressed hash table of node indexes, keyed by Handle.
+size_t							gFakeCacheTableSize = 0;	// Power of 2.
+uint64_t						gFakeCacheBudget = 0;		// 0 means no limit.
+int								gFakeCacheSuspendCount = 0;
+struct FakeResourceCacheStats	gFakeCacheStats = {0};
+double							gFakeCacheColdSeconds = 0;	// FakeSetResourceCacheCompression(), 0 if off.
+double							gFakeCacheNextColdScan = 0;	// Don't look for cold data again before then.
+
+
+static size_t	FakeCacheHash( Handle inHandle )
+{
+	uintptr_t	theKey = (uintptr_t)inHandle;
+	theKey ^= theKey >> 17;
+	theKey *= (uintptr_t)0x9E3779B97F4A7C15ULL;
+	return (size_t)(theKey ^ (theKey >> 29));
+}
+
+
+// Returns the table slot for inHandle, or the empty slot where it would go:
+static size_t	FakeCacheFindSlot( Handle inHandle )
+{
+	size_t	mask = gFakeCacheTableSize -1;
+	size_t	slot = FakeCacheHash( inHandle ) & mask;
+	while( gFakeCacheTable[slot] != FAKE_CACHE_NO_NODE && gFakeCacheNodes[gFakeCacheTable[slot]].handle != inHandle )
+		slot = (slot +1) & mask;
+	return slot;
+}
+
+
+static bool	FakeCacheGrowTable( void )
+{
+	size_t		newSize = gFakeCacheTableSize ? (gFakeCacheTableSize * 2) : 1024;
+	int32_t*	newTable = malloc( newSize * sizeof(int32_t) );
+	if( !newTable )
+		return false;
+	for( size_t x = 0; x < newSize; x++ )
+		newTable[x] = FAKE_CACHE_NO_NODE;
+	
+	int32_t*	oldTable = gFakeCacheTable;
+	size_t		oldSize = gFakeCacheTableSize;
+	gFakeCacheTable = newTable;
+	gFakeCacheTableSize = newSize;
+	for( size_t x = 0; x < oldSize; x++ )
+	{
+		if( oldTable[x] != FAKE_CACHE_NO_NODE )
+			gFakeCacheTable[FakeCacheFindSlot( gFakeCacheNodes[oldTable[x]].handle )] = oldTable[x];
+	}
+	free( oldTable );
+	
+	return true;
+}
+
+
+// Remove the entry at inSlot, moving later entries of the same probe sequence
+//	back so lookups don't need tombstones:
+static void	FakeCacheClearSlot( size_t inSlot )
+{
+	size_t	mask = gFakeCacheTableSize -1;
+	size_t	hole = inSlot;
+	size_t	slot = inSlot;
+	gFakeCacheTable[hole] = FAKE_CACHE_NO_NODE;
+	while( true )
+	{
+		slot = (slot +1) & mask;
+		if( gFakeCacheTable[slot] == FAKE_CACHE_NO_NODE )
+			break;
+		size_t	home = FakeCacheHash( gFakeCacheNodes[gFakeCacheTable[slot]].handle ) & mask;
+		if( ((slot -home) & mask) >= ((slot -hole) & mask) )	// Would still be found if moved into the hole?
+		{
+			gFakeCacheTable[hole] = gFakeCacheTable[slot];
+			gFakeCacheTable[slot] = FAKE_CACHE_NO_NODE;
+			hole = slot;
+		}
+	}
+}
+
+
+static void	FakeCacheUnlinkNode( int32_t inNode )
+{
+	struct FakeCacheNode*	theNode = gFakeCacheNodes +inNode;
+	if( theNode->newer != FAKE_CACHE_NO_NODE )
+		gFakeCacheNodes[theNode->newer].older = theNode->older;
+	else
+		gFakeCacheNewest = theNode->older;
+	if( theNode->older != FAKE_CACHE_NO_NODE )
+		gFakeCacheNodes[theNode->older].newer = theNode->newer;
+	else
+		gFakeCacheOldest = theNode->newer;
+}
+
+
+static void	FakeCacheLinkNodeAsNewest( int32_t inNode )
+{
+	struct FakeCacheNode*	theNode = gFakeCacheNodes +inNode;
+	theNode->newer = FAKE_CACHE_NO_NODE;
+	theNode->older = gFakeCacheNewest;
+	if( gFakeCacheNewest != FAKE_CACHE_NO_NODE )
+		gFakeCacheNodes[gFakeCacheNewest].newer = inNode;
+	gFakeCacheNewest = inNode;
+	if( gFakeCacheOldest == FAKE_CACHE_NO_NODE )
+		gFakeCacheOldest = inNode;
+}
+
+
+// Forget a node's compressed data, e.g. because the Handle has data again:
+static void	FakeCacheDropCompressed( struct FakeCacheNode* inNode )
+{
+	if( !inNode->compressed )
+		return;
+	gFakeCacheStats.numCompressed--;
+	gFakeCacheStats.bytesBeforeCompression -= inNode->originalSize;
+	gFakeCacheStats.bytesAfterCompression -= inNode->size;
+	gFakeCacheStats.bytesCached -= inNode->size;
+	inNode->size = 0;
+	free( inNode->compressed );
+	inNode->compressed = NULL;
+	((MasterPointer*)inNode->handle)->memoryFlags &= ~MASTERPOINTER_COMPRESSED_FLAG;
+}
+
+
+static void	FakeCacheMakeNewest( int32_t inNode )
+{
+	FakeCacheDropCompressed( gFakeCacheNodes +inNode );	// Somebody gave the Handle new data.
+	
+	// Somebody may have resized it since we last looked:
+	uint64_t	newSize = (uint64_t)FakeGetHandleSize( gFakeCacheNodes[inNode].handle );
+	gFakeCacheStats.bytesCached += newSize -gFakeCacheNodes[inNode].size;
+	if( newSize != gFakeCacheNodes[inNode].size )
+		gFakeCacheNodes[inNode].incompressible = false;
+	gFakeCacheNodes[inNode].size = newSize;
+	if( gFakeCacheColdSeconds > 0 )
+		gFakeCacheNodes[inNode].lastUsed = FakeTraceCurrentTime();
+	
+	if( inNode != gFakeCacheNewest )
+	{
+		FakeCacheUnlinkNode( inNode );
+		FakeCacheLinkNodeAsNewest( inNode );
+	}
+}
+
+
+static void	FakeCacheRemoveNodeInSlot( size_t inSlot )
+{
+	int32_t		theNode = gFakeCacheTable[inSlot];
+	FakeCacheDropCompressed( gFakeCacheNodes +theNode );
+	FakeCacheUnlinkNode( theNode );
+	FakeCacheClearSlot( inSlot );
+	gFakeCacheStats.bytesCached -= gFakeCacheNodes[theNode].size;
+	gFakeCacheStats.numCached--;
+	gFakeCacheNodes[theNode].handle = NULL;
+	gFakeCacheNodes[theNode].older = gFakeCacheFreeNode;
+	gFakeCacheFreeNode = theNode;
+}
+
+
+// Empty least recently used Handles until we're within budget. Purgeable ones
+//	go first, locked ones and the one that was just used stay:
+static void	FakeCacheEnforceBudget( void )
+{
+	for( int pass = 0; pass < 2; pass++ )
+	{
+		int32_t		currNode = gFakeCacheOldest;
+		while( gFakeCacheBudget != 0 && gFakeCacheStats.bytesCached > gFakeCacheBudget
+				&& currNode != FAKE_CACHE_NO_NODE && currNode != gFakeCacheNewest )
+		{
+			struct FakeCacheNode*	theNode = gFakeCacheNodes +currNode;
+			int32_t					newerNode = theNode->newer;
+			char					theState = FakeHGetState( theNode->handle );
+			bool					purgeable = theNode->purgeable || (theState & kFakeHandlePurgeableBit);
+			if( (theState & kFakeHandleLockedBit) == 0 && (purgeable || pass == 1) )
+			{
+				Handle		theHandle = theNode->handle;
+				uint64_t	theSize = theNode->size;
+				FakeCacheRemoveNodeInSlot( FakeCacheFindSlot( theHandle ) );
+				FakeEmptyHandle( theHandle );
+				gFakeCacheStats.evictions++;
+				gFakeCacheStats.bytesEvicted += theSize;
+				FAKE_TRACE_EVENT( kFakeTraceResourceEvicted, .byteCount = (int64_t)theSize );
+			}
+			currNode = newerNode;
+		}
+	}
+}
+
+
+// Compress the data of a node, and empty its Handle. Returns false if that
+//	wouldn't save enough:
+static bool	FakeCacheCompressNode( struct FakeCacheNode* inNode )
+{
+	uint64_t	theSize = (uint64_t)FakeGetHandleSize( inNode->handle );
+	if( theSize < FAKE_CACHE_MIN_COMPRESS_SIZE || *inNode->handle == NULL || theSize > SIZE_MAX )
+		return false;
+	size_t		capacity = (size_t)(theSize -theSize / FAKE_CACHE_MIN_COMPRESS_SAVINGS);
+	uint8_t*	compressed = malloc( capacity );
+	size_t		compressedSize = compressed ? FakeLZCompress( (const uint8_t*)*inNode->handle, (size_t)theSize, compressed, capacity ) : 0;
+	if( compressedSize == 0 )
+	{
+		free( compressed );
+		return false;
+	}
+	uint8_t*	shrunk = realloc( compressed, compressedSize );
+	inNode->compressed = shrunk ? shrunk : compressed;
+	inNode->originalSize = theSize;
+	FakeEmptyHandle( inNode->handle );
+	((MasterPointer*)inNode->handle)->memoryFlags |= MASTERPOINTER_COMPRESSED_FLAG;
+	
+	gFakeCacheStats.bytesCached += compressedSize -inNode->size;
+	inNode->size = compressedSize;
+	gFakeCacheStats.numCompressed++;
+	gFakeCacheStats.compressions++;
+	gFakeCacheStats.bytesBeforeCompression += theSize;
+	gFakeCacheStats.bytesAfterCompression += compressedSize;
+	return true;
+}
+
+
+// Compress the data of Handles nobody asked for in gFakeCacheColdSeconds, unless
+//	they're locked or eviction is suspended. Least recently used ones come first, so we can stop at the
+//	first one that isn't cold yet:
+static void	FakeCacheCompressColdNodes( void )
+{
+	if( gFakeCacheColdSeconds <= 0 || gFakeCacheSuspendCount > 0 )
+		return;
+	double		now = FakeTraceCurrentTime();
+	if( now < gFakeCacheNextColdScan )
+		return;
+	gFakeCacheNextColdScan = now +gFakeCacheColdSeconds / 4;	// Nothing gets much colder before that.
+	
+	for( int32_t currNode = gFakeCacheOldest; currNode != FAKE_CACHE_NO_NODE; currNode = gFakeCacheNodes[currNode].newer )
+	{
+		struct FakeCacheNode*	theNode = gFakeCacheNodes +currNode;
+		if( (now -theNode->lastUsed) < gFakeCacheColdSeconds )
+			break;
+		if( theNode->compressed || theNode->incompressible || (FakeHGetState( theNode->handle ) & kFakeHandleLockedBit) )
+			continue;
+		if( !FakeCacheCompressNode( theNode ) )
+			theNode->incompressible = true;
+	}
+}
+
+
+void	FakeResourceCacheAdd( Handle inHandle, bool inPurgeable )
+{
+	if( (gFakeCacheNumNodes +1) * 2 > (int64_t)gFakeCacheTableSize && !FakeCacheGrowTable() )
+		return;	// Can't track it? Then we just never empty it.
+	
+	size_t	slot = FakeCacheFindSlot( inHandle );
+	if( gFakeCacheTable[slot] != FAKE_CACHE_NO_NODE )
+		return;	// Was already in RAM.
+	
+	int32_t		theNode = gFakeCacheFreeNode;
+	if( theNode != FAKE_CACHE_NO_NODE )
+		gFakeCacheFreeNode = gFakeCacheNodes[theNode].older;
+	else
+	{
+		struct FakeCacheNode*	newNodes = realloc( gFakeCacheNodes, (gFakeCacheNumNodes +1) * sizeof(struct FakeCacheNode) );
+		if( !newNodes )
+			return;
+		gFakeCacheNodes = newNodes;
+		theNode = gFakeCacheNumNodes++;
+	}
+	
+	gFakeCacheNodes[theNode].handle = inHandle;
+	gFakeCacheNodes[theNode].size = (uint64_t)FakeGetHandleSize( inHandle );
+	gFakeCacheNodes[theNode].purgeable = inPurgeable;
+	gFakeCacheNodes[theNode].incompressible = false;
+	gFakeCacheNodes[theNode].lastUsed = (gFakeCacheColdSeconds > 0) ? FakeTraceCurrentTime() : 0;
+	gFakeCacheNodes[theNode].compressed = NULL;
+	gFakeCacheTable[slot] = theNode;
+	FakeCacheLinkNodeAsNewest( theNode );
+	gFakeCacheStats.bytesCached += gFakeCacheNodes[theNode].size;
+	gFakeCacheStats.numCached++;
+	
+	if( gFakeCacheSuspendCount == 0 )
+		FakeCacheEnforceBudget();
+	FakeCacheCompressColdNodes();
+}
+
+
+void	FakeResourceCacheTouch( Handle inHandle )
+{
+	gFakeCacheStats.hits++;
+	if( gFakeCacheTableSize == 0 )
+		return;
+	
+	int32_t	theNode = gFakeCacheTable[FakeCacheFindSlot( inHandle )];
+	if( theNode != FAKE_CACHE_NO_NODE )
+		FakeCacheMakeNewest( theNode );
+	FakeCacheCompressColdNodes();
+}
+
+
+bool	FakeResourceCacheRestore( Handle inHandle )
+{
+	if( gFakeCacheTableSize == 0 || *inHandle != NULL )
+		return false;
+	size_t					slot = FakeCacheFindSlot( inHandle );
+	int32_t					nodeIndex = gFakeCacheTable[slot];
+	struct FakeCacheNode*	theNode = (nodeIndex != FAKE_CACHE_NO_NODE) ? (gFakeCacheNodes +nodeIndex) : NULL;
+	if( !theNode || !theNode->compressed )
+		return false;
+	
+	double		startTime = FakeTraceCurrentTime();
+	char*		theData = malloc( (theNode->originalSize > 0) ? (size_t)theNode->originalSize : 1 );
+	if( !theData || !FakeLZDecompress( theNode->compressed, (size_t)theNode->size, (uint8_t*)theData, (size_t)theNode->originalSize ) )
+	{
+		free( theData );
+		FAKE_TRACE( kFakeTraceLevelWarning, "Couldn't decompress cached resource data, reading it again." );
+		FakeCacheRemoveNodeInSlot( slot );
+		return false;
+	}
+	FakeAdoptHandleMemory( inHandle, theData, (long)theNode->originalSize );
+	FakeCacheDropCompressed( theNode );
+	FakeCacheMakeNewest( nodeIndex );
+	gFakeCacheStats.decompressions++;
+	gFakeCacheStats.decompressSeconds += FakeTraceCurrentTime() -startTime;
+	return true;
+}
+
+
+void	FakeResourceCacheCountMiss( void )
+{
+	gFakeCacheStats.misses++;
+}
+
+
+void	FakeResourceCacheRemove( Handle inHandle )
+{
+	if( gFakeCacheTableSize == 0 )
+		return;
+	
+	size_t	slot = FakeCacheFindSlot( inHandle );
+	if( gFakeCacheTable[slot] != FAKE_CACHE_NO_NODE )
+		FakeCacheRemoveNodeInSlot( slot );
+}
+
+
+void	FakeResourceCacheSuspendEviction( void )
+{
+	gFakeCacheSuspendCount++;
+}
+
+
+void	FakeResourceCacheResumeEviction( void )
+{
+	if( --gFakeCacheSuspendCount == 0 )
+	{
+		FakeCacheEnforceBudget();
+		FakeCacheCompressColdNodes();
+	}
+}
+
+
+void	FakeSetResourceCacheBudget( uint64_t inMaxBytes )
+{
+	gFakeCacheBudget = inMaxBytes;
+	if( gFakeCacheSuspendCount == 0 )
+		FakeCacheEnforceBudget();
+}
+
+
+void	FakeSetResourceCacheCompression( double inColdSeconds )
+{
+	if( inColdSeconds > 0 && gFakeCacheColdSeconds <= 0 )
+	{
+		double	now = FakeTraceCurrentTime();	// We didn't note when they were used, so they're cold from now on.
+		for( int32_t currNode = gFakeCacheOldest; currNode != FAKE_CACHE_NO_NODE; currNode = gFakeCacheNodes[currNode].newer )
+			gFakeCacheNodes[currNode].lastUsed = now;
+	}
+	gFakeCacheColdSeconds = (inColdSeconds > 0) ? inColdSeconds : 0;
+	gFakeCacheNextColdScan = 0;
+	FakeCacheCompressColdNodes();
+}
+
+
+void	FakeGetResourceCacheStats( struct FakeResourceCacheStats* outStats )
+{
+	*outStats = gFakeCacheStats;
+	outStats->budget = gFakeCacheBudget;
+}
+
+
+void	FakeResetResourceCacheStats( void )
+{
+	gFakeCacheStats.hits = 0;
+	gFakeCacheStats.misses = 0;
+	gFakeCacheStats.evictions = 0;
+	gFakeCacheStats.bytesEvicted = 0;
+	gFakeCacheStats.compressions = 0;
+	gFakeCacheStats.decompressions = 0;
+	gFakeCacheStats.decompressSeconds = 0;
+}
@@ -0,0 +1,58 @@
+//
+//  FakeResourceCache.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Keeps track of which resources' data is in RAM and could be read from
+//  disk again, and empties the least recently used of their Handles when
+//  there's more of it than FakeSetResourceCacheBudget() allows. Before that,
+//  it may keep the data of those that weren't used in a while compressed,
+//  see FakeSetResourceCacheCompression().
+//
+//  Only call these from the thread that makes the Resource Manager calls.
+//
+
+#ifndef ReClassicfication_FakeResourceCache_h
+#define ReClassicfication_FakeResourceCache_h
+
+#include <stdbool.h>
+#include "FakeResources.h"
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+// Private calls for internal use:
+
+// The data of this resource Handle was just read from disk and may be emptied
+//	again later. Does nothing if it's already in the cache:
+void	FakeResourceCacheAdd( Handle inHandle, bool inPurgeable );
+
+// The resource was requested, and its data was in RAM:
+void	FakeResourceCacheTouch( Handle inHandle );
+
+// The resource was requested and its data had to be read from disk:
+void	FakeResourceCacheCountMiss( void );
+
+// If the Handle is empty because we compressed its data, put the data back
+//	in it, and return true. Otherwise (e.g. it was emptied to stay within the
+//	budget) return false, so the caller reads it from disk:
+bool	FakeResourceCacheRestore( Handle inHandle );
+
+// The Handle mustn't be emptied anymore (e.g. it was changed, disposed or is
+//	no longer a resource). Does nothing if it isn't in the cache:
+void	FakeResourceCacheRemove( Handle inHandle );
+
+// Don't empty any Handles until the matching FakeResourceCacheResumeEviction().
+//	Use this while you need all data of a file in RAM. Calls may be nested:
+void	FakeResourceCacheSuspendEviction( void );
+void	FakeResourceCacheResumeEviction( void );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,623 @@
+//
+//  FakeResourceViews.hpp
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Read the data of common resource types where it is, without copying it or
+//  swapping its bytes by hand. Needs C++17. Nothing here allocates memory.
+//
+//  A view points into a resource Handle's memory, so it's only good until the
+//  Handle is resized, emptied, purged or disposed of (FakeHLock() it if you're
+//  not sure). Views check everything they read against the size of the data:
+//  damaged data ends an iteration early or gives empty strings, it's never
+//  read past.
+//
+
+#ifndef ReClassicfication_FakeResourceViews_hpp
+#define ReClassicfication_FakeResourceViews_hpp
+
+#if __cplusplus < 201703L
+#error "FakeResourceViews.hpp needs C++17 or later."
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include "FakeResources.h"
+
+
+namespace Fake
+{
+
+// An integer (or enum) as it is stored in resource data, most significant
+//	byte first, at any alignment. Reading or writing one compiles to a load
+//	and a single byte swap instruction:
+template<class T>
+class BigEndian
+{
+	static_assert( std::is_integral<T>::value || std::is_enum<T>::value, "BigEndian<> is for integers and enums." );
+
+	template<class U, bool = std::is_enum<U>::value> struct Underlying { using type = U; };
+	template<class U> struct Underlying<U, true> { using type = typename std::underlying_type<U>::type; };
+	using Bits = typename std::make_unsigned<typename Underlying<T>::type>::type;
+
+public:
+	using value_type = T;
+
+	constexpr BigEndian() : mBytes{} {}
+	constexpr BigEndian( T inValue ) : mBytes{} { set( inValue ); }
+
+	constexpr T		get() const	// Spelled out, so compilers see it's a byte swap.
+	{
+		if constexpr( sizeof(T) == 1 )
+			return static_cast<T>( mBytes[0] );
+		else if constexpr( sizeof(T) == 2 )
+			return static_cast<T>( static_cast<Bits>( (mBytes[0] << 8) | mBytes[1] ) );
+		else if constexpr( sizeof(T) == 4 )
+			return static_cast<T>( static_cast<Bits>( get32( 0 ) ) );
+		else
+			return static_cast<T>( static_cast<Bits>( (static_cast<uint64_t>( get32( 0 ) ) << 32) | get32( 4 ) ) );
+	}
+
+	constexpr void	set( T inValue )
+	{
+		uint64_t	value = static_cast<Bits>( inValue );
+		for( size_t x = sizeof(T); x-- > 0; )
+		{
+			mBytes[x] = static_cast<uint8_t>( value );
+			value >>= 8;
+		}
+	}
+
+	constexpr operator T() const					{ return get(); }
+	constexpr BigEndian&	operator =( T inValue )	{ set( inValue ); return *this; }
+
+private:
+	constexpr uint32_t	get32( size_t inOffset ) const
+	{
+		return (static_cast<uint32_t>( mBytes[inOffset] ) << 24) | (static_cast<uint32_t>( mBytes[inOffset +1] ) << 16)
+				| (static_cast<uint32_t>( mBytes[inOffset +2] ) << 8) | mBytes[inOffset +3];
+	}
+
+	uint8_t		mBytes[sizeof(T)];
+};
+
+using BigInt16 = BigEndian<int16_t>;
+using BigUInt16 = BigEndian<uint16_t>;
+using BigInt32 = BigEndian<int32_t>;
+using BigUInt32 = BigEndian<uint32_t>;
+
+static_assert( sizeof(BigInt32) == 4 && alignof(BigInt32) == 1, "BigEndian<> must lie over the bytes of resource data." );
+
+
+// A QuickDraw rectangle:
+struct BigRect
+{
+	BigInt16	top;
+	BigInt16	left;
+	BigInt16	bottom;
+	BigInt16	right;
+
+	constexpr int16_t	height() const	{ return (bottom > top) ? static_cast<int16_t>( bottom -top ) : 0; }
+	constexpr int16_t	width() const	{ return (right > left) ? static_cast<int16_t>( right -left ) : 0; }
+};
+
+
+// A range of bytes, usually the data of a resource:
+class ByteView
+{
+public:
+	constexpr ByteView() = default;
+	constexpr ByteView( const uint8_t* inData, size_t inSize ) : mData( inData ), mSize( inSize ) {}
+	explicit ByteView( Handle inResource )
+		: mData( (inResource && *inResource) ? reinterpret_cast<const uint8_t*>( *inResource ) : nullptr ),
+		  mSize( mData ? static_cast<size_t>( FakeGetHandleSize( inResource ) ) : 0 ) {}
+
+	constexpr const uint8_t*	data() const	{ return mData; }
+	constexpr size_t			size() const	{ return mSize; }
+	constexpr bool				empty() const	{ return mSize == 0; }
+	constexpr const uint8_t*	begin() const	{ return mData; }
+	constexpr const uint8_t*	end() const		{ return mData +mSize; }
+
+	constexpr bool		fits( size_t inOffset, size_t inLength ) const	{ return inOffset <= mSize && inLength <= (mSize -inOffset); }
+
+	// The inLength bytes at inOffset, or as many of them as there are:
+	constexpr ByteView	sub( size_t inOffset, size_t inLength = SIZE_MAX ) const
+	{
+		if( inOffset > mSize )
+			return ByteView();
+		return ByteView( mData +inOffset, (inLength < (mSize -inOffset)) ? inLength : (mSize -inOffset) );
+	}
+
+	// The struct of BigEndian<> fields at inOffset, or nullptr if it doesn't fit:
+	template<class S>
+	const S*	get( size_t inOffset = 0 ) const
+	{
+		static_assert( alignof(S) == 1 && std::is_trivially_copyable<S>::value, "Only for structs made of BigEndian<> and uint8_t fields." );
+		return fits( inOffset, sizeof(S) ) ? reinterpret_cast<const S*>( mData +inOffset ) : nullptr;
+	}
+
+	// The Pascal string at inOffset. Sets *outNextOffset to the byte after it.
+	//	Returns false (and an empty string) if it doesn't fit:
+	constexpr bool	pstring( size_t inOffset, std::string_view* outString, size_t* outNextOffset = nullptr ) const
+	{
+		if( !fits( inOffset, 1 ) || !fits( inOffset +1, mData[inOffset] ) )
+		{
+			*outString = std::string_view();
+			return false;
+		}
+		*outString = std::string_view( reinterpret_cast<const char*>( mData +inOffset +1 ), mData[inOffset] );
+		if( outNextOffset )
+			*outNextOffset = inOffset +1 +mData[inOffset];
+		return true;
+	}
+
+private:
+	const uint8_t*	mData = nullptr;
+	size_t			mSize = 0;
+};
+
+
+// A number of structs made of BigEndian<> fields (or BigEndian<> values) in a row:
+template<class T>
+class ArrayView
+{
+	static_assert( alignof(T) == 1 && std::is_trivially_copyable<T>::value, "Only for BigEndian<> and structs made of them." );
+
+public:
+	constexpr ArrayView() = default;
+	ArrayView( ByteView inBytes, size_t inOffset, size_t inCount )
+	{
+		ByteView	bytes = inBytes.sub( inOffset );
+		mCount = (inCount < bytes.size() / sizeof(T)) ? inCount : bytes.size() / sizeof(T);	// As many as there are.
+		mData = reinterpret_cast<const T*>( bytes.data() );
+	}
+
+	constexpr size_t	size() const						{ return mCount; }
+	constexpr bool		empty() const						{ return mCount == 0; }
+	constexpr const T*	begin() const						{ return mData; }
+	constexpr const T*	end() const							{ return mData +mCount; }
+	constexpr const T&	operator []( size_t inIndex ) const	{ return mData[inIndex]; }
+
+private:
+	const T*	mData = nullptr;
+	size_t		mCount = 0;
+};
+
+
+// Converts arrays of 16 or 32 bit values between big endian and the machine's
+//	byte order in place, see FakeSwapBigEndian16(). Quicker than going through
+//	an ArrayView<BigEndian<>> if you need each value more than once:
+inline void	SwapBigEndian( int16_t* ioValues, size_t inCount )	{ FakeSwapBigEndian16( ioValues, inCount ); }
+inline void	SwapBigEndian( uint16_t* ioValues, size_t inCount )	{ FakeSwapBigEndian16( ioValues, inCount ); }
+inline void	SwapBigEndian( int32_t* ioValues, size_t inCount )	{ FakeSwapBigEndian32( ioValues, inCount ); }
+inline void	SwapBigEndian( uint32_t* ioValues, size_t inCount )	{ FakeSwapBigEndian32( ioValues, inCount ); }
+
+
+// 'STR#': A count, then that many Pascal strings. Iterating gives the strings'
+//	characters without their length bytes:
+class StringListView
+{
+public:
+	class iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::string_view;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const std::string_view*;
+		using reference = std::string_view;
+
+		constexpr iterator() = default;
+		constexpr iterator( ByteView inBytes, size_t inOffset, size_t inRemaining ) : mBytes( inBytes ), mNextOffset( inOffset ), mRemaining( inRemaining ) { advance(); }
+
+		constexpr std::string_view	operator *() const						{ return mString; }
+		constexpr iterator&			operator ++()							{ advance(); return *this; }
+		constexpr iterator			operator ++( int )						{ iterator old = *this; advance(); return old; }
+		constexpr bool				operator ==( const iterator& inOther ) const	{ return mAtEnd == inOther.mAtEnd && (mAtEnd || mNextOffset == inOther.mNextOffset); }
+		constexpr bool				operator !=( const iterator& inOther ) const	{ return !(*this == inOther); }
+
+	private:
+		constexpr void	advance()
+		{
+			mAtEnd = (mRemaining == 0) || !mBytes.pstring( mNextOffset, &mString, &mNextOffset );
+			if( !mAtEnd )
+				mRemaining--;
+		}
+
+		ByteView			mBytes;
+		std::string_view	mString;
+		size_t				mNextOffset = 0;
+		size_t				mRemaining = 0;
+		bool				mAtEnd = true;
+	};
+
+	explicit StringListView( Handle inResource ) : mBytes( inResource ) {}
+	explicit constexpr StringListView( ByteView inBytes ) : mBytes( inBytes ) {}
+
+	// How many strings the list says it has. Damaged lists may have fewer:
+	size_t		size() const		{ const BigUInt16* count = mBytes.get<BigUInt16>(); return count ? count->get() : 0; }
+
+	iterator	begin() const		{ return iterator( mBytes, 2, size() ); }
+	iterator	end() const			{ return iterator(); }
+
+	// The string at inIndex (from 0, unlike GetIndString()), or an empty one if there is none:
+	std::string_view	operator []( size_t inIndex ) const
+	{
+		for( std::string_view currString : *this )
+		{
+			if( inIndex-- == 0 )
+				return currString;
+		}
+		return std::string_view();
+	}
+
+private:
+	ByteView	mBytes;
+};
+
+
+// 'vers':
+struct VersionHeader
+{
+	uint8_t		majorRevision;			// BCD.
+	uint8_t		minorAndBugRevision;	// BCD, minor in the high nibble.
+	uint8_t		developmentStage;		// One of the kFakeVersStage constants.
+	uint8_t		nonReleaseRevision;
+	BigInt16	regionCode;
+};
+
+enum
+{
+	kFakeVersStageDevelopment = 0x20,
+	kFakeVersStageAlpha = 0x40,
+	kFakeVersStageBeta = 0x60,
+	kFakeVersStageRelease = 0x80
+};
+
+class VersionView
+{
+public:
+	explicit VersionView( Handle inResource ) : mBytes( inResource ) {}
+	explicit constexpr VersionView( ByteView inBytes ) : mBytes( inBytes ) {}
+
+	// nullptr if the resource is too short:
+	const VersionHeader*	header() const		{ return mBytes.get<VersionHeader>(); }
+
+	// E.g. "1.0.2":
+	std::string_view		shortVersion() const
+	{
+		std::string_view	shortVersion;
+		mBytes.pstring( sizeof(VersionHeader), &shortVersion );
+		return shortVersion;
+	}
+
+	// E.g. "1.0.2, © 1991 Example Corp.":
+	std::string_view		longVersion() const
+	{
+		std::string_view	shortVersion, longVersion;
+		size_t				longVersionOffset = 0;
+		if( mBytes.pstring( sizeof(VersionHeader), &shortVersion, &longVersionOffset ) )
+			mBytes.pstring( longVersionOffset, &longVersion );
+		return longVersion;
+	}
+
+private:
+	ByteView	mBytes;
+};
+
+
+// 'DITL': A count -1, then the items, each a header, then dataLength bytes,
+//	padded to an even length:
+struct DialogItemHeader
+{
+	BigUInt32	placeholder;		// Handle or procedure pointer at runtime.
+	BigRect		bounds;
+	uint8_t		type;				// One of the kFakeDITL constants, plus kFakeDITLDisabled.
+	uint8_t		dataLength;
+};
+
+enum
+{
+	kFakeDITLUserItem = 0,
+	kFakeDITLHelpItem = 1,
+	kFakeDITLButton = 4,
+	kFakeDITLCheckBox = 5,
+	kFakeDITLRadioButton = 6,
+	kFakeDITLControl = 7,			// Data is a 'CNTL' ID.
+	kFakeDITLStaticText = 8,
+	kFakeDITLEditText = 16,
+	kFakeDITLIcon = 32,				// Data is an 'ICON'/'cicn' ID.
+	kFakeDITLPicture = 64,			// Data is a 'PICT' ID.
+	kFakeDITLDisabled = 128
+};
+
+class DialogItemView
+{
+public:
+	constexpr DialogItemView( const DialogItemHeader* inHeader, ByteView inData ) : mHeader( inHeader ), mData( inData ) {}
+
+	const DialogItemHeader&	header() const		{ return *mHeader; }
+	const BigRect&			bounds() const		{ return mHeader->bounds; }
+	uint8_t					type() const		{ return mHeader->type & ~kFakeDITLDisabled; }
+	bool					enabled() const		{ return (mHeader->type & kFakeDITLDisabled) == 0; }
+	ByteView				data() const		{ return mData; }
+
+	// Title of buttons, check boxes and radio buttons, or the text of text items:
+	std::string_view		text() const		{ return std::string_view( reinterpret_cast<const char*>( mData.data() ), mData.size() ); }
+
+	// ID of the resource for control, icon and picture items. 0 if the data is too short:
+	int16_t					resourceID() const	{ const BigInt16* theID = mData.get<BigInt16>(); return theID ? theID->get() : 0; }
+
+private:
+	const DialogItemHeader*	mHeader;
+	ByteView				mData;
+};
+
+class DialogItemListView
+{
+public:
+	class iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = DialogItemView;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const DialogItemView*;
+		using reference = DialogItemView;
+
+		constexpr iterator() = default;
+		iterator( ByteView inBytes, size_t inOffset, size_t inRemaining ) : mBytes( inBytes ), mOffset( inOffset ), mRemaining( inRemaining ) { check(); }
+
+		DialogItemView		operator *() const
+		{
+			const DialogItemHeader*	itemHeader = mBytes.get<DialogItemHeader>( mOffset );
+			return DialogItemView( itemHeader, mBytes.sub( mOffset +sizeof(DialogItemHeader), itemHeader->dataLength ) );
+		}
+		iterator&			operator ++()							{ advance(); return *this; }
+		iterator			operator ++( int )						{ iterator old = *this; advance(); return old; }
+		bool				operator ==( const iterator& inOther ) const	{ return mRemaining == inOther.mRemaining && (mRemaining == 0 || mOffset == inOther.mOffset); }
+		bool				operator !=( const iterator& inOther ) const	{ return !(*this == inOther); }
+
+	private:
+		// Stops at the first item that doesn't fit:
+		void	check()
+		{
+			const DialogItemHeader*	itemHeader = (mRemaining > 0) ? mBytes.get<DialogItemHeader>( mOffset ) : nullptr;
+			if( !itemHeader || !mBytes.fits( mOffset +sizeof(DialogItemHeader), itemHeader->dataLength ) )
+				mRemaining = 0;
+		}
+
+		void	advance()
+		{
+			const DialogItemHeader*	itemHeader = mBytes.get<DialogItemHeader>( mOffset );
+			mOffset += sizeof(DialogItemHeader) +itemHeader->dataLength +(itemHeader->dataLength & 1);
+			mRemaining--;
+			check();
+		}
+
+		ByteView	mBytes;
+		size_t		mOffset = 0;
+		size_t		mRemaining = 0;
+	};
+
+	explicit DialogItemListView( Handle inResource ) : mBytes( inResource ) {}
+	explicit constexpr DialogItemListView( ByteView inBytes ) : mBytes( inBytes ) {}
+
+	// How many items the list says it has. Damaged lists may have fewer:
+	size_t		size() const		{ const BigInt16* countMinusOne = mBytes.get<BigInt16>(); return (countMinusOne && *countMinusOne >= 0) ? countMinusOne->get() +1 : 0; }
+
+	iterator	begin() const		{ return iterator( mBytes, 2, size() ); }
+	iterator	end() const			{ return iterator(); }
+
+private:
+	ByteView	mBytes;
+};
+
+
+// 'MENU': A header, the title, then the items, each a Pascal string and 4
+//	bytes, until an empty string:
+struct MenuHeader
+{
+	BigInt16	menuID;
+	BigInt16	width;
+	BigInt16	height;
+	BigInt16	procID;				// 'MDEF' ID.
+	BigInt16	filler;
+	BigUInt32	enableFlags;		// Bit 0 for the whole menu, bits 1 to 31 for the first 31 items.
+};
+
+struct MenuItemInfo
+{
+	uint8_t		icon;				// Icon number, 0 for none.
+	uint8_t		keyEquivalent;		// Character, 0 for none.
+	uint8_t		mark;				// Character, 0 for none.
+	uint8_t		style;				// Style bits (bold = 1, italic = 2, ...).
+};
+
+class MenuItemView
+{
+public:
+	constexpr MenuItemView( std::string_view inText, const MenuItemInfo* inInfo ) : mText( inText ), mInfo( inInfo ) {}
+
+	std::string_view		text() const		{ return mText; }
+	const MenuItemInfo&		info() const		{ return *mInfo; }
+
+private:
+	std::string_view		mText;
+	const MenuItemInfo*		mInfo;
+};
+
+class MenuView
+{
+public:
+	class iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = MenuItemView;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const MenuItemView*;
+		using reference = MenuItemView;
+
+		constexpr iterator() = default;
+		iterator( ByteView inBytes, size_t inOffset ) : mBytes( inBytes ), mNextOffset( inOffset ) { advance(); }
+
+		MenuItemView		operator *() const						{ return MenuItemView( mText, mInfo ); }
+		iterator&			operator ++()							{ advance(); return *this; }
+		iterator			operator ++( int )						{ iterator old = *this; advance(); return old; }
+		bool				operator ==( const iterator& inOther ) const	{ return mInfo == inOther.mInfo; }
+		bool				operator !=( const iterator& inOther ) const	{ return !(*this == inOther); }
+
+	private:
+		void	advance()
+		{
+			size_t		infoOffset = 0;
+			mInfo = nullptr;
+			if( mBytes.pstring( mNextOffset, &mText, &infoOffset ) && !mText.empty() )
+				mInfo = mBytes.get<MenuItemInfo>( infoOffset );
+			mNextOffset = infoOffset +sizeof(MenuItemInfo);
+		}
+
+		ByteView				mBytes;
+		std::string_view		mText;
+		const MenuItemInfo*		mInfo = nullptr;	// nullptr once we're at the end.
+		size_t					mNextOffset = 0;
+	};
+
+	explicit MenuView( Handle inResource ) : mBytes( inResource ) {}
+	explicit constexpr MenuView( ByteView inBytes ) : mBytes( inBytes ) {}
+
+	// nullptr if the resource is too short:
+	const MenuHeader*	header() const		{ return mBytes.get<MenuHeader>(); }
+
+	std::string_view	title() const
+	{
+		std::string_view	title;
+		mBytes.pstring( sizeof(MenuHeader), &title );
+		return title;
+	}
+
+	// Whether the item at inIndex (from 0) is enabled. Items after the 31st always are:
+	bool		isItemEnabled( size_t inIndex ) const
+	{
+		const MenuHeader*	menuHeader = header();
+		return !menuHeader || inIndex >= 31 || (menuHeader->enableFlags & (1U << (inIndex +1))) != 0;
+	}
+
+	iterator	begin() const
+	{
+		std::string_view	title;
+		size_t				itemsOffset = 0;
+		return mBytes.pstring( sizeof(MenuHeader), &title, &itemsOffset ) ? iterator( mBytes, itemsOffset ) : iterator();
+	}
+	iterator	end() const			{ return iterator(); }
+
+private:
+	ByteView	mBytes;
+};
+
+
+// 'cicn': A header, then the mask's bits, the black & white icon's bits, the
+//	color table and the color icon's pixels:
+struct PixMapHeader
+{
+	BigUInt32	baseAddr;
+	BigInt16	rowBytes;			// The top 2 bits are flags.
+	BigRect		bounds;
+	BigInt16	pmVersion;
+	BigInt16	packType;
+	BigInt32	packSize;
+	BigInt32	hRes;				// Fixed.
+	BigInt32	vRes;				// Fixed.
+	BigInt16	pixelType;
+	BigInt16	pixelSize;			// Bits per pixel.
+	BigInt16	cmpCount;
+	BigInt16	cmpSize;
+	BigInt32	planeBytes;
+	BigUInt32	pmTable;
+	BigInt32	pmReserved;
+
+	size_t		byteCount() const	{ return static_cast<size_t>( rowBytes & 0x3FFF ) * bounds.height(); }
+};
+
+struct BitMapHeader
+{
+	BigUInt32	baseAddr;
+	BigInt16	rowBytes;
+	BigRect		bounds;
+
+	size_t		byteCount() const	{ return (rowBytes > 0) ? static_cast<size_t>( rowBytes ) * bounds.height() : 0; }
+};
+
+struct ColorIconHeader
+{
+	PixMapHeader	iconPMap;
+	BitMapHeader	iconMask;
+	BitMapHeader	iconBMap;
+	BigUInt32		iconData;
+};
+
+struct ColorTableHeader
+{
+	BigInt32	ctSeed;
+	BigInt16	ctFlags;
+	BigInt16	ctSize;				// Number of entries -1.
+};
+
+struct ColorSpecEntry
+{
+	BigInt16	value;				// Pixel value.
+	BigUInt16	red;
+	BigUInt16	green;
+	BigUInt16	blue;
+};
+
+static_assert( sizeof(PixMapHeader) == 50 && sizeof(BitMapHeader) == 14 && sizeof(ColorIconHeader) == 82, "Must match the 'cicn' layout." );
+
+class ColorIconView
+{
+public:
+	explicit ColorIconView( Handle inResource ) : mBytes( inResource ) {}
+	explicit constexpr ColorIconView( ByteView inBytes ) : mBytes( inBytes ) {}
+
+	// nullptr if the resource is too short:
+	const ColorIconHeader*			header() const		{ return mBytes.get<ColorIconHeader>(); }
+
+	// All of these are empty if the resource is too short for them:
+	ByteView						maskData() const	{ return header() ? part( maskOffset(), header()->iconMask.byteCount() ) : ByteView(); }
+	ByteView						bitmapData() const	{ return header() ? part( bitmapOffset(), header()->iconBMap.byteCount() ) : ByteView(); }
+
+	ArrayView<ColorSpecEntry>		colors() const
+	{
+		const ColorTableHeader*	table = header() ? mBytes.get<ColorTableHeader>( colorTableOffset() ) : nullptr;
+		if( !table || table->ctSize < 0 )
+			return ArrayView<ColorSpecEntry>();
+		return ArrayView<ColorSpecEntry>( mBytes, colorTableOffset() +sizeof(ColorTableHeader), static_cast<size_t>( table->ctSize ) +1 );
+	}
+
+	ByteView						pixelData() const
+	{
+		const ColorTableHeader*	table = header() ? mBytes.get<ColorTableHeader>( colorTableOffset() ) : nullptr;
+		if( !table || table->ctSize < 0 )
+			return ByteView();
+		size_t	pixelOffset = colorTableOffset() +sizeof(ColorTableHeader) +(static_cast<size_t>( table->ctSize ) +1) * sizeof(ColorSpecEntry);
+		return part( pixelOffset, header()->iconPMap.byteCount() );
+	}
+
+private:
+	// These need a header():
+	size_t		maskOffset() const			{ return sizeof(ColorIconHeader); }
+	size_t		bitmapOffset() const		{ return maskOffset() +header()->iconMask.byteCount(); }
+	size_t		colorTableOffset() const	{ return bitmapOffset() +header()->iconBMap.byteCount(); }
+	ByteView	part( size_t inOffset, size_t inLength ) const	{ return mBytes.fits( inOffset, inLength ) ? mBytes.sub( inOffset, inLength ) : ByteView(); }
+
+	ByteView	mBytes;
+};
+
+}
+
+#endif
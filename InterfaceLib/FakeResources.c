@@ -8,8 +8,22 @@
 
 #include <stdint.h>
 #include <string.h>	// for memmove().
+#include <fcntl.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include "FakeResources.h"
+#include "FakeThreads.h"
+#include "FakeTrace.h"
+#include "FakeContainers.h"
+#include "FakeResourceCache.h"
+#include "FakePrefetch.h"
+#include "FakeAsyncIO.h"
+#include "FakeDecompression.h"
+#include "FakeHandleIndex.h"
+#include "FakeResIDIndex.h"
+#include "FakeResBloomFilter.h"
+#include "FakeSharedResources.h"
+#include "FakeKeyScan.h"
 #include "EndianStuff.h"
 
 
@@ -42,15 +56,50 @@
 	name list offset (resource map-relative)				  2 bytes
 */
 
+// Where the parts of a resource file are, as absolute file offsets:
+struct FakeResMapLocation
+{
+	uint64_t						dataOffset;
+	uint64_t						dataLength;
+	uint64_t						mapOffset;
+	uint32_t						mapLength;
+	uint64_t						readLimit;			// Where the resource fork ends.
+	bool							extendedFormat;
+};
+
 struct FakeResourceMap
 {
 	struct FakeResourceMap*			nextResourceMap;
+	struct FakeResourceMap*			prevResourceMap;	// So FakeCloseResFile() can take it out of the list without searching it.
 	bool							dirty;				// per-file tracking of whether FakeUpdateResFile() needs to write
-	FILE*							fileDescriptor;
+	FILE*							fileDescriptor;		// NULL while closed to stay under FakeSetResFileLimit(), use FakeGetResMapFD().
+	bool							reopenable;			// Never written, so its file may be closed and opened again read-only when needed.
+	dev_t							fileDevice;			// Identify the file, so we notice if another one took its place while it was closed.
+	ino_t							fileInode;
+	struct FakeResourceMap*			olderOpenMap;		// In gOldestOpenReopenableMap's list while reopenable and its file is open.
+	struct FakeResourceMap*			newerOpenMap;
+	uint32_t						numFetchReads;		// Reads of FakeStartResFetch() in flight, which need the file to stay open.
+	bool							readOnly;			// Resource fork inside another file, FakeUpdateResFile() mustn't write.
+	bool							extendedFormat;		// FakeUpdateResFile() writes the extended format, see FakeSetResFileFormat().
+	uint64_t						readLimit;			// Absolute file offset where the resource fork ends.
 	int16_t							fileRefNum;
+	char*							filePath;			// So we know where to put the access profile.
+	struct FakePrefetchJob*			prefetchJob;		// Reading resources in the background, or NULL.
+	double							profileUntil;		// Record resource accesses until then. 0 if not recording.
+	uint32_t						profileCounter;		// Number of resources recorded so far.
+	struct FakeResTransaction*		transaction;		// Edits staged since FakeBeginResTransaction(), or NULL.
 	uint16_t						resFileAttributes;
 	uint16_t						numTypes;
+	uint16_t						maxTypes;			// Room in typeList and typeCodes before they have to grow.
 	struct FakeTypeListEntry*		typeList;
+	uint32_t*						typeCodes;			// Type of each typeList entry, kept apart so we can scan them quickly.
+	struct FakeHandleIndex*			handleIndex;		// Where each resource Handle's entry is. Made when first needed, NULL until then.
+	struct FakeResBloomFilter*		bloomFilter;		// Type and ID of each resource, so FakeGetResource() can skip this file. Made when first needed, NULL until then.
+	struct FakeResMapLocation		location;			// Where the map was when the file was opened.
+	struct FakeSharedResKey*		sharedKey;			// What to publish the resource data under once it's loaded, see FakeSetResSharedCache(). NULL if we don't.
+	struct FakeSharedResources*		sharedResources;	// Resource data published for this file, which Handles may point into. NULL if none.
+	bool							sharedDataMoved;	// Saved since, so sharedResources no longer has the data at the offsets we now know.
+	struct FakeSharedResCopies*		sharedCopies;		// Data of resources that share it in the file, which Handles may point into. NULL if none, see FakeSetResDedup().
 };
 
 /*
@@ -64,9 +113,12 @@ struct FakeResourceMap
 
 struct FakeTypeListEntry
 {
-	uint32_t						resourceType;
-	uint16_t						numberOfResourcesOfType;	// -1
+	uint16_t						numberOfResourcesOfType;	// -1 on disk. In RAM, includes the numRemovedResources.
+	uint16_t						numRemovedResources;		// Entries with a NULL resourceHandle, see FakeMarkReferenceEntryRemoved().
+	uint32_t						maxResourcesOfType;			// Room in resourceList and resourceIDs before they have to grow.
 	struct FakeReferenceListEntry*	resourceList;
+	int16_t*						resourceIDs;				// ID of each resourceList entry, kept apart so we can scan them quickly. See FakeSetResourceID().
+	struct FakeResIDIndex*			idIndex;					// The resources by ID. Made when first needed, NULL until then.
 };
 
 /*
@@ -81,9 +133,15 @@ struct FakeTypeListEntry
 
 struct FakeReferenceListEntry
 {
-	int16_t				resourceID;
+	int16_t				resourceID;			// Same as in the type's resourceIDs, for code that only has the entry.
 	uint8_t				resourceAttributes;
-	Handle				resourceHandle;
+	Handle				resourceHandle;		// Empty (NULL master pointer) until the data has been loaded.
+	uint64_t			dataOffset;			// Absolute file offset of this resource's data length, so we can load it later.
+	uint32_t			dataExtent;			// Bytes from dataOffset to the next resource's data. 0 if this resource isn't on disk.
+	uint32_t			profileOrder;		// 1 for the first resource requested while recording a profile etc., 0 if not requested.
+	uint32_t			prefetchSlot;		// Index +1 of this resource in the map's prefetchJob, 0 if not being prefetched.
+	bool				compressedInRAM;	// resCompressed, but we couldn't decompress it, so the Handle has the data as in the file.
+	bool				sharesData;			// Another resource's data is at the same dataOffset, so they mustn't borrow the same block.
 	char				resourceName[257];	// 257 = 1 Pascal length byte, 255 characters for actual string, 1 byte for C terminator \0.
 };
 
@@ -92,13 +150,219 @@ struct FakeReferenceListEntry
 	Look-up by name is case-insensitive but case-preserving and diacritic-sensitive.
 */
 
+/*
+	Extended resource file, for files too large for the above (see FakeSetResFileFormat()):
+	
+	zeroes, so classic readers see an empty map				 16 bytes
+	'RCLX'													  4 bytes
+	version (1)												  2 bytes
+	reserved												  2 bytes
+	resource data offset									  8 bytes
+	resource map offset										  8 bytes
+	resource data length									  8 bytes
+	resource map length										  8 bytes
+	Reserved for system use									 72 bytes
+	Application data										128 bytes
+	resource data											...
+	resource map											...
+	
+	Resource data is 4-byte-long-counted like in classic files.
+	
+	Resource map:
+	
+	'RCLX'													  4 bytes
+	Resource file attributes								  2 bytes
+	reserved												  2 bytes
+	type list offset (resource map-relative)				  4 bytes
+	name list offset (resource map-relative)				  4 bytes
+	
+	Type list:
+	
+	number of types											  4 bytes
+		resource type										  4 bytes
+		number of resources									  4 bytes
+		offset to reference list (resource map-relative)	  4 bytes
+	
+	Reference list:
+	
+	resource ID												  2 bytes
+	resource attributes										  1 byte
+	reserved												  1 byte
+	resource name offset (relative to name list, -1 = none)	  4 bytes
+	resource data offset (resource data relative)			  8 bytes
+*/
+
+// An edit FakeAddResource(), FakeRemoveResource() or FakeSetResInfo() staged
+//	in a transaction instead of making it right away:
+enum FakeResEditKind
+{
+	kFakeResEditNone = 0,		// Was undone by a later edit, e.g. removing a resource added in the same transaction.
+	kFakeResEditAdd,
+	kFakeResEditRemove,
+	kFakeResEditSetInfo
+};
+
+struct FakeResEdit
+{
+	enum FakeResEditKind	kind;
+	Handle					resourceHandle;
+	uint32_t				resourceType;		// Only for kFakeResEditAdd.
+	int16_t					resourceID;			// Not for kFakeResEditRemove.
+	FakeStr255				resourceName;		// Not for kFakeResEditRemove.
+};
+
+struct FakeResTransaction
+{
+	struct FakeResEdit*		edits;				// In the order they were made.
+	size_t					numEdits;
+	size_t					maxEdits;			// How many fit in edits before we have to realloc().
+};
+
+
+// A resource FakeStartResFetch() was asked for, whose proc hasn't been called yet:
+struct FakeResFetch
+{
+	Handle					resourceHandle;	// NULL if it wasn't found, was removed, or its file was closed.
+	struct FakeResourceMap*	map;			// File it's in, so we know which fetches to settle when that changes.
+	FakeResFetchProc		proc;
+	void*					refCon;
+	char*					data;			// What was read so far, starting with the data length. NULL if nothing.
+	uint32_t				dataSize;		// Room in data.
+	uint32_t				amountRead;
+	uint64_t				dataOffset;		// Absolute file offset of the data length.
+	int16_t					error;
+	bool					inUse;
+	bool					reading;		// A read for it is queued or in flight.
+	size_t					next;			// Next free slot, or next done fetch.
+};
+
+#define FAKE_NO_RES_FETCH	SIZE_MAX
+
+
+// A resource that isn't in any of the open files:
+struct FakeResMiss
+{
+	uint32_t				generation;		// gFakeResMissGeneration at the time. 0 if unused.
+	uint32_t				resType;
+	int16_t					resID;
+};
+
+#define FAKE_RES_MISS_CACHE_SIZE	64		// A power of 2.
+
+
+// What FakeShareResourceMap() publishes along with the resource data, followed
+//	by the resource map as it is in the file:
+struct FakeSharedMapInfo
+{
+	struct FakeResMapLocation	location;
+	bool						readOnly;
+};
+
+#define FAKE_SHARED_COMPRESSED_IN_RAM	1	// Flag of published data we couldn't decompress, see compressedInRAM.
+
+
+// Where FakeSaveResourceMap() puts each resource's data, see FakeLayOutResourceData():
+struct FakeResDataLayout
+{
+	struct FakeReferenceListEntry**	entries;		// In the order their data goes in the file.
+	uint64_t*						offsets;		// Where each one's length goes, resource data relative.
+	bool*							sharesData;		// Whether each one's offset is another one's, too. NULL if none are.
+	size_t							numEntries;
+	uint64_t						dataLength;		// Up to the end of the last one.
+};
+
+// Resources FakeLayOutResourceData() already found a place for, by a hash of
+//	their data, after FakeSetResDedup(true):
+struct FakeResDataHashTable
+{
+	size_t*							slots;			// Index +1 of an entry in the layout, 0 if empty.
+	size_t							numSlots;		// A power of 2.
+	uint64_t*						hashes;			// Of each entry in the layout.
+};
+
+// One resource being sorted by FakeLayOutResourceData():
+struct FakeResDataRank
+{
+	struct FakeReferenceListEntry*	entry;
+	bool							preload;
+	uint32_t						profileRank;	// Position in the profile, UINT32_MAX if not in it.
+	uint32_t						typeRank;		// Position of its type in the type order, UINT32_MAX if not in it.
+	size_t							mapIndex;		// Position in the map.
+};
+
 
 struct FakeResourceMap	*	gResourceMap = NULL;		// Linked list.
 struct FakeResourceMap	*	gCurrResourceMap = NULL;	// Start search of map here.
-int16_t						gFileRefNumSeed = 0;
+int32_t						gFileRefNumSeed = 0;		// Next reference number never handed out. Once all have been, closed files' are reused.
+struct FakeResourceMap**	gResourceMapsByRefNum = NULL;	// The open map for each reference number, or NULL.
+size_t						gMaxResourceMapsByRefNum = 0;
+size_t						gNumResourceMaps = 0;
+int16_t*					gFreeFileRefNums = NULL;	// Queue of reference numbers to hand out again. Made once there are no new ones left.
+size_t						gFirstFreeFileRefNum = 0;
+size_t						gNumFreeFileRefNums = 0;
+size_t						gFakeResFileLimit = 0;		// FakeSetResFileLimit().
+size_t						gNumOpenReopenableMaps = 0;
+struct FakeResourceMap	*	gOldestOpenReopenableMap = NULL;	// Least recently used first.
+struct FakeResourceMap	*	gNewestOpenReopenableMap = NULL;
 int16_t						gFakeResError = noErr;
 struct FakeTypeCountEntry*	gLoadedTypes = NULL;
 int16_t						gNumLoadedTypes = 0;
+bool						gFakeResLoad = true;		// FakeSetResLoad().
+int16_t						gFakeResLoadThreads = 1;	// FakeSetResLoadThreads().
+long						gFakeNumSeeks = 0;			// FakeFSeek() calls so far, for trace events.
+double						gFakeResProfileSeconds = 0;	// FakeSetResProfileRecording().
+bool						gFakeResPrefetch = true;	// FakeSetResPrefetch().
+bool						gFakeResFetchIOUring = true;	// FakeSetResFetchIOUring().
+struct FakeAsyncIO*			gFakeResFetchIO = NULL;		// Made when the first fetch starts.
+struct FakeResFetch*		gFakeResFetches = NULL;		// Indexed by the userData of their reads.
+size_t						gMaxResFetches = 0;
+size_t						gNumResFetches = 0;			// Slots in use.
+size_t						gFirstFreeResFetch = FAKE_NO_RES_FETCH;
+size_t						gFirstDoneResFetch = FAKE_NO_RES_FETCH;	// Queue of those whose proc is due, oldest first.
+size_t						gLastDoneResFetch = FAKE_NO_RES_FETCH;
+bool						gCompletingResFetches = false;	// Inside FakeCompleteResFetches(), which wakes the poller itself.
+struct FakeResMiss			gFakeResMisses[FAKE_RES_MISS_CACHE_SIZE];	// Resources FakeGetResource() recently didn't find, see FakeForgetResMisses().
+uint32_t					gFakeResMissGeneration = 1;	// Misses noted with an older one are out of date.
+bool						gFakeResSharedCache = false;	// FakeSetResSharedCache().
+bool						gFakeResDedup = false;		// FakeSetResDedup().
+
+
+// Reference numbers go from 0 up, negative ones are errors:
+#define FAKE_MAX_FILE_REF_NUMS			(INT16_MAX +1)
+
+// Most Handles that point at the same copy-on-write data, see FakeShareDuplicateData().
+//	More resources sharing it in the file get their own copies:
+#define FAKE_MAX_SHARED_DATA_COPIES		64
+
+// Largest chunk of resource data we read in one go when several resources lie
+//	next to each other on disk, and how many unneeded bytes between two resources
+//	we're willing to read to save a separate read:
+#define FAKE_MAX_COALESCED_READ_SIZE	(1024 * 1024)
+#define FAKE_MAX_COALESCED_READ_GAP		4096
+
+// Access profiles are saved next to the resource file, with this appended to its name:
+#define FAKE_PROFILE_SUFFIX				".rprof"
+#define FAKE_PROFILE_MAGIC				'RPRF'
+#define FAKE_PROFILE_VERSION			1
+
+// Lengths of the parts of classic and extended resource files described above:
+#define FAKE_CLASSIC_MAP_HEADER_LENGTH	(16 + 4 + 2 + 2 + 2 + 2)
+#define FAKE_EXTENDED_MAGIC				'RCLX'
+#define FAKE_EXTENDED_VERSION			1
+#define FAKE_EXTENDED_HEADER_LENGTH		(16 + 4 + 2 + 2 + 8 + 8 + 8 + 8)
+#define FAKE_EXTENDED_MAP_HEADER_LENGTH	(4 + 2 + 2 + 4 + 4)
+#define FAKE_EXTENDED_TYPE_ENTRY_LENGTH	(4 + 4 + 4)
+#define FAKE_EXTENDED_REF_ENTRY_LENGTH	(2 + 1 + 1 + 4 + 8)
+
+// Both formats start the resource data after the header, reserved and application data:
+#define FAKE_RES_DATA_OFFSET			(16 + 112 + 128)
+
+// FakeCompactResFile() counts what it takes to read cold resources in pages of this size:
+#define FAKE_COLD_READ_PAGE_SIZE		4096
+
+// Types with at most this many resources are looked up by scanning their
+//	resourceIDs, which is quicker than making and searching a FakeResIDIndex:
+#define FAKE_MIN_RESOURCES_FOR_ID_INDEX	256
 
 
 struct FakeTypeCountEntry
@@ -132,8 +396,10 @@ size_t	FakeFWriteUInt16BE( uint16_t inInt, FILE* theFile )
 void	FakeFSeek( FILE* inFile, long inOffset, int inMode )
 {
 	int theResult = fseek( inFile,  inOffset, inMode );
+	gFakeNumSeeks++;
+	FAKE_TRACE_EVENT( kFakeTraceSeek, .offset = inOffset );
 	if( theResult != 0 )
-		printf( "Seek to %ld result %d\n", inOffset, theResult );
+		FAKE_TRACE( kFakeTraceLevelError, "Seek to %ld result %d", inOffset, theResult );
 }
 
 
@@ -193,352 +459,3095 @@ void	FakeReleaseType( uint32_t resType )
 
 struct FakeResourceMap*	FakeFindResourceMap( int16_t inFileRefNum, struct FakeResourceMap*** outPrevMapPtr )
 {
-	struct FakeResourceMap*	currMap = gResourceMap;
+	struct FakeResourceMap*	theMap = (inFileRefNum >= 0 && (size_t)inFileRefNum < gMaxResourceMapsByRefNum) ? gResourceMapsByRefNum[inFileRefNum] : NULL;
 	if( outPrevMapPtr )
-		*outPrevMapPtr = &gResourceMap;
-	
-	while( currMap != NULL && currMap->fileRefNum != inFileRefNum )
-	{
-		if( outPrevMapPtr )
-			*outPrevMapPtr = &currMap->nextResourceMap;
-		currMap = currMap->nextResourceMap;
-	}
-	return currMap;
-}
-
-short fakeresfileopen(const char* inPath, const char* inMode, size_t startOffs) {
-    struct FakeResourceMap	* theMap = FakeResFileOpen(inPath, inMode, startOffs);
-    if( theMap )
-        return theMap->fileRefNum;
-    else
-        return gFakeResError;
+		*outPrevMapPtr = (theMap && theMap->prevResourceMap) ? &theMap->prevResourceMap->nextResourceMap : &gResourceMap;
+	return theMap;
 }
 
 
-struct FakeResourceMap*	FakeResFileOpen( const char* inPath, const char* inMode, size_t startOffs )
+// Makes sure FakeNewFileRefNum() can hand out inCount more reference numbers.
+//	Returns false if there aren't that many left, or not enough memory:
+static bool	FakeReserveFileRefNums( size_t inCount )
 {
-	FILE		*			theFile = fopen( inPath, inMode );
-	if( !theFile )
-	{
-		gFakeResError = fnfErr;
-		return NULL;
-	}
-	
-	uint32_t			resourceDataOffset = 0;
-	uint32_t			resourceMapOffset = 0;
-	uint32_t			lengthOfResourceData = 0;
-	uint32_t			lengthOfResourceMap = 0;
+	if( inCount > FAKE_MAX_FILE_REF_NUMS -gNumResourceMaps )
+		return false;
 	
-	struct FakeResourceMap	*	newMap = calloc( 1, sizeof(struct FakeResourceMap) );
-	newMap->fileDescriptor = theFile;
-	newMap->fileRefNum = gFileRefNumSeed++;
-
-    fseek(theFile, startOffs, SEEK_SET);
-
-	if( fread( &resourceDataOffset, 1, sizeof(resourceDataOffset), theFile ) != sizeof(resourceDataOffset) )
-	{
-		gFakeResError = eofErr;
-		free( newMap );
-		newMap = NULL;
-		return NULL;
-	}
-	resourceDataOffset = BIG_ENDIAN_32(resourceDataOffset) + startOffs;
-	printf("resourceDataOffset %d\n", resourceDataOffset);
-
-	if( fread( &resourceMapOffset, 1, sizeof(resourceMapOffset), theFile ) != sizeof(resourceMapOffset) )
+	size_t	numNew = FAKE_MAX_FILE_REF_NUMS -(size_t)gFileRefNumSeed;
+	if( numNew > inCount )
+		numNew = inCount;
+	if( (size_t)gFileRefNumSeed +numNew > gMaxResourceMapsByRefNum )
 	{
-		gFakeResError = eofErr;
-		free( newMap );
-		newMap = NULL;
-		return NULL;
+		size_t	newMax = gMaxResourceMapsByRefNum ? gMaxResourceMapsByRefNum : 64;
+		while( newMax < (size_t)gFileRefNumSeed +numNew )
+			newMax *= 2;
+		if( newMax > FAKE_MAX_FILE_REF_NUMS )
+			newMax = FAKE_MAX_FILE_REF_NUMS;
+		struct FakeResourceMap**	newMaps = realloc( gResourceMapsByRefNum, newMax * sizeof(struct FakeResourceMap*) );
+		if( !newMaps )
+			return false;
+		memset( newMaps +gMaxResourceMapsByRefNum, 0, (newMax -gMaxResourceMapsByRefNum) * sizeof(struct FakeResourceMap*) );
+		gResourceMapsByRefNum = newMaps;
+		gMaxResourceMapsByRefNum = newMax;
 	}
-	resourceMapOffset = BIG_ENDIAN_32(resourceMapOffset) + startOffs;
-	printf("resourceMapOffset %d\n", resourceMapOffset);
 	
-	if( fread( &lengthOfResourceData, 1, sizeof(lengthOfResourceData), theFile ) != sizeof(lengthOfResourceData) )
-	{
-		gFakeResError = eofErr;
-		free( newMap );
-		newMap = NULL;
-		return NULL;
-	}
-	lengthOfResourceData = BIG_ENDIAN_32(lengthOfResourceData);
-
-	if( fread( &lengthOfResourceMap, 1, sizeof(lengthOfResourceMap), theFile ) != sizeof(lengthOfResourceMap) )
+	// Running out of new ones? Queue up those of the files closed so far, FakeFreeFileRefNum() adds the rest:
+	if( numNew < inCount && !gFreeFileRefNums )
 	{
-		gFakeResError = eofErr;
-		free( newMap );
-		newMap = NULL;
-		return NULL;
-	}
-	lengthOfResourceMap = BIG_ENDIAN_32(lengthOfResourceMap);
-	
-	FakeFSeek( theFile, 112, SEEK_CUR );	// Skip system data.
-	FakeFSeek( theFile, 128, SEEK_CUR );	// Skip application data.
-	
-	FakeFSeek( theFile, resourceMapOffset, SEEK_SET );
-	FakeFSeek( theFile, 16, SEEK_CUR );		// Skip resource file header copy.
-	FakeFSeek( theFile, 4, SEEK_CUR );		// Skip next resource map placeholder.
-	FakeFSeek( theFile, 2, SEEK_CUR );		// Skip file ref num placeholder.
-	fread( &newMap->resFileAttributes, 1, sizeof(uint16_t), theFile );		// Read file attributes.
-	newMap->resFileAttributes = BIG_ENDIAN_16(newMap->resFileAttributes);
-	printf("resFileAttributes %d\n", newMap->resFileAttributes);
-	
-	uint16_t		typeListOffset = 0;
-	uint16_t		nameListOffset = 0;
-	
-	fread( &typeListOffset, 1, sizeof(typeListOffset), theFile );
-	typeListOffset = BIG_ENDIAN_16(typeListOffset);
-	fread( &nameListOffset, 1, sizeof(nameListOffset), theFile );
-	nameListOffset = BIG_ENDIAN_16(nameListOffset);
-	
-	long		typeListSeekPos = resourceMapOffset +(long)typeListOffset;
-	printf("typeListSeekPos %ld\n", typeListSeekPos);
-	FakeFSeek( theFile, typeListSeekPos, SEEK_SET );
-	
-	uint16_t		numTypes = 0;
-	fread( &numTypes, 1, sizeof(numTypes), theFile );
-	numTypes = BIG_ENDIAN_16(numTypes) +1;
-	printf("numTypes %d\n", numTypes);
-	
-	newMap->typeList = calloc( ((int)numTypes), sizeof(struct FakeTypeListEntry) );
-	newMap->numTypes = numTypes;
-	for( int x = 0; x < ((int)numTypes); x++ )
-	{
-		uint32_t	currType = 0;
-		fread( &currType, 1, sizeof(uint32_t), theFile );	// Read type code (4CC).
-		char		typeStr[5] = {0};
-		memmove( typeStr, &currType, 4 );
-		printf( "currType '%s'\n", typeStr );
-		currType = BIG_ENDIAN_32( currType );
-		newMap->typeList[x].resourceType = currType;
-		
-		FakeRetainType( currType );
-				
-		uint16_t		numResources = 0;
-		fread( &numResources, 1, sizeof(numResources), theFile );
-		numResources = BIG_ENDIAN_16(numResources);
-		printf("\tnumResources %d\n", numResources +1);
-		
-		uint16_t		refListOffset = 0;
-		fread( &refListOffset, 1, sizeof(refListOffset), theFile );
-		refListOffset = BIG_ENDIAN_16(refListOffset);
-		
-		long		oldOffset = ftell(theFile);
-		
-		long		refListSeekPos = typeListSeekPos +(long)refListOffset;
-		printf("\trefListSeekPos %ld\n", refListSeekPos);
-		FakeFSeek( theFile, refListSeekPos, SEEK_SET );
-				
-		newMap->typeList[x].resourceList = calloc( ((int)numResources) +1, sizeof(struct FakeReferenceListEntry) );
-		newMap->typeList[x].numberOfResourcesOfType = ((int)numResources) +1;
-		for( int y = 0; y < ((int)numResources) +1; y++ )
+		gFreeFileRefNums = malloc( FAKE_MAX_FILE_REF_NUMS * sizeof(int16_t) );
+		if( !gFreeFileRefNums )
+			return false;
+		for( int32_t x = 0; x < gFileRefNumSeed; x++ )
 		{
-			fread( &newMap->typeList[x].resourceList[y].resourceID, 1, sizeof(uint16_t), theFile );
-			newMap->typeList[x].resourceList[y].resourceID = BIG_ENDIAN_16(newMap->typeList[x].resourceList[y].resourceID);
-			
-			uint16_t	nameOffset = 0;
-			fread( &nameOffset, 1, sizeof(nameOffset), theFile );
-			nameOffset = BIG_ENDIAN_16(nameOffset);
-
-			unsigned char	attributesAndDataOffset[4];
-			uint32_t		dataOffset = 0;
-			fread( &attributesAndDataOffset, 1, sizeof(attributesAndDataOffset), theFile );
-			newMap->typeList[x].resourceList[y].resourceAttributes = attributesAndDataOffset[0];
-			memmove( ((char*)&dataOffset) +1, attributesAndDataOffset +1, 3 );
-			dataOffset = BIG_ENDIAN_32(dataOffset);
-			FakeFSeek( theFile, 4, SEEK_CUR );		// Skip resource Handle placeholder.
-		
-			long		innerOldOffset = ftell(theFile);
-			long		dataSeekPos = resourceDataOffset +(long)dataOffset;
-			FakeFSeek( theFile, dataSeekPos, SEEK_SET );
-			uint32_t	dataLength = 0;
-			fread( &dataLength, 1, sizeof(dataLength), theFile );
-			dataLength = BIG_ENDIAN_32(dataLength);
-			newMap->typeList[x].resourceList[y].resourceHandle = FakeNewHandle(dataLength);
-			fread( (*newMap->typeList[x].resourceList[y].resourceHandle), 1, dataLength, theFile );
-			
-			if( -1 != (long)nameOffset )
-			{
-				long		nameSeekPos = resourceMapOffset +(long)nameListOffset +(long)nameOffset;
-				FakeFSeek( theFile, nameSeekPos, SEEK_SET );
-				uint8_t	nameLength = 0;
-				fread( &nameLength, 1, sizeof(nameLength), theFile );
-				newMap->typeList[x].resourceList[y].resourceName[0] = nameLength;
-				if( nameLength > 0 )
-					fread( newMap->typeList[x].resourceList[y].resourceName +1, 1, nameLength, theFile );
-			}
-			
-			printf( "\t%d: \"%s\"\n", newMap->typeList[x].resourceList[y].resourceID, newMap->typeList[x].resourceList[y].resourceName +1 );
-			
-			FakeFSeek( theFile, innerOldOffset, SEEK_SET );
+			if( !gResourceMapsByRefNum[x] )
+				gFreeFileRefNums[gNumFreeFileRefNums++] = (int16_t)x;
 		}
-		
-		FakeFSeek( theFile, oldOffset, SEEK_SET );
 	}
 	
-	newMap->nextResourceMap = gResourceMap;
-	gResourceMap = newMap;
-	gFakeResError = noErr;
-	
-	gCurrResourceMap = gResourceMap;
+	return true;
+}
+
+
+// Hands out a reference number for inMap, after FakeReserveFileRefNums() made
+//	sure there is one. New ones until there are none left, then those of closed
+//	files, those closed longest ago first, so a stale reference number takes as
+//	long as possible to point at another file:
+static int16_t	FakeNewFileRefNum( struct FakeResourceMap* inMap )
+{
+	int16_t		theRefNum = 0;
+	if( gFileRefNumSeed < FAKE_MAX_FILE_REF_NUMS )
+		theRefNum = (int16_t)gFileRefNumSeed++;
+	else
+	{
+		theRefNum = gFreeFileRefNums[gFirstFreeFileRefNum];
+		gFirstFreeFileRefNum = (gFirstFreeFileRefNum +1) % FAKE_MAX_FILE_REF_NUMS;
+		gNumFreeFileRefNums--;
+	}
+	gResourceMapsByRefNum[theRefNum] = inMap;
+	gNumResourceMaps++;
 	
-	return newMap;
+	return theRefNum;
 }
 
 
-int16_t	FakeOpenResFile( const unsigned char* inPath )
+static void	FakeFreeFileRefNum( int16_t inFileRefNum )
 {
-#if READ_REAL_RESOURCE_FORKS
-	const char*	resForkSuffix = "/..namedfork/rsrc";
-#endif // READ_REAL_RESOURCE_FORKS
-	char		thePath[256 +17] = {0};
-	memmove(thePath,inPath +1,inPath[0]);
-#if READ_REAL_RESOURCE_FORKS
-	memmove(thePath +inPath[0],resForkSuffix,17);
-#endif // READ_REAL_RESOURCE_FORKS
-	struct FakeResourceMap*	theMap = FakeResFileOpen( thePath, "r+", 0 );
-	if( !theMap )
-		theMap = FakeResFileOpen( thePath, "r", 0 );
-	if( theMap )
-		return theMap->fileRefNum;
+	gResourceMapsByRefNum[inFileRefNum] = NULL;
+	gNumResourceMaps--;
+	if( gFreeFileRefNums )
+		gFreeFileRefNums[(gFirstFreeFileRefNum +gNumFreeFileRefNums++) % FAKE_MAX_FILE_REF_NUMS] = inFileRefNum;
+}
+
+
+static void	FakeStopResourcePrefetch( struct FakeResourceMap* inMap );
+
+
+// Reopenable maps whose files are open are kept in a list, least recently used first:
+static void	FakeLinkOpenReopenableMap( struct FakeResourceMap* inMap )
+{
+	inMap->olderOpenMap = gNewestOpenReopenableMap;
+	inMap->newerOpenMap = NULL;
+	if( gNewestOpenReopenableMap )
+		gNewestOpenReopenableMap->newerOpenMap = inMap;
 	else
-		return gFakeResError;
+		gOldestOpenReopenableMap = inMap;
+	gNewestOpenReopenableMap = inMap;
+	gNumOpenReopenableMaps++;
 }
 
 
-static bool FakeFindResourceHandleInMap( Handle theResource, struct FakeTypeListEntry** outTypeEntry, struct FakeReferenceListEntry** outRefEntry, struct FakeResourceMap* inMap )
+static void	FakeUnlinkOpenReopenableMap( struct FakeResourceMap* inMap )
+{
+	if( !inMap->olderOpenMap && gOldestOpenReopenableMap != inMap )
+		return;	// Not in the list.
+	
+	if( inMap->olderOpenMap )
+		inMap->olderOpenMap->newerOpenMap = inMap->newerOpenMap;
+	else
+		gOldestOpenReopenableMap = inMap->newerOpenMap;
+	if( inMap->newerOpenMap )
+		inMap->newerOpenMap->olderOpenMap = inMap->olderOpenMap;
+	else
+		gNewestOpenReopenableMap = inMap->olderOpenMap;
+	inMap->olderOpenMap = NULL;
+	inMap->newerOpenMap = NULL;
+	gNumOpenReopenableMaps--;
+}
+
+
+// Closes the files of the least recently used reopenable maps until there are
+//	no more open than FakeSetResFileLimit() allows. Files fetches are reading
+//	from stay open, and so does inKeepMap's:
+static void	FakeCloseUnusedResMapFiles( struct FakeResourceMap* inKeepMap )
 {
-	if( (theResource != NULL) && (inMap != NULL) )
+	struct FakeResourceMap*	currMap = gOldestOpenReopenableMap;
+	while( gFakeResFileLimit > 0 && gNumOpenReopenableMaps > gFakeResFileLimit && currMap != NULL )
 	{
-		for( int x = 0; x < inMap->numTypes; x++ )
+		struct FakeResourceMap*	nextMap = currMap->newerOpenMap;
+		if( currMap != inKeepMap && currMap->numFetchReads == 0 )
 		{
-			for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
-			{
-				if( inMap->typeList[x].resourceList[y].resourceHandle == theResource )
-				{
-					if (outTypeEntry)
-					{
-						*outTypeEntry = &inMap->typeList[x];
-					}
-					
-					if (outRefEntry)
-					{
-						*outRefEntry = &inMap->typeList[x].resourceList[y];
-					}
-
-					return true;
-				}
-			}
+			FakeStopResourcePrefetch( currMap );	// Its thread reads the file. What it didn't hand out yet is read again when needed.
+			FakeUnlinkOpenReopenableMap( currMap );
+			fclose( currMap->fileDescriptor );
+			currMap->fileDescriptor = NULL;
 		}
+		currMap = nextMap;
 	}
+}
 
-	if (outTypeEntry)
-	{
-		*outTypeEntry = NULL;
-	}
-	
-	if (outRefEntry)
+
+// Opens a reopenable map's file again, without touching any globals. NULL if
+//	that fails, or another file has taken its place since it was opened:
+static FILE*	FakeReopenResMapFile( struct FakeResourceMap* inMap )
+{
+	FILE*		theFile = inMap->filePath ? fopen( inMap->filePath, "r" ) : NULL;
+	struct stat	fileInfo;
+	if( theFile && (fstat( fileno( theFile ), &fileInfo ) != 0 || fileInfo.st_dev != inMap->fileDevice || fileInfo.st_ino != inMap->fileInode) )
 	{
-		*outRefEntry = NULL;
+		fclose( theFile );
+		theFile = NULL;
 	}
-
-	return false;
+	if( !theFile )
+		FAKE_TRACE( kFakeTraceLevelError, "Couldn't open \"%s\" again.", inMap->filePath ? inMap->filePath : "" );
+	return theFile;
 }
 
 
-static bool FakeFindResourceHandle( Handle theResource, struct FakeResourceMap** outMap, struct FakeTypeListEntry** outTypeEntry, struct FakeReferenceListEntry** outRefEntry )
+// Notes which file a reopenable map has open, so FakeReopenResMapFile() can tell
+//	if it's still the same one:
+static void	FakeNoteResMapFileIdentity( struct FakeResourceMap* inMap )
 {
-	struct FakeResourceMap*		currMap = gResourceMap;
-	while( currMap != NULL )
+	struct stat	fileInfo;
+	if( inMap->fileDescriptor && fstat( fileno( inMap->fileDescriptor ), &fileInfo ) == 0 )
 	{
-		if( FakeFindResourceHandleInMap(theResource, outTypeEntry, outRefEntry, currMap) )
-		{
-			if( outMap )
-			{
-				*outMap = currMap;
-			}
-			return true;
-		}
-
-		currMap = currMap->nextResourceMap;
+		inMap->fileDevice = fileInfo.st_dev;
+		inMap->fileInode = fileInfo.st_ino;
 	}
+}
 
-	if ( outMap )
+
+// The descriptor to read an installed map's file with, opening it again if it
+//	was closed to stay under FakeSetResFileLimit(). Flushes the FILE first, as
+//	pread() doesn't see data still in its buffer. -1 if it can't be opened:
+static int	FakeGetResMapFD( struct FakeResourceMap* inMap )
+{
+	if( !inMap->fileDescriptor )
 	{
-		*outMap = NULL;
+		inMap->fileDescriptor = FakeReopenResMapFile( inMap );
+		if( !inMap->fileDescriptor )
+			return -1;
+		FakeLinkOpenReopenableMap( inMap );
+		FakeCloseUnusedResMapFiles( inMap );
 	}
-	
-	if (outTypeEntry)
+	else if( inMap->newerOpenMap )	// In the list, but not the most recently used?
 	{
-		*outTypeEntry = NULL;
+		FakeUnlinkOpenReopenableMap( inMap );
+		FakeLinkOpenReopenableMap( inMap );
 	}
 	
-	if (outRefEntry)
-	{
-		*outRefEntry = NULL;
-	}
+	fflush( inMap->fileDescriptor );
+	return fileno( inMap->fileDescriptor );
+}
 
-	return false;
+
+static bool	FakeReferenceEntryNeedsLoad( struct FakeReferenceListEntry* inEntry )
+{
+	return( (*inEntry->resourceHandle == NULL) && (inEntry->dataExtent != 0) );
 }
 
 
-static struct FakeTypeListEntry* FakeFindTypeListEntry(struct FakeResourceMap* inMap, uint32_t theType)
+static int	FakeCompareReferenceEntryOffsets( const void* inA, const void* inB )
 {
-	if( inMap != NULL )
+	uint64_t	offsA = (*(struct FakeReferenceListEntry**)inA)->dataOffset;
+	uint64_t	offsB = (*(struct FakeReferenceListEntry**)inB)->dataOffset;
+	if( offsA < offsB )
+		return -1;
+	else if( offsA > offsB )
+		return 1;
+	return 0;
+}
+
+
+// Returns a list of all resources in the given map, sorted by data offset.
+//	Caller must free() the list. Returns NULL, with a count of 0, if there's
+//	not enough memory.
+static struct FakeReferenceListEntry**	FakeCopyReferenceEntriesByOffset( struct FakeResourceMap* inMap, size_t* outCount )
+{
+	size_t	numEntries = 0;
+	for( int x = 0; x < inMap->numTypes; x++ )
+		numEntries += inMap->typeList[x].numberOfResourcesOfType -inMap->typeList[x].numRemovedResources;
+	
+	*outCount = 0;
+	struct FakeReferenceListEntry**	entries = malloc( (numEntries +1) * sizeof(struct FakeReferenceListEntry*) );
+	if( !entries )
+		return NULL;
+	size_t	currEntry = 0;
+	for( int x = 0; x < inMap->numTypes; x++ )
 	{
-		for( int x = 0; x < inMap->numTypes; x++ )
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
 		{
-			if( inMap->typeList[x].resourceType == theType )
-			{
-				return &inMap->typeList[x];
-			}
+			if( inMap->typeList[x].numRemovedResources == 0 || inMap->typeList[x].resourceList[y].resourceHandle )	// No Handles yet while reading the map.
+				entries[currEntry++] = &inMap->typeList[x].resourceList[y];
 		}
 	}
+	qsort( entries, numEntries, sizeof(struct FakeReferenceListEntry*), FakeCompareReferenceEntryOffsets );
+	
+	*outCount = numEntries;
+	return entries;
+}
 
-	return NULL;
+
+// Work out how many bytes each resource's data may occupy on disk, so we can
+//	later read several resources that follow each other in one go.
+static void	FakeComputeDataExtents( struct FakeReferenceListEntry** inEntries, size_t inCount, uint64_t inDataEnd )
+{
+	uint64_t	nextOffset = inDataEnd;
+	for( size_t x = inCount; x-- > 0; )
+	{
+		if( (x +1) < inCount && inEntries[x +1]->dataOffset != inEntries[x]->dataOffset )	// Resources sharing data share the extent.
+			nextOffset = inEntries[x +1]->dataOffset;
+		inEntries[x]->sharesData = ((x +1) < inCount && inEntries[x +1]->dataOffset == inEntries[x]->dataOffset)
+									|| (x > 0 && inEntries[x -1]->dataOffset == inEntries[x]->dataOffset);
+		
+		uint64_t	extent = (nextOffset > inEntries[x]->dataOffset) ? (nextOffset -inEntries[x]->dataOffset) : 0;
+		if( extent > UINT32_MAX )
+			extent = UINT32_MAX;	// No resource is larger than that, its length says where it really ends.
+		else if( extent < sizeof(uint32_t) )
+			extent = sizeof(uint32_t);	// Too small to be right, we'll read the actual length when loading.
+		inEntries[x]->dataExtent = (uint32_t)extent;
+	}
 }
 
-int16_t	FakeHomeResFile( Handle theResource )
+
+// Decompress a resource we just read if it needs it. If we can't, keep the
+//	data as it is in the file, so it can be written back unchanged:
+static void	FakeFinishLoadingReferenceEntry( struct FakeReferenceListEntry* inEntry, int16_t inLoadErr )
 {
-	struct FakeResourceMap*		currMap = NULL;
+	inEntry->compressedInRAM = false;
+	if( inLoadErr == noErr && (inEntry->resourceAttributes & resCompressed) != 0 )
+		inEntry->compressedInRAM = (FakeDecompressResourceData( inEntry->resourceHandle ) != noErr);
+}
 
-	if( FakeFindResourceHandle( theResource, &currMap, NULL, NULL) )
+
+// Load a single resource's data with two reads, no matter how large it is:
+static int16_t	FakeLoadReferenceEntryDirectly( int inFD, uint64_t inReadLimit, struct FakeReferenceListEntry* inEntry )
+{
+	uint32_t	dataLength = 0;
+	if( ((uint64_t)inEntry->dataOffset +sizeof(dataLength)) > inReadLimit )
+		return eofErr;
+	ssize_t		amountRead = pread( inFD, &dataLength, sizeof(dataLength), inEntry->dataOffset );
+	FAKE_TRACE_EVENT( kFakeTraceBytesRead, .offset = inEntry->dataOffset, .byteCount = amountRead );
+	if( amountRead != sizeof(dataLength) )
+		return eofErr;
+	dataLength = BIG_ENDIAN_32(dataLength);
+	if( ((uint64_t)inEntry->dataOffset +sizeof(dataLength) +dataLength) > inReadLimit )
+		return eofErr;
+	
+	long	err = FakeSetHandleSizeReentrant( inEntry->resourceHandle, dataLength );
+	if( err != noErr )
+		return (int16_t)err;
+	if( dataLength > 0 )
 	{
-		gFakeResError = noErr;
-		return currMap->fileRefNum;
+		amountRead = pread( inFD, *inEntry->resourceHandle, dataLength, inEntry->dataOffset +sizeof(dataLength) );
+		FAKE_TRACE_EVENT( kFakeTraceBytesRead, .offset = inEntry->dataOffset +sizeof(dataLength), .byteCount = amountRead );
+		if( amountRead != (ssize_t)dataLength )
+		{
+			FakeEmptyHandle( inEntry->resourceHandle );
+			return eofErr;
+		}
 	}
 	
-	gFakeResError = resNotFound;
-	return -1;
+	return noErr;
 }
 
 
-void	FakeUpdateResFile( int16_t inFileRefNum )
+// Load the data of the given resources from the given file. The entries must be
+//	sorted by data offset. Resources that lie next to each other on disk are
+//	loaded with a single read. Errors for individual resources are returned in
+//	outErrors (if not NULL), the first error that occurred is the return value.
+//	Nothing at or after inReadLimit is read.
+//	Only uses pread(), so several threads may call this on different entries.
+static int16_t	FakeLoadReferenceEntriesFromFile( int inFD, uint64_t inReadLimit, struct FakeReferenceListEntry** inEntries, int16_t* outErrors, size_t inCount )
 {
-	const long kResourceHeaderLength            = 16;
-	const long kResourceHeaderMapOffsetPos      = 4;
-	const long kResourceHeaderMapLengthPos      = 4 + 4 + 4;
-	const long kResourceHeaderReservedLength    = 112;
-	const long kResourceHeaderAppReservedLength = 128;
-	const long kReservedHeaderLength            = kResourceHeaderReservedLength + kResourceHeaderAppReservedLength;
-	const long kResourceDataSizeLength          = 4;
-	const long kResourceMapNextHandleLength     = 4;
-	const long kResourceMapFileRefLength        = 2;
-	const long kResourceMapTypeListOffsetLength = 2;
-	const long kResourceMapNameListOffsetLength = 2;
-	const long kResourceMapNumTypesLength       = 2;
-	const long kResourceRefLength               = 2 + 2 + 1 + 3 + 4;
-	const long kResourceTypeLength              = 4 + 2 + 2;
-
-	struct FakeResourceMap*		currMap = FakeFindResourceMap( inFileRefNum, NULL );
-	long						headerLength = kResourceHeaderLength + kReservedHeaderLength;
+	int16_t		firstErr = noErr;
+	char*		runBuffer = NULL;
+	size_t		runBufferSize = 0;
+	size_t		x = 0;
+	
+	while( x < inCount )
+	{
+		if( !FakeReferenceEntryNeedsLoad( inEntries[x] ) )
+		{
+			if( outErrors )
+				outErrors[x] = noErr;
+			x++;
+			continue;
+		}
+		
+		// Collect all following resources that we can read along with this one:
+		uint64_t	runStart = inEntries[x]->dataOffset;
+		uint64_t	runEnd = runStart +inEntries[x]->dataExtent;
+		size_t		runCount = 1;
+		while( (x +runCount) < inCount )
+		{
+			struct FakeReferenceListEntry*	nextEntry = inEntries[x +runCount];
+			uint64_t						nextEnd = nextEntry->dataOffset +nextEntry->dataExtent;
+			if( nextEntry->dataExtent == 0 || nextEntry->dataOffset > (runEnd +FAKE_MAX_COALESCED_READ_GAP) )
+				break;
+			if( nextEnd > runEnd )
+			{
+				if( (nextEnd -runStart) > FAKE_MAX_COALESCED_READ_SIZE )
+					break;
+				runEnd = nextEnd;
+			}
+			runCount++;
+		}
+		if( runEnd > inReadLimit )
+			runEnd = (runStart < inReadLimit) ? inReadLimit : runStart;
+		
+		if( runCount == 1 && (runEnd -runStart) > FAKE_MAX_COALESCED_READ_SIZE )	// Big resource on its own? Read straight into the Handle.
+		{
+			int16_t	err = FakeLoadReferenceEntryDirectly( inFD, inReadLimit, inEntries[x] );
+			FakeFinishLoadingReferenceEntry( inEntries[x], err );
+			FAKE_TRACE_EVENT( kFakeTraceResourceLoaded, .resID = inEntries[x]->resourceID, .offset = inEntries[x]->dataOffset,
+								.byteCount = FakeGetHandleSize( inEntries[x]->resourceHandle ), .error = err );
+			if( outErrors )
+				outErrors[x] = err;
+			if( firstErr == noErr )
+				firstErr = err;
+			x++;
+			continue;
+		}
+		
+		if( runBufferSize < (runEnd -runStart) )
+		{
+			free( runBuffer );
+			runBufferSize = runEnd -runStart;
+			runBuffer = malloc( runBufferSize );
+			if( !runBuffer )
+			{
+				runBufferSize = 0;
+				firstErr = memFulErr;
+				break;
+			}
+		}
+		ssize_t	amountRead = pread( inFD, runBuffer, runEnd -runStart, runStart );
+		FAKE_TRACE_EVENT( kFakeTraceBytesRead, .offset = runStart, .byteCount = amountRead );
+		if( amountRead < 0 )
+			amountRead = 0;
+		
+		for( size_t y = x; y < (x +runCount); y++ )
+		{
+			struct FakeReferenceListEntry*	currEntry = inEntries[y];
+			int16_t							err = noErr;
+			if( FakeReferenceEntryNeedsLoad( currEntry ) )
+			{
+				uint32_t	posInRun = (uint32_t)(currEntry->dataOffset -runStart);
+				uint32_t	dataLength = 0;
+				if( (posInRun +sizeof(dataLength)) <= amountRead )
+				{
+					memmove( &dataLength, runBuffer +posInRun, sizeof(dataLength) );
+					dataLength = BIG_ENDIAN_32(dataLength);
+				}
+				
+				if( (posInRun +sizeof(dataLength)) > amountRead
+					|| (dataLength +sizeof(dataLength)) > currEntry->dataExtent
+					|| (posInRun +sizeof(dataLength) +dataLength) > amountRead )	// Not all of it in our buffer? Read it separately.
+				{
+					err = FakeLoadReferenceEntryDirectly( inFD, inReadLimit, currEntry );
+				}
+				else
+				{
+					err = (int16_t)FakeSetHandleSizeReentrant( currEntry->resourceHandle, dataLength );
+					if( err == noErr )
+						memmove( *currEntry->resourceHandle, runBuffer +posInRun +sizeof(dataLength), dataLength );
+				}
+				FakeFinishLoadingReferenceEntry( currEntry, err );
+				FAKE_TRACE_EVENT( kFakeTraceResourceLoaded, .resID = currEntry->resourceID, .offset = currEntry->dataOffset,
+									.byteCount = FakeGetHandleSize( currEntry->resourceHandle ), .error = err );
+			}
+			if( outErrors )
+				outErrors[y] = err;
+			if( firstErr == noErr )
+				firstErr = err;
+		}
+		
+		x += runCount;
+	}
+	
+	free( runBuffer );
+	
+	return firstErr;
+}
+
+
+struct FakeParallelLoad
+{
+	int								fd;
+	uint64_t						readLimit;
+	struct FakeReferenceListEntry**	entries;
+	int16_t*						errors;
+	size_t*							chunkStarts;	// Index of first entry in each chunk, plus one past the last entry.
+	int16_t*						chunkErrors;
+};
+
+
+static void	FakeLoadReferenceEntriesChunk( size_t inChunk, void* inRefCon )
+{
+	struct FakeParallelLoad*	theLoad = inRefCon;
+	size_t						chunkStart = theLoad->chunkStarts[inChunk];
+	
+	theLoad->chunkErrors[inChunk] = FakeLoadReferenceEntriesFromFile( theLoad->fd, theLoad->readLimit, theLoad->entries +chunkStart,
+																		theLoad->errors ? (theLoad->errors +chunkStart) : NULL,
+																		theLoad->chunkStarts[inChunk +1] -chunkStart );
+}
+
+
+// Load the data of the given resources (sorted by data offset) from inMap's
+//	file, using several threads if FakeSetResLoadThreads() asked for it and
+//	there's enough data to make it worthwhile:
+static int16_t	FakeLoadReferenceEntriesOfMap( struct FakeResourceMap* inMap, struct FakeReferenceListEntry** inEntries, int16_t* outErrors, size_t inCount )
+{
+	int			fd = FakeGetResMapFD( inMap );	// If it's -1, reading fails and each resource gets the error.
+	uint64_t	totalSize = 0;
+	
+	if( gFakeResLoadThreads > 1 )
+	{
+		for( size_t x = 0; x < inCount; x++ )
+		{
+			if( FakeReferenceEntryNeedsLoad( inEntries[x] ) )
+				totalSize += inEntries[x]->dataExtent;
+		}
+	}
+	if( gFakeResLoadThreads <= 1 || totalSize < (2 * FAKE_MAX_COALESCED_READ_SIZE) )
+		return FakeLoadReferenceEntriesFromFile( fd, inMap->readLimit, inEntries, outErrors, inCount );
+	
+	// Split the resources into one contiguous chunk of about the same size per thread:
+	uint64_t	chunkSize = totalSize / gFakeResLoadThreads;
+	if( chunkSize < FAKE_MAX_COALESCED_READ_SIZE )
+		chunkSize = FAKE_MAX_COALESCED_READ_SIZE;
+	size_t*		chunkStarts = malloc( (gFakeResLoadThreads +1) * sizeof(size_t) );
+	int16_t*	chunkErrors = calloc( gFakeResLoadThreads, sizeof(int16_t) );
+	if( !chunkStarts || !chunkErrors )
+	{
+		free( chunkStarts );
+		free( chunkErrors );
+		return FakeLoadReferenceEntriesFromFile( fd, inMap->readLimit, inEntries, outErrors, inCount );
+	}
+	size_t		numChunks = 0;
+	uint64_t	sizeInChunk = 0;
+	chunkStarts[numChunks++] = 0;
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		if( sizeInChunk >= chunkSize && numChunks < (size_t)gFakeResLoadThreads )
+		{
+			chunkStarts[numChunks++] = x;
+			sizeInChunk = 0;
+		}
+		if( FakeReferenceEntryNeedsLoad( inEntries[x] ) )
+			sizeInChunk += inEntries[x]->dataExtent;
+	}
+	chunkStarts[numChunks] = inCount;
+	
+	struct FakeParallelLoad	theLoad = { fd, inMap->readLimit, inEntries, outErrors, chunkStarts, chunkErrors };
+	FakeRunParallel( numChunks, gFakeResLoadThreads, FakeLoadReferenceEntriesChunk, &theLoad );
+	
+	int16_t		firstErr = noErr;
+	for( size_t x = 0; x < numChunks && firstErr == noErr; x++ )
+		firstErr = chunkErrors[x];
+	
+	free( chunkErrors );
+	free( chunkStarts );
+	
+	return firstErr;
+}
+
+
+// Let the cache know which of these resources' data is now in RAM and could
+//	be emptied again, because it can be re-read from the file:
+static void	FakeCacheReferenceEntries( struct FakeReferenceListEntry** inEntries, size_t inCount )
+{
+	FakeResourceCacheSuspendEviction();
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		struct FakeReferenceListEntry*	currEntry = inEntries[x];
+		if( *currEntry->resourceHandle != NULL && currEntry->dataExtent != 0 && (currEntry->resourceAttributes & resChanged) == 0
+			&& !FakeIsHandleMemoryBorrowed( currEntry->resourceHandle ) )	// Emptying shared data wouldn't make room.
+			FakeResourceCacheAdd( currEntry->resourceHandle, (currEntry->resourceAttributes & resPurgeable) != 0 );
+	}
+	FakeResourceCacheResumeEviction();
+}
+
+
+static void	FakeCacheReferenceEntriesOfMap( struct FakeResourceMap* inMap )
+{
+	size_t							numEntries = 0;
+	struct FakeReferenceListEntry**	entries = FakeCopyReferenceEntriesByOffset( inMap, &numEntries );
+	FakeCacheReferenceEntries( entries, numEntries );
+	free( entries );
+}
+
+
+// Take the data of the given resources the prefetch thread has already read,
+//	and make sure it doesn't read any of them anymore, so we can read the rest:
+static void	FakeClaimPrefetchedEntries( struct FakeResourceMap* inMap, struct FakeReferenceListEntry** inEntries, size_t inCount )
+{
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		struct FakeReferenceListEntry*	currEntry = inEntries[x];
+		if( currEntry->prefetchSlot == 0 || !FakeReferenceEntryNeedsLoad( currEntry ) )
+			continue;
+		
+		char*		theData = NULL;
+		uint32_t	theLength = 0;
+		int16_t		err = noErr;
+		if( FakeClaimPrefetchedData( inMap->prefetchJob, currEntry->prefetchSlot -1, &theData, &theLength, &err ) == kFakePrefetchRead )
+		{
+			FakeAdoptHandleMemory( currEntry->resourceHandle, theData, theLength );
+			FakeFinishLoadingReferenceEntry( currEntry, noErr );
+			FAKE_TRACE_EVENT( kFakeTraceResourceLoaded, .resID = currEntry->resourceID, .offset = currEntry->dataOffset, .byteCount = theLength );
+		}
+		currEntry->prefetchSlot = 0;	// If it failed, we'll try again and report the error.
+	}
+}
+
+
+// Point the Handles of the given resources that aren't in RAM yet at the data
+//	another process published for them, if there is any. Only touches these
+//	Handles, so several threads can do this for different maps:
+static void	FakeClaimSharedEntries( struct FakeResourceMap* inMap, struct FakeReferenceListEntry** inEntries, size_t inCount )
+{
+	if( !inMap->sharedResources || inMap->sharedDataMoved )
+		return;
+	
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		struct FakeReferenceListEntry*	currEntry = inEntries[x];
+		uint32_t	theLength = 0, theFlags = 0;
+		char*		theData = FakeReferenceEntryNeedsLoad( currEntry ) ? FakeFindSharedResPayload( inMap->sharedResources, currEntry->dataOffset, &theLength, &theFlags ) : NULL;
+		if( theData && currEntry->sharesData )	// Changing one mustn't change the others.
+		{
+			char*	theCopy = malloc( (theLength > 0) ? theLength : 1 );
+			if( !theCopy )
+				continue;	// Let the caller read it.
+			memmove( theCopy, theData, theLength );
+			FakeAdoptHandleMemory( currEntry->resourceHandle, theCopy, theLength );
+		}
+		else if( theData )
+			FakeBorrowHandleMemory( currEntry->resourceHandle, theData, theLength );
+		if( theData )
+			currEntry->compressedInRAM = (theFlags & FAKE_SHARED_COMPRESSED_IN_RAM) != 0;
+	}
+}
+
+
+// Like FakeLoadReferenceEntriesOfMap(), but also takes data that was published
+//	or the prefetch thread already read, and adds the resources to the cache:
+static int16_t	FakeLoadReferenceEntries( struct FakeResourceMap* inMap, struct FakeReferenceListEntry** inEntries, int16_t* outErrors, size_t inCount )
+{
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		if( FakeReferenceEntryNeedsLoad( inEntries[x] ) )
+			FakeResourceCacheRestore( inEntries[x]->resourceHandle );	// Data the cache compressed needn't be read.
+	}
+	FakeClaimSharedEntries( inMap, inEntries, inCount );
+	if( inMap->prefetchJob )
+		FakeClaimPrefetchedEntries( inMap, inEntries, inCount );
+	int16_t		err = FakeLoadReferenceEntriesOfMap( inMap, inEntries, outErrors, inCount );
+	FakeCacheReferenceEntries( inEntries, inCount );
+	return err;
+}
+
+
+static int16_t	FakeLoadReferenceEntry( struct FakeResourceMap* inMap, struct FakeReferenceListEntry* inEntry )
+{
+	return FakeLoadReferenceEntries( inMap, &inEntry, NULL, 1 );
+}
+
+
+// Make sure all resources in the given map are in RAM, e.g. before we overwrite its file:
+static int16_t	FakeLoadAllReferenceEntries( struct FakeResourceMap* inMap )
+{
+	size_t							numEntries = 0;
+	struct FakeReferenceListEntry**	entries = FakeCopyReferenceEntriesByOffset( inMap, &numEntries );
+	if( !entries )
+		return memFulErr;
+	int16_t							err = FakeLoadReferenceEntries( inMap, entries, NULL, numEntries );
+	free( entries );
+	return err;
+}
+
+
+short fakeresfileopen(const char* inPath, const char* inMode, size_t startOffs) {
+    struct FakeResourceMap	* theMap = FakeResFileOpen(inPath, inMode, startOffs);
+    if( theMap )
+        return theMap->fileRefNum;
+    else
+        return gFakeResError;
+}
+
+
+static uint16_t	FakeGetUInt16BE( const uint8_t* inBytes )
+{
+	uint16_t	theNum = 0;
+	memmove( &theNum, inBytes, sizeof(theNum) );
+	return BIG_ENDIAN_16(theNum);
+}
+
+
+static uint32_t	FakeGetUInt32BE( const uint8_t* inBytes )
+{
+	uint32_t	theNum = 0;
+	memmove( &theNum, inBytes, sizeof(theNum) );
+	return BIG_ENDIAN_32(theNum);
+}
+
+
+static uint64_t	FakeGetUInt64BE( const uint8_t* inBytes )
+{
+	return ((uint64_t)FakeGetUInt32BE( inBytes ) << 32) | FakeGetUInt32BE( inBytes +4 );
+}
+
+
+static void	FakePutUInt16BE( uint8_t* outBytes, uint16_t inNum )
+{
+	inNum = BIG_ENDIAN_16(inNum);
+	memmove( outBytes, &inNum, sizeof(inNum) );
+}
+
+
+static void	FakePutUInt32BE( uint8_t* outBytes, uint32_t inNum )
+{
+	inNum = BIG_ENDIAN_32(inNum);
+	memmove( outBytes, &inNum, sizeof(inNum) );
+}
+
+
+static void	FakePutUInt64BE( uint8_t* outBytes, uint64_t inNum )
+{
+	FakePutUInt32BE( outBytes, (uint32_t)(inNum >> 32) );
+	FakePutUInt32BE( outBytes +4, (uint32_t)inNum );
+}
+
+
+// Changes the ID in both places we keep it:
+static void	FakeSetResourceID( struct FakeTypeListEntry* inTypeEntry, size_t inEntryIndex, int16_t inID )
+{
+	inTypeEntry->resourceIDs[inEntryIndex] = inID;
+	inTypeEntry->resourceList[inEntryIndex].resourceID = inID;
+}
+
+
+// Free a map and everything in it, without touching any of the globals:
+static void	FakeDisposeResourceMap( struct FakeResourceMap* inMap )
+{
+	for( int x = 0; x < inMap->numTypes; x++ )
+	{
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
+		{
+			if( inMap->typeList[x].resourceList[y].resourceHandle )
+				FakeDisposeHandle( inMap->typeList[x].resourceList[y].resourceHandle );
+		}
+		free( inMap->typeList[x].resourceList );
+		free( inMap->typeList[x].resourceIDs );
+		FakeDisposeResIDIndex( inMap->typeList[x].idIndex );
+	}
+	free( inMap->typeList );
+	free( inMap->typeCodes );
+	FakeDisposeHandleIndex( inMap->handleIndex );
+	FakeDisposeResBloomFilter( inMap->bloomFilter );
+	free( inMap->sharedKey );
+	FakeDetachSharedResources( inMap->sharedResources );	// After the Handles that may point into it.
+	FakeDisposeSharedResCopies( inMap->sharedCopies );
+	free( inMap->filePath );
+	free( inMap );
+}
+
+
+// Whether this is the header of a file FakeSaveResourceMap() wrote in the
+//	extended format, see the top of this file:
+static bool	FakeIsExtendedResFileHeader( const uint8_t inHeader[FAKE_EXTENDED_HEADER_LENGTH] )
+{
+	for( int x = 0; x < 16; x++ )
+	{
+		if( inHeader[x] != 0 )
+			return false;
+	}
+	return FakeGetUInt32BE( inHeader +16 ) == FAKE_EXTENDED_MAGIC && FakeGetUInt16BE( inHeader +20 ) == FAKE_EXTENDED_VERSION;
+}
+
+
+// Pick apart a classic resource map read by FakeReadResourceMap():
+static int16_t	FakeParseClassicResourceMap( struct FakeResourceMap* newMap, const uint8_t* mapData, uint32_t lengthOfResourceMap, uint64_t resourceDataOffset )
+{
+	const uint32_t	kTypeEntryLength = 4 + 2 + 2;
+	const uint32_t	kRefEntryLength = 2 + 2 + 1 + 3 + 4;
+	
+	newMap->resFileAttributes = FakeGetUInt16BE( mapData +16 +4 +2 );
+	FAKE_TRACE( kFakeTraceLevelDebug, "resFileAttributes %d", newMap->resFileAttributes );
+	
+	uint32_t	typeListOffset = FakeGetUInt16BE( mapData +16 +4 +2 +2 );
+	uint32_t	nameListOffset = FakeGetUInt16BE( mapData +16 +4 +2 +2 +2 );
+	FAKE_TRACE( kFakeTraceLevelDebug, "typeListOffset %u", typeListOffset );
+	
+	int16_t		err = noErr;
+	uint16_t	numTypes = 0;
+	if( (typeListOffset + 2) > lengthOfResourceMap )
+		err = mapReadErr;
+	else
+		numTypes = FakeGetUInt16BE( mapData +typeListOffset ) +1;
+	FAKE_TRACE( kFakeTraceLevelDebug, "numTypes %d", numTypes );
+	
+	newMap->typeList = calloc( ((int)numTypes) +1, sizeof(struct FakeTypeListEntry) );
+	newMap->typeCodes = calloc( ((int)numTypes) +1, sizeof(uint32_t) );
+	newMap->maxTypes = numTypes +1;
+	for( int x = 0; x < ((int)numTypes) && err == noErr; x++ )
+	{
+		uint32_t	typeEntryOffset = typeListOffset +2 +x * kTypeEntryLength;
+		if( (typeEntryOffset +kTypeEntryLength) > lengthOfResourceMap )
+		{
+			err = mapReadErr;
+			break;
+		}
+		
+		uint32_t	currType = FakeGetUInt32BE( mapData +typeEntryOffset );
+		FAKE_TRACE( kFakeTraceLevelDebug, "currType '%.4s'", (const char*)mapData +typeEntryOffset );
+		newMap->typeCodes[x] = currType;
+		newMap->numTypes = x +1;
+		
+		int			numResources = FakeGetUInt16BE( mapData +typeEntryOffset +4 ) +1;
+		FAKE_TRACE( kFakeTraceLevelDebug, "\tnumResources %d", numResources );
+		
+		uint32_t	refListOffset = typeListOffset +FakeGetUInt16BE( mapData +typeEntryOffset +4 +2 );
+		FAKE_TRACE( kFakeTraceLevelDebug, "\trefListOffset %u", refListOffset );
+		if( (refListOffset +numResources * kRefEntryLength) > lengthOfResourceMap )
+		{
+			err = mapReadErr;
+			break;
+		}
+		
+		newMap->typeList[x].resourceList = calloc( numResources, sizeof(struct FakeReferenceListEntry) );
+		newMap->typeList[x].resourceIDs = calloc( numResources, sizeof(int16_t) );
+		newMap->typeList[x].numberOfResourcesOfType = numResources;
+		newMap->typeList[x].maxResourcesOfType = numResources;
+		for( int y = 0; y < numResources; y++ )
+		{
+			struct FakeReferenceListEntry*	currEntry = &newMap->typeList[x].resourceList[y];
+			const uint8_t*					refData = mapData +refListOffset +y * kRefEntryLength;
+			
+			FakeSetResourceID( &newMap->typeList[x], y, (int16_t)FakeGetUInt16BE( refData ) );
+			uint16_t	nameOffset = FakeGetUInt16BE( refData +2 );
+			currEntry->resourceAttributes = refData[4];
+			currEntry->dataOffset = resourceDataOffset +(FakeGetUInt32BE( refData +4 ) & 0x00FFFFFF);
+			
+			if( nameOffset != 0xFFFF )	// -1 means no name.
+			{
+				uint32_t	namePos = nameListOffset +nameOffset;
+				if( namePos >= lengthOfResourceMap || (namePos +1 +mapData[namePos]) > lengthOfResourceMap )
+				{
+					err = mapReadErr;
+					break;
+				}
+				memmove( currEntry->resourceName, mapData +namePos, 1 +mapData[namePos] );
+			}
+			
+			FAKE_TRACE( kFakeTraceLevelDebug, "\t%d: \"%s\"", currEntry->resourceID, currEntry->resourceName +1 );
+		}
+	}
+	
+	return err;
+}
+
+
+// Pick apart an extended resource map read by FakeReadResourceMap(). All
+//	offsets in it are 32 bits, so we check them against the map's length in 64:
+static int16_t	FakeParseExtendedResourceMap( struct FakeResourceMap* newMap, const uint8_t* mapData, uint32_t lengthOfResourceMap, uint64_t resourceDataOffset )
+{
+	if( FakeGetUInt32BE( mapData ) != FAKE_EXTENDED_MAGIC )
+		return mapReadErr;
+	newMap->resFileAttributes = FakeGetUInt16BE( mapData +4 );
+	FAKE_TRACE( kFakeTraceLevelDebug, "resFileAttributes %d", newMap->resFileAttributes );
+	
+	uint32_t	typeListOffset = FakeGetUInt32BE( mapData +8 );
+	uint32_t	nameListOffset = FakeGetUInt32BE( mapData +12 );
+	FAKE_TRACE( kFakeTraceLevelDebug, "typeListOffset %u", typeListOffset );
+	if( ((uint64_t)typeListOffset +4) > lengthOfResourceMap )
+		return mapReadErr;
+	uint32_t	numTypes = FakeGetUInt32BE( mapData +typeListOffset );
+	FAKE_TRACE( kFakeTraceLevelDebug, "numTypes %u", numTypes );
+	if( numTypes >= UINT16_MAX
+		|| ((uint64_t)typeListOffset +4 +(uint64_t)numTypes * FAKE_EXTENDED_TYPE_ENTRY_LENGTH) > lengthOfResourceMap )
+		return mapReadErr;
+	
+	newMap->typeList = calloc( numTypes +1, sizeof(struct FakeTypeListEntry) );
+	newMap->typeCodes = calloc( numTypes +1, sizeof(uint32_t) );
+	newMap->maxTypes = (uint16_t)(numTypes +1);
+	if( !newMap->typeList || !newMap->typeCodes )
+		return memFulErr;
+	for( uint32_t x = 0; x < numTypes; x++ )
+	{
+		const uint8_t*	typeData = mapData +typeListOffset +4 +x * FAKE_EXTENDED_TYPE_ENTRY_LENGTH;
+		newMap->typeCodes[x] = FakeGetUInt32BE( typeData );
+		FAKE_TRACE( kFakeTraceLevelDebug, "currType '%.4s'", (const char*)typeData );
+		newMap->numTypes = (uint16_t)(x +1);
+		
+		uint32_t	numResources = FakeGetUInt32BE( typeData +4 );
+		uint32_t	refListOffset = FakeGetUInt32BE( typeData +8 );
+		FAKE_TRACE( kFakeTraceLevelDebug, "\tnumResources %u at %u", numResources, refListOffset );
+		if( numResources > UINT16_MAX
+			|| ((uint64_t)refListOffset +(uint64_t)numResources * FAKE_EXTENDED_REF_ENTRY_LENGTH) > lengthOfResourceMap )
+			return mapReadErr;
+		
+		newMap->typeList[x].resourceList = calloc( numResources +1, sizeof(struct FakeReferenceListEntry) );
+		newMap->typeList[x].resourceIDs = calloc( numResources +1, sizeof(int16_t) );
+		if( !newMap->typeList[x].resourceList || !newMap->typeList[x].resourceIDs )
+			return memFulErr;
+		newMap->typeList[x].numberOfResourcesOfType = (uint16_t)numResources;
+		newMap->typeList[x].maxResourcesOfType = numResources;
+		for( uint32_t y = 0; y < numResources; y++ )
+		{
+			struct FakeReferenceListEntry*	currEntry = &newMap->typeList[x].resourceList[y];
+			const uint8_t*					refData = mapData +refListOffset +y * FAKE_EXTENDED_REF_ENTRY_LENGTH;
+			
+			FakeSetResourceID( &newMap->typeList[x], y, (int16_t)FakeGetUInt16BE( refData ) );
+			currEntry->resourceAttributes = refData[2];
+			uint32_t	nameOffset = FakeGetUInt32BE( refData +4 );
+			currEntry->dataOffset = resourceDataOffset +FakeGetUInt64BE( refData +8 );
+			if( currEntry->dataOffset < resourceDataOffset )
+				return mapReadErr;	// Wrapped around.
+			
+			if( nameOffset != 0xFFFFFFFF )	// -1 means no name.
+			{
+				uint64_t	namePos = (uint64_t)nameListOffset +nameOffset;
+				if( namePos >= lengthOfResourceMap || (namePos +1 +mapData[namePos]) > lengthOfResourceMap )
+					return mapReadErr;
+				memmove( currEntry->resourceName, mapData +namePos, 1 +mapData[namePos] );
+			}
+			
+			FAKE_TRACE( kFakeTraceLevelDebug, "\t%d: \"%s\"", currEntry->resourceID, currEntry->resourceName +1 );
+		}
+	}
+	
+	return noErr;
+}
+
+
+// Make a new FakeResourceMap from the resource map in mapData, which is at
+//	inLocation in theFile. Like FakeReadResourceMap(), this doesn't touch any
+//	globals and doesn't create the resources' Handles yet.
+static struct FakeResourceMap*	FakeMakeResourceMap( FILE* theFile, const struct FakeResMapLocation* inLocation, const uint8_t* mapData,
+													double inStartTime, int16_t* outError )
+{
+	struct FakeResourceMap	*	newMap = calloc( 1, sizeof(struct FakeResourceMap) );
+	if( !newMap )
+	{
+		*outError = memFulErr;
+		return NULL;
+	}
+	newMap->fileDescriptor = theFile;
+	newMap->readLimit = inLocation->readLimit;
+	newMap->extendedFormat = inLocation->extendedFormat;
+	newMap->location = *inLocation;
+	int16_t		err = inLocation->extendedFormat ? FakeParseExtendedResourceMap( newMap, mapData, inLocation->mapLength, inLocation->dataOffset )
+								: FakeParseClassicResourceMap( newMap, mapData, inLocation->mapLength, inLocation->dataOffset );
+	if( err != noErr )
+	{
+		FAKE_TRACE( kFakeTraceLevelWarning, "Damaged resource map at offset %llu", (unsigned long long)inLocation->mapOffset );
+		FakeDisposeResourceMap( newMap );
+		*outError = err;
+		return NULL;
+	}
+	
+	// Now that we know where all resources are, work out how large each one may be:
+	size_t							numEntries = 0;
+	struct FakeReferenceListEntry**	entries = FakeCopyReferenceEntriesByOffset( newMap, &numEntries );
+	if( !entries )
+	{
+		FakeDisposeResourceMap( newMap );
+		*outError = memFulErr;
+		return NULL;
+	}
+	FakeComputeDataExtents( entries, numEntries, inLocation->dataOffset +inLocation->dataLength );
+	free( entries );
+	
+	FAKE_TRACE_EVENT( kFakeTraceMapParsed, .count = (int64_t)numEntries, .byteCount = (int64_t)inLocation->mapLength,
+						.duration = FakeTraceCurrentTime() -inStartTime );
+	
+	*outError = noErr;
+	return newMap;
+}
+
+
+// Read the resource map of the given file into a new FakeResourceMap. This
+//	doesn't touch any globals and doesn't create the resources' Handles yet,
+//	so several threads can read different files at the same time.
+//	inForkLength is the size of the resource fork at startOffs, or 0 if it
+//	extends to the end of the file.
+static struct FakeResourceMap*	FakeReadResourceMap( FILE* theFile, size_t startOffs, uint32_t inForkLength, int16_t* outError )
+{
+	int				fd = fileno( theFile );
+	uint8_t			header[FAKE_EXTENDED_HEADER_LENGTH];
+	double			startTime = FAKE_TRACE_EVENTS_ON() ? FakeTraceCurrentTime() : 0;
+	
+	ssize_t		headerLength = pread( fd, header, sizeof(header), startOffs );
+	if( headerLength < 16 )
+	{
+		*outError = eofErr;
+		return NULL;
+	}
+	uint64_t	resourceDataOffset = 0, resourceMapOffset = 0, lengthOfResourceData = 0, lengthOfResourceMap = 0;
+	bool		extendedFormat = (headerLength == sizeof(header)) && FakeIsExtendedResFileHeader( header );
+	if( extendedFormat )
+	{
+		resourceDataOffset = FakeGetUInt64BE( header +24 );
+		resourceMapOffset = FakeGetUInt64BE( header +32 );
+		lengthOfResourceData = FakeGetUInt64BE( header +40 );
+		lengthOfResourceMap = FakeGetUInt64BE( header +48 );
+	}
+	else
+	{
+		resourceDataOffset = FakeGetUInt32BE( header +0 );
+		resourceMapOffset = FakeGetUInt32BE( header +4 );
+		lengthOfResourceData = FakeGetUInt32BE( header +8 );
+		lengthOfResourceMap = FakeGetUInt32BE( header +12 );
+	}
+	uint64_t	forkLength = inForkLength ? inForkLength : (UINT64_MAX -startOffs);
+	if( resourceDataOffset > forkLength || lengthOfResourceData > (forkLength -resourceDataOffset)
+		|| resourceMapOffset > forkLength || lengthOfResourceMap > (forkLength -resourceMapOffset) )
+	{
+		*outError = mapReadErr;
+		return NULL;
+	}
+	resourceDataOffset += startOffs;
+	resourceMapOffset += startOffs;
+	FAKE_TRACE( kFakeTraceLevelDebug, "resourceDataOffset %llu", (unsigned long long)resourceDataOffset );
+	FAKE_TRACE( kFakeTraceLevelDebug, "resourceMapOffset %llu", (unsigned long long)resourceMapOffset );
+	
+	// Read the whole map in one go, then pick it apart in RAM:
+	if( lengthOfResourceMap < (extendedFormat ? FAKE_EXTENDED_MAP_HEADER_LENGTH +4 : FAKE_CLASSIC_MAP_HEADER_LENGTH +2)
+		|| lengthOfResourceMap > UINT32_MAX )
+	{
+		*outError = mapReadErr;
+		return NULL;
+	}
+	uint8_t*	mapData = malloc( lengthOfResourceMap );
+	if( !mapData )
+	{
+		*outError = memFulErr;
+		return NULL;
+	}
+	if( pread( fd, mapData, lengthOfResourceMap, resourceMapOffset ) != (ssize_t)lengthOfResourceMap )
+	{
+		free( mapData );
+		*outError = eofErr;
+		return NULL;
+	}
+	
+	struct FakeResMapLocation	location = { resourceDataOffset, lengthOfResourceData, resourceMapOffset, (uint32_t)lengthOfResourceMap,
+												startOffs +forkLength, extendedFormat };
+	struct FakeResourceMap	*	newMap = FakeMakeResourceMap( theFile, &location, mapData, startTime, outError );
+	free( mapData );
+	
+	return newMap;
+}
+
+
+// Give all resources in a map read by FakeReadResourceMap() their (empty) Handles:
+static int16_t	FakeCreateResourceHandles( struct FakeResourceMap* inMap )
+{
+	for( int x = 0; x < inMap->numTypes; x++ )
+	{
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
+		{
+			inMap->typeList[x].resourceList[y].resourceHandle = FakeNewEmptyHandle();
+			if( !inMap->typeList[x].resourceList[y].resourceHandle )
+				return memFulErr;
+		}
+	}
+	
+	return noErr;
+}
+
+
+static int	FakeCompareTypes( const void* inA, const void* inB )
+{
+	uint32_t	typeA = *(const uint32_t*)inA;
+	uint32_t	typeB = *(const uint32_t*)inB;
+	return (typeA < typeB) ? -1 : ((typeA > typeB) ? 1 : 0);
+}
+
+
+// Retain the types of several files with a single update of gLoadedTypes.
+//	Returns memFulErr, without retaining any, if there's not enough memory:
+static int16_t	FakeRetainTypesOfMaps( struct FakeResourceMap** inMaps, size_t inCount )
+{
+	size_t		numTypes = 0;
+	for( size_t x = 0; x < inCount; x++ )
+		numTypes += inMaps[x] ? inMaps[x]->numTypes : 0;
+	
+	uint32_t*					types = malloc( (numTypes +1) * sizeof(uint32_t) );
+	struct FakeTypeCountEntry*	newLoadedTypes = types ? realloc( gLoadedTypes, (gNumLoadedTypes +numTypes +1) * sizeof(struct FakeTypeCountEntry) ) : NULL;
+	if( !newLoadedTypes )
+	{
+		free( types );
+		return memFulErr;
+	}
+	gLoadedTypes = newLoadedTypes;
+	numTypes = 0;
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		if( !inMaps[x] )
+			continue;
+		memmove( types +numTypes, inMaps[x]->typeCodes, inMaps[x]->numTypes * sizeof(uint32_t) );
+		numTypes += inMaps[x]->numTypes;
+	}
+	qsort( types, numTypes, sizeof(uint32_t), FakeCompareTypes );
+	
+	int16_t		numOldTypes = gNumLoadedTypes;
+	size_t		x = 0;
+	while( x < numTypes )
+	{
+		size_t	numSame = 1;
+		while( (x +numSame) < numTypes && types[x +numSame] == types[x] )
+			numSame++;
+		
+		int		y = 0;
+		for( y = 0; y < numOldTypes; y++ )
+		{
+			if( gLoadedTypes[y].type == types[x] )
+			{
+				gLoadedTypes[y].retainCount += numSame;
+				break;
+			}
+		}
+		if( y >= numOldTypes )
+		{
+			gLoadedTypes[gNumLoadedTypes].type = types[x];
+			gLoadedTypes[gNumLoadedTypes].retainCount = numSame;
+			gNumLoadedTypes++;
+		}
+		
+		x += numSame;
+	}
+	
+	free( types );
+	return noErr;
+}
+
+
+static struct FakeReferenceListEntry*	FakeFindReferenceListEntry( struct FakeResourceMap* inMap, uint32_t resType, int16_t resID );
+static void	FakeSettleResFetchesOfMap( struct FakeResourceMap* inMap, bool inClosing );
+static void	FakeForgetResFetchesOfHandle( Handle inResource );
+
+
+// One resource in an access profile:
+struct FakeProfileEntry
+{
+	uint32_t		resType;
+	int16_t			resID;
+	uint32_t		order;
+};
+
+
+static int	FakeCompareProfileEntries( const void* inA, const void* inB )
+{
+	uint32_t	orderA = ((const struct FakeProfileEntry*)inA)->order;
+	uint32_t	orderB = ((const struct FakeProfileEntry*)inB)->order;
+	return (orderA < orderB) ? -1 : ((orderA > orderB) ? 1 : 0);
+}
+
+
+// Opens the access profile next to the given map's file:
+static FILE*	FakeOpenResourceProfile( struct FakeResourceMap* inMap, const char* inMode )
+{
+	if( !inMap->filePath )
+		return NULL;
+	size_t	pathLength = strlen( inMap->filePath );
+	char*	profilePath = malloc( pathLength +sizeof(FAKE_PROFILE_SUFFIX) );
+	if( !profilePath )
+		return NULL;
+	memmove( profilePath, inMap->filePath, pathLength );
+	memmove( profilePath +pathLength, FAKE_PROFILE_SUFFIX, sizeof(FAKE_PROFILE_SUFFIX) );
+	FILE*	theFile = fopen( profilePath, inMode );
+	free( profilePath );
+	return theFile;
+}
+
+
+/*
+	Access profile:
+	
+	'RPRF'													  4 bytes
+	version (1)												  2 bytes
+	number of resources										  4 bytes
+		resource type										  4 bytes
+		resource ID											  2 bytes
+	
+	Resources are listed in the order they were first requested.
+*/
+
+static void	FakeSaveResourceProfile( struct FakeResourceMap* inMap )
+{
+	struct FakeProfileEntry*	entries = malloc( (inMap->profileCounter +1) * sizeof(struct FakeProfileEntry) );
+	uint32_t					numEntries = 0;
+	if( !entries )
+		return;
+	for( int x = 0; x < inMap->numTypes; x++ )
+	{
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
+		{
+			struct FakeReferenceListEntry*	currEntry = &inMap->typeList[x].resourceList[y];
+			if( currEntry->profileOrder == 0 || numEntries >= inMap->profileCounter )
+				continue;
+			entries[numEntries].resType = inMap->typeCodes[x];
+			entries[numEntries].resID = currEntry->resourceID;
+			entries[numEntries].order = currEntry->profileOrder;
+			numEntries++;
+		}
+	}
+	qsort( entries, numEntries, sizeof(struct FakeProfileEntry), FakeCompareProfileEntries );
+	
+	FILE*	theFile = FakeOpenResourceProfile( inMap, "w" );
+	if( theFile )
+	{
+		FakeFWriteUInt32BE( FAKE_PROFILE_MAGIC, theFile );
+		FakeFWriteUInt16BE( FAKE_PROFILE_VERSION, theFile );
+		FakeFWriteUInt32BE( numEntries, theFile );
+		for( uint32_t x = 0; x < numEntries; x++ )
+		{
+			FakeFWriteUInt32BE( entries[x].resType, theFile );
+			FakeFWriteInt16BE( entries[x].resID, theFile );
+		}
+		if( fclose( theFile ) != 0 )
+			FAKE_TRACE( kFakeTraceLevelWarning, "Couldn't save resource access profile of %s", inMap->filePath );
+	}
+	free( entries );
+}
+
+
+// Returns the resources in the access profile next to the map's file, in
+//	the order they should be loaded, or NULL if there's no profile:
+static struct FakeProfileEntry*	FakeReadResourceProfile( struct FakeResourceMap* inMap, uint32_t* outCount )
+{
+	FILE*		theFile = FakeOpenResourceProfile( inMap, "r" );
+	uint8_t		header[4 + 2 + 4];
+	*outCount = 0;
+	if( !theFile )
+		return NULL;
+	if( fread( header, 1, sizeof(header), theFile ) != sizeof(header)
+		|| FakeGetUInt32BE( header ) != FAKE_PROFILE_MAGIC || FakeGetUInt16BE( header +4 ) != FAKE_PROFILE_VERSION )
+	{
+		fclose( theFile );
+		return NULL;
+	}
+	
+	uint32_t					numEntries = FakeGetUInt32BE( header +4 +2 );
+	struct FakeProfileEntry*	entries = calloc( (size_t)numEntries +1, sizeof(struct FakeProfileEntry) );
+	uint8_t						entryData[4 + 2];
+	for( uint32_t x = 0; entries && x < numEntries; x++ )
+	{
+		if( fread( entryData, 1, sizeof(entryData), theFile ) != sizeof(entryData) )
+			break;
+		entries[x].resType = FakeGetUInt32BE( entryData );
+		entries[x].resID = (int16_t)FakeGetUInt16BE( entryData +4 );
+		entries[x].order = x +1;
+		*outCount = x +1;
+	}
+	fclose( theFile );
+	
+	return entries;
+}
+
+
+// Remember in which order resources are first requested, and save that when we're done:
+static void	FakeRecordResourceAccess( struct FakeResourceMap* inMap, struct FakeReferenceListEntry* inEntry )
+{
+	if( inMap->profileUntil == 0 )
+		return;
+	if( FakeTraceCurrentTime() > inMap->profileUntil )
+	{
+		FakeSaveResourceProfile( inMap );
+		inMap->profileUntil = 0;
+		return;
+	}
+	if( inEntry->profileOrder == 0 )
+		inEntry->profileOrder = ++inMap->profileCounter;
+}
+
+
+// Start reading the resources in the map's access profile, and those marked
+//	resPreload, on a background thread:
+static void	FakeStartResourcePrefetch( struct FakeResourceMap* inMap )
+{
+	uint32_t					numProfileEntries = 0;
+	struct FakeProfileEntry*	profileEntries = FakeReadResourceProfile( inMap, &numProfileEntries );
+	size_t						numEntries = 0;
+	struct FakeReferenceListEntry**	entries = FakeCopyReferenceEntriesByOffset( inMap, &numEntries );
+	struct FakeReferenceListEntry**	prefetchEntries = malloc( (numEntries +1) * sizeof(struct FakeReferenceListEntry*) );
+	uint64_t*					offsets = malloc( (numEntries +1) * sizeof(uint64_t) );
+	uint32_t*					extents = malloc( (numEntries +1) * sizeof(uint32_t) );
+	size_t						numPrefetches = 0;
+	
+	if( entries && prefetchEntries && offsets && extents )
+	{
+		// Profile order first, then the preloads in file order:
+		for( uint32_t x = 0; x < numProfileEntries && numPrefetches < numEntries; x++ )
+		{
+			struct FakeReferenceListEntry*	theEntry = FakeFindReferenceListEntry( inMap, profileEntries[x].resType, profileEntries[x].resID );
+			if( theEntry && theEntry->prefetchSlot == 0 && FakeReferenceEntryNeedsLoad( theEntry ) )
+			{
+				prefetchEntries[numPrefetches++] = theEntry;
+				theEntry->prefetchSlot = (uint32_t)numPrefetches;
+			}
+		}
+		for( size_t x = 0; x < numEntries; x++ )
+		{
+			if( (entries[x]->resourceAttributes & resPreload) && entries[x]->prefetchSlot == 0 && FakeReferenceEntryNeedsLoad( entries[x] ) )
+			{
+				prefetchEntries[numPrefetches++] = entries[x];
+				entries[x]->prefetchSlot = (uint32_t)numPrefetches;
+			}
+		}
+		
+		for( size_t x = 0; x < numPrefetches; x++ )
+		{
+			offsets[x] = prefetchEntries[x]->dataOffset;
+			extents[x] = prefetchEntries[x]->dataExtent;
+		}
+		if( numPrefetches > 0 )
+			inMap->prefetchJob = FakeStartPrefetch( FakeGetResMapFD( inMap ), inMap->readLimit, offsets, extents, numPrefetches );
+		if( !inMap->prefetchJob )
+		{
+			for( size_t x = 0; x < numPrefetches; x++ )
+				prefetchEntries[x]->prefetchSlot = 0;
+		}
+	}
+	
+	free( extents );
+	free( offsets );
+	free( prefetchEntries );
+	free( entries );
+	free( profileEntries );
+}
+
+
+// Wait for the background thread to finish and throw away whatever it read
+//	that nobody claimed, e.g. before we change or close the file:
+static void	FakeStopResourcePrefetch( struct FakeResourceMap* inMap )
+{
+	if( !inMap->prefetchJob )
+		return;
+	
+	FakeStopPrefetch( inMap->prefetchJob );
+	inMap->prefetchJob = NULL;
+	for( int x = 0; x < inMap->numTypes; x++ )
+	{
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
+			inMap->typeList[x].resourceList[y].prefetchSlot = 0;
+	}
+}
+
+
+// Any change to which resources are in which open file, or which file is
+//	current, could make a resource FakeGetResource() didn't find appear:
+static void	FakeForgetResMisses( void )
+{
+	if( ++gFakeResMissGeneration == 0 )	// Wrapped around? Clear out the old ones for real.
+	{
+		memset( gFakeResMisses, 0, sizeof(gFakeResMisses) );
+		gFakeResMissGeneration = 1;
+	}
+}
+
+
+// Gets rid of a map FakeInstallResourceMaps() couldn't install, whose data
+//	may already be loaded and in the cache, and closes its file:
+static void	FakeDisposeUninstalledResourceMap( struct FakeResourceMap* inMap )
+{
+	for( int x = 0; x < inMap->numTypes; x++ )
+	{
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
+			FakeResourceCacheRemove( inMap->typeList[x].resourceList[y].resourceHandle );
+	}
+	if( inMap->fileDescriptor )
+		fclose( inMap->fileDescriptor );
+	FakeDisposeResourceMap( inMap );
+}
+
+
+// Make maps read by FakeReadResourceMap() available to the other resource
+//	calls, as if each had been opened in turn, so the last one ends up current.
+//	Returns memFulErr, without installing any, if there's not enough memory:
+static int16_t	FakeInstallResourceMaps( struct FakeResourceMap** inMaps, size_t inCount )
+{
+	if( FakeRetainTypesOfMaps( inMaps, inCount ) != noErr )
+		return memFulErr;
+	
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		if( !inMaps[x] )
+			continue;
+		inMaps[x]->fileRefNum = FakeNewFileRefNum( inMaps[x] );
+		inMaps[x]->nextResourceMap = gResourceMap;
+		if( gResourceMap )
+			gResourceMap->prevResourceMap = inMaps[x];
+		gResourceMap = inMaps[x];
+		if( inMaps[x]->reopenable && inMaps[x]->fileDescriptor )
+			FakeLinkOpenReopenableMap( inMaps[x] );
+		
+		if( gFakeResProfileSeconds > 0 )
+			inMaps[x]->profileUntil = FakeTraceCurrentTime() +gFakeResProfileSeconds;
+		if( !gFakeResLoad && gFakeResPrefetch && !inMaps[x]->sharedResources	// If we loaded everything already, or it's published, there's nothing to prefetch.
+			&& inMaps[x]->fileDescriptor )	// Closed to stay under FakeSetResFileLimit()? Don't open all of them again.
+			FakeStartResourcePrefetch( inMaps[x] );
+	}
+	
+	FakeCloseUnusedResMapFiles( NULL );
+	gCurrResourceMap = gResourceMap;
+	FakeForgetResMisses();
+	return noErr;
+}
+
+
+// Publish the data of all resources in the map for other processes that open
+//	the same file, then point our Handles at the published data, so we share it
+//	with them, too. Without touching any globals. Call this once the data is
+//	loaded, and before the resources go in the cache:
+static void	FakeShareResourceMap( struct FakeResourceMap* inMap )
+{
+	if( !inMap->sharedKey )
+		return;
+	
+	size_t							numEntries = 0;
+	struct FakeReferenceListEntry**	entries = FakeCopyReferenceEntriesByOffset( inMap, &numEntries );
+	struct FakeSharedResPayload*	payloads = malloc( (numEntries +1) * sizeof(struct FakeSharedResPayload) );
+	size_t							infoLength = sizeof(struct FakeSharedMapInfo) +inMap->location.mapLength;
+	struct FakeSharedMapInfo*		info = malloc( infoLength );
+	size_t							numPayloads = 0;
+	if( entries && payloads && info
+		&& pread( fileno( inMap->fileDescriptor ), info +1, inMap->location.mapLength, inMap->location.mapOffset ) == (ssize_t)inMap->location.mapLength )
+	{
+		for( size_t x = 0; x < numEntries; x++ )
+		{
+			if( *entries[x]->resourceHandle == NULL || (numPayloads > 0 && payloads[numPayloads -1].key == entries[x]->dataOffset) )
+				continue;	// Couldn't be read, or shares its data with the one before.
+			payloads[numPayloads].key = entries[x]->dataOffset;
+			payloads[numPayloads].data = *entries[x]->resourceHandle;
+			payloads[numPayloads].length = (uint32_t)((MasterPointer*)entries[x]->resourceHandle)->size;	// FakeGetHandleSize() sets a global.
+			payloads[numPayloads].flags = entries[x]->compressedInRAM ? FAKE_SHARED_COMPRESSED_IN_RAM : 0;
+			numPayloads++;
+		}
+		memset( info, 0, sizeof(struct FakeSharedMapInfo) );
+		info->location = inMap->location;
+		info->readOnly = inMap->readOnly;
+		FakePublishSharedResources( inMap->sharedKey, info, infoLength, payloads, numPayloads );
+		
+		// Whether we published it or another process just beat us to it, use the published data from now on:
+		inMap->sharedResources = FakeAttachSharedResources( inMap->sharedKey );
+		for( size_t x = 0; inMap->sharedResources && x < numEntries; x++ )
+		{
+			long		ourLength = ((MasterPointer*)entries[x]->resourceHandle)->size;
+			uint32_t	theLength = 0, theFlags = 0;
+			char*		theData = (*entries[x]->resourceHandle != NULL) ? FakeFindSharedResPayload( inMap->sharedResources, entries[x]->dataOffset, &theLength, &theFlags ) : NULL;
+			if( theData && theLength == ourLength && !entries[x]->sharesData )	// Those sharing data keep their own copies.
+				FakeBorrowHandleMemory( entries[x]->resourceHandle, theData, theLength );	// Frees our copy.
+		}
+	}
+	
+	free( info );
+	free( payloads );
+	free( entries );
+	free( inMap->sharedKey );
+	inMap->sharedKey = NULL;
+}
+
+
+// Whether inEntry can get a copy-on-write copy of inFirst's data, which is at the same offset:
+static bool	FakeCanShareDataOf( struct FakeReferenceListEntry* inEntry, struct FakeReferenceListEntry* inFirst )
+{
+	return inEntry == inFirst || (FakeReferenceEntryNeedsLoad( inEntry )
+									&& (inEntry->resourceAttributes & resCompressed) == (inFirst->resourceAttributes & resCompressed));
+}
+
+
+// After FakeSetResDedup(true), read the data resources share in the file
+//	(inEntries, sorted by offset) once, and give their Handles copy-on-write
+//	copies of it, so it only takes up RAM once until one of them is changed.
+//	Only touches this map, and not if its data is published for other processes:
+static void	FakeShareDuplicateData( struct FakeResourceMap* inMap, struct FakeReferenceListEntry** inEntries, size_t inCount )
+{
+	if( !gFakeResDedup || inMap->sharedKey || inMap->sharedResources || inMap->sharedCopies )
+		return;
+	
+	// Read the first of each run of resources with the same offset:
+	struct FakeReferenceListEntry**	firsts = malloc( (inCount +1) * sizeof(struct FakeReferenceListEntry*) );
+	size_t							numFirsts = 0;
+	for( size_t x = 0; firsts && x < inCount; x++ )
+	{
+		if( inEntries[x]->sharesData && (x == 0 || inEntries[x -1]->dataOffset != inEntries[x]->dataOffset) )
+			firsts[numFirsts++] = inEntries[x];
+	}
+	if( numFirsts > 0 )
+		FakeLoadReferenceEntriesFromFile( fileno( inMap->fileDescriptor ), inMap->readLimit, firsts, NULL, numFirsts );
+	free( firsts );
+	
+	// Each copy gets the data of each run, as many copies as the longest run needs:
+	struct FakeSharedResPayload*	payloads = (numFirsts > 0) ? malloc( numFirsts * sizeof(struct FakeSharedResPayload) ) : NULL;
+	uint64_t*						copyOffsets = (numFirsts > 0) ? malloc( numFirsts * sizeof(uint64_t) ) : NULL;
+	size_t							numPayloads = 0, numCopies = 0;
+	for( size_t x = 0; payloads && copyOffsets && x < inCount; )
+	{
+		struct FakeReferenceListEntry*	first = inEntries[x];
+		size_t							runEnd = x +1, numSharing = 1;
+		for( ; runEnd < inCount && inEntries[runEnd]->dataOffset == first->dataOffset; runEnd++ )
+		{
+			if( numSharing < FAKE_MAX_SHARED_DATA_COPIES && FakeCanShareDataOf( inEntries[runEnd], first ) )
+				numSharing++;
+		}
+		x = runEnd;
+		if( numSharing < 2 || *first->resourceHandle == NULL || ((MasterPointer*)first->resourceHandle)->size == 0 )
+			continue;	// Nothing to share, or it couldn't be read, and they'll report the error.
+		payloads[numPayloads].key = first->dataOffset;
+		payloads[numPayloads].data = *first->resourceHandle;
+		payloads[numPayloads].length = (uint32_t)((MasterPointer*)first->resourceHandle)->size;	// FakeGetHandleSize() sets a global.
+		payloads[numPayloads].flags = 0;
+		numPayloads++;
+		if( numSharing > numCopies )
+			numCopies = numSharing;
+	}
+	inMap->sharedCopies = (numPayloads > 0) ? FakeMakeSharedResCopies( payloads, numPayloads, numCopies, copyOffsets ) : NULL;
+	
+	// Point each Handle of a run at its own copy, in the same order as above:
+	for( size_t x = 0, currPayload = 0; inMap->sharedCopies && currPayload < numPayloads; x++ )
+	{
+		struct FakeReferenceListEntry*	first = inEntries[x];
+		if( first->dataOffset != payloads[currPayload].key )	// Not the start of a run we copied.
+			continue;
+		size_t		currCopy = 0;
+		for( size_t y = x; y < inCount && inEntries[y]->dataOffset == first->dataOffset && currCopy < numCopies; y++ )
+		{
+			struct FakeReferenceListEntry*	currEntry = inEntries[y];
+			if( currEntry != first && !FakeCanShareDataOf( currEntry, first ) )
+				continue;
+			currEntry->compressedInRAM = first->compressedInRAM;
+			char*	theData = FakeGetSharedResCopy( inMap->sharedCopies, currCopy++ ) +copyOffsets[currPayload];
+			FakeBorrowHandleMemory( currEntry->resourceHandle, theData, payloads[currPayload].length );	// Frees the first one's copy.
+		}
+		currPayload++;
+	}
+	
+	free( copyOffsets );
+	free( payloads );
+}
+
+
+// Read the data of all resources in the map (if desired) without touching any globals:
+static void	FakePreloadResourceMap( struct FakeResourceMap* inMap )
+{
+	if( !gFakeResLoad )
+		return;
+	
+	size_t							numEntries = 0;
+	struct FakeReferenceListEntry**	entries = FakeCopyReferenceEntriesByOffset( inMap, &numEntries );
+	if( !entries )
+		return;	// They're read when they're asked for instead.
+	FakeClaimSharedEntries( inMap, entries, numEntries );
+	FakeShareDuplicateData( inMap, entries, numEntries );
+	FakeLoadReferenceEntriesFromFile( fileno( inMap->fileDescriptor ), inMap->readLimit, entries, NULL, numEntries );
+	free( entries );
+	FakeShareResourceMap( inMap );
+}
+
+
+// Like FakeReadResourceMap(), but if inFindContainer is true and the file is
+//	a MacBinary, AppleSingle or AppleDouble file, reads the resource fork in it.
+//	Resource forks inside other files are opened read-only.
+static struct FakeResourceMap*	FakeReadResourceMapOfForkFromDisk( FILE* theFile, size_t startOffs, uint32_t inForkLength, bool inFindContainer, int16_t* outError )
+{
+	uint32_t				forkOffset = 0, forkLength = 0;
+	int16_t					containerErr = noErr;
+	struct FakeResourceMap*	theMap = NULL;
+	
+	if( inFindContainer && FakeLocateResourceFork( fileno( theFile ), &forkOffset, &forkLength ) != kFakeContainerNone )
+	{
+		containerErr = resFNotFound;
+		if( forkLength != 0 )
+			theMap = FakeReadResourceMap( theFile, forkOffset, forkLength, &containerErr );
+		if( theMap )
+		{
+			theMap->readOnly = true;
+			*outError = noErr;
+			return theMap;
+		}
+		FAKE_TRACE( kFakeTraceLevelInfo, "No resource fork in container (%d), trying as a plain resource file.", containerErr );
+	}
+	
+	theMap = FakeReadResourceMap( theFile, startOffs, inForkLength, outError );
+	if( theMap && (startOffs != 0 || inForkLength != 0) )
+		theMap->readOnly = true;	// FakeUpdateResFile() can only write whole files.
+	else if( !theMap && containerErr != noErr )
+		*outError = containerErr;	// Looked like a container, so that error is more helpful.
+	
+	return theMap;
+}
+
+
+// Make a map from what another process published for this file, if anything.
+//	Its Handles get the published data when they're loaded:
+static struct FakeResourceMap*	FakeAttachSharedResourceMap( FILE* theFile, const struct FakeSharedResKey* inKey )
+{
+	double						startTime = FAKE_TRACE_EVENTS_ON() ? FakeTraceCurrentTime() : 0;
+	struct FakeSharedResources*	theShared = FakeAttachSharedResources( inKey );
+	if( !theShared )
+		return NULL;
+	
+	size_t							infoLength = 0;
+	const struct FakeSharedMapInfo*	info = FakeGetSharedResInfo( theShared, &infoLength );
+	struct FakeResourceMap*			newMap = NULL;
+	int16_t							err = mapReadErr;
+	if( infoLength >= sizeof(struct FakeSharedMapInfo) && (infoLength -sizeof(struct FakeSharedMapInfo)) == info->location.mapLength )
+		newMap = FakeMakeResourceMap( theFile, &info->location, (const uint8_t*)(info +1), startTime, &err );
+	if( !newMap )
+	{
+		FAKE_TRACE( kFakeTraceLevelWarning, "Couldn't use the published resource map (%d), reading the file.", err );
+		FakeDetachSharedResources( theShared );
+		return NULL;
+	}
+	newMap->readOnly = info->readOnly;
+	newMap->sharedResources = theShared;
+	return newMap;
+}
+
+
+// Like FakeReadResourceMapOfForkFromDisk(), but after FakeSetResSharedCache(true)
+//	uses the map and data another process published for the file, if there is
+//	any, and otherwise notes down what to publish them under once they're loaded:
+static struct FakeResourceMap*	FakeReadResourceMapOfFork( FILE* theFile, size_t startOffs, uint32_t inForkLength, bool inFindContainer, int16_t* outError )
+{
+	struct FakeSharedResKey		sharedKey;
+	if( !gFakeResSharedCache || !FakeMakeSharedResKey( fileno( theFile ), startOffs, inForkLength, &sharedKey ) )
+		return FakeReadResourceMapOfForkFromDisk( theFile, startOffs, inForkLength, inFindContainer, outError );
+	
+	struct FakeResourceMap*		theMap = FakeAttachSharedResourceMap( theFile, &sharedKey );
+	if( theMap )
+	{
+		*outError = noErr;
+		return theMap;
+	}
+	
+	theMap = FakeReadResourceMapOfForkFromDisk( theFile, startOffs, inForkLength, inFindContainer, outError );
+	if( theMap && (theMap->sharedKey = malloc( sizeof(struct FakeSharedResKey) )) )
+		*theMap->sharedKey = sharedKey;
+	return theMap;
+}
+
+
+// inForkLength == 0 means the fork goes to the end of the file and we look for containers:
+static struct FakeResourceMap*	FakeResFileOpenFork( const char* inPath, const char* inMode, size_t startOffs, uint32_t inForkLength )
+{
+	double					startTime = FAKE_TRACE_EVENTS_ON() ? FakeTraceCurrentTime() : 0;
+	FAKE_TRACE_EVENT( kFakeTraceFileOpenBegin, .name = inPath );
+	
+	if( !FakeReserveFileRefNums( 1 ) )
+	{
+		gFakeResError = tmfoErr;
+		FAKE_TRACE_EVENT( kFakeTraceFileOpenEnd, .error = tmfoErr, .duration = FakeTraceCurrentTime() -startTime );
+		return NULL;
+	}
+	
+	FILE		*			theFile = fopen( inPath, inMode );
+	if( !theFile )
+	{
+		gFakeResError = fnfErr;
+		FAKE_TRACE_EVENT( kFakeTraceFileOpenEnd, .error = fnfErr, .duration = FakeTraceCurrentTime() -startTime );
+		return NULL;
+	}
+	
+	int16_t					err = noErr;
+	struct FakeResourceMap	*	newMap = FakeReadResourceMapOfFork( theFile, startOffs, inForkLength, (startOffs == 0 && inForkLength == 0), &err );
+	if( newMap )
+		err = FakeCreateResourceHandles( newMap );
+	if( err != noErr )
+	{
+		if( newMap )
+			FakeDisposeResourceMap( newMap );
+		fclose( theFile );
+		gFakeResError = err;
+		FAKE_TRACE_EVENT( kFakeTraceFileOpenEnd, .error = err, .duration = FakeTraceCurrentTime() -startTime );
+		return NULL;
+	}
+	
+	if( gFakeResLoad && (newMap->sharedKey || gFakeResDedup) )	// Share it before it goes in the cache, which is only for data we don't share.
+	{
+		FakePreloadResourceMap( newMap );
+		FakeCacheReferenceEntriesOfMap( newMap );
+	}
+	else if( gFakeResLoad )
+		FakeLoadAllReferenceEntries( newMap );
+	
+	newMap->filePath = strdup( inPath );
+	newMap->reopenable = ((strcmp( inMode, "r" ) == 0 || newMap->readOnly) && newMap->filePath != NULL);
+	FakeNoteResMapFileIdentity( newMap );
+	if( FakeInstallResourceMaps( &newMap, 1 ) != noErr )
+	{
+		FakeDisposeUninstalledResourceMap( newMap );
+		gFakeResError = memFulErr;
+		FAKE_TRACE_EVENT( kFakeTraceFileOpenEnd, .error = memFulErr, .duration = FakeTraceCurrentTime() -startTime );
+		return NULL;
+	}
+	gFakeResError = noErr;
+	FAKE_TRACE_EVENT( kFakeTraceFileOpenEnd, .refNum = newMap->fileRefNum, .duration = FakeTraceCurrentTime() -startTime );
+	
+	return newMap;
+}
+
+
+struct FakeResourceMap*	FakeResFileOpen( const char* inPath, const char* inMode, size_t startOffs )
+{
+	return FakeResFileOpenFork( inPath, inMode, startOffs, 0 );
+}
+
+
+static void	FakeCPathFromResFilePath( const unsigned char* inPath, char outPath[256 +17] )
+{
+#if READ_REAL_RESOURCE_FORKS
+	const char*	resForkSuffix = "/..namedfork/rsrc";
+#endif // READ_REAL_RESOURCE_FORKS
+	memset( outPath, 0, 256 +17 );
+	memmove(outPath,inPath +1,inPath[0]);
+#if READ_REAL_RESOURCE_FORKS
+	memmove(outPath +inPath[0],resForkSuffix,17);
+#endif // READ_REAL_RESOURCE_FORKS
+}
+
+
+int16_t	FakeOpenResFile( const unsigned char* inPath )
+{
+	char		thePath[256 +17] = {0};
+	FakeCPathFromResFilePath( inPath, thePath );
+	struct FakeResourceMap*	theMap = FakeResFileOpen( thePath, "r+", 0 );
+	if( !theMap )
+		theMap = FakeResFileOpen( thePath, "r", 0 );
+	if( theMap )
+		return theMap->fileRefNum;
+	else
+		return gFakeResError;
+}
+
+
+int16_t	FakeOpenResFork( const unsigned char* inPath, uint32_t inForkOffset, uint32_t inForkLength )
+{
+	char		thePath[256 +17] = {0};
+	memmove( thePath, inPath +1, inPath[0] );	// Never the named fork, this is for forks inside the data.
+	struct FakeResourceMap*	theMap = FakeResFileOpenFork( thePath, "r", inForkOffset, inForkLength );
+	if( theMap )
+		return theMap->fileRefNum;
+	else
+		return gFakeResError;
+}
+
+
+struct FakeMultiFileOpen
+{
+	const unsigned char**		paths;
+	struct FakeResourceMap**	maps;
+	int16_t*					errors;
+};
+
+
+// With FakeSetResFileLimit(), FakeOpenResFiles() doesn't keep all the files
+//	open between reading their maps and their data, where they only need to
+//	be open one at a time for each thread. Doesn't change any globals:
+static void	FakeCloseReopenableFileOfNewMap( struct FakeResourceMap* inMap )
+{
+	if( gFakeResFileLimit > 0 && inMap->reopenable && inMap->fileDescriptor )
+	{
+		fclose( inMap->fileDescriptor );
+		inMap->fileDescriptor = NULL;
+	}
+}
+
+
+static void	FakeReadResourceMapOfFile( size_t inIndex, void* inRefCon )
+{
+	struct FakeMultiFileOpen*	theOpen = inRefCon;
+	char						thePath[256 +17] = {0};
+	const char*					modes[] = { "r+", "r" };
+	
+	FakeCPathFromResFilePath( theOpen->paths[inIndex], thePath );
+	FAKE_TRACE_EVENT( kFakeTraceFileOpenBegin, .name = thePath );
+	theOpen->errors[inIndex] = fnfErr;
+	for( int x = 0; x < 2 && theOpen->maps[inIndex] == NULL; x++ )
+	{
+		FILE*	theFile = fopen( thePath, modes[x] );
+		if( !theFile )
+			continue;
+		theOpen->maps[inIndex] = FakeReadResourceMapOfFork( theFile, 0, 0, true, &theOpen->errors[inIndex] );
+		if( !theOpen->maps[inIndex] )
+		{
+			fclose( theFile );
+			continue;
+		}
+		struct FakeResourceMap*	theMap = theOpen->maps[inIndex];
+		theMap->filePath = strdup( thePath );
+		theMap->reopenable = ((strcmp( modes[x], "r" ) == 0 || theMap->readOnly) && theMap->filePath != NULL);
+		FakeNoteResMapFileIdentity( theMap );
+		FakeCloseReopenableFileOfNewMap( theMap );
+	}
+}
+
+
+static void	FakePreloadResourceMapOfFile( size_t inIndex, void* inRefCon )
+{
+	struct FakeMultiFileOpen*	theOpen = inRefCon;
+	struct FakeResourceMap*		theMap = theOpen->maps[inIndex];
+	if( !theMap )
+		return;
+	if( !theMap->fileDescriptor )
+		theMap->fileDescriptor = FakeReopenResMapFile( theMap );
+	if( theMap->fileDescriptor )	// Otherwise its resources are read, and fail, when they're asked for.
+		FakePreloadResourceMap( theMap );
+	FakeCloseReopenableFileOfNewMap( theMap );
+}
+
+
+void	FakeOpenResFiles( const unsigned char** inPaths, int16_t inCount, int16_t* outRefNums, int16_t* outErrors )
+{
+	struct FakeResourceMap**	maps = calloc( inCount +1, sizeof(struct FakeResourceMap*) );
+	int16_t*					errors = outErrors ? outErrors : calloc( inCount +1, sizeof(int16_t) );
+	struct FakeMultiFileOpen	theOpen = { inPaths, maps, errors };
+	double						startTime = FAKE_TRACE_EVENTS_ON() ? FakeTraceCurrentTime() : 0;
+	
+	if( !maps || !errors )	// Open them one after the other instead, which needs less memory.
+	{
+		if( errors != outErrors )
+			free( errors );
+		free( maps );
+		int16_t		firstErr = noErr;
+		for( int16_t x = 0; x < inCount; x++ )
+		{
+			int16_t		refNum = FakeOpenResFile( inPaths[x] );
+			int16_t		err = FakeResError();
+			if( outRefNums )
+				outRefNums[x] = (err == noErr) ? refNum : err;
+			if( outErrors )
+				outErrors[x] = err;
+			if( firstErr == noErr )
+				firstErr = err;
+		}
+		gFakeResError = firstErr;
+		return;
+	}
+	
+	if( !FakeReserveFileRefNums( (size_t)inCount ) )
+	{
+		gFakeResError = tmfoErr;
+		for( int16_t x = 0; x < inCount; x++ )
+		{
+			errors[x] = tmfoErr;
+			if( outRefNums )
+				outRefNums[x] = tmfoErr;
+		}
+		if( errors != outErrors )
+			free( errors );
+		free( maps );
+		return;
+	}
+	
+	// Parse all maps at the same time, then create their Handles here, where it's safe:
+	FakeRunParallel( inCount, gFakeResLoadThreads, FakeReadResourceMapOfFile, &theOpen );
+	for( int16_t x = 0; x < inCount; x++ )
+	{
+		if( maps[x] && (errors[x] = FakeCreateResourceHandles( maps[x] )) != noErr )
+		{
+			if( maps[x]->fileDescriptor )
+				fclose( maps[x]->fileDescriptor );
+			FakeDisposeResourceMap( maps[x] );
+			maps[x] = NULL;
+		}
+	}
+	
+	// Now read the resource data of all files at the same time:
+	if( gFakeResLoad )
+		FakeRunParallel( inCount, gFakeResLoadThreads, FakePreloadResourceMapOfFile, &theOpen );
+	
+	if( FakeInstallResourceMaps( maps, inCount ) != noErr )
+	{
+		for( int16_t x = 0; x < inCount; x++ )
+		{
+			if( !maps[x] )
+				continue;
+			FakeDisposeUninstalledResourceMap( maps[x] );
+			maps[x] = NULL;
+			errors[x] = memFulErr;
+		}
+	}
+	for( int16_t x = 0; x < inCount; x++ )
+	{
+		if( maps[x] )
+			FakeCacheReferenceEntriesOfMap( maps[x] );
+	}
+	
+	gFakeResError = noErr;
+	for( int16_t x = 0; x < inCount; x++ )
+	{
+		if( gFakeResError == noErr )
+			gFakeResError = errors[x];
+		if( outRefNums )
+			outRefNums[x] = maps[x] ? maps[x]->fileRefNum : errors[x];
+		FAKE_TRACE_EVENT( kFakeTraceFileOpenEnd, .refNum = maps[x] ? maps[x]->fileRefNum : 0, .error = errors[x],
+							.duration = FakeTraceCurrentTime() -startTime );
+	}
+	
+	if( errors != outErrors )
+		free( errors );
+	free( maps );
+}
+
+
+// Returns the map's index of where each resource Handle is, making it if
+//	needed. NULL if there isn't enough memory for it.
+static struct FakeHandleIndex*	FakeGetHandleIndex( struct FakeResourceMap* inMap )
+{
+	if( inMap->handleIndex )
+		return inMap->handleIndex;
+	
+	size_t		numEntries = 0;
+	for( int x = 0; x < inMap->numTypes; x++ )
+		numEntries += inMap->typeList[x].numberOfResourcesOfType -inMap->typeList[x].numRemovedResources;
+	inMap->handleIndex = FakeNewHandleIndex( numEntries );
+	for( int x = 0; inMap->handleIndex && x < inMap->numTypes; x++ )
+	{
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
+		{
+			Handle	currHandle = inMap->typeList[x].resourceList[y].resourceHandle;
+			if( currHandle && !FakeHandleIndexSet( inMap->handleIndex, currHandle, x, y ) )
+			{
+				FakeDisposeHandleIndex( inMap->handleIndex );
+				inMap->handleIndex = NULL;
+				break;
+			}
+		}
+	}
+	
+	return inMap->handleIndex;
+}
+
+
+// Throw away the map's Handle index after moving many entries, it's made again when next needed:
+static void	FakeForgetHandleIndex( struct FakeResourceMap* inMap )
+{
+	FakeDisposeHandleIndex( inMap->handleIndex );
+	inMap->handleIndex = NULL;
+}
+
+
+// Note in the map's Handle index (if it has one) that the entry is at the given position now:
+static void	FakeUpdateHandleIndex( struct FakeResourceMap* inMap, Handle inResource, size_t inTypeIndex, size_t inEntryIndex )
+{
+	if( inMap->handleIndex && !FakeHandleIndexSet( inMap->handleIndex, inResource, (uint32_t)inTypeIndex, (uint32_t)inEntryIndex ) )
+		FakeForgetHandleIndex( inMap );
+}
+
+
+// Returns the map's Bloom filter, making it if needed. NULL if there isn't enough memory for it.
+static struct FakeResBloomFilter*	FakeGetResBloomFilter( struct FakeResourceMap* inMap )
+{
+	if( inMap->bloomFilter )
+		return inMap->bloomFilter;
+	
+	size_t		numEntries = 0;
+	for( int x = 0; x < inMap->numTypes; x++ )
+		numEntries += inMap->typeList[x].numberOfResourcesOfType -inMap->typeList[x].numRemovedResources;
+	inMap->bloomFilter = FakeNewResBloomFilter( numEntries * 2 +64 );	// Room for adding some.
+	for( int x = 0; inMap->bloomFilter && x < inMap->numTypes; x++ )
+	{
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
+		{
+			if( inMap->typeList[x].resourceList[y].resourceHandle )	// Not removed?
+				FakeResBloomFilterAdd( inMap->bloomFilter, inMap->typeCodes[x], inMap->typeList[x].resourceIDs[y] );
+		}
+	}
+	
+	return inMap->bloomFilter;
+}
+
+
+// Throw away the map's Bloom filter, it's made again when next needed:
+static void	FakeForgetResBloomFilter( struct FakeResourceMap* inMap )
+{
+	FakeDisposeResBloomFilter( inMap->bloomFilter );
+	inMap->bloomFilter = NULL;
+}
+
+
+// Note in the map's Bloom filter (if it has one) that it has a resource with this type and ID now:
+static void	FakeUpdateResBloomFilter( struct FakeResourceMap* inMap, uint32_t inType, int16_t inID )
+{
+	if( inMap->bloomFilter && !FakeResBloomFilterAdd( inMap->bloomFilter, inType, inID ) )
+		FakeForgetResBloomFilter( inMap );
+	FakeForgetResMisses();
+}
+
+
+static bool FakeFindResourceHandleInMap( Handle theResource, struct FakeTypeListEntry** outTypeEntry, struct FakeReferenceListEntry** outRefEntry, struct FakeResourceMap* inMap )
+{
+	struct FakeHandleIndex*	handleIndex = (theResource != NULL && inMap != NULL) ? FakeGetHandleIndex( inMap ) : NULL;
+	uint32_t				typeIndex = 0, entryIndex = 0;
+	if( handleIndex && FakeHandleIndexFind( handleIndex, theResource, &typeIndex, &entryIndex ) )
+	{
+		if (outTypeEntry)
+		{
+			*outTypeEntry = &inMap->typeList[typeIndex];
+		}
+		
+		if (outRefEntry)
+		{
+			*outRefEntry = &inMap->typeList[typeIndex].resourceList[entryIndex];
+		}
+		
+		return true;
+	}
+	else if( (theResource != NULL) && (inMap != NULL) && !handleIndex )	// Not enough memory for an index? Look at each one.
+	{
+		for( int x = 0; x < inMap->numTypes; x++ )
+		{
+			for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
+			{
+				if( inMap->typeList[x].resourceList[y].resourceHandle == theResource )
+				{
+					if (outTypeEntry)
+					{
+						*outTypeEntry = &inMap->typeList[x];
+					}
+					
+					if (outRefEntry)
+					{
+						*outRefEntry = &inMap->typeList[x].resourceList[y];
+					}
+
+					return true;
+				}
+			}
+		}
+	}
+
+	if (outTypeEntry)
+	{
+		*outTypeEntry = NULL;
+	}
+	
+	if (outRefEntry)
+	{
+		*outRefEntry = NULL;
+	}
+
+	return false;
+}
+
+
+// Looks in the current file first, where a resource that was just gotten
+//	usually is, so this doesn't depend on how many files are open:
+static bool FakeFindResourceHandle( Handle theResource, struct FakeResourceMap** outMap, struct FakeTypeListEntry** outTypeEntry, struct FakeReferenceListEntry** outRefEntry )
+{
+	if( gCurrResourceMap && FakeFindResourceHandleInMap( theResource, outTypeEntry, outRefEntry, gCurrResourceMap ) )
+	{
+		if( outMap )
+			*outMap = gCurrResourceMap;
+		return true;
+	}
+	
+	struct FakeResourceMap*		currMap = gResourceMap;
+	while( currMap != NULL )
+	{
+		if( currMap != gCurrResourceMap && FakeFindResourceHandleInMap(theResource, outTypeEntry, outRefEntry, currMap) )
+		{
+			if( outMap )
+			{
+				*outMap = currMap;
+			}
+			return true;
+		}
+
+		currMap = currMap->nextResourceMap;
+	}
+
+	if ( outMap )
+	{
+		*outMap = NULL;
+	}
+	
+	if (outTypeEntry)
+	{
+		*outTypeEntry = NULL;
+	}
+	
+	if (outRefEntry)
+	{
+		*outRefEntry = NULL;
+	}
+
+	return false;
+}
+
+
+static struct FakeTypeListEntry* FakeFindTypeListEntry(struct FakeResourceMap* inMap, uint32_t theType)
+{
+	if( inMap != NULL )
+	{
+		size_t	typeIndex = FakeFindUInt32Key( inMap->typeCodes, inMap->numTypes, theType );
+		if( typeIndex < inMap->numTypes )
+		{
+			return &inMap->typeList[typeIndex];
+		}
+	}
+
+	return NULL;
+}
+
+
+// Throw away the type's index of resource IDs, it's made again when next needed:
+static void	FakeForgetResIDIndex( struct FakeTypeListEntry* inTypeEntry )
+{
+	FakeDisposeResIDIndex( inTypeEntry->idIndex );
+	inTypeEntry->idIndex = NULL;
+}
+
+
+// Returns the type's index of resource IDs, making it if needed. NULL if
+//	there isn't enough memory for it. IDs staged in a transaction count as used.
+static struct FakeResIDIndex*	FakeGetResIDIndex( struct FakeResourceMap* inMap, struct FakeTypeListEntry* inTypeEntry )
+{
+	if( inTypeEntry->idIndex )
+		return inTypeEntry->idIndex;
+	
+	inTypeEntry->idIndex = FakeNewResIDIndex( inTypeEntry->numberOfResourcesOfType -inTypeEntry->numRemovedResources );
+	for( int y = 0; inTypeEntry->idIndex && y < inTypeEntry->numberOfResourcesOfType; y++ )
+	{
+		if( inTypeEntry->resourceList[y].resourceHandle && !FakeResIDIndexAppend( inTypeEntry->idIndex, inTypeEntry->resourceIDs[y], (uint16_t)y ) )
+			FakeForgetResIDIndex( inTypeEntry );
+	}
+	if( !inTypeEntry->idIndex )
+		return NULL;
+	FakeResIDIndexSort( inTypeEntry->idIndex );
+	
+	uint32_t	resType = inMap->typeCodes[inTypeEntry -inMap->typeList];
+	for( size_t x = 0; inMap->transaction && x < inMap->transaction->numEdits; x++ )
+	{
+		struct FakeResEdit*			currEdit = inMap->transaction->edits +x;
+		struct FakeTypeListEntry*	editTypeEntry = NULL;
+		if( (currEdit->kind == kFakeResEditAdd && currEdit->resourceType == resType)
+			|| (currEdit->kind == kFakeResEditSetInfo && FakeFindResourceHandleInMap( currEdit->resourceHandle, &editTypeEntry, NULL, inMap )
+				&& editTypeEntry == inTypeEntry) )
+			FakeResIDIndexMarkUsed( inTypeEntry->idIndex, currEdit->resourceID );
+	}
+	
+	return inTypeEntry->idIndex;
+}
+
+
+static void	FakeForgetResIDIndexes( struct FakeResourceMap* inMap )
+{
+	for( int x = 0; x < inMap->numTypes; x++ )
+		FakeForgetResIDIndex( inMap->typeList +x );
+}
+
+
+// An ID was staged in a transaction, so FakeUniqueID() mustn't hand it out anymore:
+static void	FakeNoteStagedResID( struct FakeResourceMap* inMap, uint32_t inType, int16_t inID )
+{
+	struct FakeTypeListEntry*	typeEntry = FakeFindTypeListEntry( inMap, inType );
+	if( typeEntry && typeEntry->idIndex )
+		FakeResIDIndexMarkUsed( typeEntry->idIndex, inID );
+}
+
+
+// Makes room for inCount more types in the map's type list. Grows it by
+//	half again as much as it has, so adding many is linear overall:
+static bool	FakeReserveTypeListEntries( struct FakeResourceMap* inMap, size_t inCount )
+{
+	size_t	neededTypes = (size_t)inMap->numTypes +inCount;
+	if( neededTypes <= inMap->maxTypes )
+		return true;
+	if( neededTypes > UINT16_MAX )
+		return false;
+	
+	size_t	newMaxTypes = inMap->maxTypes +inMap->maxTypes / 2;
+	if( newMaxTypes < neededTypes )
+		newMaxTypes = (neededTypes < 8) ? 8 : neededTypes;
+	if( newMaxTypes > UINT16_MAX )
+		newMaxTypes = UINT16_MAX;
+	struct FakeTypeListEntry*	newTypeList = realloc( inMap->typeList, newMaxTypes * sizeof(struct FakeTypeListEntry) );
+	if( !newTypeList )
+		return false;
+	inMap->typeList = newTypeList;
+	uint32_t*					newTypeCodes = realloc( inMap->typeCodes, newMaxTypes * sizeof(uint32_t) );
+	if( !newTypeCodes )
+		return false;	// typeList is just bigger than it needs to be, that's OK.
+	inMap->typeCodes = newTypeCodes;
+	inMap->maxTypes = (uint16_t)newMaxTypes;
+	return true;
+}
+
+
+// Same for the reference list of one type:
+static bool	FakeReserveReferenceEntries( struct FakeTypeListEntry* inTypeEntry, size_t inCount )
+{
+	size_t	neededResources = (size_t)inTypeEntry->numberOfResourcesOfType +inCount;
+	if( neededResources <= inTypeEntry->maxResourcesOfType )
+		return true;
+	if( neededResources > UINT16_MAX )
+		return false;
+	
+	size_t	newMaxResources = inTypeEntry->maxResourcesOfType +inTypeEntry->maxResourcesOfType / 2;
+	if( newMaxResources < neededResources )
+		newMaxResources = (neededResources < 8) ? 8 : neededResources;
+	if( newMaxResources > UINT16_MAX )
+		newMaxResources = UINT16_MAX;
+	struct FakeReferenceListEntry*	newList = realloc( inTypeEntry->resourceList, newMaxResources * sizeof(struct FakeReferenceListEntry) );
+	if( !newList )
+		return false;
+	inTypeEntry->resourceList = newList;
+	int16_t*						newIDs = realloc( inTypeEntry->resourceIDs, newMaxResources * sizeof(int16_t) );
+	if( !newIDs )
+		return false;	// resourceList is just bigger than it needs to be, that's OK.
+	inTypeEntry->resourceIDs = newIDs;
+	inTypeEntry->maxResourcesOfType = (uint32_t)newMaxResources;
+	return true;
+}
+
+
+// Moves the entries of the given type's list together, over those
+//	FakeMarkReferenceEntryRemoved() left:
+static void	FakeCompactTypeListEntry( struct FakeResourceMap* inMap, size_t inTypeIndex )
+{
+	struct FakeTypeListEntry*	typeEntry = inMap->typeList +inTypeIndex;
+	if( typeEntry->numRemovedResources == 0 )
+		return;
+	
+	uint16_t*	newEntryIndexes = typeEntry->idIndex ? malloc( (typeEntry->numberOfResourcesOfType +1) * sizeof(uint16_t) ) : NULL;
+	size_t		numResources = 0;
+	for( size_t y = 0; y < typeEntry->numberOfResourcesOfType; y++ )
+	{
+		if( !typeEntry->resourceList[y].resourceHandle )
+			continue;
+		if( numResources != y )
+		{
+			typeEntry->resourceList[numResources] = typeEntry->resourceList[y];
+			typeEntry->resourceIDs[numResources] = typeEntry->resourceIDs[y];
+			FakeUpdateHandleIndex( inMap, typeEntry->resourceList[numResources].resourceHandle, inTypeIndex, numResources );
+		}
+		if( newEntryIndexes )
+			newEntryIndexes[y] = (uint16_t)numResources;
+		numResources++;
+	}
+	if( newEntryIndexes )
+		FakeResIDIndexRenumber( typeEntry->idIndex, newEntryIndexes );
+	else
+		FakeForgetResIDIndex( typeEntry );
+	free( newEntryIndexes );
+	typeEntry->numberOfResourcesOfType = (uint16_t)numResources;
+	typeEntry->numRemovedResources = 0;
+	
+	// Give back memory if most of it is unused now:
+	if( typeEntry->maxResourcesOfType > 16 && (typeEntry->maxResourcesOfType / 4) > numResources )
+	{
+		struct FakeReferenceListEntry*	newList = realloc( typeEntry->resourceList, (numResources * 2) * sizeof(struct FakeReferenceListEntry) );
+		if( newList )
+		{
+			typeEntry->resourceList = newList;
+			int16_t*	newIDs = realloc( typeEntry->resourceIDs, (numResources * 2) * sizeof(int16_t) );
+			if( newIDs )	// Otherwise it just stays bigger than it needs to be.
+				typeEntry->resourceIDs = newIDs;
+			typeEntry->maxResourcesOfType = (uint32_t)numResources * 2;
+		}
+	}
+}
+
+
+static void	FakeCompactResourceMap( struct FakeResourceMap* inMap )
+{
+	for( size_t x = 0; x < inMap->numTypes; x++ )
+		FakeCompactTypeListEntry( inMap, x );
+}
+
+
+// Removes the given type and its reference list from the map:
+static void	FakeRemoveTypeListEntry( struct FakeResourceMap* inMap, size_t inTypeIndex )
+{
+	FakeReleaseType( inMap->typeCodes[inTypeIndex] );
+	free( inMap->typeList[inTypeIndex].resourceList );
+	free( inMap->typeList[inTypeIndex].resourceIDs );
+	FakeForgetResIDIndex( inMap->typeList +inTypeIndex );
+	
+	inMap->numTypes--;
+	if( inTypeIndex < inMap->numTypes )
+	{
+		memmove( inMap->typeList +inTypeIndex, inMap->typeList +inTypeIndex +1, (inMap->numTypes -inTypeIndex) * sizeof(struct FakeTypeListEntry) );
+		memmove( inMap->typeCodes +inTypeIndex, inMap->typeCodes +inTypeIndex +1, (inMap->numTypes -inTypeIndex) * sizeof(uint32_t) );
+		FakeForgetHandleIndex( inMap );	// The types after it moved.
+	}
+}
+
+
+// The resource was removed from its file and the caller keeps its Handle, so
+//	it mustn't be emptied or filled by a fetch anymore, or point into data the
+//	file shares:
+static void	FakeHandOverRemovedResource( Handle inResource )
+{
+	FakeForgetResFetchesOfHandle( inResource );
+	FakeResourceCacheRemove( inResource );
+	FakeOwnHandleMemory( inResource );	// The caller keeps it after the file and its shared data are gone.
+}
+
+
+// Clears the entry, leaving a NULL resourceHandle so it's skipped, instead of
+//	moving all entries after it. Call FakeTidyTypeListEntry() afterwards.
+static void	FakeMarkReferenceEntryRemoved( struct FakeResourceMap* inMap, struct FakeTypeListEntry* inTypeEntry, struct FakeReferenceListEntry* inEntry )
+{
+	FakeHandOverRemovedResource( inEntry->resourceHandle );
+	if( inMap->handleIndex )
+		FakeHandleIndexRemove( inMap->handleIndex, inEntry->resourceHandle );
+	if( inTypeEntry->idIndex )
+		FakeResIDIndexRemove( inTypeEntry->idIndex, inEntry->resourceID, (uint16_t)(inEntry -inTypeEntry->resourceList) );
+	if( inMap->bloomFilter && !FakeResBloomFilterNoteRemoved( inMap->bloomFilter ) )
+		FakeForgetResBloomFilter( inMap );
+	FakeSetResourceID( inTypeEntry, inEntry -inTypeEntry->resourceList, 0 );
+	memset( inEntry, 0, sizeof(struct FakeReferenceListEntry) );
+	inTypeEntry->numRemovedResources++;
+}
+
+
+// Removes the type if none of its resources are left, and squeezes out the
+//	removed entries once they're more than those left, so each removal costs
+//	about the same on average:
+static void	FakeTidyTypeListEntry( struct FakeResourceMap* inMap, size_t inTypeIndex )
+{
+	struct FakeTypeListEntry*	typeEntry = inMap->typeList +inTypeIndex;
+	size_t						numLeft = typeEntry->numberOfResourcesOfType -typeEntry->numRemovedResources;
+	if( numLeft == 0 )
+		FakeRemoveTypeListEntry( inMap, inTypeIndex );
+	else if( typeEntry->numRemovedResources > numLeft )
+		FakeCompactTypeListEntry( inMap, inTypeIndex );
+}
+
+
+// Adds an entry for the given resource to the map. Returns the error:
+static int16_t	FakeAddReferenceEntry( struct FakeResourceMap* inMap, Handle theData, uint32_t theType, int16_t theID, const unsigned char* name )
+{
+	struct FakeTypeListEntry*	typeEntry = FakeFindTypeListEntry( inMap, theType );
+	if( !typeEntry )
+	{
+		if( !FakeReserveTypeListEntries( inMap, 1 ) )
+			return memFulErr;
+		
+		inMap->typeCodes[inMap->numTypes] = theType;
+		typeEntry = inMap->typeList +inMap->numTypes++;
+		memset( typeEntry, 0, sizeof(struct FakeTypeListEntry) );
+		FakeRetainType(theType);
+	}
+	size_t						typeIndex = typeEntry -inMap->typeList;
+	
+	if( typeEntry->numberOfResourcesOfType == UINT16_MAX )
+		FakeCompactTypeListEntry( inMap, typeIndex );
+	if( !FakeReserveReferenceEntries( typeEntry, 1 ) )
+	{
+		int16_t		err = (typeEntry->numberOfResourcesOfType == UINT16_MAX) ? addResFailed : memFulErr;
+		if( typeEntry->numberOfResourcesOfType == 0 )
+			FakeRemoveTypeListEntry( inMap, typeIndex );	// We just made it.
+		return err;
+	}
+	
+	struct FakeReferenceListEntry*	resourceEntry = typeEntry->resourceList +typeEntry->numberOfResourcesOfType++;
+	memset( resourceEntry, 0, sizeof(struct FakeReferenceListEntry) );
+	resourceEntry->resourceAttributes = resChanged;
+	FakeSetResourceID( typeEntry, typeEntry->numberOfResourcesOfType -1, theID );
+	if( name )
+		memcpy( resourceEntry->resourceName, name, name[0] +1 );
+	resourceEntry->resourceHandle = theData;
+	FakeUpdateHandleIndex( inMap, theData, typeIndex, typeEntry->numberOfResourcesOfType -1 );
+	if( typeEntry->idIndex && !FakeResIDIndexInsert( typeEntry->idIndex, theID, (uint16_t)(typeEntry->numberOfResourcesOfType -1) ) )
+		FakeForgetResIDIndex( typeEntry );
+	FakeUpdateResBloomFilter( inMap, theType, theID );
+	
+	inMap->dirty = true;
+	return noErr;
+}
+
+int16_t	FakeHomeResFile( Handle theResource )
+{
+	struct FakeResourceMap*		currMap = NULL;
+
+	if( FakeFindResourceHandle( theResource, &currMap, NULL, NULL) )
+	{
+		gFakeResError = noErr;
+		return currMap->fileRefNum;
+	}
+	
+	gFakeResError = resNotFound;
+	return -1;
+}
+
+
+// The last edit of inKind staged for inResource, or NULL:
+static struct FakeResEdit*	FakeFindStagedEdit( struct FakeResTransaction* inTransaction, Handle inResource, enum FakeResEditKind inKind )
+{
+	for( size_t x = inTransaction->numEdits; x > 0; x-- )
+	{
+		struct FakeResEdit*	currEdit = inTransaction->edits +x -1;
+		if( currEdit->resourceHandle == inResource && currEdit->kind == inKind )
+			return currEdit;
+	}
+	
+	return NULL;
+}
+
+
+// Finds a resource that was added in a transaction that hasn't been committed yet:
+static struct FakeResEdit*	FakeFindStagedAdd( Handle inResource, struct FakeResourceMap** outMap )
+{
+	for( struct FakeResourceMap* currMap = gResourceMap; currMap != NULL; currMap = currMap->nextResourceMap )
+	{
+		struct FakeResEdit*	addEdit = currMap->transaction ? FakeFindStagedEdit( currMap->transaction, inResource, kFakeResEditAdd ) : NULL;
+		if( addEdit )
+		{
+			if( outMap )
+				*outMap = currMap;
+			return addEdit;
+		}
+	}
+	
+	return NULL;
+}
+
+
+static struct FakeResEdit*	FakeStageEdit( struct FakeResTransaction* ioTransaction, enum FakeResEditKind inKind, Handle inResource )
+{
+	if( ioTransaction->numEdits == ioTransaction->maxEdits )
+	{
+		size_t				newMaxEdits = (ioTransaction->maxEdits == 0) ? 64 : ioTransaction->maxEdits * 2;
+		struct FakeResEdit*	newEdits = realloc( ioTransaction->edits, newMaxEdits * sizeof(struct FakeResEdit) );
+		if( !newEdits )
+			return NULL;
+		ioTransaction->edits = newEdits;
+		ioTransaction->maxEdits = newMaxEdits;
+	}
+	
+	struct FakeResEdit*	newEdit = ioTransaction->edits +ioTransaction->numEdits++;
+	memset( newEdit, 0, sizeof(struct FakeResEdit) );
+	newEdit->kind = inKind;
+	newEdit->resourceHandle = inResource;
+	return newEdit;
+}
+
+
+static void	FakeDisposeResTransaction( struct FakeResTransaction* inTransaction )
+{
+	free( inTransaction->edits );
+	free( inTransaction );
+}
+
+
+static int	FakeCompareStagedEditHandles( const void* inA, const void* inB )
+{
+	uintptr_t	a = (uintptr_t)(*(const struct FakeResEdit**)inA)->resourceHandle;
+	uintptr_t	b = (uintptr_t)(*(const struct FakeResEdit**)inB)->resourceHandle;
+	return (a < b) ? -1 : (a > b);
+}
+
+
+static int	FakeCompareStagedEditTypes( const void* inA, const void* inB )
+{
+	const struct FakeResEdit*	a = *(const struct FakeResEdit**)inA;
+	const struct FakeResEdit*	b = *(const struct FakeResEdit**)inB;
+	if( a->resourceType != b->resourceType )
+		return (a->resourceType < b->resourceType) ? -1 : 1;
+	return (a < b) ? -1 : (a > b);	// Keep the order they were added in.
+}
+
+
+// The staged removal or new info for the given resource, or NULL:
+static struct FakeResEdit*	FakeFindStagedChange( struct FakeResEdit** inChanges, size_t inCount, Handle inResource )
+{
+	struct FakeResEdit		key = { .resourceHandle = inResource };
+	struct FakeResEdit*		keyPtr = &key;
+	struct FakeResEdit**	foundChange = bsearch( &keyPtr, inChanges, inCount, sizeof(struct FakeResEdit*), FakeCompareStagedEditHandles );
+	return foundChange ? *foundChange : NULL;
+}
+
+
+// How many of the type's resources are left once the staged removals are made:
+static size_t	FakeCountKeptReferenceEntries( struct FakeTypeListEntry* inTypeEntry, struct FakeResEdit** inChanges, size_t inNumChanges )
+{
+	size_t		numKept = 0;
+	for( int y = 0; y < inTypeEntry->numberOfResourcesOfType; y++ )
+	{
+		Handle				currResource = inTypeEntry->resourceList[y].resourceHandle;
+		struct FakeResEdit*	currChange = currResource ? FakeFindStagedChange( inChanges, inNumChanges, currResource ) : NULL;
+		if( currResource && (!currChange || currChange->kind != kFakeResEditRemove) )
+			numKept++;
+	}
+	return numKept;
+}
+
+
+// Makes all edits staged in inTransaction to inMap, building each reference
+//	list just once. Staging made sure there's at most one removal or new info
+//	per resource, and that only resources not in inMap are added. Returns
+//	memFulErr, or addResFailed if a type would end up with more than 65535
+//	resources, without changing anything.
+static int16_t	FakeApplyResTransaction( struct FakeResourceMap* inMap, struct FakeResTransaction* inTransaction )
+{
+	struct FakeResEdit**	changes = malloc( (inTransaction->numEdits +1) * sizeof(struct FakeResEdit*) );
+	struct FakeResEdit**	additions = malloc( (inTransaction->numEdits +1) * sizeof(struct FakeResEdit*) );
+	size_t					numChanges = 0, numAdditions = 0;
+	if( !changes || !additions )
+	{
+		free( changes );
+		free( additions );
+		return memFulErr;
+	}
+	for( size_t x = 0; x < inTransaction->numEdits; x++ )
+	{
+		if( inTransaction->edits[x].kind == kFakeResEditAdd )
+			additions[numAdditions++] = inTransaction->edits +x;
+		else if( inTransaction->edits[x].kind != kFakeResEditNone )
+			changes[numChanges++] = inTransaction->edits +x;
+	}
+	if( numChanges == 0 && numAdditions == 0 )
+	{
+		free( changes );
+		free( additions );
+		return noErr;
+	}
+	qsort( changes, numChanges, sizeof(struct FakeResEdit*), FakeCompareStagedEditHandles );
+	qsort( additions, numAdditions, sizeof(struct FakeResEdit*), FakeCompareStagedEditTypes );
+	
+	// Make every new list before changing anything, so we can still give up. The
+	//	map's types come first in newTypeList, then those only additions have:
+	size_t							maxNewTypes = inMap->numTypes +numAdditions;
+	struct FakeTypeListEntry*		newTypeList = calloc( maxNewTypes, sizeof(struct FakeTypeListEntry) );
+	uint32_t*						newTypeCodes = malloc( maxNewTypes * sizeof(uint32_t) );
+	size_t*							additionsOfType = malloc( (2 * (size_t)inMap->numTypes +1) * sizeof(size_t) );	// First addition and count, per type of the map.
+	bool*							typeHadAdditions = calloc( numAdditions +1, sizeof(bool) );
+	struct FakeReferenceListEntry**	removedEntries = malloc( (numChanges +1) * sizeof(struct FakeReferenceListEntry*) );
+	size_t							numAddedTypes = 0;
+	int16_t							err = (newTypeList && newTypeCodes && additionsOfType && typeHadAdditions && removedEntries) ? noErr : memFulErr;
+	for( int x = 0; err == noErr && x < inMap->numTypes; x++ )
+	{
+		struct FakeTypeListEntry*	oldType = inMap->typeList +x;
+		size_t						firstAddition = 0, numAdditionsOfType = 0;
+		while( firstAddition < numAdditions && additions[firstAddition]->resourceType != inMap->typeCodes[x] )
+			firstAddition++;
+		while( (firstAddition +numAdditionsOfType) < numAdditions && additions[firstAddition +numAdditionsOfType]->resourceType == inMap->typeCodes[x] )
+			typeHadAdditions[firstAddition +numAdditionsOfType++] = true;
+		additionsOfType[2 * x] = firstAddition;
+		additionsOfType[2 * x +1] = numAdditionsOfType;
+		
+		size_t						maxResources = oldType->numberOfResourcesOfType +numAdditionsOfType +1;
+		if( maxResources > UINT16_MAX && (FakeCountKeptReferenceEntries( oldType, changes, numChanges ) +numAdditionsOfType) > UINT16_MAX )
+			err = addResFailed;
+		newTypeList[x].maxResourcesOfType = (uint32_t)maxResources;
+		newTypeList[x].resourceList = malloc( maxResources * sizeof(struct FakeReferenceListEntry) );
+		newTypeList[x].resourceIDs = malloc( maxResources * sizeof(int16_t) );
+		if( err == noErr && (!newTypeList[x].resourceList || !newTypeList[x].resourceIDs) )
+			err = memFulErr;
+	}
+	for( size_t a = 0; err == noErr && a < numAdditions; )
+	{
+		size_t	numAdditionsOfType = 1;
+		while( (a +numAdditionsOfType) < numAdditions && additions[a +numAdditionsOfType]->resourceType == additions[a]->resourceType )
+			numAdditionsOfType++;
+		if( !typeHadAdditions[a] )
+		{
+			struct FakeTypeListEntry*	newType = newTypeList +inMap->numTypes +numAddedTypes++;
+			newType->maxResourcesOfType = (uint32_t)numAdditionsOfType;
+			newType->resourceList = calloc( numAdditionsOfType, sizeof(struct FakeReferenceListEntry) );
+			newType->resourceIDs = calloc( numAdditionsOfType, sizeof(int16_t) );
+			if( numAdditionsOfType > UINT16_MAX || ((size_t)inMap->numTypes +numAddedTypes) > UINT16_MAX )
+				err = addResFailed;
+			else if( !newType->resourceList || !newType->resourceIDs )
+				err = memFulErr;
+		}
+		a += numAdditionsOfType;
+	}
+	if( err != noErr )
+	{
+		for( size_t x = 0; newTypeList && x < maxNewTypes; x++ )
+		{
+			free( newTypeList[x].resourceList );
+			free( newTypeList[x].resourceIDs );
+		}
+		free( newTypeList );
+		free( newTypeCodes );
+		free( additionsOfType );
+		free( typeHadAdditions );
+		free( removedEntries );
+		free( changes );
+		free( additions );
+		return err;
+	}
+	
+	FakeCompactResourceMap( inMap );	// So we don't have to skip removed entries below.
+	
+	// Apply new infos, and read the data of removed resources in one go, as the caller keeps their Handles:
+	size_t							numRemovedEntries = 0;
+	for( int x = 0; numChanges > 0 && x < inMap->numTypes; x++ )
+	{
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
+		{
+			struct FakeReferenceListEntry*	currEntry = inMap->typeList[x].resourceList +y;
+			struct FakeResEdit*				currChange = FakeFindStagedChange( changes, numChanges, currEntry->resourceHandle );
+			if( !currChange )
+				continue;
+			if( currChange->kind == kFakeResEditSetInfo )
+			{
+				FakeSetResourceID( inMap->typeList +x, y, currChange->resourceID );
+				memcpy( currEntry->resourceName, currChange->resourceName, sizeof(FakeStr255) );
+			}
+			else if( FakeReferenceEntryNeedsLoad( currEntry ) )
+				removedEntries[numRemovedEntries++] = currEntry;
+		}
+	}
+	FakeLoadReferenceEntries( inMap, removedEntries, NULL, numRemovedEntries );
+	free( removedEntries );
+	
+	// Fill in the new type list, with each type's new reference list:
+	size_t						numNewTypes = 0;
+	for( int x = 0; x < inMap->numTypes; x++ )
+	{
+		struct FakeTypeListEntry*	oldType = inMap->typeList +x;
+		uint32_t					oldTypeCode = inMap->typeCodes[x];
+		size_t						firstAddition = additionsOfType[2 * x], numAdditionsOfType = additionsOfType[2 * x +1];
+		struct FakeTypeListEntry	newType = newTypeList[x];	// Only ever moves down, so it's still there.
+		size_t						numResources = 0;
+		for( int y = 0; y < oldType->numberOfResourcesOfType; y++ )
+		{
+			struct FakeResEdit*	currChange = (numChanges > 0) ? FakeFindStagedChange( changes, numChanges, oldType->resourceList[y].resourceHandle ) : NULL;
+			if( currChange && currChange->kind == kFakeResEditRemove )
+				FakeHandOverRemovedResource( oldType->resourceList[y].resourceHandle );
+			else
+			{
+				newType.resourceList[numResources] = oldType->resourceList[y];
+				newType.resourceIDs[numResources++] = oldType->resourceIDs[y];
+			}
+		}
+		for( size_t a = firstAddition; a < (firstAddition +numAdditionsOfType); a++ )
+		{
+			struct FakeReferenceListEntry*	newEntry = newType.resourceList +numResources;
+			memset( newEntry, 0, sizeof(struct FakeReferenceListEntry) );
+			newEntry->resourceAttributes = resChanged;
+			FakeSetResourceID( &newType, numResources++, additions[a]->resourceID );
+			memcpy( newEntry->resourceName, additions[a]->resourceName, sizeof(FakeStr255) );
+			newEntry->resourceHandle = additions[a]->resourceHandle;
+		}
+		free( oldType->resourceList );
+		free( oldType->resourceIDs );
+		FakeDisposeResIDIndex( oldType->idIndex );
+		
+		if( numResources == 0 )
+		{
+			free( newType.resourceList );
+			free( newType.resourceIDs );
+			FakeReleaseType( oldTypeCode );
+			continue;
+		}
+		newType.numberOfResourcesOfType = (uint16_t)numResources;
+		newTypeList[numNewTypes] = newType;
+		newTypeCodes[numNewTypes] = oldTypeCode;
+		numNewTypes++;
+	}
+	
+	// Additions of types the map didn't have yet go at the end, like FakeAddResource() does:
+	size_t						nextAddedType = inMap->numTypes;
+	for( size_t a = 0; a < numAdditions; )
+	{
+		size_t	numAdditionsOfType = 1;
+		while( (a +numAdditionsOfType) < numAdditions && additions[a +numAdditionsOfType]->resourceType == additions[a]->resourceType )
+			numAdditionsOfType++;
+		if( !typeHadAdditions[a] )
+		{
+			struct FakeTypeListEntry	newType = newTypeList[nextAddedType++];
+			newType.numberOfResourcesOfType = (uint16_t)numAdditionsOfType;
+			for( size_t y = 0; y < numAdditionsOfType; y++ )
+			{
+				newType.resourceList[y].resourceAttributes = resChanged;
+				FakeSetResourceID( &newType, y, additions[a +y]->resourceID );
+				memcpy( newType.resourceList[y].resourceName, additions[a +y]->resourceName, sizeof(FakeStr255) );
+				newType.resourceList[y].resourceHandle = additions[a +y]->resourceHandle;
+			}
+			newTypeList[numNewTypes] = newType;
+			newTypeCodes[numNewTypes] = additions[a]->resourceType;
+			numNewTypes++;
+			FakeRetainType( additions[a]->resourceType );
+		}
+		a += numAdditionsOfType;
+	}
+	
+	free( inMap->typeList );
+	free( inMap->typeCodes );
+	inMap->typeList = (numNewTypes > 0) ? newTypeList : NULL;
+	inMap->typeCodes = (numNewTypes > 0) ? newTypeCodes : NULL;
+	if( numNewTypes == 0 )
+	{
+		free( newTypeList );
+		free( newTypeCodes );
+	}
+	inMap->numTypes = (uint16_t)numNewTypes;
+	inMap->maxTypes = (numNewTypes > 0) ? (uint16_t)((maxNewTypes < UINT16_MAX) ? maxNewTypes : UINT16_MAX) : 0;
+	FakeForgetHandleIndex( inMap );	// Nearly everything moved.
+	FakeForgetResBloomFilter( inMap );
+	FakeForgetResMisses();
+	inMap->dirty = true;
+	
+	free( additionsOfType );
+	free( typeHadAdditions );
+	free( changes );
+	free( additions );
+	
+	return noErr;
+}
+
+
+// Report the time since *ioStartTime as a phase of saving, and start the next phase:
+static void	FakeTraceSavePhase( int16_t inFileRefNum, const char* inPhaseName, double* ioStartTime )
+{
+	double	now = FakeTraceCurrentTime();
+	FAKE_TRACE_EVENT( kFakeTraceSavePhase, .refNum = inFileRefNum, .name = inPhaseName, .duration = now -*ioStartTime );
+	*ioStartTime = now;
+}
+
+
+// Creates an empty file next to inPath, with the same permissions as the open
+//	file inFD, to write a new version of inPath into. *outTempPath gets its
+//	malloc()ed path. Returns NULL on failure.
+static FILE*	FakeCreateFileNextTo( const char* inPath, int inFD, char** outTempPath )
+{
+	size_t	pathLength = strlen( inPath );
+	char*	tempPath = malloc( pathLength +sizeof(".XXXXXX") );
+	if( !tempPath )
+		return NULL;
+	memmove( tempPath, inPath, pathLength );
+	memmove( tempPath +pathLength, ".XXXXXX", sizeof(".XXXXXX") );
+	int		tempFD = mkstemp( tempPath );
+	if( tempFD < 0 )
+	{
+		free( tempPath );
+		return NULL;
+	}
+	
+	struct stat	fileInfo;
+	if( fstat( inFD, &fileInfo ) == 0 )
+		fchmod( tempFD, fileInfo.st_mode & 07777 );
+	FILE*	tempFile = fdopen( tempFD, "w+" );
+	if( !tempFile )
+	{
+		close( tempFD );
+		unlink( tempPath );
+		free( tempPath );
+		return NULL;
+	}
+	
+	*outTempPath = tempPath;
+	return tempFile;
+}
+
+
+static void	FakeDisposeResDataLayout( struct FakeResDataLayout* inLayout )
+{
+	free( inLayout->entries );
+	free( inLayout->offsets );
+	free( inLayout->sharesData );
+	memset( inLayout, 0, sizeof(struct FakeResDataLayout) );
+}
+
+
+static int	FakeCompareResDataRanks( const void* inA, const void* inB )
+{
+	const struct FakeResDataRank*	rankA = inA;
+	const struct FakeResDataRank*	rankB = inB;
+	if( rankA->preload != rankB->preload )
+		return rankA->preload ? -1 : 1;
+	if( rankA->profileRank != rankB->profileRank )
+		return (rankA->profileRank < rankB->profileRank) ? -1 : 1;
+	if( rankA->typeRank != rankB->typeRank )
+		return (rankA->typeRank < rankB->typeRank) ? -1 : 1;
+	return (rankA->mapIndex < rankB->mapIndex) ? -1 : ((rankA->mapIndex > rankB->mapIndex) ? 1 : 0);
+}
+
+
+static uint64_t	FakeHashResData( const uint8_t* inData, size_t inLength )
+{
+	uint64_t	hash = 0x9E3779B97F4A7C15ULL ^ inLength;
+	size_t		x = 0;
+	for( ; (x +sizeof(uint64_t)) <= inLength; x += sizeof(uint64_t) )
+	{
+		uint64_t	word;
+		memmove( &word, inData +x, sizeof(word) );
+		hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+		hash ^= hash >> 32;
+	}
+	for( ; x < inLength; x++ )
+		hash = (hash ^ inData[x]) * 0x100000001B3ULL;
+	hash ^= hash >> 29;
+	return hash;
+}
+
+
+static void	FakeDisposeResDataHashTable( struct FakeResDataHashTable* inTable )
+{
+	free( inTable->slots );
+	free( inTable->hashes );
+	memset( inTable, 0, sizeof(struct FakeResDataHashTable) );
+}
+
+
+static bool	FakeMakeResDataHashTable( struct FakeResDataHashTable* outTable, size_t inNumEntries )
+{
+	outTable->numSlots = 16;
+	while( outTable->numSlots < inNumEntries * 2 )
+		outTable->numSlots *= 2;
+	outTable->slots = calloc( outTable->numSlots, sizeof(size_t) );
+	outTable->hashes = malloc( (inNumEntries +1) * sizeof(uint64_t) );
+	if( !outTable->slots || !outTable->hashes )
+	{
+		FakeDisposeResDataHashTable( outTable );
+		return false;
+	}
+	return true;
+}
+
+
+// Returns the index of the first entry in inLayout with the same data as
+//	entry inIndex, after adding inIndex if there's none, so that's inIndex:
+static size_t	FakeFindOrAddResData( struct FakeResDataHashTable* inTable, const struct FakeResDataLayout* inLayout, size_t inIndex )
+{
+	Handle		theHandle = inLayout->entries[inIndex]->resourceHandle;
+	long		theSize = ((MasterPointer*)theHandle)->size;	// FakeGetHandleSize() sets a global.
+	if( theSize <= 0 || *theHandle == NULL )
+		return inIndex;	// Nothing to share.
+	
+	uint64_t	hash = FakeHashResData( (const uint8_t*)*theHandle, (size_t)theSize );
+	inTable->hashes[inIndex] = hash;
+	size_t		slot = (size_t)hash & (inTable->numSlots -1);
+	for( ; inTable->slots[slot] != 0; slot = (slot +1) & (inTable->numSlots -1) )
+	{
+		size_t	other = inTable->slots[slot] -1;
+		Handle	otherHandle = inLayout->entries[other]->resourceHandle;
+		if( inTable->hashes[other] == hash && ((MasterPointer*)otherHandle)->size == theSize
+			&& memcmp( *otherHandle, *theHandle, (size_t)theSize ) == 0 )
+			return other;
+	}
+	inTable->slots[slot] = inIndex +1;
+	return inIndex;
+}
+
+
+// Decides where FakeSaveResourceMap() writes each resource's data. Without
+//	inOptions, that's one after the other in the order of the map, otherwise
+//	see FakeCompactResFile(). After FakeSetResDedup(true), resources with the
+//	same data share one copy. The map must have been compacted.
+static int16_t	FakeLayOutResourceData( struct FakeResourceMap* inMap, const struct FakeResCompactOptions* inOptions, struct FakeResDataLayout* outLayout )
+{
+	size_t	numEntries = 0;
+	for( int x = 0; x < inMap->numTypes; x++ )
+		numEntries += inMap->typeList[x].numberOfResourcesOfType;
+	outLayout->entries = malloc( (numEntries +1) * sizeof(struct FakeReferenceListEntry*) );
+	outLayout->offsets = malloc( (numEntries +1) * sizeof(uint64_t) );
+	outLayout->numEntries = numEntries;
+	outLayout->dataLength = 0;
+	struct FakeResDataRank*	ranks = inOptions ? malloc( (numEntries +1) * sizeof(struct FakeResDataRank) ) : NULL;
+	if( !outLayout->entries || !outLayout->offsets || (inOptions && !ranks) )
+	{
+		free( ranks );
+		FakeDisposeResDataLayout( outLayout );
+		return memFulErr;
+	}
+	
+	size_t	currEntry = 0;
+	for( int x = 0; x < inMap->numTypes; x++ )
+	{
+		uint32_t	typeRank = UINT32_MAX;
+		for( size_t t = 0; ranks && t < inOptions->numTypesInOrder && typeRank == UINT32_MAX; t++ )
+		{
+			if( inOptions->typeOrder[t] == inMap->typeCodes[x] )
+				typeRank = (uint32_t)t;
+		}
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++, currEntry++ )
+		{
+			struct FakeReferenceListEntry*	theEntry = &inMap->typeList[x].resourceList[y];
+			outLayout->entries[currEntry] = theEntry;
+			if( ranks )
+			{
+				ranks[currEntry] = (struct FakeResDataRank){ .entry = theEntry, .preload = (theEntry->resourceAttributes & resPreload) != 0,
+															.profileRank = UINT32_MAX, .typeRank = typeRank, .mapIndex = currEntry };
+			}
+		}
+	}
+	
+	if( ranks )
+	{
+		uint32_t					numProfileEntries = 0;
+		struct FakeProfileEntry*	profileEntries = inOptions->useProfile ? FakeReadResourceProfile( inMap, &numProfileEntries ) : NULL;
+		for( uint32_t x = 0; x < numProfileEntries; x++ )
+		{
+			struct FakeTypeListEntry*		typeEntry = FakeFindTypeListEntry( inMap, profileEntries[x].resType );
+			struct FakeReferenceListEntry*	theEntry = FakeFindReferenceListEntry( inMap, profileEntries[x].resType, profileEntries[x].resID );
+			if( !theEntry )
+				continue;	// Removed since.
+			size_t	mapIndex = theEntry -typeEntry->resourceList;
+			for( struct FakeTypeListEntry* prevType = inMap->typeList; prevType < typeEntry; prevType++ )
+				mapIndex += prevType->numberOfResourcesOfType;
+			if( ranks[mapIndex].profileRank == UINT32_MAX )
+				ranks[mapIndex].profileRank = x;
+		}
+		free( profileEntries );
+		
+		qsort( ranks, numEntries, sizeof(struct FakeResDataRank), FakeCompareResDataRanks );
+		for( size_t x = 0; x < numEntries; x++ )
+			outLayout->entries[x] = ranks[x].entry;
+		free( ranks );
+	}
+	
+	struct FakeResDataHashTable	hashTable = { 0 };
+	if( gFakeResDedup && !FakeMakeResDataHashTable( &hashTable, numEntries ) )
+	{
+		FakeDisposeResDataLayout( outLayout );
+		return memFulErr;
+	}
+	
+	uint64_t	alignment = (inOptions && inOptions->alignment > 1) ? inOptions->alignment : 1;
+	uint64_t	currOffset = 0;
+	for( size_t x = 0; x < numEntries; x++ )
+	{
+		size_t	firstWithData = hashTable.slots ? FakeFindOrAddResData( &hashTable, outLayout, x ) : x;
+		if( firstWithData != x )	// Same as one before, point at that one's copy.
+		{
+			if( !outLayout->sharesData && !(outLayout->sharesData = calloc( numEntries, sizeof(bool) )) )
+			{
+				FakeDisposeResDataHashTable( &hashTable );
+				FakeDisposeResDataLayout( outLayout );
+				return memFulErr;
+			}
+			outLayout->offsets[x] = outLayout->offsets[firstWithData];
+			outLayout->sharesData[x] = outLayout->sharesData[firstWithData] = true;
+			continue;
+		}
+		
+		// Pad so the data after the length starts at a multiple of the alignment in the file:
+		uint64_t	dataStart = FAKE_RES_DATA_OFFSET +currOffset +sizeof(uint32_t);
+		currOffset += (alignment -dataStart % alignment) % alignment;
+		outLayout->offsets[x] = currOffset;
+		currOffset += sizeof(uint32_t) +(uint64_t)FakeGetHandleSize( outLayout->entries[x]->resourceHandle );
+	}
+	outLayout->dataLength = currOffset;
+	FakeDisposeResDataHashTable( &hashTable );
+	
+	return noErr;
+}
+
+
+// Writes inLength zero bytes, e.g. to pad resource data to its alignment:
+static void	FakeFWriteZeroes( uint64_t inLength, FILE* theFile )
+{
+	static const uint8_t	zeroes[4096] = { 0 };
+	while( inLength > 0 )
+	{
+		size_t	amount = (inLength < sizeof(zeroes)) ? (size_t)inLength : sizeof(zeroes);
+		fwrite( zeroes, 1, amount, theFile );
+		inLength -= amount;
+	}
+}
+
+
+// Writes each resource's data where inLayout says. The file must be at
+//	FAKE_RES_DATA_OFFSET. Notes in each entry where its data is now, so we
+//	can load it from there again.
+static void	FakeWriteResourceData( FILE* theFile, const struct FakeResDataLayout* inLayout )
+{
+	uint64_t	currOffset = 0;		// Resource data relative.
+	for( size_t x = 0; x < inLayout->numEntries; x++ )
+	{
+		struct FakeReferenceListEntry*	currEntry = inLayout->entries[x];
+		uint32_t	theSize = (uint32_t)FakeGetHandleSize( currEntry->resourceHandle );
+		currEntry->sharesData = inLayout->sharesData && inLayout->sharesData[x];
+		if( inLayout->offsets[x] < currOffset )	// Shares the data written for an earlier one.
+		{
+			currEntry->dataOffset = FAKE_RES_DATA_OFFSET +inLayout->offsets[x];
+			currEntry->dataExtent = sizeof(uint32_t) +theSize;
+			continue;
+		}
+		FakeFWriteZeroes( inLayout->offsets[x] -currOffset, theFile );
+		FakeFWriteUInt32BE( theSize, theFile );
+		fwrite( *currEntry->resourceHandle, 1, theSize, theFile );
+		currOffset = inLayout->offsets[x] +sizeof(uint32_t) +theSize;
+		
+		currEntry->dataOffset = FAKE_RES_DATA_OFFSET +inLayout->offsets[x];	// Remember where to reload it from.
+		currEntry->dataExtent = sizeof(uint32_t) +theSize;
+	}
+}
+
+
+// Whether FakeSaveResourceMap() can write the map and data laid out as in
+//	inLayout in the map's format. Classic files only have 24 bits for data
+//	offsets and 16 for offsets in the map, so rather than write a damaged
+//	file, we return mapReadErr if those would overflow.
+static int16_t	FakeCheckResourceMapFitsFormat( struct FakeResourceMap* inMap, const struct FakeResDataLayout* inLayout )
+{
+	const uint64_t	kRefEntryLength = inMap->extendedFormat ? FAKE_EXTENDED_REF_ENTRY_LENGTH : (2 + 2 + 1 + 3 + 4);
+	const uint64_t	kTypeEntryLength = inMap->extendedFormat ? FAKE_EXTENDED_TYPE_ENTRY_LENGTH : (4 + 2 + 2);
+	const uint64_t	kTypeListOffset = inMap->extendedFormat ? FAKE_EXTENDED_MAP_HEADER_LENGTH : FAKE_CLASSIC_MAP_HEADER_LENGTH +2;
+	uint64_t		refListOffset = (inMap->extendedFormat ? 4 : 2) +inMap->numTypes * kTypeEntryLength;	// Type list-relative in classic files.
+	uint64_t		namesLength = 0;
+	
+	for( int x = 0; x < inMap->numTypes; x++ )
+	{
+		if( !inMap->extendedFormat && refListOffset > 0xFFFF )
+			return mapReadErr;
+		refListOffset += inMap->typeList[x].numberOfResourcesOfType * kRefEntryLength;
+		for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
+		{
+			if( (uint64_t)FakeGetHandleSize( inMap->typeList[x].resourceList[y].resourceHandle ) > UINT32_MAX )
+				return mapReadErr;
+			if( inMap->typeList[x].resourceList[y].resourceName[0] != 0 )
+			{
+				if( !inMap->extendedFormat && namesLength >= 0xFFFF )	// 0xFFFF means "no name".
+					return mapReadErr;
+				namesLength += inMap->typeList[x].resourceList[y].resourceName[0] +1;
+			}
+		}
+	}
+	
+	for( size_t x = 0; !inMap->extendedFormat && x < inLayout->numEntries; x++ )
+	{
+		if( inLayout->offsets[x] > 0x00FFFFFF )
+			return mapReadErr;
+	}
+	
+	uint64_t	nameListOffset = kTypeListOffset +refListOffset;
+	if( inMap->extendedFormat )
+		return ((nameListOffset +namesLength) > UINT32_MAX) ? mapReadErr : noErr;
+	if( nameListOffset > 0xFFFF || (FAKE_RES_DATA_OFFSET +inLayout->dataLength +nameListOffset +namesLength) > UINT32_MAX )
+		return mapReadErr;
+	return noErr;
+}
+
+
+// Writes the map and all resource data, laid out as in inLayout, in the
+//	extended format described at the top of this file. The map is put together
+//	in RAM and written in one go. Nothing has been written yet if this fails.
+static int16_t	FakeWriteExtendedResourceFile( struct FakeResourceMap* currMap, const struct FakeResDataLayout* inLayout, int16_t inFileRefNum, double* ioPhaseStartTime, uint64_t* outFileLength )
+{
+	const uint64_t	kResDataOffset = FAKE_RES_DATA_OFFSET;	// Same as in classic files, so there's room for application data.
+	FILE*			theFile = currMap->fileDescriptor;
+	size_t			numResources = 0;
+	size_t			namesLength = 0;
+	for( int x = 0; x < currMap->numTypes; x++ )
+	{
+		numResources += currMap->typeList[x].numberOfResourcesOfType;
+		for( int y = 0; y < currMap->typeList[x].numberOfResourcesOfType; y++ )
+		{
+			if( currMap->typeList[x].resourceList[y].resourceName[0] != 0 )
+				namesLength += currMap->typeList[x].resourceList[y].resourceName[0] +1;
+		}
+	}
+	size_t		typeListOffset = FAKE_EXTENDED_MAP_HEADER_LENGTH;
+	size_t		refListOffset = typeListOffset +4 +currMap->numTypes * FAKE_EXTENDED_TYPE_ENTRY_LENGTH;
+	size_t		nameListOffset = refListOffset +numResources * FAKE_EXTENDED_REF_ENTRY_LENGTH;
+	size_t		resMapLength = nameListOffset +namesLength;
+	uint8_t*	mapData = calloc( 1, resMapLength );
+	if( !mapData )
+		return memFulErr;
+	
+	FakePutUInt32BE( mapData, FAKE_EXTENDED_MAGIC );
+	FakePutUInt16BE( mapData +4, currMap->resFileAttributes );
+	FakePutUInt32BE( mapData +8, (uint32_t)typeListOffset );
+	FakePutUInt32BE( mapData +12, (uint32_t)nameListOffset );
+	FakePutUInt32BE( mapData +typeListOffset, currMap->numTypes );
+	
+	FakeFSeek( theFile, kResDataOffset, SEEK_SET );
+	FakeWriteResourceData( theFile, inLayout );
+	if( FAKE_TRACE_EVENTS_ON() )
+		FakeTraceSavePhase( inFileRefNum, "data", ioPhaseStartTime );
+	
+	// Note where each resource's data went in the map:
+	size_t		nameListCurrOffset = 0;
+	uint8_t*	typeData = mapData +typeListOffset +4;
+	uint8_t*	refData = mapData +refListOffset;
+	for( int x = 0; x < currMap->numTypes; x++ )
+	{
+		FakePutUInt32BE( typeData, currMap->typeCodes[x] );
+		FakePutUInt32BE( typeData +4, currMap->typeList[x].numberOfResourcesOfType );
+		FakePutUInt32BE( typeData +8, (uint32_t)(refData -mapData) );
+		typeData += FAKE_EXTENDED_TYPE_ENTRY_LENGTH;
+		
+		for( int y = 0; y < currMap->typeList[x].numberOfResourcesOfType; y++ )
+		{
+			struct FakeReferenceListEntry*	currEntry = &currMap->typeList[x].resourceList[y];
+			currEntry->resourceAttributes &= ~resChanged;	// It's in the file now.
+			if( !currEntry->compressedInRAM )
+				currEntry->resourceAttributes &= ~resCompressed;	// We write what we decompressed.
+			FakePutUInt16BE( refData, (uint16_t)currMap->typeList[x].resourceIDs[y] );
+			refData[2] = currEntry->resourceAttributes;
+			if( currEntry->resourceName[0] == 0 )
+				FakePutUInt32BE( refData +4, 0xFFFFFFFF );	// Don't have a name, mark as -1.
+			else
+			{
+				FakePutUInt32BE( refData +4, (uint32_t)nameListCurrOffset );
+				memmove( mapData +nameListOffset +nameListCurrOffset, currEntry->resourceName, currEntry->resourceName[0] +1 );
+				nameListCurrOffset += currEntry->resourceName[0] +1;
+			}
+			FakePutUInt64BE( refData +8, currEntry->dataOffset -kResDataOffset );
+			refData += FAKE_EXTENDED_REF_ENTRY_LENGTH;
+		}
+	}
+	
+	// Map right after the data, then the header that says where it all is:
+	uint64_t	resMapOffset = kResDataOffset +inLayout->dataLength;
+	fwrite( mapData, 1, resMapLength, theFile );
+	free( mapData );
+	
+	uint8_t		header[FAKE_EXTENDED_HEADER_LENGTH] = { 0 };	// First 16 bytes stay 0, so classic readers reject the file.
+	FakePutUInt32BE( header +16, FAKE_EXTENDED_MAGIC );
+	FakePutUInt16BE( header +20, FAKE_EXTENDED_VERSION );
+	FakePutUInt64BE( header +24, kResDataOffset );
+	FakePutUInt64BE( header +32, resMapOffset );
+	FakePutUInt64BE( header +40, inLayout->dataLength );
+	FakePutUInt64BE( header +48, resMapLength );
+	FakeFSeek( theFile, 0, SEEK_SET );
+	fwrite( header, 1, sizeof(header), theFile );
+	for( size_t x = sizeof(header); x < kResDataOffset; x += sizeof(uint32_t) )
+		FakeFWriteUInt32BE( 0, theFile );	// Reserved and application data.
+	if( FAKE_TRACE_EVENTS_ON() )
+		FakeTraceSavePhase( inFileRefNum, "map", ioPhaseStartTime );
+	
+	*outFileLength = resMapOffset +resMapLength;
+	return noErr;
+}
+
+
+// Writes the map and all resource data, laid out as in inLayout, in the classic
+//	format. Offsets that don't fit are cut off, so call FakeCheckResourceMapFitsFormat() first.
+static int16_t	FakeWriteClassicResourceFile( struct FakeResourceMap* currMap, const struct FakeResDataLayout* inLayout, int16_t inFileRefNum, double* ioPhaseStartTime, uint64_t* outFileLength )
+{
+	const long kResourceHeaderLength            = 16;
+	const long kResourceHeaderMapOffsetPos      = 4;
+	const long kResourceHeaderMapLengthPos      = 4 + 4 + 4;
+	const long kResourceHeaderReservedLength    = 112;
+	const long kResourceHeaderAppReservedLength = 128;
+	const long kReservedHeaderLength            = kResourceHeaderReservedLength + kResourceHeaderAppReservedLength;
+	const long kResourceMapNextHandleLength     = 4;
+	const long kResourceMapFileRefLength        = 2;
+	const long kResourceMapTypeListOffsetLength = 2;
+	const long kResourceMapNameListOffsetLength = 2;
+	const long kResourceMapNumTypesLength       = 2;
+	const long kResourceRefLength               = 2 + 2 + 1 + 3 + 4;
+	const long kResourceTypeLength              = 4 + 2 + 2;
+
+	long						headerLength = kResourceHeaderLength + kReservedHeaderLength;
 	uint32_t					resMapOffset = 0;
 	long						refListSize = 0;
 	
-	if (!currMap->dirty)
-		return;
-
 	// Write header:
 	FakeFSeek( currMap->fileDescriptor, 0, SEEK_SET );
 	uint32_t    resDataOffset = (uint32_t)headerLength;
@@ -553,22 +3562,14 @@ void	FakeUpdateResFile( int16_t inFileRefNum )
 	for( int x = 0; x < (kResourceHeaderAppReservedLength / sizeof(uint32_t)); x++ )
 		FakeFWriteUInt32BE( 0, currMap->fileDescriptor );
 	
-	resMapOffset = (uint32_t)headerLength;
-	
 	// Write out data for each resource and calculate space needed:
+	FakeWriteResourceData( currMap->fileDescriptor, inLayout );
+	resMapOffset = (uint32_t)(headerLength +inLayout->dataLength);
 	for( int x = 0; x < currMap->numTypes; x++ )
-	{
-		for( int y = 0; y < currMap->typeList[x].numberOfResourcesOfType; y++ )
-		{
-			uint32_t	theSize = (uint32_t)FakeGetHandleSize( currMap->typeList[x].resourceList[y].resourceHandle );
-			FakeFWriteUInt32BE( theSize, currMap->fileDescriptor );
-			resMapOffset += sizeof(theSize);
-			fwrite( *currMap->typeList[x].resourceList[y].resourceHandle, 1, theSize, currMap->fileDescriptor );
-			resMapOffset += theSize;
-		}
-
 		refListSize += currMap->typeList[x].numberOfResourcesOfType * kResourceRefLength;
-	}
+	
+	if( FAKE_TRACE_EVENTS_ON() )
+		FakeTraceSavePhase( inFileRefNum, "data", ioPhaseStartTime );
 	
 	// Write out what we know into the header now:
 	FakeFSeek( currMap->fileDescriptor, kResourceHeaderMapOffsetPos, SEEK_SET );
@@ -605,14 +3606,14 @@ void	FakeUpdateResFile( int16_t inFileRefNum )
 	// Now write type list and ref lists:
 	uint32_t		nameListStartOffset = 0;
 	FakeFWriteUInt16BE( currMap->numTypes -1, currMap->fileDescriptor );
-	uint32_t		resDataCurrOffset = 0;		// Keep track of where we wrote the associated data for each resource, relative to the start of resource data
+	resMapLength = typeListOffset +kResourceMapNumTypesLength +currMap->numTypes * kResourceTypeLength;	// Even a map without types has its count.
 	
 	refListStartPosition = kResourceMapNumTypesLength + currMap->numTypes * kResourceTypeLength; // relative to beginning of resource type list
 
 	for( int x = 0; x < currMap->numTypes; x++ )
 	{
 		// Write entry for this type:
-		uint32_t	currType = currMap->typeList[x].resourceType;
+		uint32_t	currType = currMap->typeCodes[x];
 		FakeFWriteUInt32BE( currType, currMap->fileDescriptor );
 		
 		uint16_t	numResources = currMap->typeList[x].numberOfResourcesOfType -1;
@@ -628,7 +3629,7 @@ void	FakeUpdateResFile( int16_t inFileRefNum )
 
 		for( int y = 0; y < currMap->typeList[x].numberOfResourcesOfType; y++ )
 		{
-			FakeFWriteInt16BE( currMap->typeList[x].resourceList[y].resourceID, currMap->fileDescriptor );
+			FakeFWriteInt16BE( currMap->typeList[x].resourceIDs[y], currMap->fileDescriptor );
 			
 			// Write name to name table:
 			if( currMap->typeList[x].resourceList[y].resourceName[0] == 0 )
@@ -649,10 +3650,13 @@ void	FakeUpdateResFile( int16_t inFileRefNum )
 				nameListStartOffset += currMap->typeList[x].resourceList[y].resourceName[0] +1;	// Make sure we write next name *after* this one.
 			}
 			
+			currMap->typeList[x].resourceList[y].resourceAttributes &= ~resChanged;	// It's in the file now.
+			if( !currMap->typeList[x].resourceList[y].compressedInRAM )
+				currMap->typeList[x].resourceList[y].resourceAttributes &= ~resCompressed;	// We write what we decompressed.
 			fwrite( &currMap->typeList[x].resourceList[y].resourceAttributes, 1, sizeof(uint8_t), currMap->fileDescriptor );
+			uint32_t	resDataCurrOffset = (uint32_t)(currMap->typeList[x].resourceList[y].dataOffset -resDataOffset);	// Where FakeWriteResourceData() put it, relative to the start of resource data.
 			uint32_t	resDataCurrOffsetBE = BIG_ENDIAN_32(resDataCurrOffset);
 			fwrite( ((uint8_t*)&resDataCurrOffsetBE) +1, 1, 3, currMap->fileDescriptor );
-			resDataCurrOffset += kResourceDataSizeLength + FakeGetHandleSize(currMap->typeList[x].resourceList[y].resourceHandle);
 			FakeFWriteUInt32BE( 0, currMap->fileDescriptor );	// Handle placeholder.
 			
 			long	currMapLen = (ftell(currMap->fileDescriptor) -resMapOffset);
@@ -665,16 +3669,301 @@ void	FakeUpdateResFile( int16_t inFileRefNum )
 		// Jump back to after our type entry so we can write the next one:
 		FakeFSeek( currMap->fileDescriptor, oldOffsetAfterPrevType, SEEK_SET );
 	}
-
-	// Write res map length:
-	FakeFSeek( currMap->fileDescriptor, kResourceHeaderMapLengthPos, SEEK_SET );
-	FakeFWriteUInt32BE( resMapLength, currMap->fileDescriptor );
-    FakeFSeek( currMap->fileDescriptor, resMapOffset + kResourceHeaderMapLengthPos, SEEK_SET );
-    FakeFWriteUInt32BE( resMapLength, currMap->fileDescriptor );
+
+	// Write res map length:
+	FakeFSeek( currMap->fileDescriptor, kResourceHeaderMapLengthPos, SEEK_SET );
+	FakeFWriteUInt32BE( resMapLength, currMap->fileDescriptor );
+    FakeFSeek( currMap->fileDescriptor, resMapOffset + kResourceHeaderMapLengthPos, SEEK_SET );
+    FakeFWriteUInt32BE( resMapLength, currMap->fileDescriptor );
+	if( FAKE_TRACE_EVENTS_ON() )
+		FakeTraceSavePhase( inFileRefNum, "map", ioPhaseStartTime );
+	
+	*outFileLength = (uint64_t)resMapOffset +resMapLength;
+	return noErr;
+}
+
+
+// Writes the map and all resource data to the map's file. With inAtomically,
+//	they're written to a new file that then replaces the old one, so a crash
+//	can't leave a half-written file behind. inLayout says in which order to
+//	write the data (see FakeCompactResFile()), NULL for the order of the map.
+static void	FakeSaveResourceMap( struct FakeResourceMap* currMap, int16_t inFileRefNum, bool inAtomically, const struct FakeResCompactOptions* inLayout )
+{
+	if (!currMap->dirty)
+		return;
+	if( currMap->readOnly )
+	{
+		gFakeResError = wrPermErr;
+		return;
+	}
+	
+	bool		tracing = FAKE_TRACE_EVENTS_ON();
+	double		saveStartTime = tracing ? FakeTraceCurrentTime() : 0;
+	double		phaseStartTime = saveStartTime;
+	long		numSeeksBefore = gFakeNumSeeks;
+	FAKE_TRACE_EVENT( kFakeTraceSaveBegin, .refNum = inFileRefNum );
+	
+	FakeSettleResFetchesOfMap( currMap, false );	// Their offsets are about to change.
+	FakeCompactResourceMap( currMap );	// The file has no room for removed entries.
+	
+	// We're about to overwrite the file, so get everything we haven't read yet,
+	//	and make sure it stays in RAM until we've written it:
+	FakeResourceCacheSuspendEviction();
+	int16_t		loadErr = FakeLoadAllReferenceEntries( currMap );
+	if( loadErr != noErr )
+	{
+		FakeResourceCacheResumeEviction();
+		gFakeResError = (loadErr == memFulErr) ? memFulErr : eofErr;
+		FAKE_TRACE_EVENT( kFakeTraceSaveEnd, .refNum = inFileRefNum, .error = gFakeResError, .count = gFakeNumSeeks -numSeeksBefore,
+							.duration = FakeTraceCurrentTime() -saveStartTime );
+		return;
+	}
+	FakeStopResourcePrefetch( currMap );	// Everything's in RAM now, and it mustn't read while we write.
+	if( tracing )
+		FakeTraceSavePhase( inFileRefNum, "load", &phaseStartTime );
+	
+	struct FakeResDataLayout	layout = { 0 };
+	int16_t		err = FakeLayOutResourceData( currMap, inLayout, &layout );
+	if( err == noErr )
+		err = FakeCheckResourceMapFitsFormat( currMap, &layout );	// Before we touch the file, so it stays as it was.
+	if( err != noErr )
+	{
+		FakeDisposeResDataLayout( &layout );
+		if( err == mapReadErr )
+			FAKE_TRACE( kFakeTraceLevelError, "Resources of file %d don't fit in a %s resource file.", inFileRefNum,
+						currMap->extendedFormat ? "extended" : "classic" );
+		FakeResourceCacheResumeEviction();
+		gFakeResError = err;
+		FAKE_TRACE_EVENT( kFakeTraceSaveEnd, .refNum = inFileRefNum, .error = err, .count = gFakeNumSeeks -numSeeksBefore,
+							.duration = FakeTraceCurrentTime() -saveStartTime );
+		return;
+	}
+	
+	int			fd = FakeGetResMapFD( currMap );	// Everything's in RAM, but it may have been closed to stay under FakeSetResFileLimit().
+	if( fd < 0 )
+	{
+		FakeDisposeResDataLayout( &layout );
+		FakeResourceCacheResumeEviction();
+		gFakeResError = fnfErr;
+		FAKE_TRACE_EVENT( kFakeTraceSaveEnd, .refNum = inFileRefNum, .error = fnfErr, .count = gFakeNumSeeks -numSeeksBefore,
+							.duration = FakeTraceCurrentTime() -saveStartTime );
+		return;
+	}
+	
+	currMap->sharedDataMoved = (currMap->sharedResources != NULL);	// What was published stays where it is, the offsets we know change.
+	
+	FILE*		originalFile = NULL;	// The file we're replacing, if inAtomically.
+	char*		tempPath = NULL;
+	if( inAtomically && currMap->filePath )
+	{
+		FILE*	tempFile = FakeCreateFileNextTo( currMap->filePath, fd, &tempPath );
+		if( !tempFile )
+		{
+			FakeDisposeResDataLayout( &layout );
+			FakeResourceCacheResumeEviction();
+			gFakeResError = wrPermErr;
+			FAKE_TRACE_EVENT( kFakeTraceSaveEnd, .refNum = inFileRefNum, .error = wrPermErr, .count = gFakeNumSeeks -numSeeksBefore,
+								.duration = FakeTraceCurrentTime() -saveStartTime );
+			return;
+		}
+		originalFile = currMap->fileDescriptor;
+		currMap->fileDescriptor = tempFile;
+	}
+
+	uint64_t	fileLength = 0;
+	clearerr( currMap->fileDescriptor );	// So we only see errors of this save below.
+	if( currMap->extendedFormat )
+		err = FakeWriteExtendedResourceFile( currMap, &layout, inFileRefNum, &phaseStartTime, &fileLength );
+	else
+		err = FakeWriteClassicResourceFile( currMap, &layout, inFileRefNum, &phaseStartTime, &fileLength );
+	FakeDisposeResDataLayout( &layout );
+	if( err == noErr && (fflush( currMap->fileDescriptor ) != 0 || ferror( currMap->fileDescriptor )) )
+		err = ioErr;	// Disk full, or the file got larger than we may write.
+	if( err != noErr && !originalFile )	// Nothing to fall back on.
+	{
+		FakeResourceCacheResumeEviction();
+		gFakeResError = err;
+		FAKE_TRACE_EVENT( kFakeTraceSaveEnd, .refNum = inFileRefNum, .error = err, .count = gFakeNumSeeks -numSeeksBefore,
+							.duration = FakeTraceCurrentTime() -saveStartTime );
+		return;
+	}
+	
+	ftruncate(fileno(currMap->fileDescriptor), fileLength);
+	if( originalFile )
+	{
+		if( err != noErr || fsync( fileno( currMap->fileDescriptor ) ) != 0 || rename( tempPath, currMap->filePath ) != 0 )
+		{
+			fclose( currMap->fileDescriptor );
+			unlink( tempPath );
+			free( tempPath );
+			currMap->fileDescriptor = originalFile;
+			
+			// We just noted where everything is in the file that didn't make it, so keep it all in RAM until the next save:
+			for( int x = 0; x < currMap->numTypes; x++ )
+			{
+				for( int y = 0; y < currMap->typeList[x].numberOfResourcesOfType; y++ )
+				{
+					FakeResourceCacheRemove( currMap->typeList[x].resourceList[y].resourceHandle );
+					currMap->typeList[x].resourceList[y].dataExtent = 0;
+				}
+			}
+			FakeResourceCacheResumeEviction();
+			gFakeResError = (err != noErr) ? err : wrPermErr;
+			FAKE_TRACE_EVENT( kFakeTraceSaveEnd, .refNum = inFileRefNum, .error = gFakeResError, .count = gFakeNumSeeks -numSeeksBefore,
+								.duration = FakeTraceCurrentTime() -saveStartTime );
+			return;
+		}
+		fclose( originalFile );
+		free( tempPath );
+		if( currMap->reopenable )
+			FakeNoteResMapFileIdentity( currMap );	// So we open the new file if we have to close it.
+	}
+	if( tracing )
+		FakeTraceSavePhase( inFileRefNum, "flush", &phaseStartTime );
+	
+	currMap->dirty = false;
+	FakeCacheReferenceEntriesOfMap( currMap );	// Changed resources can now be read again, too.
+	FakeResourceCacheResumeEviction();
+	FAKE_TRACE_EVENT( kFakeTraceSaveEnd, .refNum = inFileRefNum, .byteCount = (int64_t)fileLength,
+						.count = gFakeNumSeeks -numSeeksBefore, .duration = FakeTraceCurrentTime() -saveStartTime );
+}
+
+
+void	FakeSetResFileFormat( int16_t inFileRefNum, enum FakeResFileFormat inFormat )
+{
+	struct FakeResourceMap*	theMap = FakeFindResourceMap( inFileRefNum, NULL );
+	if( !theMap )
+	{
+		gFakeResError = resFNotFound;
+		return;
+	}
+	gFakeResError = noErr;
+	bool	extendedFormat = (inFormat == kFakeResFileExtended);
+	if( theMap->extendedFormat != extendedFormat )
+	{
+		theMap->extendedFormat = extendedFormat;
+		theMap->dirty = true;	// So the next FakeUpdateResFile() converts it.
+	}
+}
+
+
+enum FakeResFileFormat	FakeGetResFileFormat( int16_t inFileRefNum )
+{
+	struct FakeResourceMap*	theMap = FakeFindResourceMap( inFileRefNum, NULL );
+	gFakeResError = theMap ? noErr : resFNotFound;
+	return (theMap && theMap->extendedFormat) ? kFakeResFileExtended : kFakeResFileClassic;
+}
+
+
+void	FakeUpdateResFile( int16_t inFileRefNum )
+{
+	struct FakeResourceMap*	theMap = FakeFindResourceMap( inFileRefNum, NULL );
+	if( !theMap )
+	{
+		gFakeResError = resFNotFound;
+		return;
+	}
+	gFakeResError = noErr;
+	FakeSaveResourceMap( theMap, inFileRefNum, false, NULL );	// Sets the error if it fails.
+}
+
+
+// Works out what reading the data of the cold resources (see
+//	FakeResCompactReport) takes, from the map's file as it is on disk now:
+static void	FakeMeasureColdReads( struct FakeResourceMap* inMap, uint64_t* outDataLength, uint64_t* outBytesRead, uint32_t* outNumReads )
+{
+	uint32_t						numProfileEntries = 0;
+	struct FakeProfileEntry*		profileEntries = FakeReadResourceProfile( inMap, &numProfileEntries );
+	size_t							numEntries = 0;
+	struct FakeReferenceListEntry**	entries = FakeCopyReferenceEntriesByOffset( inMap, &numEntries );
+	struct FakeReferenceListEntry**	coldEntries = malloc( (numProfileEntries +numEntries +1) * sizeof(struct FakeReferenceListEntry*) );
+	size_t							numColdEntries = 0;
+	int								fd = FakeGetResMapFD( inMap );
+	*outDataLength = 0;
+	*outBytesRead = 0;
+	*outNumReads = 0;
+	
+	if( entries && coldEntries )
+	{
+		for( uint32_t x = 0; x < numProfileEntries; x++ )
+		{
+			struct FakeReferenceListEntry*	theEntry = FakeFindReferenceListEntry( inMap, profileEntries[x].resType, profileEntries[x].resID );
+			if( theEntry )
+				coldEntries[numColdEntries++] = theEntry;
+		}
+		for( size_t x = 0; x < numEntries; x++ )
+		{
+			if( entries[x]->resourceAttributes & resPreload )
+				coldEntries[numColdEntries++] = entries[x];
+		}
+		qsort( coldEntries, numColdEntries, sizeof(struct FakeReferenceListEntry*), FakeCompareReferenceEntryOffsets );
+		
+		// Count each piece of data once, and the pages it's on, joining neighbouring pages into one read:
+		uint64_t	prevOffset = UINT64_MAX;
+		uint64_t	runFirstPage = 0, runLastPage = 0;
+		for( size_t x = 0; x < numColdEntries; x++ )
+		{
+			uint32_t	dataLength = 0;
+			if( coldEntries[x]->dataExtent == 0 || coldEntries[x]->dataOffset == prevOffset
+				|| pread( fd, &dataLength, sizeof(dataLength), coldEntries[x]->dataOffset ) != sizeof(dataLength) )
+				continue;	// Not in the file, or counted already.
+			prevOffset = coldEntries[x]->dataOffset;
+			uint64_t	length = sizeof(dataLength) +(uint64_t)BIG_ENDIAN_32(dataLength);
+			uint64_t	firstPage = coldEntries[x]->dataOffset / FAKE_COLD_READ_PAGE_SIZE;
+			uint64_t	lastPage = (coldEntries[x]->dataOffset +length -1) / FAKE_COLD_READ_PAGE_SIZE;
+			*outDataLength += length;
+			if( *outNumReads == 0 || firstPage > runLastPage +1 )
+			{
+				*outBytesRead += (*outNumReads == 0) ? 0 : (runLastPage -runFirstPage +1) * FAKE_COLD_READ_PAGE_SIZE;
+				(*outNumReads)++;
+				runFirstPage = firstPage;
+				runLastPage = lastPage;
+			}
+			else if( lastPage > runLastPage )
+				runLastPage = lastPage;
+		}
+		if( *outNumReads > 0 )
+			*outBytesRead += (runLastPage -runFirstPage +1) * FAKE_COLD_READ_PAGE_SIZE;
+	}
+	
+	free( coldEntries );
+	free( entries );
+	free( profileEntries );
+}
+
+
+void	FakeCompactResFile( int16_t inFileRefNum, const struct FakeResCompactOptions* inOptions, struct FakeResCompactReport* outReport )
+{
+	const struct FakeResCompactOptions	kDefaultOptions = { .useProfile = true };
+	struct FakeResourceMap*				theMap = FakeFindResourceMap( inFileRefNum, NULL );
+	struct FakeResCompactReport			report = { 0 };
+	struct stat							fileInfo;
+	if( !theMap )
+	{
+		gFakeResError = resFNotFound;
+		return;
+	}
+	if( theMap->readOnly )
+	{
+		gFakeResError = wrPermErr;
+		return;
+	}
 	
-	ftruncate(fileno(currMap->fileDescriptor), resMapOffset + resMapLength);
+	if( fstat( FakeGetResMapFD( theMap ), &fileInfo ) == 0 )
+		report.fileLengthBefore = (uint64_t)fileInfo.st_size;
+	FakeMeasureColdReads( theMap, &report.coldDataLength, &report.coldBytesReadBefore, &report.coldReadsBefore );
 	
-	currMap->dirty = false;
+	gFakeResError = noErr;
+	theMap->dirty = true;	// Even if nothing changed, the data may be in the wrong order or have gaps.
+	FakeSaveResourceMap( theMap, inFileRefNum, true, inOptions ? inOptions : &kDefaultOptions );	// Sets the error if it fails.
+	if( gFakeResError == noErr )
+	{
+		if( fstat( FakeGetResMapFD( theMap ), &fileInfo ) == 0 )
+			report.fileLengthAfter = (uint64_t)fileInfo.st_size;
+		FakeMeasureColdReads( theMap, &report.coldDataLength, &report.coldBytesReadAfter, &report.coldReadsAfter );
+	}
+	if( outReport )
+		*outReport = report;
 }
 
 
@@ -684,8 +3973,31 @@ void	FakeRedirectResFileToPath( int16_t inFileRefNum, const char* cPath )
 	struct FakeResourceMap*		currMap = FakeFindResourceMap( inFileRefNum, &prevMapPtr );
 	if( currMap )
 	{
-		fclose( currMap->fileDescriptor );
+		FakeSettleResFetchesOfMap( currMap, false );
+		
+		// The data will only be in RAM until the next FakeUpdateResFile(), so don't let the cache empty it:
+		FakeCompactResourceMap( currMap );
+		FakeResourceCacheSuspendEviction();
+		FakeLoadAllReferenceEntries( currMap );
+		for( int x = 0; x < currMap->numTypes; x++ )
+		{
+			for( int y = 0; y < currMap->typeList[x].numberOfResourcesOfType; y++ )
+			{
+				FakeResourceCacheRemove( currMap->typeList[x].resourceList[y].resourceHandle );
+				currMap->typeList[x].resourceList[y].dataExtent = 0;
+			}
+		}
+		FakeResourceCacheResumeEviction();
+		FakeStopResourcePrefetch( currMap );
+		FakeUnlinkOpenReopenableMap( currMap );
+		if( currMap->fileDescriptor )
+			fclose( currMap->fileDescriptor );
 		currMap->fileDescriptor = fopen( cPath, "w" );
+		currMap->reopenable = false;
+		free( currMap->filePath );
+		currMap->filePath = strdup( cPath );
+		currMap->readOnly = false;
+		currMap->readLimit = UINT64_MAX;
 		currMap->dirty = true;
 	}
 }
@@ -697,85 +4009,649 @@ void	FakeCloseResFile( int16_t inFileRefNum )
 	struct FakeResourceMap*		currMap = FakeFindResourceMap( inFileRefNum, &prevMapPtr );
 	if( currMap )
 	{
+		FakeSettleResFetchesOfMap( currMap, true );
+		if( currMap->transaction )	// Never committed, so it never happened.
+		{
+			FakeDisposeResTransaction( currMap->transaction );
+			currMap->transaction = NULL;
+		}
 		FakeUpdateResFile(inFileRefNum);
+		FakeStopResourcePrefetch( currMap );
+		if( currMap->profileUntil != 0 )
+			FakeSaveResourceProfile( currMap );
 		
 		*prevMapPtr = currMap->nextResourceMap;	// Remove this from the linked list.
+		if( currMap->nextResourceMap )
+			currMap->nextResourceMap->prevResourceMap = currMap->prevResourceMap;
+		FakeFreeFileRefNum( currMap->fileRefNum );
+		FakeForgetResMisses();
 		if( gCurrResourceMap == currMap )
 			gCurrResourceMap = currMap->nextResourceMap;
 		
 		for( int x = 0; x < currMap->numTypes; x++ )
 		{
-			FakeReleaseType( currMap->typeList[x].resourceType );
+			FakeReleaseType( currMap->typeCodes[x] );
 			
 			for( int y = 0; y < currMap->typeList[x].numberOfResourcesOfType; y++ )
 			{
+				if( !currMap->typeList[x].resourceList[y].resourceHandle )
+					continue;	// Removed.
+				FakeResourceCacheRemove( currMap->typeList[x].resourceList[y].resourceHandle );
 				FakeDisposeHandle( currMap->typeList[x].resourceList[y].resourceHandle );
 			}
 			free( currMap->typeList[x].resourceList );
+			free( currMap->typeList[x].resourceIDs );
+			FakeDisposeResIDIndex( currMap->typeList[x].idIndex );
 		}
 		free( currMap->typeList );
+		free( currMap->typeCodes );
+		FakeDisposeHandleIndex( currMap->handleIndex );
+		FakeDisposeResBloomFilter( currMap->bloomFilter );
+		free( currMap->sharedKey );
+		FakeDetachSharedResources( currMap->sharedResources );	// After the Handles that may point into it.
+		FakeDisposeSharedResCopies( currMap->sharedCopies );
 		
-		fclose( currMap->fileDescriptor );
+		FakeUnlinkOpenReopenableMap( currMap );
+		if( currMap->fileDescriptor )
+			fclose( currMap->fileDescriptor );
+		free( currMap->filePath );
 		free( currMap );
 	}
 }
 
 
-Handle	FakeGet1ResourceFromMap( uint32_t resType, int16_t resID, struct FakeResourceMap* inMap )
+static struct FakeReferenceListEntry*	FakeFindReferenceListEntry( struct FakeResourceMap* inMap, uint32_t resType, int16_t resID )
+{
+	struct FakeTypeListEntry*	typeEntry = FakeFindTypeListEntry( inMap, resType );
+	struct FakeResIDIndex*		idIndex = (typeEntry != NULL && typeEntry->numberOfResourcesOfType > FAKE_MIN_RESOURCES_FOR_ID_INDEX) ? FakeGetResIDIndex( inMap, typeEntry ) : NULL;
+	uint16_t					entryIndex = 0;
+	if( idIndex )
+		return FakeResIDIndexFind( idIndex, resID, &entryIndex ) ? &typeEntry->resourceList[entryIndex] : NULL;
+	else if( typeEntry != NULL )
+	{
+		size_t	numResources = typeEntry->numberOfResourcesOfType;
+		for( size_t y = FakeFindInt16Key( typeEntry->resourceIDs, numResources, resID ); y < numResources;
+				y += 1 +FakeFindInt16Key( typeEntry->resourceIDs +y +1, numResources -y -1, resID ) )
+		{
+			if( typeEntry->resourceList[y].resourceHandle )	// Not removed?
+				return &typeEntry->resourceList[y];
+		}
+	}
+	
+	return NULL;
+}
+
+
+// Finds a resource in the current file or the ones opened before it, like
+//	FakeGetResource(). Most files that don't have it are skipped without
+//	searching them thanks to their Bloom filter, and if none of them had it
+//	the last few times we were asked, we don't even look at the files.
+static struct FakeReferenceListEntry*	FakeFindReferenceListEntryInChain( uint32_t resType, int16_t resID, struct FakeResourceMap** outMap )
+{
+	struct FakeResMiss*	theMiss = gFakeResMisses +(((resType * 0x9E3779B1U) ^ (uint16_t)resID) & (FAKE_RES_MISS_CACHE_SIZE -1));
+	if( theMiss->generation == gFakeResMissGeneration && theMiss->resType == resType && theMiss->resID == resID )
+		return NULL;
+	
+	for( struct FakeResourceMap* currMap = gCurrResourceMap; currMap != NULL; currMap = currMap->nextResourceMap )
+	{
+		struct FakeResBloomFilter*	bloomFilter = FakeGetResBloomFilter( currMap );
+		if( bloomFilter && !FakeResBloomFilterMayContain( bloomFilter, resType, resID ) )
+			continue;
+		struct FakeReferenceListEntry*	theEntry = FakeFindReferenceListEntry( currMap, resType, resID );
+		if( theEntry != NULL )
+		{
+			*outMap = currMap;
+			return theEntry;
+		}
+	}
+	
+	theMiss->generation = gFakeResMissGeneration;
+	theMiss->resType = resType;
+	theMiss->resID = resID;
+	return NULL;
+}
+
+
+// Names compare like in the Toolbox, ignoring case but not diacritics:
+static struct FakeReferenceListEntry*	FakeFindNamedReferenceListEntry( struct FakeResourceMap* inMap, uint32_t resType, const unsigned char* name )
+{
+	struct FakeTypeListEntry*	typeEntry = FakeFindTypeListEntry( inMap, resType );
+	if( typeEntry == NULL )
+		return NULL;
+	
+	for( size_t y = 0; y < typeEntry->numberOfResourcesOfType; y++ )
+	{
+		struct FakeReferenceListEntry*	currEntry = &typeEntry->resourceList[y];
+		if( currEntry->resourceHandle && (uint8_t)currEntry->resourceName[0] == name[0]	// Most names differ in length.
+			&& FakeEqualString( (const unsigned char*)currEntry->resourceName, name, false, true ) )
+			return currEntry;
+	}
+	
+	return NULL;
+}
+
+
+// Hand out a resource's Handle, loading its data first unless FakeSetResLoad(false) was called:
+static Handle	FakeGetLoadedResourceHandle( struct FakeResourceMap* inMap, struct FakeReferenceListEntry* inEntry )
 {
 	gFakeResError = noErr;
+	FakeRecordResourceAccess( inMap, inEntry );
 	
-	if( inMap != NULL )
+	if( gFakeResLoad && FakeReferenceEntryNeedsLoad( inEntry ) && !FakeResourceCacheRestore( inEntry->resourceHandle ) )
 	{
-		for( int x = 0; x < inMap->numTypes; x++ )
+		FakeResourceCacheCountMiss();
+		gFakeResError = FakeLoadReferenceEntry( inMap, inEntry );
+		if( gFakeResError != noErr )
+			return NULL;
+	}
+	else if( gFakeResLoad )
+		FakeResourceCacheTouch( inEntry->resourceHandle );
+	if( inEntry->compressedInRAM && *inEntry->resourceHandle != NULL )
+		gFakeResError = CantDecompress;	// You get the data as it is in the file.
+	
+	return inEntry->resourceHandle;
+}
+
+
+Handle	FakeGet1ResourceFromMap( uint32_t resType, int16_t resID, struct FakeResourceMap* inMap )
+{
+	struct FakeReferenceListEntry*	theEntry = FakeFindReferenceListEntry( inMap, resType, resID );
+	if( theEntry != NULL )
+		return FakeGetLoadedResourceHandle( inMap, theEntry );
+	
+	gFakeResError = resNotFound;
+	
+	return NULL;
+}
+
+
+Handle	FakeGet1Resource( uint32_t resType, int16_t resID )
+{
+	return FakeGet1ResourceFromMap( resType, resID, gCurrResourceMap );
+}
+
+
+Handle	FakeGetResource( uint32_t resType, int16_t resID )
+{
+	struct FakeResourceMap *		currMap = NULL;
+	struct FakeReferenceListEntry*	theEntry = FakeFindReferenceListEntryInChain( resType, resID, &currMap );
+	if( theEntry != NULL )
+		return FakeGetLoadedResourceHandle( currMap, theEntry );
+	
+	gFakeResError = resNotFound;
+	
+	return NULL;
+}
+
+
+Handle	FakeGet1NamedResource( uint32_t resType, const unsigned char* name )
+{
+	struct FakeReferenceListEntry*	theEntry = FakeFindNamedReferenceListEntry( gCurrResourceMap, resType, name );
+	if( theEntry != NULL )
+		return FakeGetLoadedResourceHandle( gCurrResourceMap, theEntry );
+	
+	gFakeResError = resNotFound;
+	
+	return NULL;
+}
+
+
+Handle	FakeGetNamedResource( uint32_t resType, const unsigned char* name )
+{
+	for( struct FakeResourceMap* currMap = gCurrResourceMap; currMap != NULL; currMap = currMap->nextResourceMap )
+	{
+		struct FakeReferenceListEntry*	theEntry = FakeFindNamedReferenceListEntry( currMap, resType, name );
+		if( theEntry != NULL )
+			return FakeGetLoadedResourceHandle( currMap, theEntry );
+	}
+	
+	gFakeResError = resNotFound;
+	
+	return NULL;
+}
+
+
+struct FakeBatchLoad
+{
+	struct FakeResourceMap*			map;
+	struct FakeReferenceListEntry*	entry;
+	size_t							batchIndex;
+};
+
+
+static int	FakeCompareBatchLoads( const void* inA, const void* inB )
+{
+	const struct FakeBatchLoad*	a = inA;
+	const struct FakeBatchLoad*	b = inB;
+	if( a->map != b->map )
+		return (a->map < b->map) ? -1 : 1;
+	if( a->entry->dataOffset != b->entry->dataOffset )
+		return (a->entry->dataOffset < b->entry->dataOffset) ? -1 : 1;
+	return 0;
+}
+
+
+void	FakeGetResources( struct FakeResourceBatchEntry* ioEntries, size_t inCount )
+{
+	struct FakeBatchLoad*	loads = malloc( (inCount +1) * sizeof(struct FakeBatchLoad) );
+	size_t					numLoads = 0;
+	int16_t					firstErr = noErr;
+	
+	// Look up everything first and note which resources still need to be read:
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		struct FakeResourceMap *		currMap = NULL;
+		struct FakeReferenceListEntry*	theEntry = FakeFindReferenceListEntryInChain( ioEntries[x].resType, ioEntries[x].resID, &currMap );
+		
+		ioEntries[x].resHandle = NULL;
+		ioEntries[x].resError = resNotFound;
+		if( theEntry != NULL )
 		{
-			uint32_t		currType = inMap->typeList[x].resourceType;
-			if( currType == resType )
+			ioEntries[x].resHandle = theEntry->resourceHandle;
+			ioEntries[x].resError = noErr;
+			FakeRecordResourceAccess( currMap, theEntry );
+			if( gFakeResLoad && FakeReferenceEntryNeedsLoad( theEntry ) && !FakeResourceCacheRestore( theEntry->resourceHandle ) )
 			{
-				for( int y = 0; y < inMap->typeList[x].numberOfResourcesOfType; y++ )
-				{
-					if( inMap->typeList[x].resourceList[y].resourceID == resID )
-					{
-						return inMap->typeList[x].resourceList[y].resourceHandle;
-					}
-				}
-				break;
+				FakeResourceCacheCountMiss();
+				loads[numLoads].map = currMap;
+				loads[numLoads].entry = theEntry;
+				loads[numLoads].batchIndex = x;
+				numLoads++;
+			}
+			else if( gFakeResLoad )
+				FakeResourceCacheTouch( theEntry->resourceHandle );
+			if( theEntry->compressedInRAM && *theEntry->resourceHandle != NULL )
+				ioEntries[x].resError = CantDecompress;
+		}
+	}
+	
+	// Now read them in file order, one file at a time, so neighbours get read together.
+	//	Don't empty any until we've read all, so we don't throw out the ones we're returning:
+	qsort( loads, numLoads, sizeof(struct FakeBatchLoad), FakeCompareBatchLoads );
+	FakeResourceCacheSuspendEviction();
+	
+	struct FakeReferenceListEntry**	entries = malloc( (numLoads +1) * sizeof(struct FakeReferenceListEntry*) );
+	int16_t*						errors = malloc( (numLoads +1) * sizeof(int16_t) );
+	size_t							x = 0;
+	while( x < numLoads )
+	{
+		size_t	numInMap = 0;
+		while( (x +numInMap) < numLoads && loads[x +numInMap].map == loads[x].map )
+		{
+			entries[numInMap] = loads[x +numInMap].entry;
+			numInMap++;
+		}
+		
+		FakeLoadReferenceEntries( loads[x].map, entries, errors, numInMap );
+		
+		for( size_t y = 0; y < numInMap; y++ )
+		{
+			if( errors[y] != noErr )
+			{
+				ioEntries[loads[x +y].batchIndex].resHandle = NULL;
+				ioEntries[loads[x +y].batchIndex].resError = errors[y];
 			}
+			else if( entries[y]->compressedInRAM )
+				ioEntries[loads[x +y].batchIndex].resError = CantDecompress;
+		}
+		x += numInMap;
+	}
+	FakeResourceCacheResumeEviction();
+	
+	for( x = 0; x < inCount && firstErr == noErr; x++ )
+		firstErr = ioEntries[x].resError;
+	gFakeResError = firstErr;
+	
+	free( errors );
+	free( entries );
+	free( loads );
+}
+
+
+static struct FakeAsyncIO*	FakeGetResFetchIO( void )
+{
+	if( !gFakeResFetchIO )
+		gFakeResFetchIO = FakeAsyncIOCreate( gFakeResFetchIOUring );
+	return gFakeResFetchIO;
+}
+
+
+// Returns the index of a new fetch, or FAKE_NO_RES_FETCH if we're out of memory:
+static size_t	FakeNewResFetch( FakeResFetchProc inProc, void* inRefCon )
+{
+	if( gFirstFreeResFetch == FAKE_NO_RES_FETCH )
+	{
+		size_t					newMax = gMaxResFetches ? (gMaxResFetches * 2) : 64;
+		struct FakeResFetch*	newFetches = realloc( gFakeResFetches, newMax * sizeof(struct FakeResFetch) );
+		if( !newFetches )
+			return FAKE_NO_RES_FETCH;
+		gFakeResFetches = newFetches;
+		for( size_t x = newMax; x-- > gMaxResFetches; )
+		{
+			gFakeResFetches[x].inUse = false;
+			gFakeResFetches[x].next = gFirstFreeResFetch;
+			gFirstFreeResFetch = x;
+		}
+		gMaxResFetches = newMax;
+	}
+	
+	size_t					theSlot = gFirstFreeResFetch;
+	struct FakeResFetch*	theFetch = gFakeResFetches +theSlot;
+	gFirstFreeResFetch = theFetch->next;
+	memset( theFetch, 0, sizeof(struct FakeResFetch) );
+	theFetch->proc = inProc;
+	theFetch->refCon = inRefCon;
+	theFetch->inUse = true;
+	theFetch->next = FAKE_NO_RES_FETCH;
+	gNumResFetches++;
+	
+	return theSlot;
+}
+
+
+// No more reading to do for this one, queue it up for its proc to be called:
+static void	FakeQueueDoneResFetch( size_t inSlot )
+{
+	bool	wasEmpty = (gFirstDoneResFetch == FAKE_NO_RES_FETCH);
+	gFakeResFetches[inSlot].next = FAKE_NO_RES_FETCH;
+	if( wasEmpty )
+		gFirstDoneResFetch = inSlot;
+	else
+		gFakeResFetches[gLastDoneResFetch].next = inSlot;
+	gLastDoneResFetch = inSlot;
+	
+	if( wasEmpty && !gCompletingResFetches )
+		FakeAsyncIOWakeUp( gFakeResFetchIO );	// E.g. nothing to read, then the kernel wouldn't tell the poller.
+}
+
+
+// Start reading the rest of a fetch's data, inTotalLength bytes in all:
+static bool	FakeReadMoreOfResFetch( size_t inSlot, uint32_t inTotalLength )
+{
+	struct FakeResFetch*	theFetch = gFakeResFetches +inSlot;
+	if( inTotalLength > theFetch->dataSize )
+	{
+		char*	newData = realloc( theFetch->data, inTotalLength );
+		if( !newData )
+			return false;
+		theFetch->data = newData;
+		theFetch->dataSize = inTotalLength;
+	}
+	int		fd = FakeGetResMapFD( theFetch->map );
+	if( fd < 0 || !FakeAsyncIOQueueRead( gFakeResFetchIO, fd, theFetch->data +theFetch->amountRead,
+								inTotalLength -theFetch->amountRead, (uint64_t)theFetch->dataOffset +theFetch->amountRead, inSlot ) )
+		return false;
+	theFetch->reading = true;
+	theFetch->map->numFetchReads++;
+	FakeAsyncIOSubmit( gFakeResFetchIO );
+	return true;
+}
+
+
+// One of our reads finished. Usually the first one got the whole extent, i.e.
+//	data length and data. If the length says there's more, read that too:
+static void	FakeContinueResFetch( size_t inSlot, int64_t inResult )
+{
+	struct FakeResFetch*	theFetch = gFakeResFetches +inSlot;
+	theFetch->reading = false;
+	theFetch->map->numFetchReads--;
+	if( inResult < 0 )
+	{
+		FAKE_TRACE( kFakeTraceLevelError, "Reading resource at %llu failed (%lld).", (unsigned long long)theFetch->dataOffset, (long long)inResult );
+		theFetch->error = eofErr;
+	}
+	else
+	{
+		FAKE_TRACE_EVENT( kFakeTraceBytesRead, .offset = theFetch->dataOffset +theFetch->amountRead, .byteCount = inResult );
+		theFetch->amountRead += (uint32_t)inResult;
+		
+		uint64_t	wantedLength = theFetch->dataSize;
+		if( theFetch->amountRead >= sizeof(uint32_t) )
+		{
+			uint32_t	dataLength = 0;
+			memmove( &dataLength, theFetch->data, sizeof(dataLength) );
+			wantedLength = sizeof(dataLength) +(uint64_t)BIG_ENDIAN_32(dataLength);
+		}
+		if( theFetch->amountRead < wantedLength && theFetch->resourceHandle != NULL )
+		{
+			if( inResult == 0 || ((uint64_t)theFetch->dataOffset +wantedLength) > theFetch->map->readLimit )
+				theFetch->error = eofErr;
+			else if( !FakeReadMoreOfResFetch( inSlot, (uint32_t)wantedLength ) )
+				theFetch->error = memFulErr;
+			else
+				return;
+		}
+	}
+	
+	if( theFetch->error != noErr )
+	{
+		free( theFetch->data );
+		theFetch->data = NULL;
+	}
+	FakeQueueDoneResFetch( inSlot );
+}
+
+
+static void	FakeReapResFetches( bool inWait )
+{
+	struct FakeAsyncCompletion	completions[64];
+	size_t						numReaped = 0;
+	do
+	{
+		numReaped = FakeAsyncIOReap( gFakeResFetchIO, completions, sizeof(completions) / sizeof(completions[0]), inWait );
+		for( size_t x = 0; x < numReaped; x++ )
+			FakeContinueResFetch( (size_t)completions[x].userData, completions[x].result );
+		inWait = false;
+	}
+	while( numReaped == sizeof(completions) / sizeof(completions[0]) );
+}
+
+
+// Waits for the reads of fetches from the given file, and forgets what they
+//	read, as the file is about to change. FakeCompleteResFetches() loads those
+//	resources again if it needs to. If inClosing, they fail with resFNotFound:
+static void	FakeSettleResFetchesOfMap( struct FakeResourceMap* inMap, bool inClosing )
+{
+	if( gNumResFetches == 0 )
+		return;
+	
+	bool	stillReading = true;
+	while( stillReading )
+	{
+		stillReading = false;
+		for( size_t x = 0; x < gMaxResFetches && !stillReading; x++ )
+			stillReading = gFakeResFetches[x].inUse && gFakeResFetches[x].reading && gFakeResFetches[x].map == inMap;
+		if( stillReading )
+			FakeReapResFetches( true );
+	}
+	
+	for( size_t x = 0; x < gMaxResFetches; x++ )
+	{
+		struct FakeResFetch*	currFetch = gFakeResFetches +x;
+		if( !currFetch->inUse || currFetch->map != inMap )
+			continue;
+		free( currFetch->data );
+		currFetch->data = NULL;
+		if( inClosing )
+		{
+			currFetch->resourceHandle = NULL;
+			currFetch->map = NULL;
+			if( currFetch->error == noErr )
+				currFetch->error = resFNotFound;
+		}
+	}
+}
+
+
+// A resource was removed from its file, so the caller owns its Handle now and
+//	we mustn't touch it anymore:
+static void	FakeForgetResFetchesOfHandle( Handle inResource )
+{
+	if( gNumResFetches == 0 )
+		return;
+	
+	for( size_t x = 0; x < gMaxResFetches; x++ )
+	{
+		struct FakeResFetch*	currFetch = gFakeResFetches +x;
+		if( currFetch->inUse && currFetch->resourceHandle == inResource )
+		{
+			currFetch->resourceHandle = NULL;
+			if( currFetch->error == noErr )
+				currFetch->error = resNotFound;
+		}
+	}
+}
+
+
+// Puts what a fetch read into its resource's Handle, unless something else
+//	loaded it meanwhile. Returns the Handle to give its proc, or NULL:
+static Handle	FakeFinishResFetch( struct FakeResFetch* inFetch )
+{
+	struct FakeResourceMap*			theMap = NULL;
+	struct FakeReferenceListEntry*	theEntry = NULL;
+	if( inFetch->error != noErr )
+		return NULL;
+	if( !inFetch->resourceHandle || !FakeFindResourceHandle( inFetch->resourceHandle, &theMap, NULL, &theEntry ) )
+	{
+		inFetch->error = resNotFound;
+		return NULL;
+	}
+	
+	if( FakeReferenceEntryNeedsLoad( theEntry ) )
+	{
+		if( inFetch->data )
+		{
+			uint32_t	dataLength = 0;
+			memmove( &dataLength, inFetch->data, sizeof(dataLength) );
+			dataLength = BIG_ENDIAN_32(dataLength);
+			memmove( inFetch->data, inFetch->data +sizeof(dataLength), dataLength );
+			char*		shrunkData = realloc( inFetch->data, dataLength ? dataLength : 1 );
+			FakeAdoptHandleMemory( theEntry->resourceHandle, shrunkData ? shrunkData : inFetch->data, dataLength );
+			inFetch->data = NULL;
+			FakeFinishLoadingReferenceEntry( theEntry, noErr );
+			FAKE_TRACE_EVENT( kFakeTraceResourceLoaded, .resID = theEntry->resourceID, .offset = theEntry->dataOffset, .byteCount = dataLength );
+			FakeCacheReferenceEntries( &theEntry, 1 );
+		}
+		else	// Emptied again, or its file changed while we were reading it.
+		{
+			inFetch->error = FakeLoadReferenceEntry( theMap, theEntry );
+			if( inFetch->error != noErr )
+				return NULL;
 		}
 	}
+	if( theEntry->compressedInRAM && *theEntry->resourceHandle != NULL )
+		inFetch->error = CantDecompress;
+	
+	return inFetch->resourceHandle;
+}
+
+
+void	FakeStartResFetch( uint32_t resType, int16_t resID, FakeResFetchProc inProc, void* inRefCon )
+{
+	size_t	theSlot = FakeGetResFetchIO() ? FakeNewResFetch( inProc, inRefCon ) : FAKE_NO_RES_FETCH;
+	if( theSlot == FAKE_NO_RES_FETCH )
+	{
+		gFakeResError = memFulErr;
+		return;
+	}
+	gFakeResError = noErr;
+	
+	struct FakeResFetch*			theFetch = gFakeResFetches +theSlot;
+	struct FakeResourceMap*			currMap = NULL;
+	struct FakeReferenceListEntry*	theEntry = FakeFindReferenceListEntryInChain( resType, resID, &currMap );
+	if( !theEntry )
+	{
+		theFetch->error = resNotFound;
+		FakeQueueDoneResFetch( theSlot );
+		return;
+	}
+	theFetch->resourceHandle = theEntry->resourceHandle;
+	theFetch->map = currMap;
+	FakeRecordResourceAccess( currMap, theEntry );
+	
+	FakeClaimSharedEntries( currMap, &theEntry, 1 );
+	if( currMap->prefetchJob && theEntry->prefetchSlot != 0 )
+		FakeClaimPrefetchedEntries( currMap, &theEntry, 1 );
+	if( !FakeReferenceEntryNeedsLoad( theEntry ) || FakeResourceCacheRestore( theEntry->resourceHandle ) )
+	{
+		FakeResourceCacheTouch( theEntry->resourceHandle );
+		FakeQueueDoneResFetch( theSlot );
+		return;
+	}
+	
+	FakeResourceCacheCountMiss();
+	theFetch->dataOffset = theEntry->dataOffset;
+	uint32_t	readLength = theEntry->dataExtent;
+	if( ((uint64_t)theEntry->dataOffset +readLength) > currMap->readLimit )
+		readLength = (theEntry->dataOffset < currMap->readLimit) ? (uint32_t)(currMap->readLimit -theEntry->dataOffset) : 0;
+	if( readLength < sizeof(uint32_t) )
+		theFetch->error = eofErr;
+	else if( !FakeReadMoreOfResFetch( theSlot, readLength ) )
+		theFetch->error = memFulErr;
+	if( theFetch->error != noErr )
+	{
+		free( theFetch->data );
+		theFetch->data = NULL;
+		FakeQueueDoneResFetch( theSlot );
+	}
+}
+
+
+size_t	FakeCompleteResFetches( bool inWait )
+{
+	gFakeResError = noErr;
+	if( gNumResFetches == 0 )
+		return 0;
+	
+	gCompletingResFetches = true;
+	FakeReapResFetches( inWait && gFirstDoneResFetch == FAKE_NO_RES_FETCH );
+	
+	// Only those done now, so a proc that starts a fetch that's done right away doesn't keep us here:
+	size_t	numDone = 0;
+	for( size_t x = gFirstDoneResFetch; x != FAKE_NO_RES_FETCH; x = gFakeResFetches[x].next )
+		numDone++;
+	for( size_t x = 0; x < numDone; x++ )
+	{
+		size_t					theSlot = gFirstDoneResFetch;
+		struct FakeResFetch*	theFetch = gFakeResFetches +theSlot;
+		gFirstDoneResFetch = theFetch->next;
+		if( gFirstDoneResFetch == FAKE_NO_RES_FETCH )
+			gLastDoneResFetch = FAKE_NO_RES_FETCH;
+		
+		FakeResourceCacheSuspendEviction();	// Keep the data at least while the proc runs.
+		Handle				theResource = FakeFinishResFetch( theFetch );
+		int16_t				theError = theFetch->error;
+		FakeResFetchProc	theProc = theFetch->proc;
+		void*				theRefCon = theFetch->refCon;
+		free( theFetch->data );
+		theFetch->inUse = false;
+		theFetch->next = gFirstFreeResFetch;
+		gFirstFreeResFetch = theSlot;
+		gNumResFetches--;
+		
+		theProc( theResource, theError, theRefCon );
+		FakeResourceCacheResumeEviction();
+	}
+	gCompletingResFetches = false;
 	
-	gFakeResError = resNotFound;
+	if( gFirstDoneResFetch != FAKE_NO_RES_FETCH )	// Procs started some that were done right away.
+		FakeAsyncIOWakeUp( gFakeResFetchIO );
+	gFakeResError = noErr;
 	
-	return NULL;
+	return numDone;
 }
 
 
-Handle	FakeGet1Resource( uint32_t resType, int16_t resID )
+size_t	FakeCountResFetches( void )
 {
-	return FakeGet1ResourceFromMap( resType, resID, gCurrResourceMap );
+	return gNumResFetches;
 }
 
 
-Handle	FakeGetResource( uint32_t resType, int16_t resID )
+int	FakeResFetchFD( void )
 {
-	struct FakeResourceMap *	currMap = gCurrResourceMap;
-	Handle						theRes = NULL;
-	
-	while( theRes == NULL && currMap != NULL )
-	{
-		theRes = FakeGet1ResourceFromMap( resType, resID, currMap );
-		if( theRes != NULL )
-		{
-			gFakeResError = noErr;
-			return theRes;
-		}
-		
-		currMap	= currMap->nextResourceMap;
-	}
-	
-	gFakeResError = resNotFound;
-	
-	return NULL;
+	struct FakeAsyncIO*	theIO = FakeGetResFetchIO();
+	return theIO ? FakeAsyncIOPollFD( theIO ) : -1;
 }
 
 
@@ -783,14 +4659,11 @@ int16_t	FakeCount1ResourcesInMap( uint32_t resType, struct FakeResourceMap* inMa
 {
 	gFakeResError = noErr;
 	
-	if( inMap != NULL )
+	struct FakeTypeListEntry*	typeEntry = FakeFindTypeListEntry( inMap, resType );
+	if( typeEntry != NULL )
 	{
-		for( int x = 0; x < inMap->numTypes; x++ )
-		{
-			uint32_t		currType = inMap->typeList[x].resourceType;
-			if( currType == resType )
-				return inMap->typeList[x].numberOfResourcesOfType;
-		}
+		int		numRes = typeEntry->numberOfResourcesOfType -typeEntry->numRemovedResources;
+		return (numRes > INT16_MAX) ? INT16_MAX : (int16_t)numRes;	// Extended files can have more.
 	}
 	
 	return 0;
@@ -820,7 +4693,7 @@ int16_t	FakeCount1Resources( uint32_t resType )
 
 int16_t	FakeCountResources( uint32_t resType )
 {
-	int16_t						numRes = 0;
+	int32_t						numRes = 0;
 	struct FakeResourceMap* 	theMap = gCurrResourceMap;
 	
 	while( theMap )
@@ -830,7 +4703,100 @@ int16_t	FakeCountResources( uint32_t resType )
 		theMap = theMap->nextResourceMap;
 	}
 	
-	return numRes;
+	return (numRes > INT16_MAX) ? INT16_MAX : (int16_t)numRes;
+}
+
+
+// Finds an ID of the given type that no resource in inFirstMap (and if
+//	inAllMaps is true, the maps after it) has, nor is staged to have:
+static int16_t	FakeUniqueIDInMaps( uint32_t resType, struct FakeResourceMap* inFirstMap, bool inAllMaps )
+{
+	size_t	numMaps = 0;
+	for( struct FakeResourceMap* currMap = inFirstMap; currMap != NULL && (inAllMaps || numMaps == 0); currMap = currMap->nextResourceMap )
+		numMaps++;
+	
+	struct FakeResIDIndex**	indexes = calloc( numMaps +1, sizeof(struct FakeResIDIndex*) );
+	bool*					ownIndexes = calloc( numMaps +1, sizeof(bool) );
+	struct FakeResIDIndex*	firstIndex = NULL;	// Remembers where to look next time.
+	size_t					numIndexes = 0;
+	gFakeResError = (indexes && ownIndexes) ? noErr : memFulErr;
+	for( struct FakeResourceMap* currMap = inFirstMap; gFakeResError == noErr && numIndexes < numMaps; currMap = currMap->nextResourceMap )
+	{
+		struct FakeTypeListEntry*	typeEntry = FakeFindTypeListEntry( currMap, resType );
+		if( typeEntry )
+		{
+			indexes[numIndexes] = FakeGetResIDIndex( currMap, typeEntry );
+			if( !firstIndex )
+				firstIndex = indexes[numIndexes];
+		}
+		else if( currMap->transaction )	// It may only be staged. Not worth keeping.
+		{
+			indexes[numIndexes] = FakeNewResIDIndex( 0 );
+			ownIndexes[numIndexes] = true;
+			for( size_t x = 0; indexes[numIndexes] && x < currMap->transaction->numEdits; x++ )
+			{
+				if( currMap->transaction->edits[x].kind == kFakeResEditAdd && currMap->transaction->edits[x].resourceType == resType )
+					FakeResIDIndexMarkUsed( indexes[numIndexes], currMap->transaction->edits[x].resourceID );
+			}
+		}
+		if( !indexes[numIndexes] && (typeEntry || currMap->transaction) )
+			gFakeResError = memFulErr;
+		numIndexes++;
+	}
+	
+	// IDs below 128 are reserved for the system, so only hand those out if we have to:
+	int16_t		uniqueID = 0;
+	if( gFakeResError == noErr
+		&& !FakeFindUnusedResID( indexes, numIndexes, 128, INT16_MAX, firstIndex ? FakeResIDIndexGetSearchStart( firstIndex, 128 ) : 128, &uniqueID )
+		&& !FakeFindUnusedResID( indexes, numIndexes, 1, 127, 1, &uniqueID ) )
+		gFakeResError = addResFailed;	// Every ID is taken.
+	if( gFakeResError == noErr && firstIndex )
+		FakeResIDIndexSetSearchStart( firstIndex, uniqueID );	// Until it's used, this is the one to return again.
+	
+	for( size_t x = 0; x < numIndexes; x++ )
+	{
+		if( ownIndexes[x] )
+			FakeDisposeResIDIndex( indexes[x] );
+	}
+	free( indexes );
+	free( ownIndexes );
+	
+	return (gFakeResError == noErr) ? uniqueID : 0;
+}
+
+
+int16_t	FakeUniqueID( uint32_t resType )
+{
+	return FakeUniqueIDInMaps( resType, gCurrResourceMap, true );
+}
+
+
+int16_t	FakeUnique1ID( uint32_t resType )
+{
+	return FakeUniqueIDInMaps( resType, gCurrResourceMap, false );
+}
+
+
+size_t	FakeGet1ResourceIDsInRange( uint32_t resType, int16_t inFirstID, int16_t inLastID, int16_t* outIDs, size_t inMaxCount )
+{
+	struct FakeTypeListEntry*	typeEntry = FakeFindTypeListEntry( gCurrResourceMap, resType );
+	struct FakeResIDIndex*		idIndex = typeEntry ? FakeGetResIDIndex( gCurrResourceMap, typeEntry ) : NULL;
+	gFakeResError = (typeEntry && !idIndex) ? memFulErr : noErr;
+	if( !idIndex || inFirstID > inLastID )
+		return 0;
+	
+	uint16_t*	entryIndexes = malloc( (inMaxCount +1) * sizeof(uint16_t) );
+	if( !entryIndexes )
+	{
+		gFakeResError = memFulErr;
+		return 0;
+	}
+	size_t		numFound = FakeResIDIndexCopyRange( idIndex, inFirstID, inLastID, entryIndexes, inMaxCount );
+	for( size_t x = 0; x < numFound && x < inMaxCount; x++ )
+		outIDs[x] = typeEntry->resourceList[entryIndexes[x]].resourceID;
+	free( entryIndexes );
+	
+	return numFound;
 }
 
 
@@ -856,6 +4822,8 @@ void	FakeUseResFile( int16_t resRefNum )
 	if( !currMap )
 		currMap = gResourceMap;
 	
+	if( gCurrResourceMap != currMap )
+		FakeForgetResMisses();
 	gCurrResourceMap = currMap;
 }
 
@@ -874,7 +4842,7 @@ void FakeGet1IndType( uint32_t * resType, int16_t index )
 		return;
 	}
 
-	*resType = currMap->typeList[index-1].resourceType;
+	*resType = currMap->typeCodes[index-1];
 	
 	gFakeResError = noErr;
 }
@@ -886,16 +4854,14 @@ Handle FakeGet1IndResource( uint32_t resType, int16_t index )
 	if( !currMap || (index <= 0) || (index > FakeCount1Resources(resType)))
 	{
 		gFakeResError = resNotFound;
+		return NULL;
 	}
 
-	for( int x = 0; x < currMap->numTypes; x++ )
+	struct FakeTypeListEntry*	typeEntry = FakeFindTypeListEntry( currMap, resType );
+	if( typeEntry != NULL )
 	{
-		uint32_t		currType = currMap->typeList[x].resourceType;
-		if( currType == resType )
-		{
-			gFakeResError = noErr;
-			return currMap->typeList[x].resourceList[index-1].resourceHandle;
-		}
+		FakeCompactTypeListEntry( currMap, typeEntry -currMap->typeList );	// So the index is the position in the list.
+		return FakeGetLoadedResourceHandle( currMap, &typeEntry->resourceList[index-1] );
 	}
 	
 	gFakeResError = resNotFound;
@@ -905,29 +4871,52 @@ Handle FakeGet1IndResource( uint32_t resType, int16_t index )
 
 void FakeGetResInfo( Handle theResource, int16_t * theID, uint32_t * theType, FakeStr255 name )
 {
+	struct FakeResourceMap* theMap = NULL;
 	struct FakeTypeListEntry*   typeEntry = NULL;
 	struct FakeReferenceListEntry* refEntry = NULL;
+	struct FakeResEdit* stagedEdit = NULL;
 
 
-	if( FakeFindResourceHandle(theResource, NULL, &typeEntry, &refEntry) )
+	if( FakeFindResourceHandle(theResource, &theMap, &typeEntry, &refEntry) )
 	{
+		if( theMap->transaction )
+		{
+			if( FakeFindStagedEdit( theMap->transaction, theResource, kFakeResEditRemove ) )
+			{
+				gFakeResError = resNotFound;
+				return;
+			}
+			stagedEdit = FakeFindStagedEdit( theMap->transaction, theResource, kFakeResEditSetInfo );
+		}
+		
 		gFakeResError = noErr;
 		if( theID )
 		{
-			*theID = refEntry->resourceID;
+			*theID = stagedEdit ? stagedEdit->resourceID : refEntry->resourceID;
 		}
 		
 		if( theType )
 		{
-			*theType = typeEntry->resourceType;
+			*theType = theMap->typeCodes[typeEntry -theMap->typeList];
 		}
 		
 		if( name )
 		{
-			memcpy(name, refEntry->resourceName, sizeof(FakeStr255));
+			memcpy(name, stagedEdit ? (char*)stagedEdit->resourceName : refEntry->resourceName, sizeof(FakeStr255));
 		}
 		return;
 	}
+	else if( (stagedEdit = FakeFindStagedAdd( theResource, NULL )) )
+	{
+		gFakeResError = noErr;
+		if( theID )
+			*theID = stagedEdit->resourceID;
+		if( theType )
+			*theType = stagedEdit->resourceType;
+		if( name )
+			memcpy(name, stagedEdit->resourceName, sizeof(FakeStr255));
+		return;
+	}
 	
 	gFakeResError = resNotFound;
 }
@@ -935,9 +4924,21 @@ void FakeGetResInfo( Handle theResource, int16_t * theID, uint32_t * theType, Fa
 
 void FakeSetResInfo( Handle theResource, int16_t theID, FakeStr255 name )
 {
+	struct FakeResourceMap* theMap = NULL;
+	struct FakeTypeListEntry* typeEntry = NULL;
 	struct FakeReferenceListEntry* refEntry = NULL;
+	struct FakeResEdit* stagedEdit = NULL;
 
-	if( !theResource || !FakeFindResourceHandle( theResource, NULL, NULL, &refEntry) )
+	if( theResource && !FakeFindResourceHandle( theResource, &theMap, &typeEntry, &refEntry) && (stagedEdit = FakeFindStagedAdd( theResource, &theMap )) )
+	{
+		FakeNoteStagedResID( theMap, stagedEdit->resourceType, theID );
+		stagedEdit->resourceID = theID;
+		memcpy(stagedEdit->resourceName, name, sizeof(FakeStr255));
+		gFakeResError = noErr;
+		return;
+	}
+	
+	if( !theResource || !refEntry || (theMap->transaction && FakeFindStagedEdit( theMap->transaction, theResource, kFakeResEditRemove )) )
 	{
 		gFakeResError = resNotFound;
 		return;
@@ -949,7 +4950,32 @@ void FakeSetResInfo( Handle theResource, int16_t theID, FakeStr255 name )
 		return;
 	}
 
-	refEntry->resourceID = theID;
+	if( theMap->transaction )
+	{
+		stagedEdit = FakeFindStagedEdit( theMap->transaction, theResource, kFakeResEditSetInfo );
+		if( !stagedEdit )
+			stagedEdit = FakeStageEdit( theMap->transaction, kFakeResEditSetInfo, theResource );
+		if( !stagedEdit )
+		{
+			gFakeResError = memFulErr;
+			return;
+		}
+		stagedEdit->resourceID = theID;
+		memcpy(stagedEdit->resourceName, name, sizeof(FakeStr255));
+		if( typeEntry->idIndex )
+			FakeResIDIndexMarkUsed( typeEntry->idIndex, theID );
+		gFakeResError = noErr;
+		return;
+	}
+
+	if( refEntry->resourceID != theID )
+	{
+		FakeForgetResIDIndex( typeEntry );	// Rare enough to just make it again when needed.
+		if( theMap->bloomFilter && !FakeResBloomFilterNoteRemoved( theMap->bloomFilter ) )
+			FakeForgetResBloomFilter( theMap );
+		FakeUpdateResBloomFilter( theMap, theMap->typeCodes[typeEntry -theMap->typeList], theID );
+	}
+	FakeSetResourceID( typeEntry, refEntry -typeEntry->resourceList, theID );
 	memcpy(refEntry->resourceName, name, sizeof(FakeStr255));
 
 	gFakeResError = noErr;
@@ -969,40 +4995,97 @@ void FakeAddResource( Handle theData, uint32_t theType, int16_t theID, FakeStr25
 		return;
 	}
 
-	typeEntry = FakeFindTypeListEntry( currMap, theType );
-	if( !typeEntry )
+	if( currMap->transaction )
 	{
-		currMap->numTypes++;
-		currMap->typeList = realloc(currMap->typeList, currMap->numTypes * sizeof(struct FakeTypeListEntry));
-
-		typeEntry = currMap->typeList + (currMap->numTypes - 1);
-		typeEntry->resourceType = theType;
-		typeEntry->numberOfResourcesOfType = 0;
-		typeEntry->resourceList = NULL;
-		
-		FakeRetainType(theType);
+		if( FakeFindStagedEdit( currMap->transaction, theData, kFakeResEditAdd ) )
+		{
+			gFakeResError = addResFailed;
+			return;
+		}
+		struct FakeResEdit* addEdit = FakeStageEdit( currMap->transaction, kFakeResEditAdd, theData );
+		if( !addEdit )
+		{
+			gFakeResError = memFulErr;
+			return;
+		}
+		addEdit->resourceType = theType;
+		addEdit->resourceID = theID;
+		FakeNoteStagedResID( currMap, theType, theID );
+		memcpy(addEdit->resourceName, name, sizeof(FakeStr255));
+		gFakeResError = noErr;
+		return;
 	}
 
-	typeEntry->numberOfResourcesOfType++;
+	gFakeResError = FakeAddReferenceEntry( currMap, theData, theType, theID, name );
+}
+
 
-	if( typeEntry->resourceList )
+void FakeAddResources( struct FakeResourceAddEntry* ioEntries, size_t inCount )
+{
+	struct FakeResourceMap* currMap = gCurrResourceMap;
+	FakeStr255 emptyName = {0};
+	int16_t firstErr = noErr;
+	if( currMap && currMap->transaction )	// Staging is cheap anyway.
 	{
-		typeEntry->resourceList = realloc( typeEntry->resourceList, typeEntry->numberOfResourcesOfType * sizeof(struct FakeReferenceListEntry) );
+		for( size_t x = 0; x < inCount; x++ )
+		{
+			FakeStr255 theName = {0};
+			if( ioEntries[x].resName )
+				memcpy(theName, ioEntries[x].resName, ioEntries[x].resName[0] +1);
+			FakeAddResource( ioEntries[x].resHandle, ioEntries[x].resType, ioEntries[x].resID, theName );
+			ioEntries[x].resError = gFakeResError;
+			if( firstErr == noErr )
+				firstErr = gFakeResError;
+		}
+		gFakeResError = firstErr;
+		return;
 	}
-	else
+	gFakeResError = noErr;
+	if( !currMap )
 	{
-		typeEntry->resourceList = calloc(typeEntry->numberOfResourcesOfType, sizeof(struct FakeReferenceListEntry));
+		for( size_t x = 0; x < inCount; x++ )
+			ioEntries[x].resError = resFNotFound;
+		gFakeResError = (inCount > 0) ? resFNotFound : noErr;
+		return;
 	}
-	
-	resourceEntry = typeEntry->resourceList + ( typeEntry->numberOfResourcesOfType - 1 );
-	resourceEntry->resourceAttributes = 0;
-	resourceEntry->resourceID = theID;
-	memcpy(resourceEntry->resourceName, name, sizeof(FakeStr255));
-	resourceEntry->resourceHandle = theData;
 
-	currMap->dirty = true;
+	// Make room for all of them first, so each list grows at most once:
+	size_t* numAddsPerType = calloc( (size_t)currMap->numTypes +inCount +1, sizeof(size_t) );
+	for( size_t x = 0; numAddsPerType && x < inCount; x++ )
+	{
+		struct FakeTypeListEntry* typeEntry = FakeFindTypeListEntry( currMap, ioEntries[x].resType );
+		if( !typeEntry )
+		{
+			if( !FakeReserveTypeListEntries( currMap, 1 ) )
+				break;
+			currMap->typeCodes[currMap->numTypes] = ioEntries[x].resType;
+			typeEntry = currMap->typeList +currMap->numTypes++;
+			memset( typeEntry, 0, sizeof(struct FakeTypeListEntry) );
+			FakeRetainType( ioEntries[x].resType );
+		}
+		numAddsPerType[typeEntry -currMap->typeList]++;
+	}
+	for( size_t x = 0; numAddsPerType && x < currMap->numTypes; x++ )
+		FakeReserveReferenceEntries( currMap->typeList +x, numAddsPerType[x] );	// If this fails, adding will try again.
+	free( numAddsPerType );
 
-	gFakeResError = noErr;
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		if( !ioEntries[x].resHandle || FakeFindResourceHandleInMap( ioEntries[x].resHandle, NULL, NULL, currMap ) )
+			ioEntries[x].resError = addResFailed;
+		else
+			ioEntries[x].resError = FakeAddReferenceEntry( currMap, ioEntries[x].resHandle, ioEntries[x].resType, ioEntries[x].resID,
+														ioEntries[x].resName ? ioEntries[x].resName : emptyName );
+		if( gFakeResError == noErr )
+			gFakeResError = ioEntries[x].resError;
+	}
+
+	// Types we made room for that nothing could be added to:
+	for( size_t x = currMap->numTypes; x > 0; x-- )
+	{
+		if( currMap->typeList[x -1].numberOfResourcesOfType == 0 )
+			FakeRemoveTypeListEntry( currMap, x -1 );
+	}
 }
 
 void FakeChangedResource( Handle theResource )
@@ -1017,6 +5100,8 @@ void FakeChangedResource( Handle theResource )
 
 	if( (theEntry->resourceAttributes & resProtected) == 0 )
 	{
+		theEntry->resourceAttributes |= resChanged;
+		FakeResourceCacheRemove( theResource );	// Only copy of these changes now, mustn't be emptied.
 		theMap->dirty = true;
 		gFakeResError = noErr;
 	}
@@ -1034,53 +5119,101 @@ void FakeRemoveResource( Handle theResource )
 	struct FakeResourceMap* currMap = gCurrResourceMap;
 	struct FakeTypeListEntry* typeEntry = NULL;
 	struct FakeReferenceListEntry* resEntry = NULL;
-	if( !currMap || !FakeFindResourceHandleInMap( theResource, &typeEntry, &resEntry, currMap ) || ((resEntry->resourceAttributes & resProtected) != 0) )
+	struct FakeResEdit* stagedEdit = NULL;
+	if( currMap && currMap->transaction && (stagedEdit = FakeFindStagedEdit( currMap->transaction, theResource, kFakeResEditAdd )) )
 	{
-		gFakeResError = rmvResFailed;
+		stagedEdit->kind = kFakeResEditNone;	// Never mind adding it.
+		gFakeResError = noErr;
 		return;
 	}
 	
-	struct FakeReferenceListEntry* nextResEntry = resEntry + 1;
-	int resourcesListSize = typeEntry->numberOfResourcesOfType * sizeof(struct FakeReferenceListEntry);
-	long nextResEntryOffset   = (void*)nextResEntry - (void*)typeEntry->resourceList;
-	
-	typeEntry->numberOfResourcesOfType--;
-
-	if( typeEntry->numberOfResourcesOfType > 0 )
+	if( !currMap || !FakeFindResourceHandleInMap( theResource, &typeEntry, &resEntry, currMap ) || ((resEntry->resourceAttributes & resProtected) != 0)
+		|| (currMap->transaction && FakeFindStagedEdit( currMap->transaction, theResource, kFakeResEditRemove )) )
 	{
-		memcpy( resEntry, nextResEntry, resourcesListSize - nextResEntryOffset );
-		typeEntry->resourceList = realloc( typeEntry->resourceList, resourcesListSize - sizeof(struct FakeReferenceListEntry) );
+		gFakeResError = rmvResFailed;
+		return;
 	}
-	else
+	
+	if( currMap->transaction )
 	{
-		// got rid of the last resource reference, release the memory
-		free(typeEntry->resourceList);
-		typeEntry->resourceList = NULL;
+		if( !FakeStageEdit( currMap->transaction, kFakeResEditRemove, theResource ) )
+		{
+			gFakeResError = memFulErr;
+			return;
+		}
+		if( (stagedEdit = FakeFindStagedEdit( currMap->transaction, theResource, kFakeResEditSetInfo )) )
+			stagedEdit->kind = kFakeResEditNone;	// Removing wins.
+		gFakeResError = noErr;
+		return;
+	}
+	
+	// The caller gets to keep the Handle, so it needs its data, and it mustn't be emptied anymore:
+	if( FakeReferenceEntryNeedsLoad( resEntry ) )
+		FakeLoadReferenceEntry( currMap, resEntry );
+	
+	FakeMarkReferenceEntryRemoved( currMap, typeEntry, resEntry );
+	FakeTidyTypeListEntry( currMap, typeEntry -currMap->typeList );
 
-		// now remove the type entry
-		struct FakeTypeListEntry* nextTypeEntry = typeEntry + 1;
-		int typeListSize = currMap->numTypes * sizeof(struct FakeTypeListEntry);
-		long nextTypeEntryOffset   = (void*)nextTypeEntry - (void*)currMap->typeList;
+	currMap->dirty = true;
+	gFakeResError = noErr;
+}
 
-		currMap->numTypes--;
-		FakeReleaseType(typeEntry->resourceType);
 
-		if( currMap->numTypes > 0 )
+void FakeRemoveResources( const Handle* inResources, int16_t* outErrors, size_t inCount )
+{
+	struct FakeResourceMap* currMap = gCurrResourceMap;
+	int16_t firstErr = noErr;
+	if( !currMap || currMap->transaction )
+	{
+		for( size_t x = 0; x < inCount; x++ )
 		{
-			memcpy( typeEntry, nextTypeEntry, typeListSize - nextTypeEntryOffset );
-			currMap->typeList = realloc( currMap->typeList, typeListSize - sizeof(struct FakeTypeListEntry) );
+			FakeRemoveResource( inResources[x] );
+			if( outErrors )
+				outErrors[x] = gFakeResError;
+			if( firstErr == noErr )
+				firstErr = gFakeResError;
 		}
+		gFakeResError = firstErr;
+		return;
+	}
+	gFakeResError = noErr;
+
+	// The caller keeps the Handles, so read the data of those that need it in one go:
+	struct FakeReferenceListEntry** entriesToLoad = malloc( (inCount +1) * sizeof(struct FakeReferenceListEntry*) );
+	size_t numEntriesToLoad = 0;
+	for( size_t x = 0; entriesToLoad && x < inCount; x++ )
+	{
+		struct FakeReferenceListEntry* resEntry = NULL;
+		if( FakeFindResourceHandleInMap( inResources[x], NULL, &resEntry, currMap ) && (resEntry->resourceAttributes & resProtected) == 0
+			&& FakeReferenceEntryNeedsLoad( resEntry ) )
+			entriesToLoad[numEntriesToLoad++] = resEntry;
+	}
+	FakeLoadReferenceEntries( currMap, entriesToLoad, NULL, numEntriesToLoad );
+	free( entriesToLoad );
+
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		struct FakeTypeListEntry* typeEntry = NULL;
+		struct FakeReferenceListEntry* resEntry = NULL;
+		int16_t err = noErr;
+		if( !FakeFindResourceHandleInMap( inResources[x], &typeEntry, &resEntry, currMap ) || (resEntry->resourceAttributes & resProtected) != 0 )
+			err = rmvResFailed;
 		else
 		{
-			// got rid of the last type entry
-			free(currMap->typeList);
-			currMap->typeList = NULL;
+			FakeMarkReferenceEntryRemoved( currMap, typeEntry, resEntry );	// Nothing moves until we tidy up below.
+			currMap->dirty = true;
 		}
+		if( outErrors )
+			outErrors[x] = err;
+		if( gFakeResError == noErr )
+			gFakeResError = err;
 	}
-	
 
-	currMap->dirty = true;
-	gFakeResError = noErr;
+	for( size_t x = currMap->numTypes; x > 0; x-- )
+	{
+		if( currMap->typeList[x -1].numRemovedResources > 0 )
+			FakeTidyTypeListEntry( currMap, x -1 );
+	}
 }
 
 
@@ -1098,22 +5231,35 @@ void FakeWriteResource( Handle theResource )
 	}
 }
 
-// NOTE: effectively a no-op since we don't have a way to load an individual resource from disk right now.
-//       All resources are already loaded at file open time.
+// NOTE: Only does something for resources whose file was opened after FakeSetResLoad(false),
+//       or that were fetched while it was off. Otherwise resources are loaded at file open time.
 void FakeLoadResource( Handle theResource )
 {
+	struct FakeResourceMap* theMap = NULL;
 	struct FakeReferenceListEntry* resEntry = NULL;
-	if( !theResource || !FakeFindResourceHandle( theResource, NULL, NULL, &resEntry ))
+	if( !theResource || !FakeFindResourceHandle( theResource, &theMap, NULL, &resEntry ))
 	{
 		gFakeResError = resNotFound;
 	}
+	else if( FakeReferenceEntryNeedsLoad( resEntry ) && !FakeResourceCacheRestore( theResource ) )
+	{
+		FakeRecordResourceAccess( theMap, resEntry );
+		FakeResourceCacheCountMiss();
+		gFakeResError = FakeLoadReferenceEntry( theMap, resEntry );
+	}
 	else
 	{
+		FakeRecordResourceAccess( theMap, resEntry );
+		FakeResourceCacheTouch( theResource );
 		gFakeResError = noErr;
 	}
+	if( gFakeResError == noErr && resEntry->compressedInRAM )
+		gFakeResError = CantDecompress;
 }
 
-// NOTE: effectively a no-op since we don't have a way to reload a released resource from disk right now
+// Frees the resource's data. The Handle stays valid and the data is read again
+//  the next time someone asks for this resource. Changed resources and ones
+//  that aren't in the file yet can't be released, as we'd lose their data.
 void FakeReleaseResource( Handle theResource )
 {
 	struct FakeReferenceListEntry* resEntry = NULL;
@@ -1121,17 +5267,161 @@ void FakeReleaseResource( Handle theResource )
 	{
 		gFakeResError = resNotFound;
 	}
+	else if( (resEntry->resourceAttributes & resChanged) != 0 || resEntry->dataExtent == 0 )
+	{
+		gFakeResError = resAttrErr;
+	}
 	else
 	{
+		FakeResourceCacheRemove( theResource );
+		FakeEmptyHandle( theResource );
 		gFakeResError = noErr;
 	}
 }
 
 
+void FakeBeginResTransaction( int16_t inFileRefNum )
+{
+	struct FakeResourceMap* theMap = FakeFindResourceMap( inFileRefNum, NULL );
+	if( !theMap )
+	{
+		gFakeResError = resFNotFound;
+		return;
+	}
+	if( theMap->transaction )
+	{
+		gFakeResError = resAttrErr;	// They don't nest.
+		return;
+	}
+
+	theMap->transaction = calloc( 1, sizeof(struct FakeResTransaction) );
+	gFakeResError = theMap->transaction ? noErr : memFulErr;
+}
+
+
+void FakeCommitResTransaction( int16_t inFileRefNum )
+{
+	struct FakeResourceMap* theMap = FakeFindResourceMap( inFileRefNum, NULL );
+	if( !theMap || !theMap->transaction )
+	{
+		gFakeResError = theMap ? resAttrErr : resFNotFound;
+		return;
+	}
+
+	struct FakeResTransaction* theTransaction = theMap->transaction;
+	theMap->transaction = NULL;
+	FakeForgetResIDIndexes( theMap );	// They count staged IDs as used.
+	int16_t		err = FakeApplyResTransaction( theMap, theTransaction );
+	FakeDisposeResTransaction( theTransaction );
+	if( err != noErr )
+	{
+		gFakeResError = err;	// Nothing changed, as if it was aborted.
+		return;
+	}
+
+	gFakeResError = noErr;
+	FakeSaveResourceMap( theMap, inFileRefNum, true, NULL );	// Sets the error if it fails.
+}
+
+
+void FakeAbortResTransaction( int16_t inFileRefNum )
+{
+	struct FakeResourceMap* theMap = FakeFindResourceMap( inFileRefNum, NULL );
+	if( !theMap || !theMap->transaction )
+	{
+		gFakeResError = theMap ? resAttrErr : resFNotFound;
+		return;
+	}
+
+	FakeDisposeResTransaction( theMap->transaction );	// Nothing was changed yet.
+	theMap->transaction = NULL;
+	FakeForgetResIDIndexes( theMap );	// They count staged IDs as used.
+	gFakeResError = noErr;
+}
+
+
+bool FakeIsInResTransaction( int16_t inFileRefNum )
+{
+	struct FakeResourceMap* theMap = FakeFindResourceMap( inFileRefNum, NULL );
+	return theMap && theMap->transaction;
+}
+
+
+// NOTE: Unlike the real thing, files opened while this is on load *all* their
+//       resources right away, not just the ones marked resPreload.
 void FakeSetResLoad(bool load)
 {
-	// NOTE: a no-op since resources are always loaded at file open time
+	gFakeResLoad = load;
+}
+
+
+void FakeSetResLoadThreads(int16_t numThreads)
+{
+	gFakeResLoadThreads = (numThreads < 1) ? 1 : numThreads;
+}
+
+
+void FakeSetResProfileRecording(double inSeconds)
+{
+	gFakeResProfileSeconds = (inSeconds < 0) ? 0 : inSeconds;
+}
+
+
+void FakeSetResPrefetch(bool inPrefetch)
+{
+	gFakeResPrefetch = inPrefetch;
+}
+
+
+void FakeSetResFetchIOUring(bool inUseIOUring)
+{
+	if( gNumResFetches != 0 )
+	{
+		gFakeResError = resAttrErr;
+		return;
+	}
+	gFakeResError = noErr;
+	gFakeResFetchIOUring = inUseIOUring;
+	FakeAsyncIODispose( gFakeResFetchIO );
+	gFakeResFetchIO = NULL;
+}
+
+
+
+
+
+void FakeSetResSharedCache(bool inShare)
+{
+	gFakeResSharedCache = inShare;
+}
+
+
+void FakeSetResDedup(bool inDedup)
+{
+	gFakeResDedup = inDedup;
 }
 
 
+void FakeSetResFileLimit(size_t inMaxOpenFiles)
+{
+	gFakeResFileLimit = inMaxOpenFiles;
+	FakeCloseUnusedResMapFiles( NULL );
+}
+
 
+void FakeRemoveResSharedCache(const unsigned char* inPath)
+{
+	char		thePath[256 +17] = {0};
+	FakeCPathFromResFilePath( inPath, thePath );
+	int			fd = open( thePath, O_RDONLY );
+	struct FakeSharedResKey	theKey;
+	if( fd < 0 )
+	{
+		gFakeResError = fnfErr;
+		return;
+	}
+	if( FakeMakeSharedResKey( fd, 0, 0, &theKey ) )
+		FakeRemoveSharedResources( &theKey );
+	close( fd );
+	gFakeResError = noErr;
+}
@@ -10,6 +10,7 @@
 #define ReClassicfication_FakeResources_h
 
 
+#include <stdint.h>
 #include "FakeHandles.h"
 
 #if __cplusplus
@@ -24,8 +25,13 @@ enum {
     addResFailed = -194,
     rmvResFailed = -196,
     resAttrErr = -198,
+    mapReadErr = -199,
     eofErr = -39,
-    fnfErr = -43
+    ioErr = -36,
+    fnfErr = -43,
+    wrPermErr = -61,
+    tmfoErr = -42,
+    CantDecompress = -186
 };
 #endif /* __MACERRORS__ */
 
@@ -33,7 +39,8 @@ enum {
 #ifndef __RESOURCES__
 // Resource attribute bit flags:
 enum {
-    resReserved = (1 << 0),    // Apparently not yet used.
+    resCompressed = (1 << 0),  // Data starts with an extended header and needs a 'dcmp' to decompress.
+    resReserved = resCompressed,    // Old name.
     resChanged = (1 << 1),
     resPreload = (1 << 2),
     resProtected = (1 << 3),
@@ -46,21 +53,210 @@ enum {
 
 typedef unsigned char FakeStr255[256];
 
+// Decompresses the inDataLength bytes of compressed data of a resource into
+//  outData, which has room for exactly the outDataLength bytes the extended
+//  header promises. inHeader is the whole extended header, in case the format
+//  has parameters there. Returns noErr or CantDecompress. May be called on
+//  several threads at once, for different resources.
+typedef int16_t (*FakeResourceDecompressorProc)(int16_t inDcmpID, const uint8_t *inHeader, size_t inHeaderLength,
+                                                 const uint8_t *inData, size_t inDataLength,
+                                                 uint8_t *outData, size_t outDataLength, void *inRefCon);
+
+// Called by FakeCompleteResFetches() for a resource FakeStartResFetch() was
+//  asked for. inError is what FakeResError() would say after FakeGetResource(),
+//  inResource is NULL if it couldn't be found or read.
+typedef void (*FakeResFetchProc)(Handle inResource, int16_t inError, void *inRefCon);
+
+// One resource requested from FakeGetResources():
+struct FakeResourceBatchEntry
+{
+    uint32_t resType;    // Type of the resource to get.
+    int16_t resID;       // ID of the resource to get.
+    Handle resHandle;    // Set to the resource, or NULL if it couldn't be found or loaded.
+    int16_t resError;    // Set to what FakeResError() would say after FakeGetResource() for this one.
+};
+
+// One resource to add with FakeAddResources():
+struct FakeResourceAddEntry
+{
+    Handle resHandle;               // The data, like FakeAddResource()'s theData.
+    uint32_t resType;               // Type to add it as.
+    int16_t resID;                  // ID to give it.
+    const unsigned char *resName;   // Pascal string, or NULL for no name.
+    int16_t resError;               // Set to what FakeResError() would say after FakeAddResource() for this one.
+};
+
+// Counters of the resource data cache, see FakeSetResourceCacheBudget():
+struct FakeResourceCacheStats
+{
+    uint64_t hits;            // Resources requested whose data was in RAM.
+    uint64_t misses;          // Resources requested whose data had to be read from disk.
+    uint64_t evictions;       // Resources whose data was freed to stay within the budget.
+    uint64_t bytesEvicted;
+    uint64_t bytesCached;     // Data in RAM that could be freed and read again if needed.
+    uint64_t numCached;
+    uint64_t budget;          // What was passed to FakeSetResourceCacheBudget().
+    uint64_t numCompressed;   // Resources whose data is compressed in RAM right now, see FakeSetResourceCacheCompression().
+    uint64_t bytesBeforeCompression;    // Their data, uncompressed.
+    uint64_t bytesAfterCompression;     // What it takes up compressed, and counts in bytesCached.
+    uint64_t compressions;    // Resources whose data was compressed.
+    uint64_t decompressions;  // Resources whose data was decompressed because they were requested.
+    double decompressSeconds; // Time that took, all in all.
+};
 
+// How FakeUpdateResFile() lays out a file, see FakeSetResFileFormat():
+enum FakeResFileFormat
+{
+    kFakeResFileClassic = 0,    // What the Mac's Resource Manager reads.
+    kFakeResFileExtended        // 64 bit data offsets, 32 bit map offsets, only we read it.
+};
+
+// In which order FakeCompactResFile() puts resources' data in the file. Those
+//  marked resPreload always come first, then those in the profile, then those
+//  of the listed types, then the rest in the order of the map:
+struct FakeResCompactOptions
+{
+    bool useProfile;            // Order by the access profile next to the file (see FakeSetResProfileRecording()).
+    const uint32_t *typeOrder;  // Types whose resources go next, most important first. May be NULL.
+    size_t numTypesInOrder;
+    uint32_t alignment;         // Each resource's data (after its length) starts at a multiple of this many bytes in the file, e.g. 4096 to mmap() it. 0 for none.
+};
+
+// What FakeCompactResFile() did. The "cold" resources are those read right
+//  after opening the file, i.e. the ones in its profile and the resPreload
+//  ones. Reading their data takes reading the given number of bytes in whole
+//  4 KB pages, in the given number of runs of neighbouring pages.
+struct FakeResCompactReport
+{
+    uint64_t fileLengthBefore;
+    uint64_t fileLengthAfter;
+    uint64_t coldDataLength;        // Data of the cold resources, including their lengths.
+    uint64_t coldBytesReadBefore;
+    uint64_t coldBytesReadAfter;
+    uint32_t coldReadsBefore;
+    uint32_t coldReadsAfter;
+};
+
+
+// If the file is a MacBinary, AppleSingle or AppleDouble file, the resource
+//  fork inside it is opened, read-only. Otherwise the file is the resource fork.
+//  Reference numbers of closed files are handed out again once all 32768 have
+//  been, FakeResError() is tmfoErr if that many files are open.
 int16_t FakeOpenResFile(const unsigned char *inPath);
 
+// Opens the resource fork of inForkLength bytes at inForkOffset in the given
+//  file, read-only. Nothing outside the fork is read.
+int16_t FakeOpenResFork(const unsigned char *inPath, uint32_t inForkOffset, uint32_t inForkLength);
+
+// Opens several files as if FakeOpenResFile() had been called for each in
+//  turn (so they get their reference numbers in that order and the last one
+//  ends up as the current resource file), but reads them at the same time on
+//  as many threads as FakeSetResLoadThreads() allows. outRefNums receives the
+//  reference number or error of each file, outErrors (may be NULL) its FakeResError().
+void FakeOpenResFiles(const unsigned char **inPaths, int16_t inCount, int16_t *outRefNums, int16_t *outErrors);
+
+// For applications that keep many files open. Files opened read-only (forks
+//  inside other files, and files we may not write to) are closed once more
+//  than inMaxOpenFiles of them are, those used least recently first, and
+//  opened again when their resources are read. Their reference numbers stay
+//  the same. Writable files always stay open. Files that are closed aren't
+//  prefetched (see FakeSetResPrefetch()). If another file took a closed one's
+//  place meanwhile, reading its resources fails. 0 (the default) means no limit.
+void FakeSetResFileLimit(size_t inMaxOpenFiles);
+
 void FakeCloseResFile(int16_t resRefNum);
 
 Handle FakeGet1Resource(uint32_t resType, int16_t resID);
 
 Handle FakeGetResource(uint32_t resType, int16_t resID);
 
+// Find a resource by name instead of ID. Like the Toolbox, this ignores case
+//  but not diacritics (see FakeEqualString()).
+Handle FakeGet1NamedResource(uint32_t resType, const unsigned char *name);
+
+Handle FakeGetNamedResource(uint32_t resType, const unsigned char *name);
+
+// Like calling FakeGetResource() for each entry, but resources that still need
+//  to be read from disk are read in file order, with neighbouring ones read in one go.
+void FakeGetResources(struct FakeResourceBatchEntry *ioEntries, size_t inCount);
+
+// Looks up a resource like FakeGetResource(), but doesn't wait for its data
+//  to be read. Instead, FakeCompleteResFetches() calls inProc once it's in
+//  RAM. inProc is called exactly once, also for resources that were in RAM
+//  already or couldn't be found, unless FakeResError() is memFulErr after this.
+//  Any number of fetches, from any number of files, may be going on at once.
+//  On Linux the reads go through io_uring, elsewhere a few threads do them.
+//  Fetches ignore FakeSetResLoad().
+void FakeStartResFetch(uint32_t resType, int16_t resID, FakeResFetchProc inProc, void *inRefCon);
+
+// Calls the procs of the fetches that are done, on this thread, and returns
+//  how many. If inWait and none are done yet, waits until a read finishes.
+//  The data stays in RAM while the proc runs, FakeHLock() it to keep it longer.
+size_t FakeCompleteResFetches(bool inWait);
+
+// Number of fetches whose proc hasn't been called yet:
+size_t FakeCountResFetches(void);
+
+// A file descriptor that becomes readable when FakeCompleteResFetches() has
+//  procs to call, for your event loop's poll() or epoll. Don't read from it
+//  or close it. -1 if fetches can't be done at all.
+int FakeResFetchFD(void);
+
+// Whether fetches use io_uring (the default) or threads on Linux. FakeResError()
+//  is resAttrErr if fetches are going on. Changes what FakeResFetchFD() returns.
+void FakeSetResFetchIOUring(bool inUseIOUring);
+
 int16_t FakeCurResFile();
 
 void FakeUseResFile(int16_t resRefNum);
 
+// Writes out the file if anything changed. FakeResError() is mapReadErr,
+//  and the file is left as it was, if its resources don't fit its format.
 void FakeUpdateResFile(int16_t inFileRefNum);
 
+// Classic files can't hold more than 16 MB of resource data, and the offsets
+//  in their map only have 16 bits, which runs out after a few thousand
+//  resources or 64 KB of names. Files in the extended format don't have
+//  these limits, and can have up to 65535 resources of each type (use
+//  FakeGet1ResourceIDsInRange() to list them, the counts stop at 32767).
+//  Opening a file detects which format it is in. This makes the next
+//  FakeUpdateResFile() write it in the given format.
+void FakeSetResFileFormat(int16_t inFileRefNum, enum FakeResFileFormat inFormat);
+
+enum FakeResFileFormat FakeGetResFileFormat(int16_t inFileRefNum);
+
+// Rewrites the whole file, even if nothing changed, without any unused
+//  space, with the resources' data in the order inOptions asks for (NULL
+//  means by profile, unaligned). The result is a normal file in its format
+//  (see FakeSetResFileFormat()), which any reader can open. Like
+//  FakeCommitResTransaction(), it writes a new file that replaces the old
+//  one. Padding for the alignment counts towards the 16 MB classic files can
+//  hold. outReport (may be NULL) gets the file lengths and how much reading
+//  the cold resources took before and after.
+void FakeCompactResFile(int16_t inFileRefNum, const struct FakeResCompactOptions *inOptions, struct FakeResCompactReport *outReport);
+
+// After FakeBeginResTransaction(), FakeAddResource(), FakeRemoveResource() and
+//  FakeSetResInfo() on the given file only note what to do. FakeGetResInfo(),
+//  FakeSetResInfo() and FakeRemoveResource() already see these edits, all
+//  other calls see the file as it was. FakeCommitResTransaction() then makes
+//  them all at once and saves the file, by writing a new file that replaces
+//  the old one, so a crash never leaves a half-written file behind.
+//  FakeAbortResTransaction() forgets them, as does closing the file.
+//  Transactions don't nest. FakeResError() is resAttrErr if you begin one
+//  while one is going on, or commit or abort without one. If committing
+//  fails with memFulErr, or with addResFailed because a type would get more
+//  than 65535 resources, nothing was changed and the transaction is over, as
+//  if it had been aborted.
+void FakeBeginResTransaction(int16_t inFileRefNum);
+
+void FakeCommitResTransaction(int16_t inFileRefNum);
+
+void FakeAbortResTransaction(int16_t inFileRefNum);
+
+// Whether FakeBeginResTransaction() was called on the file and it wasn't
+//  committed or aborted yet. False for files that aren't open.
+bool FakeIsInResTransaction(int16_t inFileRefNum);
+
 int16_t FakeHomeResFile(Handle theResource);
 
 int16_t FakeCount1Types();
@@ -75,16 +271,38 @@ void FakeGet1IndType(uint32_t *resType, int16_t index);
 
 Handle FakeGet1IndResource(uint32_t resType, int16_t index);
 
+// An ID no resource of that type has in any open file (FakeUniqueID()) or
+//  the current file (FakeUnique1ID()), nor is staged to have in a transaction.
+//  Tries 128 and up first, then 1 to 127. Returns the same ID again until a
+//  resource gets it. FakeResError() is addResFailed if all IDs are taken.
+int16_t FakeUniqueID(uint32_t resType);
+
+int16_t FakeUnique1ID(uint32_t resType);
+
+// The IDs of the resources of the given type in the current file, from
+//  inFirstID through inLastID, in ascending order. Copies up to inMaxCount
+//  of them into outIDs, and returns how many there are in total.
+size_t FakeGet1ResourceIDsInRange(uint32_t resType, int16_t inFirstID, int16_t inLastID, int16_t *outIDs, size_t inMaxCount);
+
 void FakeGetResInfo(Handle theResource, int16_t *theID, uint32_t *theType, FakeStr255 name);
 
 void FakeSetResInfo(Handle theResource, int16_t theID, FakeStr255 name);
 
 void FakeAddResource(Handle theData, uint32_t theType, int16_t theID, FakeStr255 name);
 
+// Like calling FakeAddResource() for each entry, but each type's list only
+//  grows once. FakeResError() is the first error of any of them.
+void FakeAddResources(struct FakeResourceAddEntry *ioEntries, size_t inCount);
+
 void FakeChangedResource(Handle theResource);
 
 void FakeRemoveResource(Handle theResource);
 
+// Like calling FakeRemoveResource() for each Handle, but the data of those
+//  not in RAM yet is read in one go. outErrors may be NULL, otherwise it gets
+//  what FakeResError() would say for each one. FakeResError() is the first error.
+void FakeRemoveResources(const Handle *inResources, int16_t *outErrors, size_t inCount);
+
 void FakeWriteResource(Handle theResource);
 
 void FakeLoadResource(Handle theResource);
@@ -93,8 +311,120 @@ void FakeReleaseResource(Handle theResource);
 
 void FakeSetResLoad(bool load);
 
+// How many threads may be used to read resource data (e.g. when opening a file).
+//  The result is the same as reading it on one thread, just faster on fast disks.
+void FakeSetResLoadThreads(int16_t numThreads);
+
+// Files opened after this remember which resources are requested in their
+//  first inSeconds after opening, and in what order, and save that next to
+//  the file as "<file>.rprof" (when the time is up or the file is closed).
+//  0 (the default) turns recording off.
+void FakeSetResProfileRecording(double inSeconds);
+
+// When FakeSetResLoad(false) is in effect, files opened after this start
+//  reading the resources listed in their "<file>.rprof", then those marked
+//  resPreload, on a background thread, so they're in RAM by the time they're
+//  asked for. The result is the same as without it. On by default.
+void FakeSetResPrefetch(bool inPrefetch);
+
+// For pools of processes that open the same files. After FakeSetResSharedCache(true),
+//  the first process to open a file while FakeSetResLoad(true) is in effect
+//  puts its resource map and the data of all its resources (decompressed) in
+//  POSIX shared memory. Processes that open the file later use those instead
+//  of reading the file, and their resource Handles point right at the shared
+//  data, so there's only one copy of it in RAM. Changing a resource's data
+//  through its Handle copies what you change, only your process sees that.
+//  What's shared is only used while the file has the same size and time
+//  of last change as when it was put there, and FakeUpdateResFile() stops a
+//  process from using it for that file. Off by default.
+void FakeSetResSharedCache(bool inShare);
+
+// Takes the file's shared resource data out of shared memory, it otherwise
+//  stays there until the file changes and is opened again, or the machine
+//  restarts. Processes that have the file open keep using it.
+void FakeRemoveResSharedCache(const unsigned char *inPath);
+
+// For files that have the same data under many resources. After FakeSetResDedup(true),
+//  FakeUpdateResFile() and FakeCompactResFile() write data several resources
+//  have only once, and point all of their reference list entries at it. And
+//  when a file is opened while FakeSetResLoad(true) is in effect, data that
+//  several resources share in the file is read once, and their Handles point
+//  at copy-on-write copies of it, so it's only in RAM once. Changing one of
+//  them copies what you change, the others don't see that. Not used for files
+//  whose data is shared through FakeSetResSharedCache(). Off by default.
+void FakeSetResDedup(bool inDedup);
+
+// Limits how many bytes of resource data that is unchanged and could be read
+//  from its file again stay in RAM, across all open files. When there's more,
+//  the least recently used resources are emptied, resPurgeable ones first.
+//  FakeHLock() a resource's Handle while you're using its data to keep it.
+//  Emptied resources are read again by FakeGetResource(), FakeLoadResource()
+//  etc. 0 (the default) means no limit.
+void FakeSetResourceCacheBudget(uint64_t inMaxBytes);
+
+// Keeps the data of resources that weren't requested in inColdSeconds, and
+//  could be read from their file again, compressed in RAM. Their Handles are
+//  empty like those that were emptied to stay within the budget, and
+//  FakeGetResource(), FakeLoadResource() etc. decompress it into them when
+//  they're requested again. Locked Handles and data that doesn't get at least
+//  1/8th smaller stay as they are. The compressed data counts towards the
+//  budget. 0 (the default) turns this off, compressed data stays compressed.
+void FakeSetResourceCacheCompression(double inColdSeconds);
+
+void FakeGetResourceCacheStats(struct FakeResourceCacheStats *outStats);
+
+// Sets the hit, miss, eviction, compression and decompression counters back to 0:
+void FakeResetResourceCacheStats(void);
+
+// Resources with the resCompressed attribute are decompressed when they're
+//  loaded, so you get the same Handle with the decompressed data every time.
+//  'dcmp' 0, 1 and 2 are built in, with the tables System 7 has for them. For
+//  other formats install a decompressor here, which also replaces a built-in
+//  one (to decompress with the tables of another System, say). Pass NULL
+//  to remove it again. Resources no decompressor can handle are returned as
+//  they are in the file, with FakeResError() == CantDecompress. Saving writes
+//  decompressed resources back uncompressed.
+void FakeSetResourceDecompressor(int16_t inDcmpID, FakeResourceDecompressorProc inProc, void *inRefCon);
+
 int16_t FakeResError();
 
+// Converts inCount 16 or 32 bit values (e.g. the samples of a 'snd ' or the
+//  words of a 'PICT') between big endian, as in resource data, and the
+//  machine's byte order, in place. ioValues needn't be aligned. Does nothing
+//  on big endian machines. Uses SSE2 or AVX2 where the CPU has them.
+void FakeSwapBigEndian16(void *ioValues, size_t inCount);
+
+void FakeSwapBigEndian32(void *ioValues, size_t inCount);
+
+// Pascal string (length byte first) to C string and back. The first two
+//  convert in place and return their argument. None of them allocate
+//  memory, and C strings longer than 255 characters are truncated.
+//  outCString needs room for 256 bytes.
+char *FakeP2CStr(unsigned char *ioString);
+
+unsigned char *FakeC2PStr(char *ioString);
+
+void FakeCopyPascalStringToC(const unsigned char *inPString, char *outCString);
+
+void FakeCopyCStringToPascal(const char *inCString, unsigned char *outPString);
+
+// Compare Pascal strings of Mac Roman text like the Toolbox. Without caseSens
+//  'a' and 'A' are the same (and so are accented letters and their uppercase
+//  forms), without diacSens accented letters equal their base letters.
+bool FakeEqualString(const unsigned char *inStr1, const unsigned char *inStr2, bool caseSens, bool diacSens);
+
+// -1 if inStr1 sorts before inStr2, 0 if they're the same, 1 if it sorts after.
+//  Letters sort alphabetically regardless of case or accents, the plain
+//  uppercase letter first, so "a" < "B" even with caseSens.
+int16_t FakeRelString(const unsigned char *inStr1, const unsigned char *inStr2, bool caseSens, bool diacSens);
+
+// Like FakeRelString(), ignoring case and accents unless the strings only
+//  differ in those.
+int16_t FakeIUCompString(const unsigned char *inStr1, const unsigned char *inStr2);
+
+// Uppercase ioString in place, without diacSens also strip accents.
+void FakeUpperString(unsigned char *ioString, bool diacSens);
+
 
 // Private calls for internal use/tests:
 short fakeresfileopen(const char *inPath, const char *inMode, size_t startOffs);
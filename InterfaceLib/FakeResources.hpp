@@ -0,0 +1,397 @@
+//
+//  FakeResources.hpp
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  C++ types that own resource files and Handles, so they're closed and
+//  disposed of when they go out of scope, and calls that return their error
+//  instead of leaving it in FakeResError(). Needs C++17. Everything here is
+//  inline and just calls the C functions, it doesn't allocate or copy.
+//
+//	using namespace Fake::Literals;
+//	Fake::Result<Fake::ResFile>	file = Fake::ResFile::open( "Game.rsrc" );
+//	if( !file )
+//		return file.error();
+//	file->use();
+//	if( Fake::Result<Fake::ResHandle> picture = Fake::Get1Resource( "PICT"_fourcc, 128 ) )
+//		Draw( picture->bytes() );
+//
+
+#ifndef ReClassicfication_FakeResources_hpp
+#define ReClassicfication_FakeResources_hpp
+
+#if __cplusplus < 201703L
+#error "FakeResources.hpp needs C++17 or later."
+#endif
+
+#include <cassert>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "FakeResourceViews.hpp"
+
+
+namespace Fake
+{
+
+// What a call that failed returns, one of the errors FakeResError() or
+//	FakeHandles' calls give:
+struct Error
+{
+	int16_t		code;
+};
+
+
+// Either a T or the Error why there isn't one, like C++23's std::expected.
+//	T has to have an empty state it's default-constructed in, which is what
+//	a Result that holds an error keeps, so nothing needs to be allocated:
+template<class T>
+class [[nodiscard]] Result
+{
+	static_assert( std::is_default_constructible<T>::value, "Result<T> needs a T with an empty state." );
+
+public:
+	Result( T&& inValue ) : mValue( std::move( inValue ) ) {}
+	Result( Error inError ) : mError( inError.code ) {}
+
+	bool		has_value() const		{ return mError == noErr; }
+	explicit	operator bool() const	{ return has_value(); }
+	int16_t		error() const			{ return mError; }
+
+	// Only if has_value():
+	T&			value() &				{ assert( has_value() ); return mValue; }
+	const T&	value() const &			{ assert( has_value() ); return mValue; }
+	T&&			value() &&				{ assert( has_value() ); return std::move( mValue ); }
+	T&			operator *() &			{ return value(); }
+	const T&	operator *() const &	{ return value(); }
+	T&&			operator *() &&			{ return std::move( *this ).value(); }
+	T*			operator ->()			{ return &value(); }
+	const T*	operator ->() const		{ return &value(); }
+
+	T			value_or( T inDefault ) &&	{ return has_value() ? std::move( mValue ) : std::move( inDefault ); }
+
+private:
+	T			mValue {};
+	int16_t		mError = noErr;
+};
+
+
+template<>
+class [[nodiscard]] Result<void>
+{
+public:
+	Result() = default;
+	Result( Error inError ) : mError( inError.code ) {}
+
+	bool		has_value() const		{ return mError == noErr; }
+	explicit	operator bool() const	{ return has_value(); }
+	int16_t		error() const			{ return mError; }
+
+private:
+	int16_t		mError = noErr;
+};
+
+
+// Resource type codes:
+constexpr uint32_t	FourCharCode( const char (&inCode)[5] )
+{
+	return (static_cast<uint32_t>( static_cast<uint8_t>( inCode[0] ) ) << 24) | (static_cast<uint32_t>( static_cast<uint8_t>( inCode[1] ) ) << 16)
+			| (static_cast<uint32_t>( static_cast<uint8_t>( inCode[2] ) ) << 8) | static_cast<uint8_t>( inCode[3] );
+}
+
+// Not constexpr, so using a literal of the wrong length fails to compile:
+inline uint32_t	FourCharCodeMustHaveFourCharacters()	{ return 0; }
+
+inline namespace Literals
+{
+
+// "PICT"_fourcc is 'PICT', without the compiler warning about multi-character constants:
+constexpr uint32_t	operator ""_fourcc( const char* inCode, size_t inLength )
+{
+	return (inLength != 4) ? FourCharCodeMustHaveFourCharacters()
+			: (static_cast<uint32_t>( static_cast<uint8_t>( inCode[0] ) ) << 24) | (static_cast<uint32_t>( static_cast<uint8_t>( inCode[1] ) ) << 16)
+				| (static_cast<uint32_t>( static_cast<uint8_t>( inCode[2] ) ) << 8) | static_cast<uint8_t>( inCode[3] );
+}
+
+}
+
+
+// inString as a Pascal string, or false if it is longer than 255 characters:
+inline bool	CopyToPascalString( std::string_view inString, FakeStr255 outString )
+{
+	if( inString.size() > 255 )
+		return false;
+	outString[0] = static_cast<unsigned char>( inString.size() );
+	memcpy( outString +1, inString.data(), inString.size() );
+	return true;
+}
+
+
+// The Error of the last Resource Manager call, if it failed:
+inline Result<void>	LastResResult()
+{
+	int16_t		error = FakeResError();
+	return (error == noErr) ? Result<void>() : Result<void>( Error{ error } );
+}
+
+
+// A Handle that isn't a resource, disposed of when this goes away:
+class OwnedHandle
+{
+public:
+	OwnedHandle() = default;
+	explicit OwnedHandle( Handle inHandle ) : mHandle( inHandle ) {}	// Takes it over.
+	OwnedHandle( OwnedHandle&& inOriginal ) noexcept : mHandle( inOriginal.release() ) {}
+	OwnedHandle&	operator =( OwnedHandle&& inOriginal ) noexcept	{ reset( inOriginal.release() ); return *this; }
+	OwnedHandle( const OwnedHandle& ) = delete;
+	OwnedHandle&	operator =( const OwnedHandle& ) = delete;
+	~OwnedHandle()	{ reset(); }
+
+	static Result<OwnedHandle>	make( size_t inSize )
+	{
+		Handle	theHandle = FakeNewHandle( static_cast<long>( inSize ) );
+		return theHandle ? Result<OwnedHandle>( OwnedHandle( theHandle ) ) : Result<OwnedHandle>( Error{ memFulErr } );
+	}
+
+	static Result<OwnedHandle>	make( ByteView inData )	// A copy of inData.
+	{
+		Result<OwnedHandle>	theHandle = make( inData.size() );
+		if( theHandle && !inData.empty() )
+			memcpy( *theHandle->get(), inData.data(), inData.size() );
+		return theHandle;
+	}
+
+	Handle		get() const				{ return mHandle; }
+	explicit	operator bool() const	{ return mHandle != nullptr; }
+
+	// Stop owning the Handle and return it:
+	Handle		release()				{ Handle theHandle = mHandle; mHandle = nullptr; return theHandle; }
+
+	void		reset( Handle inHandle = nullptr )
+	{
+		if( mHandle )
+			FakeDisposeHandle( mHandle );
+		mHandle = inHandle;
+	}
+
+	size_t		size() const			{ return mHandle ? static_cast<size_t>( FakeGetHandleSize( mHandle ) ) : 0; }
+	uint8_t*	data() const			{ return mHandle ? reinterpret_cast<uint8_t*>( *mHandle ) : nullptr; }
+	ByteView	bytes() const			{ return ByteView( mHandle ); }
+
+	Result<void>	resize( size_t inSize )
+	{
+		long	error = FakeSetHandleSizeReentrant( mHandle, static_cast<long>( inSize ) );
+		return (error == noErr) ? Result<void>() : Result<void>( Error{ static_cast<int16_t>( error ) } );
+	}
+
+private:
+	Handle		mHandle = nullptr;
+};
+
+
+// A resource's Handle. Doesn't own it, the Resource Manager disposes of it
+//	when its file is closed:
+class ResHandle
+{
+public:
+	struct Info
+	{
+		int16_t		id;
+		uint32_t	type;
+		FakeStr255	name;
+	};
+
+	ResHandle() = default;
+	explicit ResHandle( Handle inResource ) : mHandle( inResource ) {}
+
+	Handle		get() const				{ return mHandle; }
+	explicit	operator bool() const	{ return mHandle != nullptr; }
+
+	// Empty if the data isn't loaded (see FakeSetResLoad()):
+	size_t		size() const			{ return (mHandle && *mHandle) ? static_cast<size_t>( FakeGetHandleSize( mHandle ) ) : 0; }
+	uint8_t*	data() const			{ return mHandle ? reinterpret_cast<uint8_t*>( *mHandle ) : nullptr; }
+	ByteView	bytes() const			{ return ByteView( mHandle ); }
+
+	Result<Info>	info() const
+	{
+		Info	theInfo = {};
+		FakeGetResInfo( mHandle, &theInfo.id, &theInfo.type, theInfo.name );
+		int16_t	error = FakeResError();
+		return (error == noErr) ? Result<Info>( std::move( theInfo ) ) : Result<Info>( Error{ error } );
+	}
+
+	Result<void>	setInfo( int16_t inID, std::string_view inName ) const
+	{
+		FakeStr255	name;
+		if( !CopyToPascalString( inName, name ) )
+			return Error{ resAttrErr };
+		FakeSetResInfo( mHandle, inID, name );
+		return LastResResult();
+	}
+
+	int16_t			homeFile() const	{ return FakeHomeResFile( mHandle ); }
+	Result<void>	load() const		{ FakeLoadResource( mHandle ); return LastResResult(); }
+	Result<void>	changed() const		{ FakeChangedResource( mHandle ); return LastResResult(); }
+	Result<void>	write() const		{ FakeWriteResource( mHandle ); return LastResResult(); }
+
+	// Empties the Handle (see FakeReleaseResource()), which stays the
+	//	Resource Manager's, and forgets it, so this is empty afterwards:
+	void			release()			{ FakeReleaseResource( mHandle ); mHandle = nullptr; }
+
+	// Removes the resource from the current file and hands you its Handle to
+	//	dispose of. Fails with resAttrErr during a transaction on the current
+	//	file, as the Handle stays the Resource Manager's until you commit it,
+	//	so use FakeRemoveResource() then.
+	Result<OwnedHandle>	remove()
+	{
+		if( FakeIsInResTransaction( FakeCurResFile() ) )
+			return Error{ resAttrErr };
+		FakeRemoveResource( mHandle );
+		int16_t	error = FakeResError();
+		if( error != noErr )
+			return Error{ error };
+		return OwnedHandle( std::exchange( mHandle, nullptr ) );
+	}
+
+private:
+	Handle		mHandle = nullptr;
+};
+
+
+// A resource file, closed when this goes away:
+class ResFile
+{
+public:
+	ResFile() = default;
+	explicit ResFile( int16_t inRefNum ) : mRefNum( inRefNum ) {}	// Takes it over.
+	ResFile( ResFile&& inOriginal ) noexcept : mRefNum( inOriginal.release() ) {}
+	ResFile&	operator =( ResFile&& inOriginal ) noexcept	{ close(); mRefNum = inOriginal.release(); return *this; }
+	ResFile( const ResFile& ) = delete;
+	ResFile&	operator =( const ResFile& ) = delete;
+	~ResFile()	{ close(); }
+
+	// Opens the file at inPath (a POSIX path) and makes it the current file:
+	static Result<ResFile>	open( std::string_view inPath )
+	{
+		FakeStr255	path;
+		if( !CopyToPascalString( inPath, path ) )
+			return Error{ fnfErr };
+		int16_t		refNum = FakeOpenResFile( path );
+		return (refNum >= 0) ? Result<ResFile>( ResFile( refNum ) ) : Result<ResFile>( Error{ refNum } );
+	}
+
+	// The same for resources at inForkOffset in a larger file:
+	static Result<ResFile>	openFork( std::string_view inPath, uint32_t inForkOffset, uint32_t inForkLength )
+	{
+		FakeStr255	path;
+		if( !CopyToPascalString( inPath, path ) )
+			return Error{ fnfErr };
+		int16_t		refNum = FakeOpenResFork( path, inForkOffset, inForkLength );
+		return (refNum >= 0) ? Result<ResFile>( ResFile( refNum ) ) : Result<ResFile>( Error{ refNum } );
+	}
+
+	int16_t		refNum() const			{ return mRefNum; }
+	explicit	operator bool() const	{ return mRefNum >= 0; }
+
+	// Stop owning the file and return its reference number:
+	int16_t		release()				{ return std::exchange( mRefNum, int16_t(-1) ); }
+
+	void		close()
+	{
+		if( mRefNum >= 0 )
+			FakeCloseResFile( mRefNum );
+		mRefNum = -1;
+	}
+
+	void			use() const			{ FakeUseResFile( mRefNum ); }
+	Result<void>	update() const		{ FakeUpdateResFile( mRefNum ); return LastResResult(); }
+
+	// See FakeSetResFileFormat():
+	FakeResFileFormat	format() const	{ return FakeGetResFileFormat( mRefNum ); }
+	Result<void>	setFormat( FakeResFileFormat inFormat ) const	{ FakeSetResFileFormat( mRefNum, inFormat ); return LastResResult(); }
+
+	// See FakeBeginResTransaction():
+	Result<void>	beginTransaction() const	{ FakeBeginResTransaction( mRefNum ); return LastResResult(); }
+	Result<void>	commitTransaction() const	{ FakeCommitResTransaction( mRefNum ); return LastResResult(); }
+	void			abortTransaction() const	{ FakeAbortResTransaction( mRefNum ); }
+	bool			inTransaction() const		{ return FakeIsInResTransaction( mRefNum ); }
+
+	// See FakeCompactResFile():
+	Result<FakeResCompactReport>	compact( const FakeResCompactOptions* inOptions = nullptr ) const
+	{
+		FakeResCompactReport	report = {};
+		FakeCompactResFile( mRefNum, inOptions, &report );
+		int16_t		error = FakeResError();
+		return (error == noErr) ? Result<FakeResCompactReport>( std::move( report ) ) : Result<FakeResCompactReport>( Error{ error } );
+	}
+
+private:
+	int16_t		mRefNum = -1;
+};
+
+
+// The Resource Manager calls that give you a resource. Like theirs, a
+//	compressed resource without a decompressor is still handed out, with
+//	FakeResError() == CantDecompress:
+
+inline Result<ResHandle>	Get1Resource( uint32_t inType, int16_t inID )
+{
+	Handle	theResource = FakeGet1Resource( inType, inID );
+	return theResource ? Result<ResHandle>( ResHandle( theResource ) ) : Result<ResHandle>( Error{ FakeResError() } );
+}
+
+
+inline Result<ResHandle>	GetResource( uint32_t inType, int16_t inID )
+{
+	Handle	theResource = FakeGetResource( inType, inID );
+	return theResource ? Result<ResHandle>( ResHandle( theResource ) ) : Result<ResHandle>( Error{ FakeResError() } );
+}
+
+
+inline Result<ResHandle>	Get1NamedResource( uint32_t inType, std::string_view inName )
+{
+	FakeStr255	name;
+	if( !CopyToPascalString( inName, name ) )
+		return Error{ resNotFound };
+	Handle	theResource = FakeGet1NamedResource( inType, name );
+	return theResource ? Result<ResHandle>( ResHandle( theResource ) ) : Result<ResHandle>( Error{ FakeResError() } );
+}
+
+
+inline Result<ResHandle>	GetNamedResource( uint32_t inType, std::string_view inName )
+{
+	FakeStr255	name;
+	if( !CopyToPascalString( inName, name ) )
+		return Error{ resNotFound };
+	Handle	theResource = FakeGetNamedResource( inType, name );
+	return theResource ? Result<ResHandle>( ResHandle( theResource ) ) : Result<ResHandle>( Error{ FakeResError() } );
+}
+
+
+inline Result<ResHandle>	Get1IndResource( uint32_t inType, int16_t inIndex )
+{
+	Handle	theResource = FakeGet1IndResource( inType, inIndex );
+	return theResource ? Result<ResHandle>( ResHandle( theResource ) ) : Result<ResHandle>( Error{ FakeResError() } );
+}
+
+
+// Adds ioData to the current file as a new resource. If that works, the
+//	Resource Manager owns the Handle now and ioData is empty. If it doesn't,
+//	ioData keeps it:
+inline Result<ResHandle>	AddResource( OwnedHandle&& ioData, uint32_t inType, int16_t inID, std::string_view inName = {} )
+{
+	FakeStr255	name;
+	if( !CopyToPascalString( inName, name ) )
+		return Error{ addResFailed };
+	FakeAddResource( ioData.get(), inType, inID, name );
+	int16_t		error = FakeResError();
+	if( error != noErr )
+		return Error{ error };
+	return ResHandle( ioData.release() );
+}
+
+}
+
+#endif
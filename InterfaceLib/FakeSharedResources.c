@@ -0,0 +1,408 @@
+//
+//  FakeSharedResources.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "FakeSharedResources.h"
+#include "FakeTrace.h"
+
+
+/*
+	Shared memory object, one per file (and fork in it):
+
+	struct FakeSharedResHeader
+	info													infoLength bytes
+	struct FakeSharedResTableEntry, sorted by key			numPayloads of them
+	payloads, each starting at a multiple of 16				...
+
+	All in the byte order of the machine, it never leaves it.
+*/
+
+#define FAKE_SHARED_RES_MAGIC			'RCLS'
+#define FAKE_SHARED_RES_VERSION			1
+#define FAKE_SHARED_RES_ALIGNMENT		16
+
+// An object that's still empty this long after it was made belongs to a
+//	process that died before it could even say who it is:
+#define FAKE_SHARED_RES_STALE_SECONDS	10
+
+
+struct FakeSharedResHeader
+{
+	uint32_t				magic;
+	uint32_t				version;
+	uint32_t				ready;			// Set last, once everything else is written.
+	int32_t					publisherPID;	// So we can tell if it died while publishing.
+	struct FakeSharedResKey	key;
+	uint64_t				totalLength;
+	uint64_t				infoOffset;
+	uint64_t				infoLength;
+	uint64_t				tableOffset;
+	uint64_t				numPayloads;
+};
+
+
+struct FakeSharedResTableEntry
+{
+	uint64_t		key;
+	uint64_t		offset;		// From the start of the object.
+	uint32_t		length;
+	uint32_t		flags;
+};
+
+
+struct FakeSharedResources
+{
+	char*									base;
+	size_t									length;
+	const struct FakeSharedResTableEntry*	table;
+	uint64_t								numPayloads;
+};
+
+
+struct FakeSharedResCopies
+{
+	size_t			length;			// Of each copy.
+	size_t			numCopies;
+	char*			copies[];		// Private mappings of the same memory.
+};
+
+
+static uint64_t	FakeAlignSharedResOffset( uint64_t inOffset )
+{
+	return (inOffset +FAKE_SHARED_RES_ALIGNMENT -1) & ~(uint64_t)(FAKE_SHARED_RES_ALIGNMENT -1);
+}
+
+
+// The object's name only depends on which file and fork it is, so a newer
+//	version of a file replaces the older one instead of piling up:
+static void	FakeGetSharedResName( const struct FakeSharedResKey* inKey, char outName[32] )
+{
+	uint64_t	parts[] = { inKey->device, inKey->inode, inKey->forkOffset, inKey->forkLength, (uint64_t)getuid() };
+	uint64_t	hash = 14695981039346656037ULL;	// FNV-1a.
+	for( size_t x = 0; x < sizeof(parts) / sizeof(parts[0]); x++ )
+	{
+		for( int y = 0; y < 64; y += 8 )
+		{
+			hash ^= (parts[x] >> y) & 0xFF;
+			hash *= 1099511628211ULL;
+		}
+	}
+	snprintf( outName, 32, "/rcl-%016llx", (unsigned long long)hash );
+}
+
+
+static bool	FakeIsSameSharedResFile( const struct FakeSharedResKey* inA, const struct FakeSharedResKey* inB )
+{
+	return inA->device == inB->device && inA->inode == inB->inode
+			&& inA->forkOffset == inB->forkOffset && inA->forkLength == inB->forkLength;
+}
+
+
+bool	FakeMakeSharedResKey( int inFD, uint64_t inForkOffset, uint64_t inForkLength, struct FakeSharedResKey* outKey )
+{
+	struct stat		fileInfo;
+	if( fstat( inFD, &fileInfo ) != 0 )
+		return false;
+
+	memset( outKey, 0, sizeof(struct FakeSharedResKey) );
+	outKey->device = (uint64_t)fileInfo.st_dev;
+	outKey->inode = (uint64_t)fileInfo.st_ino;
+	outKey->fileSize = (uint64_t)fileInfo.st_size;
+#if __APPLE__
+	outKey->modSeconds = fileInfo.st_mtimespec.tv_sec;
+	outKey->modNanoseconds = fileInfo.st_mtimespec.tv_nsec;
+#else
+	outKey->modSeconds = fileInfo.st_mtim.tv_sec;
+	outKey->modNanoseconds = fileInfo.st_mtim.tv_nsec;
+#endif
+	outKey->forkOffset = inForkOffset;
+	outKey->forkLength = inForkLength;
+	return true;
+}
+
+
+struct FakeSharedResources*	FakeAttachSharedResources( const struct FakeSharedResKey* inKey )
+{
+	char		name[32];
+	FakeGetSharedResName( inKey, name );
+	int			fd = shm_open( name, O_RDONLY, 0 );
+	if( fd < 0 )
+		return NULL;
+
+	struct stat		objectInfo;
+	if( fstat( fd, &objectInfo ) != 0 )
+	{
+		close( fd );
+		return NULL;
+	}
+	if( objectInfo.st_size < (off_t)sizeof(struct FakeSharedResHeader) )
+	{
+		if( objectInfo.st_size == 0 && (time( NULL ) -objectInfo.st_mtime) > FAKE_SHARED_RES_STALE_SECONDS )
+			shm_unlink( name );
+		close( fd );
+		return NULL;
+	}
+
+	// Private, so we can change resource data without anyone else seeing it:
+	size_t		length = (size_t)objectInfo.st_size;
+	char*		base = mmap( NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if( base == MAP_FAILED )
+		return NULL;
+
+	const struct FakeSharedResHeader*	header = (const struct FakeSharedResHeader*)base;
+	bool		usable = false;
+	if( header->magic != FAKE_SHARED_RES_MAGIC || header->version != FAKE_SHARED_RES_VERSION
+		|| !FakeIsSameSharedResFile( &header->key, inKey ) )
+		;	// Another file with the same name, or not filled in yet. Leave it alone.
+	else if( !__atomic_load_n( &header->ready, __ATOMIC_ACQUIRE ) )
+	{
+		if( header->publisherPID > 0 && kill( header->publisherPID, 0 ) != 0 && errno == ESRCH )
+		{
+			FAKE_TRACE( kFakeTraceLevelInfo, "Removing %s, process %d died while publishing it.", name, (int)header->publisherPID );
+			shm_unlink( name );
+		}
+	}
+	else if( header->key.fileSize != inKey->fileSize || header->key.modSeconds != inKey->modSeconds
+			|| header->key.modNanoseconds != inKey->modNanoseconds )
+	{
+		FAKE_TRACE( kFakeTraceLevelInfo, "Removing %s, the file changed since it was published.", name );
+		shm_unlink( name );
+	}
+	else if( header->totalLength <= length
+			&& header->infoOffset <= header->totalLength && header->infoLength <= (header->totalLength -header->infoOffset)
+			&& header->tableOffset <= header->totalLength
+			&& header->numPayloads <= ((header->totalLength -header->tableOffset) / sizeof(struct FakeSharedResTableEntry)) )
+		usable = true;
+
+	if( !usable )
+	{
+		munmap( base, length );
+		return NULL;
+	}
+
+	struct FakeSharedResources*	theShared = calloc( 1, sizeof(struct FakeSharedResources) );
+	if( !theShared )
+	{
+		munmap( base, length );
+		return NULL;
+	}
+	theShared->base = base;
+	theShared->length = (size_t)header->totalLength;
+	theShared->table = (const struct FakeSharedResTableEntry*)(base +header->tableOffset);
+	theShared->numPayloads = header->numPayloads;
+	return theShared;
+}
+
+
+void	FakeDetachSharedResources( struct FakeSharedResources* inShared )
+{
+	if( !inShared )
+		return;
+	munmap( inShared->base, inShared->length );
+	free( inShared );
+}
+
+
+const void*	FakeGetSharedResInfo( struct FakeSharedResources* inShared, size_t* outLength )
+{
+	const struct FakeSharedResHeader*	header = (const struct FakeSharedResHeader*)inShared->base;
+	*outLength = (size_t)header->infoLength;
+	return inShared->base +header->infoOffset;
+}
+
+
+char*	FakeFindSharedResPayload( struct FakeSharedResources* inShared, uint64_t inKey, uint32_t* outLength, uint32_t* outFlags )
+{
+	size_t		low = 0, high = inShared->numPayloads;
+	while( low < high )
+	{
+		size_t		middle = low +(high -low) / 2;
+		if( inShared->table[middle].key < inKey )
+			low = middle +1;
+		else
+			high = middle;
+	}
+	if( low >= inShared->numPayloads || inShared->table[low].key != inKey )
+		return NULL;
+
+	const struct FakeSharedResTableEntry*	theEntry = inShared->table +low;
+	if( theEntry->offset > inShared->length || theEntry->length > (inShared->length -theEntry->offset) )
+		return NULL;
+	*outLength = theEntry->length;
+	*outFlags = theEntry->flags;
+	return inShared->base +theEntry->offset;
+}
+
+
+static int	FakeCompareSharedResPayloads( const void* inA, const void* inB )
+{
+	uint64_t	keyA = ((const struct FakeSharedResPayload*)inA)->key;
+	uint64_t	keyB = ((const struct FakeSharedResPayload*)inB)->key;
+	return (keyA < keyB) ? -1 : ((keyA > keyB) ? 1 : 0);
+}
+
+
+bool	FakePublishSharedResources( const struct FakeSharedResKey* inKey, const void* inInfo, size_t inInfoLength,
+									struct FakeSharedResPayload* ioPayloads, size_t inCount )
+{
+	qsort( ioPayloads, inCount, sizeof(struct FakeSharedResPayload), FakeCompareSharedResPayloads );
+
+	uint64_t	infoOffset = FakeAlignSharedResOffset( sizeof(struct FakeSharedResHeader) );
+	uint64_t	tableOffset = FakeAlignSharedResOffset( infoOffset +inInfoLength );
+	uint64_t	totalLength = FakeAlignSharedResOffset( tableOffset +inCount * sizeof(struct FakeSharedResTableEntry) );
+	for( size_t x = 0; x < inCount; x++ )
+		totalLength = FakeAlignSharedResOffset( totalLength +ioPayloads[x].length );
+	if( totalLength > (uint64_t)SIZE_MAX || totalLength > (uint64_t)INT64_MAX )
+		return false;
+
+	char		name[32];
+	FakeGetSharedResName( inKey, name );
+	int			fd = shm_open( name, O_RDWR | O_CREAT | O_EXCL, 0600 );
+	if( fd < 0 )
+		return false;	// Someone else was quicker.
+
+	// Writing to memory the system can't back gets us killed, so make sure it's there first:
+	int			err = (ftruncate( fd, (off_t)totalLength ) == 0) ? 0 : errno;
+#if __linux__
+	if( err == 0 )
+		err = posix_fallocate( fd, 0, (off_t)totalLength );
+#endif
+	char*		base = (err == 0) ? mmap( NULL, (size_t)totalLength, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) : MAP_FAILED;
+	close( fd );
+	if( base == MAP_FAILED )
+	{
+		FAKE_TRACE( kFakeTraceLevelWarning, "Couldn't make %llu bytes of shared memory for %s (%d).", (unsigned long long)totalLength, name, err );
+		shm_unlink( name );
+		return false;
+	}
+
+	struct FakeSharedResHeader*		header = (struct FakeSharedResHeader*)base;
+	header->publisherPID = (int32_t)getpid();
+	header->key = *inKey;
+	header->totalLength = totalLength;
+	header->infoOffset = infoOffset;
+	header->infoLength = inInfoLength;
+	header->tableOffset = tableOffset;
+	header->numPayloads = inCount;
+	header->version = FAKE_SHARED_RES_VERSION;
+	header->magic = FAKE_SHARED_RES_MAGIC;
+	memmove( base +infoOffset, inInfo, inInfoLength );
+
+	struct FakeSharedResTableEntry*	table = (struct FakeSharedResTableEntry*)(base +tableOffset);
+	uint64_t	payloadOffset = FakeAlignSharedResOffset( tableOffset +inCount * sizeof(struct FakeSharedResTableEntry) );
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		table[x].key = ioPayloads[x].key;
+		table[x].offset = payloadOffset;
+		table[x].length = ioPayloads[x].length;
+		table[x].flags = ioPayloads[x].flags;
+		if( ioPayloads[x].length > 0 )
+			memmove( base +payloadOffset, ioPayloads[x].data, ioPayloads[x].length );
+		payloadOffset = FakeAlignSharedResOffset( payloadOffset +ioPayloads[x].length );
+	}
+
+	__atomic_store_n( &header->ready, 1, __ATOMIC_RELEASE );
+	munmap( base, (size_t)totalLength );
+
+	return true;
+}
+
+
+void	FakeRemoveSharedResources( const struct FakeSharedResKey* inKey )
+{
+	char		name[32];
+	FakeGetSharedResName( inKey, name );
+	shm_unlink( name );
+}
+
+
+struct FakeSharedResCopies*	FakeMakeSharedResCopies( const struct FakeSharedResPayload* inPayloads, size_t inCount, size_t inNumCopies, uint64_t* outOffsets )
+{
+	uint64_t	totalLength = 0;
+	for( size_t x = 0; x < inCount; x++ )
+	{
+		outOffsets[x] = totalLength;
+		totalLength = FakeAlignSharedResOffset( totalLength +inPayloads[x].length );
+	}
+	if( totalLength == 0 || inNumCopies == 0 || totalLength > (uint64_t)SIZE_MAX || totalLength > (uint64_t)INT64_MAX )
+		return NULL;
+	
+	struct FakeSharedResCopies*	theCopies = calloc( 1, sizeof(struct FakeSharedResCopies) +inNumCopies * sizeof(char*) );
+	if( !theCopies )
+		return NULL;
+	theCopies->length = (size_t)totalLength;
+	
+	// Only we use it, so the name only needs to be unique while we make it:
+	char		name[48];
+	snprintf( name, sizeof(name), "/rcl-copies-%ld-%llx", (long)getpid(), (unsigned long long)(uintptr_t)theCopies );
+	int			fd = shm_open( name, O_RDWR | O_CREAT | O_EXCL, 0600 );
+	if( fd < 0 )
+	{
+		free( theCopies );
+		return NULL;
+	}
+	shm_unlink( name );	// Goes away once the last copy is unmapped.
+	
+	int			err = (ftruncate( fd, (off_t)totalLength ) == 0) ? 0 : errno;
+#if __linux__
+	if( err == 0 )
+		err = posix_fallocate( fd, 0, (off_t)totalLength );
+#endif
+	char*		original = (err == 0) ? mmap( NULL, theCopies->length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) : MAP_FAILED;
+	if( original != MAP_FAILED )
+	{
+		for( size_t x = 0; x < inCount; x++ )
+		{
+			if( inPayloads[x].length > 0 )
+				memmove( original +outOffsets[x], inPayloads[x].data, inPayloads[x].length );
+		}
+		munmap( original, theCopies->length );
+		
+		for( ; theCopies->numCopies < inNumCopies; theCopies->numCopies++ )
+		{
+			char*	theCopy = mmap( NULL, theCopies->length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+			if( theCopy == MAP_FAILED )
+				break;
+			theCopies->copies[theCopies->numCopies] = theCopy;
+		}
+	}
+	close( fd );
+	if( theCopies->numCopies < inNumCopies )
+	{
+		FAKE_TRACE( kFakeTraceLevelWarning, "Couldn't map %zu copies of %llu bytes of shared memory (%d).", inNumCopies, (unsigned long long)totalLength, err ? err : errno );
+		FakeDisposeSharedResCopies( theCopies );
+		return NULL;
+	}
+	
+	return theCopies;
+}
+
+
+char*	FakeGetSharedResCopy( struct FakeSharedResCopies* inCopies, size_t inCopy )
+{
+	return inCopies->copies[inCopy];
+}
+
+
+void	FakeDisposeSharedResCopies( struct FakeSharedResCopies* inCopies )
+{
+	if( !inCopies )
+		return;
+	for( size_t x = 0; x < inCopies->numCopies; x++ )
+		munmap( inCopies->copies[x], inCopies->length );
+	free( inCopies );
+}
@@ -0,0 +1,112 @@
+//
+//  FakeSharedResources.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Resource data in POSIX shared memory, so processes that open the same file
+//  keep one copy of it between them. The first process to load a file
+//  publishes a description of it and all its resources' data, later ones
+//  attach to that and point their Handles into it. Each process maps it
+//  copy-on-write, so changing a resource's data only copies the pages it
+//  changes, and only for that process.
+//
+//  Published data is found by the file's device and inode, and only used
+//  while the file still has the size and modification time it had then.
+//  It stays around after all processes have quit, until the file changes
+//  and someone publishes it again, FakeRemoveSharedResources() is called,
+//  or the machine restarts.
+//
+//  The same trick gives several Handles in one process their own copies of
+//  the same data while it only takes up RAM once: FakeMakeSharedResCopies()
+//  maps unnamed shared memory several times copy-on-write.
+//
+//  None of these touch any globals, so several threads may use them at once.
+//
+
+#ifndef ReClassicfication_FakeSharedResources_h
+#define ReClassicfication_FakeSharedResources_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+struct FakeSharedResources;
+struct FakeSharedResCopies;
+
+
+// Which file, which part of it, and which version of it, published data is for:
+struct FakeSharedResKey
+{
+	uint64_t	device;
+	uint64_t	inode;
+	uint64_t	fileSize;
+	int64_t		modSeconds;
+	int64_t		modNanoseconds;
+	uint64_t	forkOffset;		// Where the resources are in the file, as the caller asked for them.
+	uint64_t	forkLength;
+};
+
+
+// The data of one resource to publish:
+struct FakeSharedResPayload
+{
+	uint64_t	key;		// How you want to find it again, e.g. its file offset. Unique.
+	const char*	data;
+	uint32_t	length;
+	uint32_t	flags;		// Whatever you want to get back along with the data.
+};
+
+
+// Private calls for internal use:
+
+// Makes the key for the file open as inFD. Returns false if we can't stat() it.
+bool	FakeMakeSharedResKey( int inFD, uint64_t inForkOffset, uint64_t inForkLength, struct FakeSharedResKey* outKey );
+
+// Maps what was published for the given key, if anything. Returns NULL if
+//	nothing was, if it's still being published, or if it's for an older
+//	version of the file, which is removed so it can be published again.
+struct FakeSharedResources*	FakeAttachSharedResources( const struct FakeSharedResKey* inKey );
+
+// Unmaps it. Don't use any data you got from it afterwards.
+void	FakeDetachSharedResources( struct FakeSharedResources* inShared );
+
+// The description of the file that was published along with the data:
+const void*	FakeGetSharedResInfo( struct FakeSharedResources* inShared, size_t* outLength );
+
+// The data published under inKey, or NULL if there isn't any. You may change
+//	the data, only your process sees that.
+char*	FakeFindSharedResPayload( struct FakeSharedResources* inShared, uint64_t inKey, uint32_t* outLength, uint32_t* outFlags );
+
+// Publishes the given info and data for inKey, unless someone else already
+//	is or did. Sorts ioPayloads by key. Returns false if it didn't publish.
+bool	FakePublishSharedResources( const struct FakeSharedResKey* inKey, const void* inInfo, size_t inInfoLength,
+									struct FakeSharedResPayload* ioPayloads, size_t inCount );
+
+// Removes whatever was published for inKey's file and fork, no matter which
+//	version of it. Processes attached to it keep their data.
+void	FakeRemoveSharedResources( const struct FakeSharedResKey* inKey );
+
+// Puts the payloads (their keys don't matter) back to back in memory only
+//	this process can see, and maps that inNumCopies times copy-on-write.
+//	outOffsets gets where each payload is in each copy. Returns NULL if
+//	there's nothing to copy or we couldn't.
+struct FakeSharedResCopies*	FakeMakeSharedResCopies( const struct FakeSharedResPayload* inPayloads, size_t inCount, size_t inNumCopies, uint64_t* outOffsets );
+
+// Start of one of the copies, you may change it:
+char*	FakeGetSharedResCopy( struct FakeSharedResCopies* inCopies, size_t inCopy );
+
+// Unmaps all copies. Don't use any data from them afterwards.
+void	FakeDisposeSharedResCopies( struct FakeSharedResCopies* inCopies );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,310 @@
+//
+//  FakeStrings.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <string.h>
+#include "FakeResources.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define FAKE_STRINGS_X86		1
+#include <immintrin.h>
+#else
+#define FAKE_STRINGS_X86		0
+#endif
+
+
+// The tables below are for Mac Roman. Lowercase letters, accented ones
+//	included, map to their uppercase forms where Mac Roman has one (it has none
+//	for the German sharp s, 0xA7). Stripping diacritics maps accented letters
+//	and the slashed O (0xAF, 0xBF) to their base letter, but leaves ligatures
+//	like AE (0xAE, 0xBE) and OE (0xCE, 0xCF) alone.
+
+// Lowercase to uppercase:
+static const uint8_t	kFakeUpperTable[256] =
+{
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+	0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+	0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+	0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+	0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+	0x60, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+	0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+	0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0xE7, 0xCB, 0xE5, 0x80, 0xCC, 0x81, 0x82, 0x83, 0xE9,
+	0xE6, 0xE8, 0xEA, 0xED, 0xEB, 0xEC, 0x84, 0xEE, 0xF1, 0xEF, 0x85, 0xCD, 0xF2, 0xF4, 0xF3, 0x86,
+	0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+	0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xAE, 0xAF,
+	0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCE,
+	0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD9, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+	0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+	0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
+};
+
+// Accented letters to their base letters:
+static const uint8_t	kFakeStripTable[256] =
+{
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+	0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+	0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+	0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+	0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+	0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+	0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+	0x41, 0x41, 0x43, 0x45, 0x4E, 0x4F, 0x55, 0x61, 0x61, 0x61, 0x61, 0x61, 0x61, 0x63, 0x65, 0x65,
+	0x65, 0x65, 0x69, 0x69, 0x69, 0x69, 0x6E, 0x6F, 0x6F, 0x6F, 0x6F, 0x6F, 0x75, 0x75, 0x75, 0x75,
+	0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0x4F,
+	0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0x6F,
+	0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0x41, 0x41, 0x4F, 0xCE, 0xCF,
+	0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0x79, 0x59, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+	0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0x41, 0x45, 0x41, 0x45, 0x45, 0x49, 0x49, 0x49, 0x49, 0x4F, 0x4F,
+	0xF0, 0x4F, 0x55, 0x55, 0x55, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
+};
+
+// Both of the above:
+static const uint8_t	kFakeStripUpperTable[256] =
+{
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+	0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+	0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+	0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+	0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+	0x60, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+	0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+	0x41, 0x41, 0x43, 0x45, 0x4E, 0x4F, 0x55, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x43, 0x45, 0x45,
+	0x45, 0x45, 0x49, 0x49, 0x49, 0x49, 0x4E, 0x4F, 0x4F, 0x4F, 0x4F, 0x4F, 0x55, 0x55, 0x55, 0x55,
+	0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0x4F,
+	0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xAE, 0x4F,
+	0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0x41, 0x41, 0x4F, 0xCE, 0xCE,
+	0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0x59, 0x59, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+	0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0x41, 0x45, 0x41, 0x45, 0x45, 0x49, 0x49, 0x49, 0x49, 0x4F, 0x4F,
+	0xF0, 0x4F, 0x55, 0x55, 0x55, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
+};
+
+// Where each character sorts for FakeRelString(): The high byte is the
+//	uppercase base letter (or the character itself if it isn't a letter), the
+//	low byte orders uppercase before lowercase and plain before accented letters
+//	and ligatures, so "a" < "B" and "A" < "a" < "a umlaut" < "b". No two characters
+//	get the same weight.
+static const uint16_t	kFakeSortWeights[256] =
+{
+	0x0000, 0x0100, 0x0200, 0x0300, 0x0400, 0x0500, 0x0600, 0x0700,
+	0x0800, 0x0900, 0x0A00, 0x0B00, 0x0C00, 0x0D00, 0x0E00, 0x0F00,
+	0x1000, 0x1100, 0x1200, 0x1300, 0x1400, 0x1500, 0x1600, 0x1700,
+	0x1800, 0x1900, 0x1A00, 0x1B00, 0x1C00, 0x1D00, 0x1E00, 0x1F00,
+	0x2000, 0x2100, 0x2200, 0x2300, 0x2400, 0x2500, 0x2600, 0x2700,
+	0x2800, 0x2900, 0x2A00, 0x2B00, 0x2C00, 0x2D00, 0x2E00, 0x2F00,
+	0x3000, 0x3100, 0x3200, 0x3300, 0x3400, 0x3500, 0x3600, 0x3700,
+	0x3800, 0x3900, 0x3A00, 0x3B00, 0x3C00, 0x3D00, 0x3E00, 0x3F00,
+	0x4000, 0x4100, 0x4200, 0x4300, 0x4400, 0x4500, 0x4600, 0x4700,
+	0x4800, 0x4900, 0x4A00, 0x4B00, 0x4C00, 0x4D00, 0x4E00, 0x4F00,
+	0x5000, 0x5100, 0x5200, 0x5300, 0x5400, 0x5500, 0x5600, 0x5700,
+	0x5800, 0x5900, 0x5A00, 0x5B00, 0x5C00, 0x5D00, 0x5E00, 0x5F00,
+	0x6000, 0x4110, 0x4210, 0x4310, 0x4410, 0x4510, 0x4610, 0x4710,
+	0x4810, 0x4910, 0x4A10, 0x4B10, 0x4C10, 0x4D10, 0x4E10, 0x4F10,
+	0x5010, 0x5110, 0x5210, 0x5310, 0x5410, 0x5510, 0x5610, 0x5710,
+	0x5810, 0x5910, 0x5A10, 0x7B00, 0x7C00, 0x7D00, 0x7E00, 0x7F00,
+	0x4104, 0x4106, 0x4301, 0x4501, 0x4E01, 0x4F04, 0x5504, 0x4111,
+	0x4112, 0x4113, 0x4114, 0x4115, 0x4116, 0x4311, 0x4511, 0x4512,
+	0x4513, 0x4514, 0x4911, 0x4912, 0x4913, 0x4914, 0x4E11, 0x4F11,
+	0x4F12, 0x4F13, 0x4F14, 0x4F15, 0x5511, 0x5512, 0x5513, 0x5514,
+	0xA000, 0xA100, 0xA200, 0xA300, 0xA400, 0xA500, 0xA600, 0x5321,
+	0xA800, 0xA900, 0xAA00, 0xAB00, 0xAC00, 0xAD00, 0x4120, 0x4F06,
+	0xB000, 0xB100, 0xB200, 0xB300, 0xB400, 0xB500, 0xB600, 0xB700,
+	0xB800, 0xB900, 0xBA00, 0xBB00, 0xBC00, 0xBD00, 0x4121, 0x4F16,
+	0xC000, 0xC100, 0xC200, 0xC300, 0xC400, 0xC500, 0xC600, 0xC700,
+	0xC800, 0xC900, 0xCA00, 0x4102, 0x4105, 0x4F05, 0x4F20, 0x4F21,
+	0xD000, 0xD100, 0xD200, 0xD300, 0xD400, 0xD500, 0xD600, 0xD700,
+	0x5911, 0x5901, 0xDA00, 0xDB00, 0xDC00, 0xDD00, 0xDE00, 0xDF00,
+	0xE000, 0xE100, 0xE200, 0xE300, 0xE400, 0x4103, 0x4503, 0x4101,
+	0x4504, 0x4502, 0x4901, 0x4903, 0x4904, 0x4902, 0x4F01, 0x4F03,
+	0xF000, 0x4F02, 0x5501, 0x5503, 0x5502, 0xF500, 0xF600, 0xF700,
+	0xF800, 0xF900, 0xFA00, 0xFB00, 0xFC00, 0xFD00, 0xFE00, 0xFF00
+};
+
+
+// NULL means compare the bytes as they are:
+static const uint8_t*	FakeFoldTable( bool caseSens, bool diacSens )
+{
+	if( caseSens )
+		return diacSens ? NULL : kFakeStripTable;
+	else
+		return diacSens ? kFakeUpperTable : kFakeStripUpperTable;
+}
+
+
+// Subtract 0x20 from the plain ASCII lowercase letters in a word of 8 chars
+//	that are all below 128:
+static inline uint64_t	FakeUpperASCII8( uint64_t inChars )
+{
+	uint64_t	fromA = inChars +0x1F1F1F1F1F1F1F1FULL;	// High bit set for 'a' and up.
+	uint64_t	pastZ = inChars +0x0505050505050505ULL;	// High bit set for '{' and up.
+	return inChars -(((fromA & ~pastZ) & 0x8080808080808080ULL) >> 2);
+}
+
+
+static size_t	FakeFirstFoldedDifferenceByChar( const uint8_t* inStr1, const uint8_t* inStr2, size_t inLength, const uint8_t* inFold )
+{
+	for( size_t x = 0; x < inLength; x++ )
+	{
+		if( inFold ? (inFold[inStr1[x]] != inFold[inStr2[x]]) : (inStr1[x] != inStr2[x]) )
+			return x;
+	}
+	return inLength;
+}
+
+
+#if FAKE_STRINGS_X86
+
+// Index of the first of 16 characters that differ once folded, 16 if none do:
+static inline size_t	FakeFirstFoldedDifference16( const uint8_t* inStr1, const uint8_t* inStr2, const uint8_t* inFold, bool inFoldCase )
+{
+	__m128i		chars1 = _mm_loadu_si128( (const __m128i*)inStr1 );
+	__m128i		chars2 = _mm_loadu_si128( (const __m128i*)inStr2 );
+	if( inFold && _mm_movemask_epi8( _mm_or_si128( chars1, chars2 ) ) != 0 )	// Characters above 127 need the tables.
+		return FakeFirstFoldedDifferenceByChar( inStr1, inStr2, 16, inFold );
+	if( inFoldCase )
+	{
+		// Shifted so 'a' is -128, 'a' to 'z' are the bytes that end up below -128 +26:
+		__m128i		lowerStart = _mm_set1_epi8( (char)(128 -'a') ), lowerEnd = _mm_set1_epi8( -128 +26 ), caseBit = _mm_set1_epi8( 0x20 );
+		chars1 = _mm_sub_epi8( chars1, _mm_and_si128( _mm_cmplt_epi8( _mm_add_epi8( chars1, lowerStart ), lowerEnd ), caseBit ) );
+		chars2 = _mm_sub_epi8( chars2, _mm_and_si128( _mm_cmplt_epi8( _mm_add_epi8( chars2, lowerStart ), lowerEnd ), caseBit ) );
+	}
+	unsigned	differentMask = ~(unsigned)_mm_movemask_epi8( _mm_cmpeq_epi8( chars1, chars2 ) ) & 0xFFFF;
+	return differentMask ? (size_t)__builtin_ctz( differentMask ) : 16;
+}
+
+#endif // FAKE_STRINGS_X86
+
+
+// Index of the first of 8 characters that differ once folded, 8 if none do:
+static inline size_t	FakeFirstFoldedDifference8( const uint8_t* inStr1, const uint8_t* inStr2, const uint8_t* inFold, bool inFoldCase )
+{
+	uint64_t	chars1 = 0, chars2 = 0;
+	memcpy( &chars1, inStr1, 8 );
+	memcpy( &chars2, inStr2, 8 );
+	if( chars1 == chars2 )
+		return 8;
+	if( inFoldCase && ((chars1 | chars2) & 0x8080808080808080ULL) == 0 && FakeUpperASCII8( chars1 ) == FakeUpperASCII8( chars2 ) )
+		return 8;
+	return FakeFirstFoldedDifferenceByChar( inStr1, inStr2, 8, inFold );
+}
+
+
+// Index of the first character where inStr1 and inStr2 differ once folded
+//	with inFold, inLength if they don't. Plain ASCII is compared 16 or 8 chars
+//	at a time, only characters above 127 need the tables. The last block
+//	overlaps the one before instead of leaving single characters to compare:
+static size_t	FakeFirstFoldedDifference( const uint8_t* inStr1, const uint8_t* inStr2, size_t inLength, const uint8_t* inFold )
+{
+	bool	foldCase = (inFold == kFakeUpperTable || inFold == kFakeStripUpperTable);	// Stripping doesn't change plain ASCII.
+	size_t	x = 0, y = 0;
+#if FAKE_STRINGS_X86
+	if( inLength >= 16 )
+	{
+		for( ; (x +16) < inLength; x += 16 )
+		{
+			if( (y = FakeFirstFoldedDifference16( inStr1 +x, inStr2 +x, inFold, foldCase )) < 16 )
+				return x +y;
+		}
+		x = inLength -16;
+		y = FakeFirstFoldedDifference16( inStr1 +x, inStr2 +x, inFold, foldCase );
+		return (y < 16) ? (x +y) : inLength;
+	}
+#endif
+	if( inLength >= 8 )
+	{
+		for( ; (x +8) < inLength; x += 8 )
+		{
+			if( (y = FakeFirstFoldedDifference8( inStr1 +x, inStr2 +x, inFold, foldCase )) < 8 )
+				return x +y;
+		}
+		x = inLength -8;
+		y = FakeFirstFoldedDifference8( inStr1 +x, inStr2 +x, inFold, foldCase );
+		return (y < 8) ? (x +y) : inLength;
+	}
+	return FakeFirstFoldedDifferenceByChar( inStr1, inStr2, inLength, inFold );
+}
+
+
+bool	FakeEqualString( const unsigned char* inStr1, const unsigned char* inStr2, bool caseSens, bool diacSens )
+{
+	if( inStr1[0] != inStr2[0] )
+		return false;
+	return FakeFirstFoldedDifference( inStr1 +1, inStr2 +1, inStr1[0], FakeFoldTable( caseSens, diacSens ) ) == inStr1[0];
+}
+
+
+int16_t	FakeRelString( const unsigned char* inStr1, const unsigned char* inStr2, bool caseSens, bool diacSens )
+{
+	const uint8_t*	fold = FakeFoldTable( caseSens, diacSens );
+	size_t			commonLength = (inStr1[0] < inStr2[0]) ? inStr1[0] : inStr2[0];
+	size_t			x = FakeFirstFoldedDifference( inStr1 +1, inStr2 +1, commonLength, fold );
+	if( x < commonLength )
+	{
+		uint8_t		char1 = fold ? fold[inStr1[1 +x]] : inStr1[1 +x];
+		uint8_t		char2 = fold ? fold[inStr2[1 +x]] : inStr2[1 +x];
+		return (kFakeSortWeights[char1] < kFakeSortWeights[char2]) ? -1 : 1;
+	}
+	
+	if( inStr1[0] == inStr2[0] )
+		return 0;
+	return (inStr1[0] < inStr2[0]) ? -1 : 1;	// A string sorts before any longer one it starts.
+}
+
+
+int16_t	FakeIUCompString( const unsigned char* inStr1, const unsigned char* inStr2 )
+{
+	int16_t		result = FakeRelString( inStr1, inStr2, false, false );
+	if( result == 0 )
+		result = FakeRelString( inStr1, inStr2, true, true );	// Only case or accents differ.
+	return result;
+}
+
+
+void	FakeUpperString( unsigned char* ioString, bool diacSens )
+{
+	const uint8_t*	fold = diacSens ? kFakeUpperTable : kFakeStripUpperTable;
+	for( size_t x = 1; x <= ioString[0]; x++ )
+		ioString[x] = fold[ioString[x]];
+}
+
+
+char*	FakeP2CStr( unsigned char* ioString )
+{
+	size_t		length = ioString[0];
+	memmove( ioString, ioString +1, length );
+	ioString[length] = 0;
+	return (char*)ioString;
+}
+
+
+unsigned char*	FakeC2PStr( char* ioString )
+{
+	size_t		length = strlen( ioString );
+	if( length > 255 )
+		length = 255;
+	memmove( ioString +1, ioString, length );
+	ioString[0] = (char)length;
+	return (unsigned char*)ioString;
+}
+
+
+void	FakeCopyPascalStringToC( const unsigned char* inPString, char* outCString )
+{
+	size_t		length = inPString[0];
+	memmove( outCString, inPString +1, length );
+	outCString[length] = 0;
+}
+
+
+void	FakeCopyCStringToPascal( const char* inCString, unsigned char* outPString )
+{
+	size_t		length = strnlen( inCString, 255 );
+	memmove( outPString +1, inCString, length );
+	outPString[0] = (unsigned char)length;
+}
@@ -0,0 +1,59 @@
+//
+//  FakeThreads.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "FakeThreads.h"
+
+
+#define FAKE_MAX_THREADS		64
+
+
+struct FakeParallelJob
+{
+	size_t				count;
+	size_t				nextIndex;		// Next index a thread should work on. Only use atomically.
+	FakeParallelProc	proc;
+	void*				refCon;
+};
+
+
+static void*	FakeParallelWorker( void* inJob )
+{
+	struct FakeParallelJob*	theJob = inJob;
+	size_t					currIndex = 0;
+	
+	while( (currIndex = __atomic_fetch_add( &theJob->nextIndex, 1, __ATOMIC_RELAXED )) < theJob->count )
+		theJob->proc( currIndex, theJob->refCon );
+	
+	return NULL;
+}
+
+
+void	FakeRunParallel( size_t inCount, int inNumThreads, FakeParallelProc inProc, void* inRefCon )
+{
+	struct FakeParallelJob	theJob = { inCount, 0, inProc, inRefCon };
+	pthread_t				threads[FAKE_MAX_THREADS];
+	int						numThreads = 0;
+	
+	if( inNumThreads > FAKE_MAX_THREADS )
+		inNumThreads = FAKE_MAX_THREADS;
+	if( (size_t)inNumThreads > inCount )
+		inNumThreads = (int)inCount;
+	
+	// The calling thread does its share of the work, so start one thread less:
+	for( int x = 1; x < inNumThreads; x++ )
+	{
+		if( pthread_create( &threads[numThreads], NULL, FakeParallelWorker, &theJob ) == 0 )
+			numThreads++;
+	}
+	
+	FakeParallelWorker( &theJob );
+	
+	for( int x = 0; x < numThreads; x++ )
+		pthread_join( threads[x], NULL );
+}
@@ -0,0 +1,33 @@
+//
+//  FakeThreads.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#ifndef ReClassicfication_FakeThreads_h
+#define ReClassicfication_FakeThreads_h
+
+#include <stddef.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+// Called once for every index from 0 to inCount -1, possibly from several threads at once:
+typedef void (*FakeParallelProc)( size_t inIndex, void* inRefCon );
+
+
+// Private calls for internal use:
+
+// Runs inProc for all indexes on up to inNumThreads threads (including the
+//	calling one) and returns once all of them are done:
+void FakeRunParallel( size_t inCount, int inNumThreads, FakeParallelProc inProc, void* inRefCon );
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
@@ -0,0 +1,75 @@
+//
+//  FakeTrace.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+#include "FakeTrace.h"
+
+
+int							gFakeTraceLevel = kFakeTraceLevelWarning;
+FakeTraceEventProc			gFakeTraceEventProc = NULL;
+void*						gFakeTraceEventRefCon = NULL;
+FakeTraceMessageProc		gFakeTraceMessageProc = NULL;
+void*						gFakeTraceMessageRefCon = NULL;
+
+
+void	FakeSetTraceLevel( int inLevel )
+{
+	gFakeTraceLevel = inLevel;
+}
+
+
+int		FakeGetTraceLevel( void )
+{
+	return gFakeTraceLevel;
+}
+
+
+void	FakeSetTraceMessageProc( FakeTraceMessageProc inProc, void* inRefCon )
+{
+	gFakeTraceMessageProc = inProc;
+	gFakeTraceMessageRefCon = inRefCon;
+}
+
+
+void	FakeSetTraceEventProc( FakeTraceEventProc inProc, void* inRefCon )
+{
+	gFakeTraceEventRefCon = inRefCon;
+	gFakeTraceEventProc = inProc;
+}
+
+
+void	FakeTraceMessage( int inLevel, const char* inFormat, ... )
+{
+	char		message[1024];
+	va_list		args;
+	va_start( args, inFormat );
+	vsnprintf( message, sizeof(message), inFormat, args );
+	va_end( args );
+	
+	if( gFakeTraceMessageProc )
+		gFakeTraceMessageProc( inLevel, message, gFakeTraceMessageRefCon );
+	else
+		fprintf( stderr, "%s\n", message );
+}
+
+
+void	FakeTraceSendEvent( const struct FakeTraceEvent* inEvent )
+{
+	FakeTraceEventProc	theProc = gFakeTraceEventProc;
+	if( theProc )
+		theProc( inEvent, gFakeTraceEventRefCon );
+}
+
+
+double	FakeTraceCurrentTime( void )
+{
+	struct timespec	now = {0};
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,121 @@
+//
+//  FakeTrace.h
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Diagnostic messages and structured trace events for InterfaceLib.
+//
+//  Messages have a level. Anything above FAKE_TRACE_COMPILED_LEVEL is compiled
+//  out entirely, anything above the level passed to FakeSetTraceLevel() costs
+//  one comparison. Trace events only cost a NULL check until somebody calls
+//  FakeSetTraceEventProc(), and can be compiled out with FAKE_TRACE_EVENTS 0.
+//
+
+#ifndef ReClassicfication_FakeTrace_h
+#define ReClassicfication_FakeTrace_h
+
+#include <stdint.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+// Levels for FakeSetTraceLevel() and FAKE_TRACE_COMPILED_LEVEL. These are
+//	#defines so the preprocessor can compare them:
+#define kFakeTraceLevelNone		0
+#define kFakeTraceLevelError	1
+#define kFakeTraceLevelWarning	2
+#define kFakeTraceLevelInfo		3
+#define kFakeTraceLevelDebug	4
+
+// Messages more detailed than this aren't even compiled in:
+#ifndef FAKE_TRACE_COMPILED_LEVEL
+#if NDEBUG
+#define FAKE_TRACE_COMPILED_LEVEL	kFakeTraceLevelInfo
+#else
+#define FAKE_TRACE_COMPILED_LEVEL	kFakeTraceLevelDebug
+#endif
+#endif
+
+// Set to 0 to compile out all trace events:
+#ifndef FAKE_TRACE_EVENTS
+#define FAKE_TRACE_EVENTS		1
+#endif
+
+
+enum FakeTraceEventKind
+{
+	kFakeTraceFileOpenBegin,	// name = path.
+	kFakeTraceFileOpenEnd,		// refNum, error, duration.
+	kFakeTraceMapParsed,		// count = number of resources, byteCount = map length, duration.
+	kFakeTraceResourceLoaded,	// resID, offset, byteCount = data size, error.
+	kFakeTraceBytesRead,		// offset, byteCount = bytes actually read.
+	kFakeTraceSeek,				// offset.
+	kFakeTraceSaveBegin,		// refNum.
+	kFakeTraceSavePhase,		// refNum, name = phase, duration.
+	kFakeTraceSaveEnd,			// refNum, byteCount = new file size, count = number of seeks, error, duration.
+	kFakeTraceResourceEvicted	// byteCount = size of the data freed.
+};
+
+
+// Fields that don't apply to a particular kind of event are 0 (or NULL):
+struct FakeTraceEvent
+{
+	enum FakeTraceEventKind	kind;
+	int16_t					refNum;
+	int16_t					resID;
+	int16_t					error;
+	int64_t					offset;
+	int64_t					byteCount;
+	int64_t					count;
+	double					duration;	// In seconds.
+	const char*				name;
+};
+
+
+// Loading resources may happen on several threads, so both kinds of
+//	callbacks may be called from threads other than the one that made the call:
+typedef void (*FakeTraceMessageProc)( int inLevel, const char* inMessage, void* inRefCon );
+typedef void (*FakeTraceEventProc)( const struct FakeTraceEvent* inEvent, void* inRefCon );
+
+
+// Only messages of this level or lower are passed to the message proc.
+//	Defaults to kFakeTraceLevelWarning:
+void	FakeSetTraceLevel( int inLevel );
+int		FakeGetTraceLevel( void );
+
+// Pass NULL to print messages to stderr (the default):
+void	FakeSetTraceMessageProc( FakeTraceMessageProc inProc, void* inRefCon );
+
+// Pass NULL to turn off trace events again (the default):
+void	FakeSetTraceEventProc( FakeTraceEventProc inProc, void* inRefCon );
+
+
+// Private calls for internal use:
+
+extern int					gFakeTraceLevel;
+extern FakeTraceEventProc	gFakeTraceEventProc;
+
+void	FakeTraceMessage( int inLevel, const char* inFormat, ... ) __attribute__((format(printf, 2, 3)));
+void	FakeTraceSendEvent( const struct FakeTraceEvent* inEvent );
+double	FakeTraceCurrentTime( void );	// Seconds, for durations.
+
+#define FAKE_TRACE( level, ... )	do { if( (level) <= FAKE_TRACE_COMPILED_LEVEL && (level) <= gFakeTraceLevel ) FakeTraceMessage( (level), __VA_ARGS__ ); } while( 0 )
+
+#if FAKE_TRACE_EVENTS
+#define FAKE_TRACE_EVENTS_ON()		(gFakeTraceEventProc != NULL)
+// Takes the kind and designated initializers for the other fields of a FakeTraceEvent:
+#define FAKE_TRACE_EVENT( theKind, ... )	do { if( gFakeTraceEventProc ) { struct FakeTraceEvent theEvent_ = { .kind = (theKind), __VA_ARGS__ }; FakeTraceSendEvent( &theEvent_ ); } } while( 0 )
+#else
+#define FAKE_TRACE_EVENTS_ON()		0
+#define FAKE_TRACE_EVENT( theKind, ... )	do {} while( 0 )
+#endif
+
+
+#if __cplusplus
+};
+#endif
+
+#endif
@@ -137,8 +137,7 @@
 
 		FakeGetResInfo(resHandle, &theID, &theType, &resName);
 
-		memcpy(name, &resName[1], resName[0]);
-		name[name[0]+1] = '\0';
+		FakeCopyPascalStringToC(resName, name);
 		
 		printf("  - theID = %d, theType = 0x%04x, name = \"%s\"\n", theID, theType, name);
 	}
@@ -158,8 +157,7 @@
 
 		FakeGetResInfo(resHandle, &theID, &theType, &resName);
 		
-		memcpy(name, &resName[1], resName[0]);
-		name[name[0]+1] = '\0';
+		FakeCopyPascalStringToC(resName, name);
 		
 		printf("  - theID = %d, theType = 0x%04x, name = \"%s\", value = 0x%04x\n", theID, theType, name, *(uint32*)*resHandle);
 	}
@@ -175,8 +173,7 @@
 
 		FakeGetResInfo(resHandle, &theID, &theType, &resName);
 
-		memcpy(name, &resName[1], resName[0]);
-		name[name[0]+1] = '\0';
+		FakeCopyPascalStringToC(resName, name);
 		
 		printf("  - theID = %d, theType = 0x%04x, name = \"%s\", value = 0x%04x\n", theID, theType, name, *(uint32*)*resHandle);
 	}
@@ -0,0 +1,311 @@
+//
+//  ResFileTests.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Saves, reopens and compares the contents of generated resource files: in
+//  the classic and extended formats, with all resources removed, after
+//  committing and aborting transactions, and after saves that failed, which
+//  must leave the file as it was. Run by ctest, takes the path prefix for its
+//  files as argument.
+//
+//  Prints each check that failed, returns 1 if any did.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include "FakeResources.h"
+#include "ResFileGenerator.h"
+
+
+#define RCL_CHECK(cond)		RCLCheck( (cond), #cond, __FILE__, __LINE__ )
+
+
+static int		gNumFailures = 0;
+static char		gFilePath[256];
+
+
+static bool	RCLCheck( bool inPassed, const char* inCondition, const char* inFile, int inLine )
+{
+	if( !inPassed )
+	{
+		fprintf( stderr, "%s:%d: check failed: %s\n", inFile, inLine, inCondition );
+		gNumFailures++;
+	}
+	return inPassed;
+}
+
+
+static int16_t	RCLOpenTestFile( void )
+{
+	FakeStr255	path;
+	FakeCopyCStringToPascal( gFilePath, path );
+	return FakeOpenResFile( path );
+}
+
+
+// Writes a new test file and opens it:
+static int16_t	RCLOpenNewTestFile( void )
+{
+	struct RCLResFileSpec	spec = { .numTypes = 3, .resourcesPerType = 8, .minDataSize = 0, .maxDataSize = 2000,
+										.sizeDistribution = RCLSizeExponential, .namedFraction = 0.5, .seed = 7 };
+	if( !RCLWriteResFile( gFilePath, &spec ) )
+		return -1;
+	return RCLOpenTestFile();
+}
+
+
+static uint64_t	RCLHashBytes( uint64_t inHash, const void* inBytes, size_t inLength )
+{
+	for( size_t x = 0; x < inLength; x++ )
+		inHash = (inHash ^ ((const uint8_t*)inBytes)[x]) * 1099511628211ULL;
+	return inHash;
+}
+
+
+// Type, ID, name and data of all resources in the current file, in any order:
+static uint64_t	RCLHashCurrentResFile( void )
+{
+	uint64_t	sum = (uint64_t)FakeCount1Types();
+	for( int16_t t = 1; t <= FakeCount1Types(); t++ )
+	{
+		uint32_t	theType = 0;
+		FakeGet1IndType( &theType, t );
+		for( int16_t r = 1; r <= FakeCount1Resources( theType ); r++ )
+		{
+			Handle		theResource = FakeGet1IndResource( theType, r );
+			int16_t		theID = 0;
+			FakeStr255	theName = { 0 };
+			if( !RCL_CHECK( theResource != NULL ) )
+				return 0;
+			FakeLoadResource( theResource );
+			FakeGetResInfo( theResource, &theID, &theType, theName );
+			uint64_t	hash = 14695981039346656037ULL;
+			hash = RCLHashBytes( hash, &theType, sizeof(theType) );
+			hash = RCLHashBytes( hash, &theID, sizeof(theID) );
+			hash = RCLHashBytes( hash, theName, theName[0] +1 );
+			if( *theResource )
+				hash = RCLHashBytes( hash, *theResource, (size_t)FakeGetHandleSize( theResource ) );
+			sum += hash;
+		}
+	}
+	return sum;
+}
+
+
+// Makes a few edits to the current file: a new resource, one removed, one
+//	renamed. Returns the removed resource's Handle, which is the caller's to
+//	dispose of once the removal is made:
+static Handle	RCLEditCurrentResFile( void )
+{
+	FakeStr255	newName = { 3, 'N', 'e', 'w' };
+	Handle		newResource = FakeNewHandle( 300 );
+	memset( *newResource, 0xA5, 300 );
+	FakeAddResource( newResource, 'NEW ', 128, newName );
+	RCL_CHECK( FakeResError() == noErr );
+
+	Handle		removedResource = FakeGet1Resource( RCLGeneratedResType( 0 ), 129 );
+	FakeRemoveResource( removedResource );
+	RCL_CHECK( FakeResError() == noErr );
+
+	FakeStr255	renamed = { 7, 'R', 'e', 'n', 'a', 'm', 'e', 'd' };
+	FakeSetResInfo( FakeGet1Resource( RCLGeneratedResType( 1 ), 130 ), 1000, renamed );
+	RCL_CHECK( FakeResError() == noErr );
+	return removedResource;
+}
+
+
+// Saving and reopening gives the same resources, in the same format:
+static void	RCLTestSaveAndReopen( enum FakeResFileFormat inFormat )
+{
+	int16_t		refNum = RCLOpenNewTestFile();
+	if( !RCL_CHECK( refNum >= 0 ) )
+		return;
+	FakeSetResFileFormat( refNum, inFormat );
+	FakeDisposeHandle( RCLEditCurrentResFile() );
+	FakeUpdateResFile( refNum );
+	RCL_CHECK( FakeResError() == noErr );
+	uint64_t	savedHash = RCLHashCurrentResFile();
+	FakeCloseResFile( refNum );
+
+	refNum = RCLOpenTestFile();
+	if( !RCL_CHECK( refNum >= 0 ) )
+		return;
+	RCL_CHECK( FakeGetResFileFormat( refNum ) == inFormat );
+	RCL_CHECK( RCLHashCurrentResFile() == savedHash );
+	FakeCloseResFile( refNum );
+}
+
+
+// A file whose resources were all removed still opens, with no types:
+static void	RCLTestEmptyMap( enum FakeResFileFormat inFormat )
+{
+	int16_t		refNum = RCLOpenNewTestFile();
+	if( !RCL_CHECK( refNum >= 0 ) )
+		return;
+	FakeSetResFileFormat( refNum, inFormat );
+	uint32_t	theType = 0;
+	while( FakeCount1Types() > 0 )
+	{
+		FakeGet1IndType( &theType, 1 );
+		Handle	theResource = FakeGet1IndResource( theType, 1 );
+		FakeRemoveResource( theResource );
+		if( !RCL_CHECK( FakeResError() == noErr ) )
+			break;
+		FakeDisposeHandle( theResource );
+	}
+	FakeCloseResFile( refNum );
+
+	refNum = RCLOpenTestFile();
+	if( !RCL_CHECK( refNum >= 0 ) )
+		return;
+	RCL_CHECK( FakeCount1Types() == 0 );
+	RCL_CHECK( FakeGetResFileFormat( refNum ) == inFormat );
+	FakeCloseResFile( refNum );
+}
+
+
+// A committed transaction ends up in the file, an aborted one changes nothing:
+static void	RCLTestTransaction( bool inCommit )
+{
+	int16_t		refNum = RCLOpenNewTestFile();
+	if( !RCL_CHECK( refNum >= 0 ) )
+		return;
+	uint64_t	originalHash = RCLHashCurrentResFile();
+	FakeBeginResTransaction( refNum );
+	RCL_CHECK( FakeResError() == noErr );
+	Handle		removedResource = RCLEditCurrentResFile();
+
+	uint64_t	expectedHash = originalHash;
+	if( inCommit )
+	{
+		FakeCommitResTransaction( refNum );
+		RCL_CHECK( FakeResError() == noErr );
+		FakeDisposeHandle( removedResource );
+		expectedHash = RCLHashCurrentResFile();
+		RCL_CHECK( expectedHash != originalHash );
+		RCL_CHECK( FakeCount1Resources( 'NEW ' ) == 1 );
+	}
+	else
+	{
+		FakeAbortResTransaction( refNum );
+		RCL_CHECK( FakeResError() == noErr );
+		RCL_CHECK( RCLHashCurrentResFile() == originalHash );
+	}
+	FakeCloseResFile( refNum );
+
+	refNum = RCLOpenTestFile();
+	if( !RCL_CHECK( refNum >= 0 ) )
+		return;
+	RCL_CHECK( RCLHashCurrentResFile() == expectedHash );
+	FakeCloseResFile( refNum );
+}
+
+
+// A commit whose save fails, because the data after a 17 MB resource is
+//	beyond the 16 MB offsets of a classic file can reach, leaves the file as
+//	it was:
+static void	RCLTestFailedSave( void )
+{
+	int16_t		refNum = RCLOpenNewTestFile();
+	if( !RCL_CHECK( refNum >= 0 ) )
+		return;
+	uint64_t	originalHash = RCLHashCurrentResFile();
+	FakeStr255	emptyName = { 0 };
+	Handle		hugeResource = FakeNewHandle( 17 * 1024 * 1024 );
+	Handle		resourceAfter = FakeNewHandle( 16 );
+	if( !RCL_CHECK( hugeResource != NULL && resourceAfter != NULL ) )
+		return;
+	FakeBeginResTransaction( refNum );
+	FakeAddResource( hugeResource, 'HUGE', 128, emptyName );
+	FakeAddResource( resourceAfter, 'HUGE', 129, emptyName );
+	FakeCommitResTransaction( refNum );
+	RCL_CHECK( FakeResError() != noErr );
+
+	int16_t		otherRefNum = RCLOpenTestFile();	// What's in the file, not in RAM.
+	if( RCL_CHECK( otherRefNum >= 0 ) )
+	{
+		RCL_CHECK( RCLHashCurrentResFile() == originalHash );
+		FakeCloseResFile( otherRefNum );
+	}
+
+	FakeUseResFile( refNum );
+	FakeRemoveResource( hugeResource );		// So closing can save the rest.
+	FakeDisposeHandle( hugeResource );
+	FakeRemoveResource( resourceAfter );
+	FakeDisposeHandle( resourceAfter );
+	FakeCloseResFile( refNum );
+}
+
+
+// A commit whose new file can't be written completely, because it would be
+//	larger than we may write, leaves the old file in place:
+static void	RCLTestFailedWrite( void )
+{
+	int16_t		refNum = RCLOpenNewTestFile();
+	if( !RCL_CHECK( refNum >= 0 ) )
+		return;
+	uint64_t	originalHash = RCLHashCurrentResFile();
+	FakeBeginResTransaction( refNum );
+	Handle		removedResource = RCLEditCurrentResFile();
+
+	struct rlimit	oldLimit, smallLimit = { 1024, 1024 };
+	getrlimit( RLIMIT_FSIZE, &oldLimit );
+	smallLimit.rlim_max = oldLimit.rlim_max;
+	signal( SIGXFSZ, SIG_IGN );		// Make writes beyond the limit fail instead of killing us.
+	setrlimit( RLIMIT_FSIZE, &smallLimit );
+	FakeCommitResTransaction( refNum );
+	int16_t		err = FakeResError();
+	setrlimit( RLIMIT_FSIZE, &oldLimit );
+	signal( SIGXFSZ, SIG_DFL );
+	RCL_CHECK( err != noErr );
+	FakeDisposeHandle( removedResource );	// The map changed, only saving it failed.
+
+	int16_t		otherRefNum = RCLOpenTestFile();
+	if( RCL_CHECK( otherRefNum >= 0 ) )
+	{
+		RCL_CHECK( RCLHashCurrentResFile() == originalHash );
+		FakeCloseResFile( otherRefNum );
+	}
+
+	FakeUseResFile( refNum );
+	uint64_t	committedHash = RCLHashCurrentResFile();	// Still in RAM, so saving again works.
+	FakeUpdateResFile( refNum );
+	RCL_CHECK( FakeResError() == noErr );
+	FakeCloseResFile( refNum );
+	refNum = RCLOpenTestFile();
+	if( !RCL_CHECK( refNum >= 0 ) )
+		return;
+	RCL_CHECK( RCLHashCurrentResFile() == committedHash );
+	FakeCloseResFile( refNum );
+}
+
+
+int	main( int argc, const char** argv )
+{
+	const char*		pathPrefix = (argc > 1) ? argv[1] : "/tmp/ResFileTests";
+	if( strlen( pathPrefix ) > 200 )
+	{
+		fprintf( stderr, "Usage: %s [<path prefix>]\n", argv[0] );
+		return 1;
+	}
+	snprintf( gFilePath, sizeof(gFilePath), "%s.rsrc", pathPrefix );
+
+	RCLTestSaveAndReopen( kFakeResFileClassic );
+	RCLTestSaveAndReopen( kFakeResFileExtended );
+	RCLTestEmptyMap( kFakeResFileClassic );
+	RCLTestEmptyMap( kFakeResFileExtended );
+	RCLTestTransaction( true );
+	RCLTestTransaction( false );
+	RCLTestFailedSave();
+	RCLTestFailedWrite();
+
+	remove( gFilePath );
+	if( gNumFailures > 0 )
+		fprintf( stderr, "%d checks failed.\n", gNumFailures );
+	return (gNumFailures == 0) ? 0 : 1;
+}
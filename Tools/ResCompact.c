@@ -0,0 +1,133 @@
+//
+//  ResCompact.c
+//  ReClassicfication
+//
+//  Copyright (c) 2026 Uli Kusterer. All rights reserved.
+//
+//  Rewrites a resource file with FakeCompactResFile(), so the resources read
+//  right after opening it lie next to each other, and says how much reading
+//  them took before and after.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FakeResources.h"
+
+
+#define MAX_TYPES_IN_ORDER	64
+
+
+static void	PrintUsage( const char* inToolName )
+{
+	fprintf( stderr, "Usage: %s [--no-profile] [--types <TYPE>,<TYPE>...] [--align <bytes>] [--classic | --extended] <file>\n"
+				"\t--no-profile  Don't order resources by the <file>.rprof access profile.\n"
+				"\t--types       Put resources of these types next, in this order.\n"
+				"\t--align       Start each resource's data at a multiple of this many bytes, e.g. 4096.\n"
+				"\t--classic, --extended  Write the file in this format (see FakeSetResFileFormat()).\n", inToolName );
+}
+
+
+// Parses a comma-separated list of type codes, e.g. "PICT,snd ,ICN#":
+static size_t	ParseTypeList( const char* inList, uint32_t* outTypes, size_t inMaxTypes )
+{
+	size_t	numTypes = 0;
+	while( *inList && numTypes < inMaxTypes )
+	{
+		uint32_t	type = 0;
+		int			x = 0;
+		for( ; x < 4 && inList[x] && inList[x] != ','; x++ )
+			type = (type << 8) | (uint8_t)inList[x];
+		for( int y = x; y < 4; y++ )
+			type = (type << 8) | ' ';	// Shorter codes are padded with spaces, like 'snd '.
+		outTypes[numTypes++] = type;
+		inList += x;
+		if( *inList == ',' )
+			inList++;
+		else if( *inList )
+			return 0;	// More than 4 characters.
+	}
+	return numTypes;
+}
+
+
+static void	PrintColdReads( const char* inLabel, uint64_t inBytesRead, uint32_t inNumReads, uint64_t inDataLength )
+{
+	printf( "  %s %llu bytes in %u read%s", inLabel, (unsigned long long)inBytesRead, inNumReads, (inNumReads == 1) ? "" : "s" );
+	if( inDataLength > 0 )
+		printf( ", read amplification %.2f", (double)inBytesRead / (double)inDataLength );
+	printf( "\n" );
+}
+
+
+int	main( int argc, const char** argv )
+{
+	uint32_t						typeOrder[MAX_TYPES_IN_ORDER];
+	struct FakeResCompactOptions	options = { .useProfile = true, .typeOrder = typeOrder };
+	int								format = -1;
+	const char*						filePath = NULL;
+	for( int x = 1; x < argc; x++ )
+	{
+		if( strcmp( argv[x], "--no-profile" ) == 0 )
+			options.useProfile = false;
+		else if( strcmp( argv[x], "--types" ) == 0 && (x +1) < argc )
+		{
+			options.numTypesInOrder = ParseTypeList( argv[++x], typeOrder, MAX_TYPES_IN_ORDER );
+			if( options.numTypesInOrder == 0 )
+			{
+				fprintf( stderr, "Type codes have at most 4 characters: %s\n", argv[x] );
+				return 1;
+			}
+		}
+		else if( strcmp( argv[x], "--align" ) == 0 && (x +1) < argc )
+			options.alignment = (uint32_t)strtoul( argv[++x], NULL, 10 );
+		else if( strcmp( argv[x], "--classic" ) == 0 )
+			format = kFakeResFileClassic;
+		else if( strcmp( argv[x], "--extended" ) == 0 )
+			format = kFakeResFileExtended;
+		else if( argv[x][0] != '-' && !filePath )
+			filePath = argv[x];
+		else
+		{
+			PrintUsage( argv[0] );
+			return 1;
+		}
+	}
+	if( !filePath || strlen( filePath ) > 255 )
+	{
+		PrintUsage( argv[0] );
+		return 1;
+	}
+	
+	unsigned char	pascalPath[256] = {0};
+	pascalPath[0] = (unsigned char)strlen( filePath );
+	memmove( pascalPath +1, filePath, pascalPath[0] );
+	FakeSetResLoad( false );	// FakeCompactResFile() reads what it needs.
+	int16_t		refNum = FakeOpenResFile( pascalPath );
+	if( refNum < 0 )
+	{
+		fprintf( stderr, "Couldn't open %s (%d)\n", filePath, FakeResError() );
+		return 1;
+	}
+	if( format >= 0 )
+		FakeSetResFileFormat( refNum, (enum FakeResFileFormat)format );
+	
+	struct FakeResCompactReport	report;
+	FakeCompactResFile( refNum, &options, &report );
+	int16_t		err = FakeResError();
+	FakeCloseResFile( refNum );
+	if( err != noErr )
+	{
+		fprintf( stderr, "Couldn't compact %s (%d)\n", filePath, err );
+		if( err == mapReadErr )
+			fprintf( stderr, "Its resources don't fit in its format, try --extended.\n" );
+		return 1;
+	}
+	
+	printf( "%s: %llu bytes, was %llu\n", filePath, (unsigned long long)report.fileLengthAfter, (unsigned long long)report.fileLengthBefore );
+	printf( "Cold resources: %llu bytes of data\n", (unsigned long long)report.coldDataLength );
+	PrintColdReads( "before:", report.coldBytesReadBefore, report.coldReadsBefore, report.coldDataLength );
+	PrintColdReads( "after: ", report.coldBytesReadAfter, report.coldReadsAfter, report.coldDataLength );
+	
+	return 0;
+}